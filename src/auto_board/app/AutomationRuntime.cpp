@@ -2,8 +2,12 @@
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <Preferences.h>
+#include <strings.h>
 
 #include "actuators/OutputActuator.h"
+#include "app/Clock.h"
+#include "app/MainStatusScan.h"
+#include "app/Seqlock.h"
 #include "automation/light_system.h"
 #include "automation/presence.h"
 #include "automation/temp_system.h"
@@ -123,7 +127,7 @@ bool parseAuthorizedCommand(const String& payload, String& outCmd) {
   uint32_t parsed = 0;
   if (!parseUint32Strict(noncePart, parsed)) return false;
   if (parsed <= lastRemoteNonce) return false;
-  if (!acceptNonce(noncePart, millis(), REMOTE_NONCE_TTL_MS)) return false;
+  if (!acceptNonce(noncePart, clockMs(), REMOTE_NONCE_TTL_MS)) return false;
 
   lastRemoteNonce = parsed;
   if (nonceCounterReady && !readOnlyStatus) {
@@ -142,12 +146,23 @@ enum class MainMode : uint8_t {
   night,
 };
 
-MainMode parseMainMode(const String& mode) {
-  const String m = normalize(mode);
-  if (m == "startup_safe") return MainMode::startup_safe;
-  if (m == "disarm") return MainMode::disarm;
-  if (m == "away") return MainMode::away;
-  if (m == "night") return MainMode::night;
+// Trimmed and case-insensitive, like normalize(), but on the scanned text in place.
+MainMode parseMainMode(const char* text) {
+  static const struct {
+    const char* name;
+    MainMode mode;
+  } kModes[] = {
+    {"startup_safe", MainMode::startup_safe},
+    {"disarm", MainMode::disarm},
+    {"away", MainMode::away},
+    {"night", MainMode::night},
+  };
+  while (isspace(static_cast<unsigned char>(*text))) ++text;
+  size_t len = strlen(text);
+  while (len > 0 && isspace(static_cast<unsigned char>(text[len - 1]))) --len;
+  for (const auto& m : kModes) {
+    if (strlen(m.name) == len && strncasecmp(text, m.name, len) == 0) return m.mode;
+  }
   return MainMode::unknown;
 }
 
@@ -162,119 +177,95 @@ const char* toText(MainMode mode) {
   }
 }
 
-inline bool isJsonWhitespace(char c) {
-  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
-}
-
-inline bool isJsonDelimiter(char c) {
-  return c == ',' || c == '}' || c == ']' || isJsonWhitespace(c);
-}
-
-int findJsonValueStart(const String& payload, const char* key) {
-  if (!key || *key == '\0') return -1;
-  const String needle = String("\"") + String(key) + String("\"");
-  int from = 0;
-  while (from < (int)payload.length()) {
-    const int keyPos = payload.indexOf(needle, from);
-    if (keyPos < 0) return -1;
-
-    int pos = keyPos + (int)needle.length();
-    while (pos < (int)payload.length() && isJsonWhitespace(payload[pos])) ++pos;
-    if (pos >= (int)payload.length() || payload[pos] != ':') {
-      from = keyPos + 1;
-      continue;
-    }
-    ++pos;
-    while (pos < (int)payload.length() && isJsonWhitespace(payload[pos])) ++pos;
-    if (pos >= (int)payload.length()) return -1;
-    return pos;
-  }
-  return -1;
-}
+WiFiClient wifiClient;
+PubSubClient mqtt(wifiClient);
 
-bool extractJsonStringField(const String& payload, const char* key, String& out) {
-  const int valueStart = findJsonValueStart(payload, key);
-  if (valueStart < 0 || payload[valueStart] != '"') return false;
-
-  out = "";
-  bool escaping = false;
-  for (int i = valueStart + 1; i < (int)payload.length(); ++i) {
-    const char c = payload[i];
-    if (escaping) {
-      out += c;
-      escaping = false;
-      continue;
-    }
-    if (c == '\\') {
-      escaping = true;
-      continue;
-    }
-    if (c == '"') {
-      return true;
-    }
-    out += c;
-  }
-  return false;
-}
+TaskHandle_t taskControlHandle = nullptr;
+TaskHandle_t taskNetHandle = nullptr;
 
-bool extractJsonBoolField(const String& payload, const char* key, bool& out) {
-  const int valueStart = findJsonValueStart(payload, key);
-  if (valueStart < 0) return false;
+// Automation state. The control task is its only writer: it keeps the working copy
+// and publishes a snapshot after each change. The net task reads snapshots and
+// hands its changes (commands, main board context) over as intents, so neither
+// task ever waits for the other.
+struct AutoState {
+  bool lightOn = false;
+  bool fanOn = false;
+  bool lightAuto = true;
+  bool fanAuto = true;
+  float lastLux = NAN;
+  bool lastLuxOk = false;
+  float lastTempC = NAN;
+  float lastHum = NAN;
+  bool hasMainMode = false;
+  MainMode lastMainMode = MainMode::unknown;
+  uint32_t lastMainModeMs = 0;
+  bool hasMainPresence = false;
+  bool someoneHome = true; // Presence's isSomeoneHome
+  uint32_t lastMainPresenceMs = 0;
+};
 
-  if (payload.startsWith("true", valueStart)) {
-    const int end = valueStart + 4;
-    if (end >= (int)payload.length() || isJsonDelimiter(payload[end])) {
-      out = true;
-      return true;
-    }
-  }
-  if (payload.startsWith("false", valueStart)) {
-    const int end = valueStart + 5;
-    if (end >= (int)payload.length() || isJsonDelimiter(payload[end])) {
-      out = false;
-      return true;
-    }
-  }
-  return false;
-}
+AutoState ctlState; // control task only (and begin(), before the tasks start)
+Seqlock<AutoState> sharedState;
+volatile uint32_t stateReadRetries = 0;
+
+enum class IntentKind : uint8_t {
+  light_auto,
+  light_on,
+  light_off,
+  fan_auto,
+  fan_on,
+  fan_off,
+  main_mode,     // arg = MainMode
+  main_presence, // arg = someone home
+};
 
-WiFiClient wifiClient;
-PubSubClient mqtt(wifiClient);
+struct StateIntent {
+  IntentKind kind;
+  uint8_t arg;
+  uint32_t atMs;
+  const char* reason; // status published once applied; nullptr for none
+};
 
-// Shared state (access guarded by stateMu).
-SemaphoreHandle_t stateMu = nullptr;
-bool lightOn = false;
-bool fanOn = false;
-bool lightAuto = true;
-bool fanAuto = true;
-float lastLux = NAN;
-bool lastLuxOk = false;
-float lastTempC = NAN;
-float lastHum = NAN;
-bool hasMainMode = false;
-MainMode lastMainMode = MainMode::unknown;
-uint32_t lastMainModeMs = 0;
-bool hasMainPresence = false;
-uint32_t lastMainPresenceMs = 0;
+constexpr UBaseType_t INTENT_QUEUE_LEN = 8;
+constexpr UBaseType_t STATUS_QUEUE_LEN = 8;
+QueueHandle_t intentQueue = nullptr;
+QueueHandle_t statusQueue = nullptr; // const char* reasons, control -> net
+volatile uint32_t intentDrops = 0;
 
 uint32_t nextStatusMs = 0;
 constexpr uint32_t STATUS_PERIOD_MS = 5000;
 
-uint32_t nextWifiRetryMs = 0;
-uint32_t nextMqttRetryMs = 0;
+// Base retry periods; NetworkDriver backs off exponentially from these.
 constexpr uint32_t WIFI_RETRY_MS = 5000;
 constexpr uint32_t MQTT_RETRY_MS = 3000;
 
-TaskHandle_t taskControlHandle = nullptr;
-TaskHandle_t taskNetHandle = nullptr;
+// Boot timing, reported once in the first status after MQTT connects.
+struct BootPhase {
+  const char* name;
+  uint32_t ms;
+};
+constexpr size_t BOOT_PHASES_MAX = 6;
+BootPhase bootPhases[BOOT_PHASES_MAX];
+size_t bootPhaseCount = 0;
+uint32_t bootStartMs = 0;
+uint32_t bootLastMs = 0;
+uint32_t mqttUpMs = 0;
+bool bootStatusPending = true;
+
+void markBootPhase(const char* name) {
+  const uint32_t nowMs = clockMs();
+  if (bootPhaseCount < BOOT_PHASES_MAX) {
+    bootPhases[bootPhaseCount].name = name;
+    bootPhases[bootPhaseCount].ms = nowMs - bootLastMs;
+    ++bootPhaseCount;
+  }
+  bootLastMs = nowMs;
+}
 
 uint32_t nextLightLogMs = 0;
 constexpr uint32_t LIGHT_LOG_MS = 1000;
 uint32_t nextClimateLogMs = 0;
 constexpr uint32_t CLIMATE_LOG_MS = 1000;
-constexpr TickType_t STATE_LOCK_TIMEOUT_TICKS = pdMS_TO_TICKS(20);
-constexpr uint32_t STATE_LOCK_WARN_COOLDOWN_MS = 5000;
-uint32_t nextStateLockWarnMs = 0;
 
 inline bool dueOrUnset(uint32_t nowMs, uint32_t targetMs) {
   return targetMs == 0 || reached(nowMs, targetMs);
@@ -286,70 +277,99 @@ bool contextFresh(bool hasContext, uint32_t lastUpdateMs, uint32_t nowMs) {
   return !reached(nowMs, lastUpdateMs + MAIN_CONTEXT_MAX_AGE_MS);
 }
 
-bool tryLockState(uint32_t nowMs, const char* where) {
-  if (!stateMu) return true;
-  if (xSemaphoreTake(stateMu, STATE_LOCK_TIMEOUT_TICKS) == pdTRUE) return true;
+// Net task side.
+AutoState readState() {
+  AutoState s;
+  const uint32_t retries = sharedState.read(s);
+  if (retries) stateReadRetries = stateReadRetries + retries;
+  return s;
+}
 
-  if (reached(nowMs, nextStateLockWarnMs)) {
-    nextStateLockWarnMs = nowMs + STATE_LOCK_WARN_COOLDOWN_MS;
-    Serial.print("[auto] WARN: state mutex timeout @");
-    Serial.println(where ? where : "unknown");
+// False if the control task is backlogged; the intent is dropped.
+bool postIntent(IntentKind kind, uint8_t arg, uint32_t atMs, const char* reason) {
+  if (!intentQueue) return false;
+  const StateIntent in = {kind, arg, atMs, reason};
+  if (xQueueSend(intentQueue, &in, 0) != pdTRUE) {
+    intentDrops = intentDrops + 1u;
+    return false;
   }
-  return false;
+  if (taskControlHandle) xTaskNotifyGive(taskControlHandle);
+  return true;
 }
 
-void unlockState() {
-  if (stateMu) xSemaphoreGive(stateMu);
+// Control task side.
+void applyOutputs() {
+  OutputActuator::apply({ctlState.lightOn, ctlState.fanOn});
 }
 
-void applyOutputs() {
-  bool lightOnCopy = false;
-  bool fanOnCopy = false;
-  const uint32_t nowMs = millis();
-  if (!tryLockState(nowMs, "applyOutputs")) return;
-  lightOnCopy = lightOn;
-  fanOnCopy = fanOn;
-  unlockState();
-  OutputActuator::apply({lightOnCopy, fanOnCopy});
+void publishState() {
+  sharedState.publish(ctlState);
 }
 
-void publishStatus(const char* reason) {
-  bool lightOnCopy = false;
-  bool fanOnCopy = false;
-  bool lightAutoCopy = true;
-  bool fanAutoCopy = true;
-  bool luxOkCopy = false;
-  float luxCopy = NAN;
-  float tCopy = NAN;
-  float hCopy = NAN;
-  bool hasMainModeCopy = false;
-  MainMode mainModeCopy = MainMode::unknown;
-  uint32_t mainModeMsCopy = 0;
-  bool mainModeFreshCopy = false;
-  bool hasMainPresenceCopy = false;
-  bool someoneHomeCopy = true;
-  uint32_t mainPresenceMsCopy = 0;
-  bool mainPresenceFreshCopy = false;
-  const uint32_t nowMs = millis();
-
-  if (!tryLockState(nowMs, "publishStatus")) return;
-  lightOnCopy = lightOn;
-  fanOnCopy = fanOn;
-  lightAutoCopy = lightAuto;
-  fanAutoCopy = fanAuto;
-  luxOkCopy = lastLuxOk;
-  luxCopy = lastLux;
-  tCopy = lastTempC;
-  hCopy = lastHum;
-  hasMainModeCopy = hasMainMode;
-  mainModeCopy = lastMainMode;
-  mainModeMsCopy = lastMainModeMs;
-  hasMainPresenceCopy = hasMainPresence;
-  someoneHomeCopy = isSomeoneHome;
-  mainPresenceMsCopy = lastMainPresenceMs;
-  unlockState();
-  mainModeFreshCopy = contextFresh(hasMainModeCopy, mainModeMsCopy, nowMs);
-  mainPresenceFreshCopy = contextFresh(hasMainPresenceCopy, mainPresenceMsCopy, nowMs);
+void applyIntent(const StateIntent& in) {
+  AutoState& s = ctlState;
+  switch (in.kind) {
+    case IntentKind::light_auto:
+      s.lightAuto = true;
+      break;
+    case IntentKind::light_on:
+    case IntentKind::light_off:
+      s.lightAuto = false;
+      s.lightOn = (in.kind == IntentKind::light_on);
+      applyOutputs();
+      break;
+    case IntentKind::fan_auto:
+      s.fanAuto = true;
+      break;
+    case IntentKind::fan_on:
+    case IntentKind::fan_off:
+      s.fanAuto = false;
+      s.fanOn = (in.kind == IntentKind::fan_on);
+      applyOutputs();
+      break;
+    case IntentKind::main_mode:
+      s.hasMainMode = true;
+      s.lastMainMode = static_cast<MainMode>(in.arg);
+      s.lastMainModeMs = in.atMs;
+      break;
+    case IntentKind::main_presence:
+      s.hasMainPresence = true;
+      Presence::setExternalHome(in.arg != 0, in.atMs);
+      s.someoneHome = isSomeoneHome;
+      s.lastMainPresenceMs = in.atMs;
+      break;
+  }
+}
+
+void drainIntents() {
+  StateIntent in;
+  while (intentQueue && xQueueReceive(intentQueue, &in, 0) == pdTRUE) {
+    applyIntent(in);
+    // The status must show the change, so it is requested after the publish.
+    publishState();
+    if (in.reason && statusQueue) xQueueSend(statusQueue, &in.reason, 0);
+  }
+}
+
+void publishStatus(const char* reason, bool withBootTiming = false) {
+  const uint32_t nowMs = clockMs();
+  const AutoState st = readState();
+  const bool lightOnCopy = st.lightOn;
+  const bool fanOnCopy = st.fanOn;
+  const bool lightAutoCopy = st.lightAuto;
+  const bool fanAutoCopy = st.fanAuto;
+  const bool luxOkCopy = st.lastLuxOk;
+  const float luxCopy = st.lastLux;
+  const float tCopy = st.lastTempC;
+  const float hCopy = st.lastHum;
+  const bool hasMainModeCopy = st.hasMainMode;
+  const MainMode mainModeCopy = st.lastMainMode;
+  const uint32_t mainModeMsCopy = st.lastMainModeMs;
+  const bool hasMainPresenceCopy = st.hasMainPresence;
+  const bool someoneHomeCopy = st.someoneHome;
+  const uint32_t mainPresenceMsCopy = st.lastMainPresenceMs;
+  const bool mainModeFreshCopy = contextFresh(hasMainModeCopy, mainModeMsCopy, nowMs);
+  const bool mainPresenceFreshCopy = contextFresh(hasMainPresenceCopy, mainPresenceMsCopy, nowMs);
 
   String payload = "{\"node\":\"auto\",\"reason\":\"";
   payload += (reason ? reason : "unknown");
@@ -391,8 +411,41 @@ void publishStatus(const char* reason) {
     payload += ",\"main_is_someone_home_stale\":";
     payload += mainPresenceFreshCopy ? "false" : "true";
   }
+  const NetworkDriver::ReconnectStats& rc = NetworkDriver::mqttReconnects();
+  if (rc.count > 0) {
+    payload += ",\"reconnects\":";
+    payload += String(rc.count);
+    payload += ",\"reconnect_ms\":";
+    payload += String(rc.lastMs);
+    payload += ",\"reconnect_max_ms\":";
+    payload += String(rc.maxMs);
+  }
+  // Snapshot copies retried because the control task published meanwhile, and
+  // commands refused because its intent queue was full.
+  const uint32_t retries = stateReadRetries;
+  const uint32_t drops = intentDrops;
+  if (retries > 0 || drops > 0) {
+    payload += ",\"state_read_retries\":";
+    payload += String(retries);
+    payload += ",\"state_intent_drops\":";
+    payload += String(drops);
+  }
   payload += ",\"uptime_ms\":";
   payload += String(nowMs);
+  if (withBootTiming) {
+    payload += ",\"boot_ms\":{\"pre\":";
+    payload += String(bootStartMs);
+    for (size_t i = 0; i < bootPhaseCount; ++i) {
+      payload += ",\"";
+      payload += bootPhases[i].name;
+      payload += "\":";
+      payload += String(bootPhases[i].ms);
+    }
+    payload += ",\"total\":";
+    payload += String(bootLastMs - bootStartMs);
+    payload += "},\"mqtt_up_ms\":";
+    payload += String(mqttUpMs);
+  }
   payload += "}";
 
   if (mqtt.connected()) {
@@ -410,7 +463,7 @@ void publishAck(const char* cmd, bool ok, const char* detail) {
   payload += ",\"detail\":\"";
   payload += (detail ? detail : "");
   payload += "\",\"uptime_ms\":";
-  payload += String(millis());
+  payload += String(clockMs());
   payload += "}";
   mqtt.publish(MQTT_TOPIC_ACK, payload.c_str(), false);
 }
@@ -418,25 +471,15 @@ void publishAck(const char* cmd, bool ok, const char* detail) {
 void logLight(uint32_t nowMs) {
   if (nextLightLogMs != 0 && !reached(nowMs, nextLightLogMs)) return;
   nextLightLogMs = nowMs + LIGHT_LOG_MS;
+  clockWakeAt(nextLightLogMs);
 
-  bool lightOnCopy = false;
-  bool lightAutoCopy = true;
-  bool luxOkCopy = false;
-  float luxCopy = NAN;
-
-  if (!tryLockState(nowMs, "logLight")) return;
-  lightOnCopy = lightOn;
-  lightAutoCopy = lightAuto;
-  luxOkCopy = lastLuxOk;
-  luxCopy = lastLux;
-  unlockState();
-
+  const AutoState& st = ctlState;
   Serial.print("[light] auto=");
-  Serial.print(lightAutoCopy ? "1" : "0");
+  Serial.print(st.lightAuto ? "1" : "0");
   Serial.print(" led=");
-  Serial.print(lightOnCopy ? "ON" : "OFF");
+  Serial.print(st.lightOn ? "ON" : "OFF");
   Serial.print(" lux=");
-  if (luxOkCopy) Serial.print(luxCopy, 1);
+  if (st.lastLuxOk) Serial.print(st.lastLux, 1);
   else Serial.print("ERR");
   Serial.println();
 }
@@ -444,30 +487,20 @@ void logLight(uint32_t nowMs) {
 void logClimate(uint32_t nowMs) {
   if (nextClimateLogMs != 0 && !reached(nowMs, nextClimateLogMs)) return;
   nextClimateLogMs = nowMs + CLIMATE_LOG_MS;
+  clockWakeAt(nextClimateLogMs);
 
-  bool fanOnCopy = false;
-  bool fanAutoCopy = true;
-  float tCopy = NAN;
-  float hCopy = NAN;
-
-  if (!tryLockState(nowMs, "logClimate")) return;
-  fanOnCopy = fanOn;
-  fanAutoCopy = fanAuto;
-  tCopy = lastTempC;
-  hCopy = lastHum;
-  unlockState();
-
+  const AutoState& st = ctlState;
   Serial.print("[climate] auto=");
-  Serial.print(fanAutoCopy ? "1" : "0");
+  Serial.print(st.fanAuto ? "1" : "0");
   Serial.print(" fan=");
-  Serial.print(fanOnCopy ? "ON" : "OFF");
+  Serial.print(st.fanOn ? "ON" : "OFF");
   Serial.print(" temp=");
   if (!ClimateSensor::available()) Serial.print("NA");
-  else if (!isnan(tCopy)) Serial.print(tCopy, 1);
+  else if (!isnan(st.lastTempC)) Serial.print(st.lastTempC, 1);
   else Serial.print("ERR");
   Serial.print(" hum=");
   if (!ClimateSensor::available()) Serial.print("NA");
-  else if (!isnan(hCopy)) Serial.print(hCopy, 1);
+  else if (!isnan(st.lastHum)) Serial.print(st.lastHum, 1);
   else Serial.print("ERR");
   Serial.println();
 }
@@ -482,12 +515,13 @@ void logNetIfChanged() {
   const bool mc = mqtt.connected();
   const int rc = mc ? 0 : mqtt.state();
 
-  const uint32_t now = millis();
+  const uint32_t now = clockMs();
   const bool changed = !(wifi == lastWifi && mc == lastMqtt && rc == lastRc);
   const bool periodic = dueOrUnset(now, nextPeriodicMs);
   if (!changed && !periodic) return;
 
   nextPeriodicMs = now + 1000;
+  clockWakeAt(nextPeriodicMs);
   lastWifi = wifi;
   lastMqtt = mc;
   lastRc = rc;
@@ -503,43 +537,58 @@ void logNetIfChanged() {
   Serial.println();
 }
 
-void onMqttMessage(char* topic, uint8_t* payload, unsigned int length) {
-  const String topicStr = topic ? String(topic) : String("");
-  String raw;
-  raw.reserve(length);
-  for (unsigned int i = 0; i < length; ++i) raw += static_cast<char>(payload[i]);
+struct CommandIntent {
+  const char* cmd;
+  IntentKind kind;
+  const char* reason;
+};
 
-  if (topicStr == String(MQTT_TOPIC_MAIN_STATUS)) {
-    String modeText;
-    const bool hasModeField = extractJsonStringField(raw, "mode", modeText);
-    const MainMode parsedMode = hasModeField ? parseMainMode(modeText) : MainMode::unknown;
-
-    bool someoneHome = false;
-    const bool hasPresenceField =
-      extractJsonBoolField(raw, "isSomeoneHome", someoneHome) ||
-      extractJsonBoolField(raw, "someone_home", someoneHome);
-
-    const bool hasValidMode = hasModeField && parsedMode != MainMode::unknown;
-    if (!hasValidMode && !hasPresenceField) return;
-
-    const uint32_t nowMs = millis();
-    if (tryLockState(nowMs, "main status context")) {
-      if (hasValidMode) {
-        hasMainMode = true;
-        lastMainMode = parsedMode;
-        lastMainModeMs = nowMs;
-      }
-      if (hasPresenceField) {
-        hasMainPresence = true;
-        Presence::setExternalHome(someoneHome, nowMs);
-        lastMainPresenceMs = nowMs;
-      }
-      unlockState();
-    }
+constexpr CommandIntent COMMAND_INTENTS[] = {
+  {"light auto", IntentKind::light_auto, "light_auto"},
+  {"light on", IntentKind::light_on, "light_on"},
+  {"light off", IntentKind::light_off, "light_off"},
+  {"fan on", IntentKind::fan_on, "fan_on"},
+  {"fan off", IntentKind::fan_off, "fan_off"},
+  {"fan auto", IntentKind::fan_auto, "fan_auto"},
+};
+
+enum class Topic : uint8_t { other, main_status, cmd };
+
+constexpr uint32_t TOPIC_MAIN_STATUS_HASH = JsonScan::fnv1a(MQTT_TOPIC_MAIN_STATUS);
+constexpr uint32_t TOPIC_CMD_HASH = JsonScan::fnv1a(MQTT_TOPIC_CMD);
+
+// One hash of the incoming topic against hashes folded at compile time; the string
+// compare only confirms a hit. Main status wins if both topics are configured equal.
+Topic routeTopic(const char* topic) {
+  if (!topic) return Topic::other;
+  const size_t len = strlen(topic);
+  const uint32_t h = JsonScan::fnv1a(reinterpret_cast<const uint8_t*>(topic), len);
+  if (h == TOPIC_MAIN_STATUS_HASH && strcmp(topic, MQTT_TOPIC_MAIN_STATUS) == 0) return Topic::main_status;
+  if (h == TOPIC_CMD_HASH && strcmp(topic, MQTT_TOPIC_CMD) == 0) return Topic::cmd;
+  return Topic::other;
+}
+
+void onMqttMessage(char* topic, uint8_t* payload, unsigned int length) {
+  const Topic route = routeTopic(topic);
+
+  if (route == Topic::main_status) {
+    // Read straight from PubSubClient's buffer: no copy, no heap.
+    const MainStatusFields f = scanMainStatus(payload, length);
+    const MainMode parsedMode = f.hasMode ? parseMainMode(f.mode) : MainMode::unknown;
+    const bool hasValidMode = parsedMode != MainMode::unknown;
+    if (!hasValidMode && !f.hasPresence) return;
+
+    const uint32_t nowMs = clockMs();
+    if (hasValidMode) postIntent(IntentKind::main_mode, static_cast<uint8_t>(parsedMode), nowMs, nullptr);
+    if (f.hasPresence) postIntent(IntentKind::main_presence, f.someoneHome ? 1 : 0, nowMs, nullptr);
     return;
   }
 
-  if (topicStr != String(MQTT_TOPIC_CMD)) return;
+  if (route != Topic::cmd) return;
+
+  String raw;
+  raw.reserve(length);
+  for (unsigned int i = 0; i < length; ++i) raw += static_cast<char>(payload[i]);
 
   String cmd;
   if (!parseAuthorizedCommand(raw, cmd)) {
@@ -548,75 +597,19 @@ void onMqttMessage(char* topic, uint8_t* payload, unsigned int length) {
     return;
   }
 
-  if (cmd == "light auto") {
-    if (!tryLockState(millis(), "cmd light auto")) {
-      publishAck("light auto", false, "state busy");
+  for (const CommandIntent& c : COMMAND_INTENTS) {
+    if (cmd != c.cmd) continue;
+    // Applied by the control task, which then requests the status update.
+    if (!postIntent(c.kind, 0, clockMs(), c.reason)) {
+      publishAck(c.cmd, false, "state busy");
       publishStatus("state_busy");
       return;
     }
-    lightAuto = true;
-    unlockState();
-    publishAck("light auto", true, "ok");
-    publishStatus("light_auto");
-  } else if (cmd == "light on") {
-    if (!tryLockState(millis(), "cmd light on")) {
-      publishAck("light on", false, "state busy");
-      publishStatus("state_busy");
-      return;
-    }
-    lightAuto = false;
-    lightOn = true;
-    unlockState();
-    applyOutputs();
-    publishAck("light on", true, "ok");
-    publishStatus("light_on");
-  } else if (cmd == "light off") {
-    if (!tryLockState(millis(), "cmd light off")) {
-      publishAck("light off", false, "state busy");
-      publishStatus("state_busy");
-      return;
-    }
-    lightAuto = false;
-    lightOn = false;
-    unlockState();
-    applyOutputs();
-    publishAck("light off", true, "ok");
-    publishStatus("light_off");
-  } else if (cmd == "fan on") {
-    if (!tryLockState(millis(), "cmd fan on")) {
-      publishAck("fan on", false, "state busy");
-      publishStatus("state_busy");
-      return;
-    }
-    fanAuto = false;
-    fanOn = true;
-    unlockState();
-    applyOutputs();
-    publishAck("fan on", true, "ok");
-    publishStatus("fan_on");
-  } else if (cmd == "fan off") {
-    if (!tryLockState(millis(), "cmd fan off")) {
-      publishAck("fan off", false, "state busy");
-      publishStatus("state_busy");
-      return;
-    }
-    fanAuto = false;
-    fanOn = false;
-    unlockState();
-    applyOutputs();
-    publishAck("fan off", true, "ok");
-    publishStatus("fan_off");
-  } else if (cmd == "fan auto") {
-    if (!tryLockState(millis(), "cmd fan auto")) {
-      publishAck("fan auto", false, "state busy");
-      publishStatus("state_busy");
-      return;
-    }
-    fanAuto = true;
-    unlockState();
-    publishAck("fan auto", true, "ok");
-    publishStatus("fan_auto");
-  } else if (cmd == "status") {
+    publishAck(c.cmd, true, "ok");
+    return;
+  }
+
+  if (cmd == "status") {
     publishAck("status", true, "ok");
     publishStatus("status");
   } else {
@@ -626,21 +619,29 @@ void onMqttMessage(char* topic, uint8_t* payload, unsigned int length) {
 }
 
 void connectWifi(uint32_t nowMs) {
-  NetworkDriver::tryConnectWifi(nowMs, nextWifiRetryMs, WIFI_RETRY_MS);
+  NetworkDriver::tryConnectWifi(nowMs, WIFI_RETRY_MS);
 }
 
 void connectMqtt(uint32_t nowMs) {
-  const bool connected = NetworkDriver::tryConnectMqtt(
-    mqtt,
-    nowMs,
-    nextMqttRetryMs,
-    MQTT_RETRY_MS
-  );
+  const bool connected = NetworkDriver::tryConnectMqtt(mqtt, nowMs, MQTT_RETRY_MS);
   if (!connected) return;
+  const NetworkDriver::ReconnectStats& rc = NetworkDriver::mqttReconnects();
+  if (rc.count > 0) {
+    Serial.print("[net] mqtt reconnected in ");
+    Serial.print(rc.lastMs);
+    Serial.println(" ms");
+  }
   mqtt.subscribe(MQTT_TOPIC_CMD);
-  if (String(MQTT_TOPIC_MAIN_STATUS) != String(MQTT_TOPIC_CMD)) {
+  if (strcmp(MQTT_TOPIC_MAIN_STATUS, MQTT_TOPIC_CMD) != 0) {
     mqtt.subscribe(MQTT_TOPIC_MAIN_STATUS);
   }
+  if (bootStatusPending) {
+    // The boot status could not go out before the broker was reachable; send it now.
+    bootStatusPending = false;
+    mqttUpMs = clockMs();
+    publishStatus("boot", true);
+    return;
+  }
   publishStatus("online");
 }
 
@@ -649,104 +650,80 @@ void taskControl(void*) {
   uint32_t nextDhtMs = 0;
 
   for (;;) {
-    const uint32_t now = millis();
-    if (tryLockState(now, "presence tick")) {
-      Presence::tick(now);
-      unlockState();
-    }
+    const uint32_t now = clockMs();
+    AutoState& st = ctlState;
+    drainIntents();
+
+    Presence::tick(now);
+    bool changed = st.someoneHome != isSomeoneHome;
+    st.someoneHome = isSomeoneHome;
+
+    // Policy:
+    // - If main context exists, keep using the latest known values even when stale.
+    // - If no context has ever been received, use conservative fallback (keep auto-light/fan off).
+    const bool allowByMainMode = st.hasMainMode && st.lastMainMode != MainMode::away;
+    const bool allowByMainPresence = st.hasMainPresence && st.someoneHome;
 
     // Read lux and run local light automation.
     if (LightSensor::isReady() && dueOrUnset(now, nextLuxMs)) {
       nextLuxMs = now + AutoHw::LIGHT_SAMPLE_MS;
+      clockWakeAt(nextLuxMs);
 
       float lux = NAN;
       const bool ok = LightSensor::readLux(lux);
-
-      bool doAuto = true;
-      bool curLight = false;
-      bool allowByMainMode = true;
-      bool allowByMainPresence = true;
-      if (tryLockState(now, "taskControl lux")) {
-        lastLuxOk = ok;
-        lastLux = lux;
-        doAuto = lightAuto;
-        curLight = lightOn;
-        // Policy:
-        // - If main context exists, keep using the latest known values even when stale.
-        // - If no context has ever been received, use conservative fallback (keep auto-light off).
-        allowByMainMode = hasMainMode && lastMainMode != MainMode::away;
-        allowByMainPresence = hasMainPresence && isSomeoneHome;
-        unlockState();
-      } else {
-        doAuto = false;
-      }
+      st.lastLuxOk = ok;
+      st.lastLux = lux;
+      changed = true;
 
       const bool newLight = AutomationPipeline::nextLight(
-        doAuto,
-        curLight,
+        st.lightAuto,
+        st.lightOn,
         ok,
         lux,
         allowByMainMode,
         allowByMainPresence
       );
-      if (newLight != curLight) {
-        if (tryLockState(now, "taskControl set light")) {
-          lightOn = newLight;
-          unlockState();
-          applyOutputs();
-        }
+      if (newLight != st.lightOn) {
+        st.lightOn = newLight;
+        applyOutputs();
       }
     }
 
     // Read DHT at a slower cadence.
     if (ClimateSensor::available() && dueOrUnset(now, nextDhtMs)) {
       nextDhtMs = now + AutoHw::TEMP_SAMPLE_MS;
+      clockWakeAt(nextDhtMs);
       float t = NAN;
       float h = NAN;
       ClimateSensor::read(t, h);
-
-      bool doFanAuto = false;
-      bool curFan = false;
-      bool allowByMainMode = true;
-      bool allowByMainPresence = true;
-      if (tryLockState(now, "taskControl dht")) {
-        lastTempC = t;
-        lastHum = h;
-        doFanAuto = fanAuto;
-        curFan = fanOn;
-        // Policy:
-        // - If main context exists, keep using the latest known values even when stale.
-        // - If no context has ever been received, use conservative fallback (keep auto-fan off).
-        allowByMainMode = hasMainMode && lastMainMode != MainMode::away;
-        allowByMainPresence = hasMainPresence && isSomeoneHome;
-        unlockState();
-      }
+      st.lastTempC = t;
+      st.lastHum = h;
+      changed = true;
 
       const bool newFan = AutomationPipeline::nextFan(
-        doFanAuto,
-        curFan,
+        st.fanAuto,
+        st.fanOn,
         t,
         allowByMainMode,
         allowByMainPresence
       );
-      if (newFan != curFan) {
-        if (tryLockState(now, "taskControl set fan")) {
-          fanOn = newFan;
-          unlockState();
-          applyOutputs();
-        }
+      if (newFan != st.fanOn) {
+        st.fanOn = newFan;
+        applyOutputs();
       }
     }
 
+    if (changed) publishState();
     logLight(now);
     logClimate(now);
-    vTaskDelay(pdMS_TO_TICKS(50));
+    // An intent from the net task wakes the loop early.
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(50));
   }
 }
 
 void taskNet(void*) {
   for (;;) {
-    const uint32_t now = millis();
+    const uint32_t now = clockMs();
 
     connectWifi(now);
     connectMqtt(now);
@@ -756,8 +733,14 @@ void taskNet(void*) {
       mqtt.loop();
     }
 
+    const char* reason = nullptr;
+    while (statusQueue && xQueueReceive(statusQueue, &reason, 0) == pdTRUE) {
+      publishStatus(reason);
+    }
+
     if (dueOrUnset(now, nextStatusMs)) {
       nextStatusMs = now + STATUS_PERIOD_MS;
+      clockWakeAt(nextStatusMs);
       publishStatus("periodic");
     }
 
@@ -770,21 +753,28 @@ void taskNet(void*) {
 namespace AutoRuntime {
 
 void begin() {
+  bootStartMs = clockMs();
+  bootLastMs = bootStartMs;
+
   Presence::init();
   LightSystem::init();
   TempSystem::init();
   OutputActuator::init();
 
-  stateMu = xSemaphoreCreateMutex();
-  if (!stateMu) {
-    Serial.println("[auto] FATAL: state mutex create failed; halting");
+  intentQueue = xQueueCreate(INTENT_QUEUE_LEN, sizeof(StateIntent));
+  statusQueue = xQueueCreate(STATUS_QUEUE_LEN, sizeof(const char*));
+  if (!intentQueue || !statusQueue) {
+    Serial.println("[auto] FATAL: state queue create failed; halting");
     while (true) {
       delay(1000);
     }
   }
 
+  // Network first: association runs in the Wi-Fi stack while the peripherals below come up.
   NetworkDriver::initWifiSta();
-  NetworkDriver::initMqtt(mqtt, onMqttMessage);
+  NetworkDriver::initMqtt(mqtt, wifiClient, onMqttMessage);
+  connectWifi(clockMs());
+  markBootPhase("net");
 
   nonceCounterReady = noncePref.begin("eshautov2", false);
   if (nonceCounterReady) {
@@ -793,6 +783,7 @@ void begin() {
     lastRemoteNonce = 0;
     Serial.println("[auto] WARN: nonce persistence unavailable; mutating remote commands blocked");
   }
+  markBootPhase("nvs");
 
   LightSensor::begin();
   if (LightSensor::isReady()) {
@@ -805,20 +796,22 @@ void begin() {
     Serial.print(AutoHw::BH1750_ADDR_SECONDARY, HEX);
     Serial.println(")");
   }
+  markBootPhase("light");
 
   applyOutputs();
+  publishState();
   ClimateSensor::begin();
   if (ClimateSensor::available()) {
     Serial.println("[auto] DHT ready");
   } else {
     Serial.println("[auto] DHT disabled (PIN_UNUSED)");
   }
+  markBootPhase("io");
 
-  const uint32_t now = millis();
-  connectWifi(now);
-  connectMqtt(now);
-  publishStatus("boot");
-
+  // Boot timing is final before the net task (its only reader) starts.
+  Serial.printf("[auto] boot done in %lums (pre=%lums)\n",
+                (unsigned long)(bootLastMs - bootStartMs),
+                (unsigned long)bootStartMs);
   TaskRunner::start(taskControl, taskNet, &taskControlHandle, &taskNetHandle);
 }
 
@@ -0,0 +1,22 @@
+#include "app/Clock.h"
+
+#include <Arduino.h>
+
+namespace {
+class HardwareClock : public Clock {
+public:
+  uint32_t ms() const override { return millis(); }
+  uint32_t us() const override { return micros(); }
+};
+
+HardwareClock gHardwareClock;
+Clock* gClock = &gHardwareClock;
+} // namespace
+
+Clock& systemClock() {
+  return *gClock;
+}
+
+void installClock(Clock* clock) {
+  gClock = clock ? clock : &gHardwareClock;
+}
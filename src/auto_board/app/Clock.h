@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdint.h>
+
+// Time source for all timing code. Modules read clockMs()/clockUs() rather than
+// millis()/micros(), so a host-side simulation can install a SimClock and run days
+// of behaviour without waiting for them. The main board carries the same header.
+class Clock {
+public:
+  virtual ~Clock() {}
+  virtual uint32_t ms() const = 0;
+  virtual uint32_t us() const = 0;
+  // A module has a deadline at atMs. The hardware clock ignores it; SimClock jumps
+  // to it.
+  virtual void wakeAt(uint32_t atMs) { (void)atMs; }
+};
+
+// The hardware clock unless another is installed (nullptr restores it). Install
+// before the tasks start; the pointer is not guarded.
+Clock& systemClock();
+void installClock(Clock* clock);
+
+inline uint32_t clockMs() { return systemClock().ms(); }
+inline uint32_t clockUs() { return systemClock().us(); }
+inline void clockWakeAt(uint32_t atMs) { systemClock().wakeAt(atMs); }
+
+// Simulated time: stands still until moved. step() jumps straight to the earliest
+// registered deadline, so idle stretches cost one call.
+class SimClock : public Clock {
+public:
+  static constexpr uint8_t kMaxWakeups = 32;
+
+  explicit SimClock(uint32_t startMs = 0) : us_((uint64_t)startMs * 1000u) {}
+
+  uint32_t ms() const override { return (uint32_t)(us_ / 1000u); }
+  uint32_t us() const override { return (uint32_t)us_; }
+
+  void wakeAt(uint32_t atMs) override {
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (wake_[i] == atMs) return;
+    }
+    if (count_ < kMaxWakeups) {
+      wake_[count_++] = atMs;
+      return;
+    }
+    // Full: the furthest deadline gives way to an earlier one.
+    uint8_t far = 0;
+    for (uint8_t i = 1; i < count_; ++i) {
+      if (distance(wake_[i]) > distance(wake_[far])) far = i;
+    }
+    if (distance(atMs) < distance(wake_[far])) wake_[far] = atMs;
+    ++dropped_;
+  }
+
+  void advanceUs(uint32_t deltaUs) { us_ += deltaUs; }
+  void advanceMs(uint32_t deltaMs) { us_ += (uint64_t)deltaMs * 1000u; }
+
+  // Moves to the earliest deadline due by limitMs (one already past counts as due
+  // now) and returns true, or to limitMs and returns false if there is none.
+  bool step(uint32_t limitMs) {
+    uint32_t best = limitMs - ms();
+    int16_t at = -1;
+    for (uint8_t i = 0; i < count_; ++i) {
+      const uint32_t d = distance(wake_[i]);
+      if (d <= best) {
+        best = d;
+        at = i;
+      }
+    }
+    if (at >= 0) {
+      wake_[at] = wake_[--count_];
+      ++jumps_;
+    }
+    us_ = (us_ / 1000u + best) * 1000u;
+    return at >= 0;
+  }
+
+  uint8_t pending() const { return count_; }
+  uint32_t jumps() const { return jumps_; }
+  uint32_t dropped() const { return dropped_; }
+
+private:
+  // Wrap-safe: a deadline already passed is at distance 0.
+  uint32_t distance(uint32_t atMs) const {
+    const int32_t d = (int32_t)(atMs - ms());
+    return d < 0 ? 0u : (uint32_t)d;
+  }
+
+  uint64_t us_;
+  uint32_t wake_[kMaxWakeups] = {};
+  uint8_t count_ = 0;
+  uint32_t jumps_ = 0;
+  uint32_t dropped_ = 0;
+};
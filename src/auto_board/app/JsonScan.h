@@ -0,0 +1,257 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Single-pass, allocation-free JSON tokenizer over a raw buffer (the MQTT payload as
+// received). next() yields one token at a time, SAX style; strings and numbers are
+// reported as views into the buffer, so a caller picks out the fields it wants in
+// one scan and skips the rest without copying anything.
+namespace JsonScan {
+
+constexpr uint32_t kFnvBasis = 2166136261u;
+constexpr uint32_t kFnvPrime = 16777619u;
+
+// Compile-time hash of a literal (topic routing tables).
+constexpr uint32_t fnv1a(const char* s, uint32_t h = kFnvBasis) {
+  return *s ? fnv1a(s + 1, (h ^ (uint8_t)*s) * kFnvPrime) : h;
+}
+
+inline uint32_t fnv1a(const uint8_t* p, size_t len) {
+  uint32_t h = kFnvBasis;
+  for (size_t i = 0; i < len; ++i) h = (h ^ p[i]) * kFnvPrime;
+  return h;
+}
+
+enum class Token : uint8_t {
+  begin_object,
+  end_object,
+  begin_array,
+  end_array,
+  key,    // text() is the key; the next token is its value
+  string,
+  number,
+  literal_true,
+  literal_false,
+  literal_null,
+  end,    // the whole document was consumed
+  error   // malformed input; stays in error from here on
+};
+
+class Tokenizer {
+public:
+  static constexpr uint8_t kMaxDepth = 32;
+
+  Tokenizer(const uint8_t* data, size_t len) : p_(data), len_(data ? len : 0) {}
+
+  Token next() {
+    if (expect_ == Expect::failed) return Token::error;
+    skipSpace();
+    if (pos_ >= len_) return (expect_ == Expect::done) ? Token::end : fail();
+    const uint8_t c = p_[pos_];
+    switch (expect_) {
+      case Expect::key_or_close:
+        if (c == '}') return close(c);
+        return key(c);
+      case Expect::key:
+        return key(c);
+      case Expect::value_or_close:
+        if (c == ']') return close(c);
+        return value(c);
+      case Expect::value:
+        return value(c);
+      case Expect::comma_or_close:
+        if (c == '}' || c == ']') return close(c);
+        if (c != ',') return fail();
+        ++pos_;
+        expect_ = inObject() ? Expect::key : Expect::value;
+        return next();
+      case Expect::done:
+      case Expect::failed:
+      default:
+        return fail(); // trailing bytes after the document
+    }
+  }
+
+  // Last key, string, number or literal, without the quotes; escapes are left as
+  // they are (see copyText()).
+  const uint8_t* text() const { return p_ + textPos_; }
+  size_t textLen() const { return textLen_; }
+  bool escaped() const { return escaped_; }
+  // Containers open after the last token; keys of the top-level object are at 1.
+  uint8_t depth() const { return depth_; }
+
+  // Exact match of the raw text against a literal.
+  bool textIs(const char* lit) const {
+    size_t i = 0;
+    for (; lit[i]; ++i) {
+      if (i >= textLen_ || p_[textPos_ + i] != (uint8_t)lit[i]) return false;
+    }
+    return i == textLen_;
+  }
+
+  // Decoded text into out (NUL-terminated, truncated to cap - 1); \uXXXX outside
+  // ASCII becomes '?'. Returns the length written.
+  size_t copyText(char* out, size_t cap) const {
+    if (cap == 0) return 0;
+    size_t n = 0;
+    for (size_t i = 0; i < textLen_ && n + 1 < cap; ++i) {
+      char c = (char)p_[textPos_ + i];
+      if (c == '\\' && i + 1 < textLen_) {
+        c = unescape(i);
+      }
+      out[n++] = c;
+    }
+    out[n] = '\0';
+    return n;
+  }
+
+private:
+  enum class Expect : uint8_t { value, key, key_or_close, value_or_close, comma_or_close, done, failed };
+
+  Token fail() {
+    expect_ = Expect::failed;
+    return Token::error;
+  }
+
+  void skipSpace() {
+    while (pos_ < len_) {
+      const uint8_t c = p_[pos_];
+      if (c != ' ' && c != '\t' && c != '\r' && c != '\n') return;
+      ++pos_;
+    }
+  }
+
+  bool inObject() const { return depth_ > 0 && ((objects_ >> (depth_ - 1)) & 1u); }
+
+  void afterValue() { expect_ = depth_ ? Expect::comma_or_close : Expect::done; }
+
+  Token key(uint8_t c) {
+    if (c != '"' || !scanString()) return fail();
+    skipSpace();
+    if (pos_ >= len_ || p_[pos_] != ':') return fail();
+    ++pos_;
+    expect_ = Expect::value;
+    return Token::key;
+  }
+
+  Token value(uint8_t c) {
+    switch (c) {
+      case '{':
+      case '[':
+        if (depth_ >= kMaxDepth) return fail();
+        if (c == '{') objects_ |= (uint32_t)1u << depth_;
+        else objects_ &= ~((uint32_t)1u << depth_);
+        ++depth_;
+        ++pos_;
+        expect_ = (c == '{') ? Expect::key_or_close : Expect::value_or_close;
+        return (c == '{') ? Token::begin_object : Token::begin_array;
+      case '"':
+        if (!scanString()) return fail();
+        afterValue();
+        return Token::string;
+      case 't':
+        return literal("true", Token::literal_true);
+      case 'f':
+        return literal("false", Token::literal_false);
+      case 'n':
+        return literal("null", Token::literal_null);
+      default:
+        if (c != '-' && (c < '0' || c > '9')) return fail();
+        textPos_ = pos_;
+        while (pos_ < len_ && isNumberChar(p_[pos_])) ++pos_;
+        textLen_ = pos_ - textPos_;
+        escaped_ = false;
+        afterValue();
+        return Token::number;
+    }
+  }
+
+  Token close(uint8_t c) {
+    if (depth_ == 0 || inObject() != (c == '}')) return fail();
+    --depth_;
+    ++pos_;
+    afterValue();
+    return (c == '}') ? Token::end_object : Token::end_array;
+  }
+
+  Token literal(const char* word, Token t) {
+    textPos_ = pos_;
+    size_t i = 0;
+    for (; word[i]; ++i) {
+      if (pos_ + i >= len_ || p_[pos_ + i] != (uint8_t)word[i]) return fail();
+    }
+    pos_ += i;
+    textLen_ = i;
+    escaped_ = false;
+    afterValue();
+    return t;
+  }
+
+  // pos_ at the opening quote; leaves it past the closing one.
+  bool scanString() {
+    ++pos_;
+    textPos_ = pos_;
+    escaped_ = false;
+    while (pos_ < len_) {
+      const uint8_t c = p_[pos_];
+      if (c == '"') {
+        textLen_ = pos_ - textPos_;
+        ++pos_;
+        return true;
+      }
+      if (c < 0x20) return false;
+      if (c == '\\') {
+        escaped_ = true;
+        ++pos_;
+      }
+      ++pos_;
+    }
+    return false;
+  }
+
+  static bool isNumberChar(uint8_t c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+  }
+
+  // i at a backslash inside the text; advances past the escape.
+  char unescape(size_t& i) const {
+    const char e = (char)p_[textPos_ + ++i];
+    switch (e) {
+      case 'b': return '\b';
+      case 'f': return '\f';
+      case 'n': return '\n';
+      case 'r': return '\r';
+      case 't': return '\t';
+      case 'u': {
+        uint32_t cp = 0;
+        uint8_t digits = 0;
+        while (digits < 4 && i + 1 < textLen_) {
+          const char h = (char)p_[textPos_ + i + 1];
+          const int v = (h >= '0' && h <= '9') ? h - '0'
+                      : (h >= 'a' && h <= 'f') ? h - 'a' + 10
+                      : (h >= 'A' && h <= 'F') ? h - 'A' + 10
+                                               : -1;
+          if (v < 0) break;
+          cp = (cp << 4) | (uint32_t)v;
+          ++digits;
+          ++i;
+        }
+        return (digits == 4 && cp < 0x80) ? (char)cp : '?';
+      }
+      default: return e; // \" \\ \/
+    }
+  }
+
+  const uint8_t* p_;
+  size_t len_;
+  size_t pos_ = 0;
+  size_t textPos_ = 0;
+  size_t textLen_ = 0;
+  bool escaped_ = false;
+  uint8_t depth_ = 0;
+  uint32_t objects_ = 0; // bit per depth: 1 = object, 0 = array
+  Expect expect_ = Expect::value;
+};
+
+} // namespace JsonScan
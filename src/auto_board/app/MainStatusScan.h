@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "JsonScan.h"
+
+// The fields of the main board's status message the auto board acts on, read in one
+// pass straight from the MQTT payload buffer. Only top-level keys count; nested
+// objects (boot_ms) are stepped over. A malformed tail keeps what was read before it.
+struct MainStatusFields {
+  static constexpr size_t kModeCap = 24;
+
+  bool hasMode = false;
+  char mode[kModeCap] = {};
+  bool hasPresence = false;
+  bool someoneHome = false;
+};
+
+inline MainStatusFields scanMainStatus(const uint8_t* payload, size_t length) {
+  MainStatusFields f;
+  bool fromAlias = false; // "someone_home" yields to "isSomeoneHome"
+  JsonScan::Tokenizer t(payload, length);
+  if (t.next() != JsonScan::Token::begin_object) return f;
+
+  for (;;) {
+    const JsonScan::Token tok = t.next();
+    if (tok == JsonScan::Token::end || tok == JsonScan::Token::error) return f;
+    if (tok != JsonScan::Token::key || t.depth() != 1) continue;
+
+    enum { other, mode, presence, presenceAlias } field = other;
+    if (t.textIs("mode")) field = mode;
+    else if (t.textIs("isSomeoneHome")) field = presence;
+    else if (t.textIs("someone_home")) field = presenceAlias;
+
+    const JsonScan::Token value = t.next();
+    if (value == JsonScan::Token::error) return f;
+    if (field == mode && value == JsonScan::Token::string && !f.hasMode) {
+      t.copyText(f.mode, sizeof(f.mode));
+      f.hasMode = true;
+    } else if ((field == presence || field == presenceAlias) &&
+               (value == JsonScan::Token::literal_true || value == JsonScan::Token::literal_false)) {
+      if (f.hasPresence && (!fromAlias || field == presenceAlias)) continue;
+      f.hasPresence = true;
+      f.someoneHome = (value == JsonScan::Token::literal_true);
+      fromAlias = (field == presenceAlias);
+    }
+  }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Single-writer snapshot cell. The writer publishes a whole copy of T; readers copy
+// it out without taking a lock, retrying only if a publish overlapped the copy.
+// The writer never waits on readers and readers never wait on a mutex, so neither
+// side can time out. T must be trivially copyable.
+//
+// The publish runs in a critical section so a preempted writer cannot leave the
+// sequence odd while a reader spins on the other core.
+template <typename T>
+class Seqlock {
+public:
+  void publish(const T& value) {
+    portENTER_CRITICAL(&mux_);
+    seq_ = seq_ + 1u;
+    __sync_synchronize();
+    data_ = value;
+    __sync_synchronize();
+    seq_ = seq_ + 1u;
+    portEXIT_CRITICAL(&mux_);
+  }
+
+  // Returns how many times the copy had to be retried (0 almost always).
+  uint32_t read(T& out) const {
+    uint32_t retries = 0;
+    for (;;) {
+      const uint32_t before = seq_;
+      __sync_synchronize();
+      if ((before & 1u) == 0) {
+        out = data_;
+        __sync_synchronize();
+        if (seq_ == before) return retries;
+      }
+      ++retries;
+    }
+  }
+
+private:
+  volatile uint32_t seq_ = 0;
+  T data_{};
+  portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+};
@@ -1,5 +1,7 @@
 #include "presence.h"
 
+#include "app/Clock.h"
+
 bool isSomeoneHome = true;
 
 namespace Presence {
@@ -136,6 +138,9 @@ void tick(uint32_t nowMs) {
     }
     resetExit();
   }
+
+  if (entryStage_ != EntryStage::idle) clockWakeAt(entryDeadlineMs_);
+  if (exitStage_ != ExitStage::idle) clockWakeAt(exitDeadlineMs_);
 }
 
 void setExternalHome(bool home, uint32_t nowMs) {
@@ -1,39 +1,193 @@
 #include "drivers/NetworkDriver.h"
 
-#include <WiFi.h>
+#include <esp_system.h>
+#include <lwip/sockets.h>
+
+#include "app/Clock.h"
 
 namespace NetworkDriver {
 
+namespace {
+
+constexpr uint32_t kRetryMaxMs = 60000;
+constexpr uint8_t kFastRejoinAttempts = 2;
+
+WiFiClient* net = nullptr;
+
+bool wifiUp = false;
+uint8_t wifiFailures = 0;
+uint32_t nextWifiRetryMs = 0;
+uint8_t bssid[6] = {};
+int32_t channel = 0;
+bool haveBssid = false;
+
+IPAddress brokerIp;
+bool brokerResolved = false;
+int connectFd = -1;
+uint32_t connectStartMs = 0;
+uint8_t mqttFailures = 0;
+uint32_t nextMqttRetryMs = 0;
+bool mqttUp = false;
+bool mqttDown = false;
+uint32_t mqttDownMs = 0;
+ReconnectStats reconnects;
+
+inline bool reached(uint32_t nowMs, uint32_t targetMs) {
+  return (int32_t)(nowMs - targetMs) >= 0;
+}
+
+// base * 2^failures capped at kRetryMaxMs, half of it randomized so boards that lost
+// the broker together do not retry in lockstep.
+uint32_t backoffMs(uint32_t baseMs, uint8_t& failures) {
+  uint32_t ceiling = baseMs;
+  for (uint8_t i = 0; i < failures && ceiling < kRetryMaxMs; ++i) ceiling <<= 1;
+  if (ceiling > kRetryMaxMs) ceiling = kRetryMaxMs;
+  if (failures < 31) ++failures;
+  const uint32_t half = ceiling / 2;
+  return half + esp_random() % (ceiling - half + 1);
+}
+
+void closeConnectSocket() {
+  if (connectFd < 0) return;
+  close(connectFd);
+  connectFd = -1;
+}
+
+bool startTcpConnect() {
+  if (!brokerResolved) {
+    brokerResolved = brokerIp.fromString(MQTT_BROKER) || WiFi.hostByName(MQTT_BROKER, brokerIp) == 1;
+    if (!brokerResolved) return false;
+  }
+  const int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return false;
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(MQTT_PORT);
+  addr.sin_addr.s_addr = (uint32_t)brokerIp;
+  if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+    close(fd);
+    return false;
+  }
+  connectFd = fd;
+  return true;
+}
+
+// 1 = connected, 0 = pending, -1 = failed.
+int pollTcpConnect() {
+  fd_set wr;
+  FD_ZERO(&wr);
+  FD_SET(connectFd, &wr);
+  timeval tv = {0, 0};
+  const int n = select(connectFd + 1, nullptr, &wr, nullptr, &tv);
+  if (n == 0) return 0;
+  int err = 0;
+  socklen_t len = sizeof(err);
+  if (n < 0 || getsockopt(connectFd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) return -1;
+  // WiFiClient expects a blocking socket.
+  fcntl(connectFd, F_SETFL, fcntl(connectFd, F_GETFL, 0) & ~O_NONBLOCK);
+  const int one = 1;
+  setsockopt(connectFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return 1;
+}
+
+void mqttAttemptFailed(uint32_t nowMs, uint32_t baseRetryMs) {
+  closeConnectSocket();
+  nextMqttRetryMs = nowMs + backoffMs(baseRetryMs, mqttFailures);
+}
+
+} // namespace
+
 void initWifiSta() {
+  // Rejoin is driven from tryConnectWifi(), not by the stack's full-scan reconnect.
   WiFi.mode(WIFI_STA);
-  WiFi.setAutoReconnect(true);
+  WiFi.setAutoReconnect(false);
   WiFi.persistent(false);
 }
 
-void initMqtt(PubSubClient& mqtt, void (*callback)(char*, uint8_t*, unsigned int)) {
+void initMqtt(PubSubClient& mqtt, WiFiClient& client, void (*callback)(char*, uint8_t*, unsigned int)) {
+  net = &client;
   mqtt.setServer(MQTT_BROKER, MQTT_PORT);
   mqtt.setKeepAlive(MQTT_KEEPALIVE_S);
   mqtt.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
   mqtt.setCallback(callback);
 }
 
-void tryConnectWifi(uint32_t nowMs, uint32_t& nextRetryMs, uint32_t retryMs) {
-  if (WiFi.status() == WL_CONNECTED) return;
-  if ((int32_t)(nowMs - nextRetryMs) < 0) return;
-  nextRetryMs = nowMs + retryMs;
-  if (strlen(WIFI_SSID) == 0) return;
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+void tryConnectWifi(uint32_t nowMs, uint32_t baseRetryMs) {
+  if (WiFi.status() == WL_CONNECTED) {
+    if (!wifiUp) {
+      wifiUp = true;
+      wifiFailures = 0;
+      const uint8_t* b = WiFi.BSSID();
+      if (b) {
+        memcpy(bssid, b, sizeof(bssid));
+        channel = WiFi.channel();
+        haveBssid = true;
+      }
+    }
+    return;
+  }
+  if (wifiUp) {
+    wifiUp = false;
+    nextWifiRetryMs = nowMs; // first rejoin right away
+  }
+  if (!reached(nowMs, nextWifiRetryMs)) return;
+  if (strlen(WIFI_SSID) == 0) {
+    nextWifiRetryMs = nowMs + baseRetryMs;
+    return;
+  }
+
+  const bool fast = haveBssid && wifiFailures < kFastRejoinAttempts;
+  nextWifiRetryMs = nowMs + backoffMs(baseRetryMs, wifiFailures);
+  if (fast) {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, channel, bssid, true);
+  } else {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  }
 }
 
-bool tryConnectMqtt(PubSubClient& mqtt, uint32_t nowMs, uint32_t& nextRetryMs, uint32_t retryMs) {
-  if (WiFi.status() != WL_CONNECTED) return false;
+bool tryConnectMqtt(PubSubClient& mqtt, uint32_t nowMs, uint32_t baseRetryMs) {
   if (mqtt.connected()) return false;
-  if ((int32_t)(nowMs - nextRetryMs) < 0) return false;
-  nextRetryMs = nowMs + retryMs;
+  if (mqttUp) {
+    mqttUp = false;
+    mqttDown = true;
+    mqttDownMs = nowMs;
+    nextMqttRetryMs = nowMs;
+  }
+  if (!net || WiFi.status() != WL_CONNECTED) {
+    closeConnectSocket();
+    return false;
+  }
+
+  if (connectFd < 0) {
+    if (!reached(nowMs, nextMqttRetryMs)) return false;
+    connectStartMs = nowMs;
+    if (!startTcpConnect()) mqttAttemptFailed(nowMs, baseRetryMs);
+    return false;
+  }
+
+  const int tcp = pollTcpConnect();
+  if (tcp == 0) {
+    if ((uint32_t)(nowMs - connectStartMs) >= (uint32_t)MQTT_SOCKET_TIMEOUT_S * 1000u) {
+      mqttAttemptFailed(nowMs, baseRetryMs);
+    }
+    return false;
+  }
+  if (tcp < 0) {
+    brokerResolved = false; // look the broker up again next time
+    mqttAttemptFailed(nowMs, baseRetryMs);
+    return false;
+  }
 
+  // The socket is connected, so PubSubClient skips its own TCP connect.
+  *net = WiFiClient(connectFd);
+  connectFd = -1;
+
+  bool connected = false;
   const bool hasAuth = strlen(MQTT_USERNAME) > 0;
   if (hasAuth) {
-    return mqtt.connect(
+    connected = mqtt.connect(
       MQTT_CLIENT_ID,
       MQTT_USERNAME,
       MQTT_PASSWORD,
@@ -42,15 +196,34 @@ bool tryConnectMqtt(PubSubClient& mqtt, uint32_t nowMs, uint32_t& nextRetryMs, u
       true,
       "{\"node\":\"auto\",\"reason\":\"offline\"}"
     );
+  } else {
+    connected = mqtt.connect(
+      MQTT_CLIENT_ID,
+      MQTT_TOPIC_STATUS,
+      1,
+      true,
+      "{\"node\":\"auto\",\"reason\":\"offline\"}"
+    );
+  }
+  if (!connected) {
+    net->stop();
+    mqttAttemptFailed(clockMs(), baseRetryMs);
+    return false;
   }
 
-  return mqtt.connect(
-    MQTT_CLIENT_ID,
-    MQTT_TOPIC_STATUS,
-    1,
-    true,
-    "{\"node\":\"auto\",\"reason\":\"offline\"}"
-  );
+  mqttUp = true;
+  mqttFailures = 0;
+  if (mqttDown) {
+    mqttDown = false;
+    reconnects.lastMs = clockMs() - mqttDownMs;
+    if (reconnects.lastMs > reconnects.maxMs) reconnects.maxMs = reconnects.lastMs;
+    ++reconnects.count;
+  }
+  return true;
+}
+
+const ReconnectStats& mqttReconnects() {
+  return reconnects;
 }
 
 } // namespace NetworkDriver
@@ -2,12 +2,26 @@
 
 #include <Arduino.h>
 #include <PubSubClient.h>
+#include <WiFi.h>
 
 namespace NetworkDriver {
 
+struct ReconnectStats {
+  uint32_t count = 0;  // reconnects after a lost link (the first connect is not counted)
+  uint32_t lastMs = 0; // link lost -> CONNACK
+  uint32_t maxMs = 0;
+};
+
 void initWifiSta();
-void initMqtt(PubSubClient& mqtt, void (*callback)(char*, uint8_t*, unsigned int));
-void tryConnectWifi(uint32_t nowMs, uint32_t& nextRetryMs, uint32_t retryMs);
-bool tryConnectMqtt(PubSubClient& mqtt, uint32_t nowMs, uint32_t& nextRetryMs, uint32_t retryMs);
+// net must be the client PubSubClient was constructed with.
+void initMqtt(PubSubClient& mqtt, WiFiClient& net, void (*callback)(char*, uint8_t*, unsigned int));
+// Retries back off exponentially (with jitter) from baseRetryMs; a rejoin first reuses
+// the last BSSID/channel to skip the scan.
+void tryConnectWifi(uint32_t nowMs, uint32_t baseRetryMs);
+// Never waits for TCP: the socket connects in the background across calls, and only
+// the CONNACK wait (bounded by MQTT_SOCKET_TIMEOUT_S) runs inside PubSubClient.
+// Returns true on the call that completed a connect.
+bool tryConnectMqtt(PubSubClient& mqtt, uint32_t nowMs, uint32_t baseRetryMs);
+const ReconnectStats& mqttReconnects();
 
 } // namespace NetworkDriver
@@ -1,6 +1,7 @@
 #include <Arduino.h>
 
 #include "app/App.h"
+#include "app/Clock.h"
 
 static App app;
 
@@ -11,5 +12,5 @@ void setup() {
 }
 
 void loop() {
-  app.tick(millis());
+  app.tick(clockMs());
 }
@@ -3,12 +3,18 @@
 #include <Arduino.h>
 #include <Wire.h>
 
+#include "app/Clock.h"
 #include "hardware/AutoHardwareConfig.h"
 
 namespace {
 
 uint8_t addr = 0;
 bool ready = false;
+uint32_t firstSampleAtMs = 0;
+
+// Continuous high-res mode needs up to 180 ms for its first conversion. Instead of
+// blocking boot on it, readLux() reports "no sample" until then.
+constexpr uint32_t BH_FIRST_SAMPLE_MS = 180;
 
 constexpr uint8_t BH_CMD_POWER_ON = 0x01;
 constexpr uint8_t BH_CMD_RESET = 0x07;
@@ -26,7 +32,7 @@ bool initAt(uint8_t i2cAddr) {
   if (!bhWrite(i2cAddr, BH_CMD_RESET)) return false;
   delay(10);
   if (!bhWrite(i2cAddr, BH_CMD_CONT_HIRES)) return false;
-  delay(180);
+  firstSampleAtMs = clockMs() + BH_FIRST_SAMPLE_MS;
   return true;
 }
 
@@ -63,6 +69,7 @@ uint8_t address() {
 
 bool readLux(float& luxOut) {
   if (!ready || addr == 0) return false;
+  if ((int32_t)(clockMs() - firstSampleAtMs) < 0) return false;
   Wire.requestFrom((int)addr, 2);
   if (Wire.available() < 2) return false;
 
@@ -1,77 +1,102 @@
 #include "Buzzer.h"
 
+#include "app/Clock.h"
+
 namespace {
 inline bool reached(uint32_t nowMs, uint32_t targetMs) {
   return (int32_t)(nowMs - targetMs) >= 0;
 }
+
+// A callback armed for a segment that play()/stop() already replaced can still be
+// queued in the timer task; it is recognised by firing well before the new deadline.
+constexpr int64_t kEarlySlackUs = 500;
 } // namespace
 
 Buzzer::Buzzer(uint8_t pin, uint8_t channel)
-: drv_(pin, channel), mode_(Mode::idle), next_ms_(0), step_(0), tone_on_(false) {}
-
+: drv_(pin, channel) {}
+
 void Buzzer::begin() {
   drv_.begin();
+  if (!lock_) lock_ = xSemaphoreCreateMutex();
+  if (!timer_) {
+    esp_timer_create_args_t args = {};
+    args.callback = &Buzzer::onTimer_;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "buzzer";
+    if (esp_timer_create(&args, &timer_) != ESP_OK) {
+      timer_ = nullptr;
+      Serial.println("[BUZZER] WARN: esp_timer unavailable; loop-timed patterns");
+    }
+  }
   stop();
 }
 
-void Buzzer::setTone_(bool on, uint32_t hz) {
-  if (on) drv_.startTone(hz);
+void Buzzer::lock_take_() {
+  if (lock_) xSemaphoreTake(lock_, portMAX_DELAY);
+}
+
+void Buzzer::lock_give_() {
+  if (lock_) xSemaphoreGive(lock_);
+}
+
+// Lock held. Applies the next segment and arms its end.
+void Buzzer::applyNext_() {
+  if (timer_) esp_timer_stop(timer_);
+
+  uint16_t hz = 0;
+  uint16_t ms = 0;
+  if (!seq_.next(hz, ms)) {
+    drv_.stopTone();
+    active_ = false;
+    return;
+  }
+
+  if (hz != 0) drv_.startTone(hz);
   else drv_.stopTone();
-  tone_on_ = on;
+  active_ = true;
+
+  if (timer_) {
+    dueUs_ = esp_timer_get_time() + (int64_t)ms * 1000;
+    esp_timer_start_once(timer_, (uint64_t)ms * 1000u);
+  } else {
+    next_ms_ = clockMs() + ms;
+  }
 }
 
-void Buzzer::warn() {
-  mode_ = Mode::warn;
-  step_ = 0;
-  next_ms_ = 0;
-  tone_on_ = false;
+void Buzzer::onTimer_(void* arg) {
+  Buzzer* self = static_cast<Buzzer*>(arg);
+  self->lock_take_();
+  if (self->seq_.active() != BuzzerPattern::none &&
+      esp_timer_get_time() + kEarlySlackUs >= self->dueUs_) {
+    self->applyNext_();
+  }
+  self->lock_give_();
 }
 
-void Buzzer::alert() {
-  mode_ = Mode::alert;
-  step_ = 0;
-  next_ms_ = 0;
-  tone_on_ = false;
+void Buzzer::play(BuzzerPattern p) {
+  lock_take_();
+  if (seq_.request(p)) applyNext_();
+  lock_give_();
 }
 
 void Buzzer::stop() {
-  mode_ = Mode::idle;
-  step_ = 0;
-  next_ms_ = 0;
-  setTone_(false, 0);
+  lock_take_();
+  if (timer_) esp_timer_stop(timer_);
+  seq_.stop();
+  drv_.stopTone();
+  active_ = false;
+  lock_give_();
 }
 
 bool Buzzer::isActive() const {
-  return mode_ != Mode::idle;
+  return active_;
 }
 
 void Buzzer::update(uint32_t nowMs) {
-  if (mode_ == Mode::idle) return;
-  if (next_ms_ != 0 && !reached(nowMs, next_ms_)) return;
-
-  if (mode_ == Mode::warn) {
-    const uint32_t hz = 2200;
-    if (!tone_on_) {
-      setTone_(true, hz);
-      next_ms_ = nowMs + 180;
-    } else {
-      setTone_(false, 0);
-      next_ms_ = nowMs + 220;
-      step_++;
-      if (step_ >= 6) stop();
-    }
-    return;
-  }
-
-  if (mode_ == Mode::alert) {
-    const uint32_t hz = 3200;
-    if (!tone_on_) {
-      setTone_(true, hz);
-      next_ms_ = nowMs + 200;
-    } else {
-      setTone_(false, 0);
-      next_ms_ = nowMs + 120;
-    }
-    return;
-  }
-}
+  if (timer_ || !active_) return;
+  if (!reached(nowMs, next_ms_)) return;
+  lock_take_();
+  applyNext_();
+  lock_give_();
+}
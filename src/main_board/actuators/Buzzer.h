@@ -1,7 +1,15 @@
 #pragma once
 #include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "app/BuzzerPatterns.h"
 #include "drivers/BuzzerDriver.h"
 
+// Plays BuzzerPatterns from an esp_timer one-shot chain, so cadence timing does not
+// depend on how often the main loop runs. update() only steps the pattern when the
+// timer could not be created.
 class Buzzer {
 public:
   Buzzer(uint8_t pin, uint8_t channel = 0);
@@ -9,20 +17,24 @@ public:
   void begin();
   void update(uint32_t nowMs);
 
-  void warn();
-  void alert();
+  void play(BuzzerPattern p);
+  void warn() { play(BuzzerPattern::warn); }
+  void alert() { play(BuzzerPattern::alert); }
   void stop();
 
   bool isActive() const;
 
 private:
-  enum class Mode : uint8_t { idle, warn, alert };
-
   BuzzerDriver drv_;
-  Mode mode_;
-  uint32_t next_ms_;
-  uint8_t step_;
-  bool tone_on_;
+  ToneSequencer seq_;
+  esp_timer_handle_t timer_ = nullptr;
+  SemaphoreHandle_t lock_ = nullptr;
+  int64_t dueUs_ = 0;       // timer mode: when the armed segment ends
+  uint32_t next_ms_ = 0;    // fallback mode
+  volatile bool active_ = false;
 
-  void setTone_(bool on, uint32_t hz);
+  void lock_take_();
+  void lock_give_();
+  void applyNext_();
+  static void onTimer_(void* arg);
 };
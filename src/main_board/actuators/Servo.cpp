@@ -1,44 +1,75 @@
 #include "Servo.h"
 
+#include "app/Clock.h"
+
 namespace {
+constexpr uint32_t kReleaseAfterMs = 400; // let the horn finish settling before dropping PWM
+
 inline bool reached(uint32_t nowMs, uint32_t targetMs) {
   return (int32_t)(nowMs - targetMs) >= 0;
 }
 } // namespace
 
-Servo::Servo(uint8_t pin, uint8_t channel, uint8_t id, uint8_t lock_deg, uint8_t unlock_deg)
+Servo::Servo(uint8_t pin, uint8_t channel, uint8_t id, uint8_t lock_deg, uint8_t unlock_deg,
+             uint16_t move_ms, uint8_t ramp_pct)
 : drv_(pin, channel),
   id_(id),
   lock_deg_(lock_deg),
   unlock_deg_(unlock_deg),
-  cur_deg_(unlock_deg),
-  target_deg_(unlock_deg),
-  next_ms_(0) {}
+  move_ms_(move_ms),
+  ramp_pct_(ramp_pct),
+  cur_x10_((int16_t)(unlock_deg * 10)),
+  target_x10_((int16_t)(unlock_deg * 10)),
+  pending_(false),
+  settled_(true),
+  released_(false),
+  settled_ms_(0) {}
 
-void Servo::write_(uint8_t deg) {
-  drv_.writeAngle(deg);
-  cur_deg_ = deg;
+void Servo::begin() {
+  beginAt(false);
 }
 
-void Servo::begin() {
+void Servo::beginAt(bool locked) {
+  const uint8_t deg = locked ? lock_deg_ : unlock_deg_;
   drv_.begin();
-  write_(unlock_deg_);
-  target_deg_ = unlock_deg_;
-  next_ms_ = 0;
+  cur_x10_ = (int16_t)(deg * 10);
+  target_x10_ = cur_x10_;
+  drv_.writeAngleX10((uint16_t)cur_x10_);
+  profile_.hold(cur_x10_);
+  pending_ = false;
+  settled_ = true;
+  released_ = false;
+  settled_ms_ = clockMs();
+}
+
+void Servo::retarget_(uint8_t deg) {
+  const int16_t x10 = (int16_t)(deg * 10);
+  if (x10 == target_x10_ && (pending_ || !settled_)) return; // already heading there
+  target_x10_ = x10;
+  pending_ = true;
+  settled_ = (cur_x10_ == target_x10_);
 }
 
 void Servo::lock() {
-  target_deg_ = lock_deg_;
-  next_ms_ = 0;
+  retarget_(lock_deg_);
 }
 
 void Servo::unlock() {
-  target_deg_ = unlock_deg_;
-  next_ms_ = 0;
+  retarget_(unlock_deg_);
 }
 
 bool Servo::isLocked() const {
-  return cur_deg_ == lock_deg_;
+  return settled_ && cur_x10_ == (int16_t)(lock_deg_ * 10);
+}
+
+bool Servo::settled() const {
+  return settled_;
+}
+
+uint32_t Servo::etaMs(uint32_t nowMs) const {
+  if (settled_) return 0;
+  if (pending_) return move_ms_;
+  return profile_.etaMs(nowMs);
 }
 
 uint8_t Servo::id() const {
@@ -46,15 +77,33 @@ uint8_t Servo::id() const {
 }
 
 void Servo::update(uint32_t nowMs) {
-  if (cur_deg_ == target_deg_) return;
-  if (next_ms_ != 0 && !reached(nowMs, next_ms_)) return;
+  if (pending_) {
+    pending_ = false;
+    profile_.start(cur_x10_, target_x10_, nowMs, move_ms_, ramp_pct_);
+    if (released_) {
+      drv_.writeAngleX10((uint16_t)cur_x10_);
+      released_ = false;
+    }
+    if (settled_) settled_ms_ = nowMs;
+  }
 
-  if (cur_deg_ < target_deg_) {
-    cur_deg_++;
-  } else {
-    cur_deg_--;
+  if (!settled_) {
+    const int16_t pos = profile_.positionAt(nowMs);
+    if (pos != cur_x10_) {
+      drv_.writeAngleX10((uint16_t)pos);
+      cur_x10_ = pos;
+    }
+    if (profile_.settled(nowMs)) {
+      settled_ = true;
+      settled_ms_ = nowMs;
+    }
+    return;
   }
 
-  drv_.writeAngle(cur_deg_);
-  next_ms_ = nowMs + 15;
+#if SERVO_DETACH_AT_REST
+  if (!released_ && reached(nowMs, settled_ms_ + kReleaseAfterMs)) {
+    drv_.release();
+    released_ = true;
+  }
+#endif
 }
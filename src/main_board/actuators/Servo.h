@@ -1,18 +1,41 @@
 #pragma once
 #include <Arduino.h>
+#include "app/MotionProfile.h"
 #include "drivers/ServoDriver.h"
 
+#ifndef SERVO_MOVE_MS
+#define SERVO_MOVE_MS 350
+#endif
+
+#ifndef SERVO_RAMP_PCT
+#define SERVO_RAMP_PCT 25
+#endif
+
+// 1 = stop PWM pulses once a move has settled (no hold jitter/current); the next
+// lock()/unlock() re-drives the output.
+#ifndef SERVO_DETACH_AT_REST
+#define SERVO_DETACH_AT_REST 0
+#endif
+
 class Servo {
 public:
-  Servo(uint8_t pin, uint8_t channel, uint8_t id, uint8_t lock_deg, uint8_t unlock_deg);
+  Servo(uint8_t pin, uint8_t channel, uint8_t id, uint8_t lock_deg, uint8_t unlock_deg,
+        uint16_t move_ms = SERVO_MOVE_MS, uint8_t ramp_pct = SERVO_RAMP_PCT);
 
   void begin();
+  // Attaches and writes the end position directly (no sweep), e.g. when resuming a
+  // known position after a warm restart.
+  void beginAt(bool locked);
   void update(uint32_t nowMs);
 
   void lock();
   void unlock();
 
+  // True once the horn has settled at the lock position.
   bool isLocked() const;
+  bool settled() const;
+  // Remaining time of the current move (full move time if one is about to start).
+  uint32_t etaMs(uint32_t nowMs) const;
   uint8_t id() const;
 
 private:
@@ -20,10 +43,16 @@ private:
   uint8_t id_;
   uint8_t lock_deg_;
   uint8_t unlock_deg_;
+  uint16_t move_ms_;
+  uint8_t ramp_pct_;
 
-  uint8_t cur_deg_;
-  uint8_t target_deg_;
-  uint32_t next_ms_;
+  MotionProfile profile_;
+  int16_t cur_x10_;
+  int16_t target_x10_;
+  bool pending_;   // target changed; the profile starts on the next update()
+  bool settled_;
+  bool released_;
+  uint32_t settled_ms_;
 
-  void write_(uint8_t deg);
+  void retarget_(uint8_t deg);
 };
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Per-phase boot timing. Phases are marked in order; each records the time since the
+// previous mark. "pre" is the time from reset to start() (ROM/bootloader + setup()).
+// Phase names must be string literals (only the pointer is kept).
+class BootProfile {
+public:
+  static constexpr uint8_t kMaxPhases = 8;
+
+  void start(uint32_t nowMs) {
+    startMs_ = nowMs;
+    lastMs_ = nowMs;
+    count_ = 0;
+  }
+
+  void mark(const char* phase, uint32_t nowMs) {
+    if (count_ < kMaxPhases) {
+      names_[count_] = phase;
+      ms_[count_] = nowMs - lastMs_;
+      ++count_;
+    }
+    lastMs_ = nowMs;
+  }
+
+  uint8_t count() const { return count_; }
+  uint32_t phaseMs(uint8_t i) const { return (i < count_) ? ms_[i] : 0u; }
+  uint32_t totalMs() const { return lastMs_ - startMs_; }
+
+  // {"pre":N,"<phase>":N,...,"total":N}. Returns the length, or 0 if outLen is too small.
+  size_t toJson(char* out, size_t outLen) const {
+    if (!out || outLen == 0) return 0;
+    size_t n = 0;
+    if (!append_(out, outLen, n, "{\"pre\":%lu", (unsigned long)startMs_)) return fail_(out);
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (!append_(out, outLen, n, ",\"%s\":%lu", names_[i], (unsigned long)ms_[i])) return fail_(out);
+    }
+    if (!append_(out, outLen, n, ",\"total\":%lu}", (unsigned long)totalMs())) return fail_(out);
+    return n;
+  }
+
+private:
+  const char* names_[kMaxPhases] = {};
+  uint32_t ms_[kMaxPhases] = {};
+  uint8_t count_ = 0;
+  uint32_t startMs_ = 0;
+  uint32_t lastMs_ = 0;
+
+  template <typename... Args>
+  static bool append_(char* out, size_t outLen, size_t& n, const char* fmt, Args... args) {
+    const int w = snprintf(out + n, outLen - n, fmt, args...);
+    if (w < 0 || (size_t)w >= outLen - n) return false;
+    n += (size_t)w;
+    return true;
+  }
+
+  static size_t fail_(char* out) {
+    out[0] = '\0';
+    return 0;
+  }
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+
+// Buzzer cadences as data. A pattern is a list of steps (frequency, on, off, repeat);
+// looping patterns run until stopped or preempted.
+//
+// Priority: a request only interrupts a pattern of equal or lower priority. A one-shot
+// that interrupts a looping pattern hands the buzzer back to it when it finishes.
+enum class BuzzerPattern : uint8_t {
+  none,
+  sensor_fault,
+  entry_countdown,
+  warn,
+  lockout,
+  alert
+};
+
+struct ToneStep {
+  uint16_t hz;
+  uint16_t onMs;
+  uint16_t offMs;
+  uint8_t repeat;
+};
+
+struct PatternDef {
+  const ToneStep* steps;
+  uint8_t count;
+  uint8_t priority;
+  bool loop;
+};
+
+namespace BuzzerPatterns {
+
+inline PatternDef def(BuzzerPattern p) {
+  static const ToneStep kSensorFault[] = {{1800, 60, 140, 2}};
+  static const ToneStep kEntryCountdown[] = {{2600, 80, 920, 1}};
+  static const ToneStep kWarn[] = {{2200, 180, 220, 6}};
+  static const ToneStep kLockout[] = {{1400, 400, 200, 3}};
+  static const ToneStep kAlert[] = {{3200, 200, 120, 1}};
+
+  switch (p) {
+    case BuzzerPattern::sensor_fault: return {kSensorFault, 1, 1, false};
+    case BuzzerPattern::entry_countdown: return {kEntryCountdown, 1, 2, true};
+    case BuzzerPattern::warn: return {kWarn, 1, 3, false};
+    case BuzzerPattern::lockout: return {kLockout, 1, 4, false};
+    case BuzzerPattern::alert: return {kAlert, 1, 5, true};
+    case BuzzerPattern::none:
+    default: return {nullptr, 0, 0, false};
+  }
+}
+
+} // namespace BuzzerPatterns
+
+// Walks a pattern as a series of segments (tone or silence, with a duration).
+// No timing of its own: the caller applies each segment and asks for the next one
+// when it expires.
+class ToneSequencer {
+public:
+  // Returns false if a higher-priority pattern keeps the buzzer.
+  bool request(BuzzerPattern p) {
+    const PatternDef d = BuzzerPatterns::def(p);
+    if (!d.steps) return false;
+    if (active_ != BuzzerPattern::none && d.priority < BuzzerPatterns::def(active_).priority) return false;
+
+    if (active_ != BuzzerPattern::none && active_ != p && BuzzerPatterns::def(active_).loop && !d.loop) {
+      resume_ = active_;
+    } else if (d.loop) {
+      resume_ = BuzzerPattern::none;
+    }
+    begin_(p);
+    return true;
+  }
+
+  void stop() {
+    active_ = BuzzerPattern::none;
+    resume_ = BuzzerPattern::none;
+  }
+
+  BuzzerPattern active() const { return active_; }
+
+  // Next segment; hz == 0 is silence. Returns false when the buzzer should go idle.
+  bool next(uint16_t& hz, uint16_t& ms) {
+    for (uint8_t guard = 0; guard < 4; ++guard) {
+      if (active_ == BuzzerPattern::none) return false;
+      const PatternDef d = BuzzerPatterns::def(active_);
+      if (step_ < d.count) {
+        const ToneStep& s = d.steps[step_];
+        if (!toneDone_) {
+          toneDone_ = true;
+          hz = s.hz;
+          ms = s.onMs;
+          return true;
+        }
+        toneDone_ = false;
+        if (++rep_ >= s.repeat) {
+          rep_ = 0;
+          ++step_;
+        }
+        hz = 0;
+        ms = s.offMs;
+        return true;
+      }
+
+      if (d.loop) {
+        step_ = 0;
+        continue;
+      }
+      const BuzzerPattern resume = resume_;
+      resume_ = BuzzerPattern::none;
+      if (resume == BuzzerPattern::none) {
+        active_ = BuzzerPattern::none;
+        return false;
+      }
+      begin_(resume);
+    }
+    active_ = BuzzerPattern::none;
+    return false;
+  }
+
+private:
+  BuzzerPattern active_ = BuzzerPattern::none;
+  BuzzerPattern resume_ = BuzzerPattern::none;
+  uint8_t step_ = 0;
+  uint8_t rep_ = 0;
+  bool toneDone_ = false;
+
+  void begin_(BuzzerPattern p) {
+    active_ = p;
+    step_ = 0;
+    rep_ = 0;
+    toneDone_ = false;
+  }
+};
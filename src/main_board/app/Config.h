@@ -9,11 +9,9 @@ struct Config {
   uint32_t notify_cooldown_ms = 3000;
   uint32_t entry_delay_ms = 15000;
   uint32_t exit_grace_after_indoor_activity_ms = 30000;
-  uint8_t outdoor_pir_src = 3;
   uint32_t correlation_window_ms = 20000;
   uint32_t suspicion_decay_step_ms = 5000;
   uint8_t suspicion_decay_points = 8;
-  uint8_t door_ultrasonic_src = 1;
   bool auto_arm_away_on_exit_sequence = true;
   uint32_t auto_arm_exit_sequence_window_ms = 20000;
   bool allow_remote_without_token = false;
@@ -26,7 +24,6 @@ struct Config {
   bool allow_serial_sensor_commands = (ALLOW_SERIAL_SENSOR_COMMANDS_DEFAULT != 0);
   bool serial_notify_enabled = false;
   bool sensor_health_enabled = true;
-  uint32_t sensor_health_check_period_ms = 2000;
   uint32_t pir_stuck_active_ms = 180000;
   uint32_t vib_stuck_active_ms = 15000;
   uint32_t ultrasonic_offline_ms = 30000;
@@ -1,5 +1,7 @@
 #include "app/DoorUnlockSession.h"
 
+#include "app/Clock.h"
+
 namespace {
 inline bool reached(uint32_t nowMs, uint32_t deadlineMs) {
   return (int32_t)(nowMs - deadlineMs) >= 0;
@@ -22,6 +24,16 @@ void DoorUnlockSession::start(uint32_t nowMs, bool doorOpen, const Config& cfg)
   nextWarnMs_ = 0;
 }
 
+void DoorUnlockSession::rebase(uint32_t deltaMs) {
+  auto shift = [deltaMs](uint32_t& ts) {
+    if (ts != 0) ts += deltaMs;
+  };
+  shift(unlockDeadlineMs_);
+  shift(openWarnAtMs_);
+  shift(closeLockAtMs_);
+  shift(nextWarnMs_);
+}
+
 void DoorUnlockSession::clear(bool stopBuzzer, Buzzer& buzzer) {
   active_ = false;
   sawOpen_ = false;
@@ -138,3 +150,14 @@ bool DoorUnlockSession::countdown(uint32_t nowMs,
 bool DoorUnlockSession::isActive() const {
   return active_;
 }
+
+void DoorUnlockSession::requestWakeups(const Config& cfg) const {
+  if (!active_) return;
+  if (!sawOpen_) {
+    clockWakeAt(unlockDeadlineMs_ - cfg.door_unlock_warn_before_ms);
+    clockWakeAt(unlockDeadlineMs_);
+  }
+  if (openWarnAtMs_ != 0) clockWakeAt(openWarnAtMs_);
+  if (closeLockAtMs_ != 0) clockWakeAt(closeLockAtMs_);
+  if (nextWarnMs_ != 0) clockWakeAt(nextWarnMs_);
+}
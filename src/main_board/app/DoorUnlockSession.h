@@ -27,6 +27,10 @@ public:
                  uint32_t& warnBeforeMs) const;
 
   bool isActive() const;
+  // Registers the pending deadlines with the clock (SimClock jumps to them).
+  void requestWakeups(const Config& cfg) const;
+  // Shifts pending deadlines after a warm restart (millis() restarted from zero).
+  void rebase(uint32_t deltaMs);
 
 private:
   bool active_ = false;
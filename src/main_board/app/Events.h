@@ -16,7 +16,8 @@ enum class EventType {
   door_code_bad,
   manual_door_toggle,
   manual_window_toggle,
-  entry_timeout
+  entry_timeout,
+  count // number of event types; keep last
 };
 
 static const char* toString(EventType t) {
@@ -40,14 +41,35 @@ static const char* toString(EventType t) {
   }
 }
 
+// Where the reporting sensor sits (from the sensor registry); rules key on this
+// instead of individual source ids.
+enum class SensorZone : uint8_t {
+  none,
+  indoor,
+  outdoor,
+  perimeter
+};
+
+static const char* toString(SensorZone z) {
+  switch (z) {
+    case SensorZone::indoor:    return "indoor";
+    case SensorZone::outdoor:   return "outdoor";
+    case SensorZone::perimeter: return "perimeter";
+    case SensorZone::none:
+    default:                    return "none";
+  }
+}
+
 struct Event {
   EventType type = EventType::disarm;
   uint32_t ts_ms = 0;
   uint8_t src = 0;
+  SensorZone zone = SensorZone::none;
+  uint8_t value = 0; // vib_spike: hit intensity (pulse count, 0 = not measured)
 
   Event() = default;
-  constexpr Event(EventType t, uint32_t ts, uint8_t s = 0)
-  : type(t), ts_ms(ts), src(s) {}
+  constexpr Event(EventType t, uint32_t ts, uint8_t s = 0, SensorZone z = SensorZone::none, uint8_t v = 0)
+  : type(t), ts_ms(ts), src(s), zone(z), value(v) {}
 };
 
 // Serial synthetic source range for debug/test injection.
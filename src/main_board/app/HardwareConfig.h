@@ -1,6 +1,8 @@
 #pragma once
 #include <Arduino.h>
 
+#include "app/SensorRegistry.h"
+
 namespace HwCfg {
 
 constexpr uint8_t PIN_UNUSED = 255;
@@ -40,6 +42,26 @@ constexpr uint8_t PIN_US_ECHO_2 = 17; // chokepoint #2: ทางผ่านร
 constexpr uint8_t PIN_US_TRIG_3 = 4;  // chokepoint #3: ทางผ่านระหว่างห้อง
 constexpr uint8_t PIN_US_ECHO_3 = 5;  // chokepoint #3: ทางผ่านระหว่างห้อง
 
+// ============================
+// Sensor registry
+// ============================
+// One row per sensor; the row index is its slot (health bit in "sensor_faults").
+// Zones drive the rules: outdoor motion scores as approach/exit, a perimeter
+// chokepoint is the door zone, everything else is indoor activity.
+constexpr SensorDef SENSORS[] = {
+  {SensorKind::door_contact,   1, PIN_REED_1, PIN_UNUSED,    SensorZone::perimeter, 80,   "door"},
+  {SensorKind::window_contact, 2, PIN_REED_2, PIN_UNUSED,    SensorZone::perimeter, 80,   "window"},
+  {SensorKind::pir,            1, PIN_PIR_1,  PIN_UNUSED,    SensorZone::indoor,    1500, "pir1"},
+  {SensorKind::pir,            2, PIN_PIR_2,  PIN_UNUSED,    SensorZone::indoor,    1500, "pir2"},
+  {SensorKind::pir,            3, PIN_PIR_3,  PIN_UNUSED,    SensorZone::outdoor,   1500, "pir3"},
+  {SensorKind::vibration,      0, PIN_VIB_1,  PIN_UNUSED,    SensorZone::perimeter, 700,  "vib"},
+  {SensorKind::ultrasonic,     1, PIN_US_ECHO,   PIN_US_TRIG,   SensorZone::perimeter, 1500, "us1"},
+  {SensorKind::ultrasonic,     2, PIN_US_ECHO_2, PIN_US_TRIG_2, SensorZone::indoor,    1500, "us2"},
+  {SensorKind::ultrasonic,     3, PIN_US_ECHO_3, PIN_US_TRIG_3, SensorZone::indoor,    1500, "us3"},
+};
+constexpr uint8_t SENSOR_COUNT = (uint8_t)(sizeof(SENSORS) / sizeof(SENSORS[0]));
+static_assert(SENSOR_COUNT <= SensorRegistry::kMaxSensors, "sensor table exceeds registry slots");
+
 constexpr uint8_t PIN_BTN_DOOR_TOGGLE = 33;
 constexpr uint8_t PIN_BTN_WINDOW_TOGGLE = 18;
 
@@ -49,6 +71,9 @@ constexpr uint8_t PIN_BTN_WINDOW_TOGGLE = 18;
 constexpr uint8_t PIN_I2C_SDA = 21;
 constexpr uint8_t PIN_I2C_SCL = 22;
 constexpr uint8_t KEYPAD_I2C_ADDR = 0x20;
+// PCF8574 INT (open drain), GPIO23 when wired. Off by default: without the wire only
+// the 200 ms backstop read would see keys and short presses would be missed.
+constexpr uint8_t PIN_KEYPAD_INT = PIN_UNUSED; // 23 => INT-driven scan; PIN_UNUSED => row polling
 constexpr uint8_t OLED_I2C_ADDR = 0x3C;
 constexpr uint8_t BH1750_I2C_ADDR = 0x23;
 
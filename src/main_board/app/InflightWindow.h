@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stdint.h>
+
+// QoS1 publish pipeline over an ordered queue (the MQTT offline store).
+//
+// The first count() queue entries are in flight: sent and waiting for PUBACK. Up
+// to window() of them may be outstanding; acks can arrive in any order, but the
+// queue only pops from the front, so takeAcked() releases the acked prefix.
+// After a reconnect, rewind() makes every unacked entry go out again (DUP set).
+class InflightWindow {
+public:
+  static constexpr uint8_t kMax = 16;
+
+  struct Stats {
+    uint32_t acked = 0;
+    uint32_t resent = 0;
+    uint32_t ackAvgMs = 0; // running mean (1/8 weight per sample)
+    uint32_t ackMaxMs = 0;
+  };
+
+  explicit InflightWindow(uint8_t window = 8) { setWindow(window); }
+
+  void setWindow(uint8_t window) {
+    window_ = (window == 0) ? 1 : (window > kMax ? kMax : window);
+  }
+  uint8_t window() const { return window_; }
+
+  // Packet ids are drawn from base+1 .. base+span, so several windows can share one
+  // connection without colliding.
+  void setIdSpace(uint16_t base, uint16_t span) {
+    idBase_ = base;
+    idSpan_ = span ? span : 1;
+    lastId_ = 0;
+  }
+  uint8_t count() const { return count_; }
+
+  // Queue position (from the front) of the next entry to transmit, or -1 if none is
+  // due: queueLen is how many entries the queue currently holds.
+  int16_t nextToSend(uint32_t queueLen) const {
+    while (resendAt_ < count_) {
+      if (!slot_(resendAt_).acked) return resendAt_;
+      ++resendAt_;
+    }
+    if (count_ >= window_ || count_ >= queueLen) return -1;
+    return count_;
+  }
+
+  // Records the transmission of position pos (as returned by nextToSend). Returns the
+  // packet id to send with; dup is true for a retransmission.
+  uint16_t sent(int16_t pos, uint32_t nowMs, bool& dup) {
+    if (pos < (int16_t)count_) {
+      Entry& e = slot_((uint8_t)pos);
+      e.sentMs = nowMs;
+      ++resendAt_;
+      ++stats_.resent;
+      dup = true;
+      return e.packetId;
+    }
+    Entry& e = slot_(count_);
+    e.packetId = nextId_();
+    e.sentMs = nowMs;
+    e.acked = false;
+    ++count_;
+    resendAt_ = count_;
+    dup = false;
+    return e.packetId;
+  }
+
+  bool ack(uint16_t packetId, uint32_t nowMs) {
+    for (uint8_t i = 0; i < count_; ++i) {
+      Entry& e = slot_(i);
+      if (e.acked || e.packetId != packetId) continue;
+      e.acked = true;
+      const uint32_t ms = nowMs - e.sentMs;
+      ++stats_.acked;
+      stats_.ackAvgMs = (stats_.acked == 1) ? ms : stats_.ackAvgMs + ((int32_t)(ms - stats_.ackAvgMs) / 8);
+      if (ms > stats_.ackMaxMs) stats_.ackMaxMs = ms;
+      return true;
+    }
+    return false;
+  }
+
+  // Number of entries at the queue front that are acked; the caller pops that many.
+  uint8_t takeAcked() {
+    uint8_t n = 0;
+    while (count_ > 0 && slot_(0).acked) {
+      head_ = (uint8_t)((head_ + 1) % kMax);
+      --count_;
+      ++n;
+    }
+    resendAt_ = (resendAt_ > n) ? (uint8_t)(resendAt_ - n) : 0;
+    return n;
+  }
+
+  // Connection lost: everything unacked goes out again once the link is back.
+  void rewind() { resendAt_ = 0; }
+
+  // The queue dropped its contents (e.g. reset): forget in-flight state.
+  void clear() {
+    count_ = 0;
+    resendAt_ = 0;
+  }
+
+  const Stats& stats() const { return stats_; }
+
+private:
+  struct Entry {
+    uint16_t packetId = 0;
+    bool acked = false;
+    uint32_t sentMs = 0;
+  };
+
+  Entry ring_[kMax];
+  uint8_t head_ = 0;
+  uint8_t count_ = 0;
+  mutable uint8_t resendAt_ = 0;
+  uint8_t window_ = 8;
+  uint16_t lastId_ = 0;
+  uint16_t idBase_ = 0;
+  uint16_t idSpan_ = 0xFFFF;
+  Stats stats_;
+
+  Entry& slot_(uint8_t pos) { return ring_[(head_ + pos) % kMax]; }
+  const Entry& slot_(uint8_t pos) const { return ring_[(head_ + pos) % kMax]; }
+
+  uint16_t nextId_() {
+    if (lastId_ >= idSpan_) lastId_ = 0;
+    return (uint16_t)(idBase_ + ++lastId_);
+  }
+};
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary serial injection frames for hardware-in-the-loop stress tests. The ASCII
+// test codes allow a few events per second; a frame carries a batch of timestamped
+// codes that the board drains at loop rate and acknowledges with its latency.
+//
+//   A5 5A | type | seq (u16 LE) | len | payload[len] | crc16 (u16 LE)
+//
+// The CRC is CRC-16/CCITT-FALSE over type..payload. 0xA5 never occurs in the ASCII
+// protocol, so it switches the serial reader into frame mode.
+namespace InjectFrame {
+
+constexpr uint8_t kMagic0 = 0xA5;
+constexpr uint8_t kMagic1 = 0x5A;
+constexpr uint8_t kHeaderSize = 6;  // magic, type, seq, len
+constexpr uint8_t kOverhead = 8;    // header + crc
+constexpr uint8_t kMaxPayload = 251;
+// A frame whose bytes stop for this long is abandoned; the host writes a frame in
+// one go, so a stall means it died mid-frame or the 0xA5 was noise.
+constexpr uint32_t kByteTimeoutMs = 50;
+
+enum class Type : uint8_t {
+  events = 0x01, // host -> board
+  ack = 0x81     // board -> host
+};
+
+// EVENTS payload: flags, then records of code (u16 LE), offset_ms (u16 LE) and value.
+// An event is due offset_ms after the frame arrived; offsets must not decrease.
+constexpr uint8_t kFlagQuiet = 0x01; // no per-event [TRACE] lines
+constexpr uint8_t kRecordSize = 5;
+constexpr uint8_t kMaxRecords = (kMaxPayload - 1) / kRecordSize;
+
+struct Record {
+  uint16_t code = 0;
+  uint16_t offsetMs = 0;
+  uint8_t value = 0; // vib_spike intensity; 0 elsewhere
+};
+
+enum class Status : uint8_t {
+  ok = 0,
+  crc = 1,    // frame dropped; seq is the one received, which may be corrupt
+  busy = 2,   // queue full; resend the same seq later
+  bad = 3,    // malformed payload or unknown type
+  dup = 4     // seq already processed; the previous ack is repeated instead
+};
+
+// ACK payload, 16 bytes. latencyUs runs from the frame's last byte to the end of
+// its last event; maxEventUs is the slowest single event of the batch.
+struct Ack {
+  Status status = Status::ok;
+  uint8_t accepted = 0;
+  uint8_t blocked = 0;   // refused by an allow_serial_* policy
+  uint8_t rejected = 0;  // unknown code
+  uint32_t latencyUs = 0;
+  uint32_t maxEventUs = 0;
+  uint16_t gaps = 0;     // out-of-order seqs seen so far (lost or resent frames)
+  uint8_t queueFree = 0; // event slots free when the ack was sent
+  uint8_t reserved = 0;
+};
+constexpr uint8_t kAckSize = 16;
+
+inline uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t b = 0; b < 8; ++b) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+inline void putU16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+inline void putU32(uint8_t* p, uint32_t v) {
+  putU16(p, (uint16_t)v);
+  putU16(p + 2, (uint16_t)(v >> 16));
+}
+inline uint16_t getU16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+inline uint32_t getU32(const uint8_t* p) { return getU16(p) | ((uint32_t)getU16(p + 2) << 16); }
+
+// Writes a complete frame to out (kOverhead + len bytes); returns its size.
+inline size_t encode(uint8_t* out, Type type, uint16_t seq, const uint8_t* payload, uint8_t len) {
+  out[0] = kMagic0;
+  out[1] = kMagic1;
+  out[2] = (uint8_t)type;
+  putU16(out + 3, seq);
+  out[5] = len;
+  for (uint8_t i = 0; i < len; ++i) out[kHeaderSize + i] = payload[i];
+  putU16(out + kHeaderSize + len, crc16(out + 2, 4u + len));
+  return (size_t)kOverhead + len;
+}
+
+inline void encodeAck(uint8_t* payload, const Ack& a) {
+  payload[0] = (uint8_t)a.status;
+  payload[1] = a.accepted;
+  payload[2] = a.blocked;
+  payload[3] = a.rejected;
+  putU32(payload + 4, a.latencyUs);
+  putU32(payload + 8, a.maxEventUs);
+  putU16(payload + 12, a.gaps);
+  payload[14] = a.queueFree;
+  payload[15] = a.reserved;
+}
+
+inline bool decodeAck(const uint8_t* payload, uint8_t len, Ack& a) {
+  if (len < kAckSize) return false;
+  a.status = (Status)payload[0];
+  a.accepted = payload[1];
+  a.blocked = payload[2];
+  a.rejected = payload[3];
+  a.latencyUs = getU32(payload + 4);
+  a.maxEventUs = getU32(payload + 8);
+  a.gaps = getU16(payload + 12);
+  a.queueFree = payload[14];
+  a.reserved = payload[15];
+  return true;
+}
+
+inline uint8_t recordCount(uint8_t len) { return len ? (uint8_t)((len - 1) / kRecordSize) : 0; }
+
+// False if the EVENTS payload is not flags + whole records.
+inline bool validEvents(uint8_t len) { return len >= 1 && (len - 1) % kRecordSize == 0; }
+
+inline Record record(const uint8_t* payload, uint8_t i) {
+  const uint8_t* p = payload + 1 + (size_t)i * kRecordSize;
+  Record r;
+  r.code = getU16(p);
+  r.offsetMs = getU16(p + 2);
+  r.value = p[4];
+  return r;
+}
+
+inline void putRecord(uint8_t* payload, uint8_t i, const Record& r) {
+  uint8_t* p = payload + 1 + (size_t)i * kRecordSize;
+  putU16(p, r.code);
+  putU16(p + 2, r.offsetMs);
+  p[4] = r.value;
+}
+
+// Byte-at-a-time frame decoder. A bad magic, oversize length or CRC mismatch drops
+// back to hunting for kMagic0, so a corrupt or truncated frame costs only itself.
+class Decoder {
+public:
+  enum class Result : uint8_t {
+    more,    // byte consumed, frame incomplete
+    frame,   // a valid frame is available until the next feed()
+    crc,     // a frame arrived with a bad CRC
+    resync   // not a frame after all; the byte was dropped
+  };
+
+  Result feed(uint8_t b) {
+    switch (state_) {
+      case State::magic0:
+        if (b == kMagic0) state_ = State::magic1;
+        return Result::resync;
+      case State::magic1:
+        if (b == kMagic1) {
+          state_ = State::header;
+          pos_ = 0;
+          return Result::more;
+        }
+        state_ = (b == kMagic0) ? State::magic1 : State::magic0;
+        return Result::resync;
+      case State::header:
+        hdr_[pos_++] = b;
+        if (pos_ < 4) return Result::more;
+        if (hdr_[3] > kMaxPayload) {
+          state_ = State::magic0;
+          return Result::resync;
+        }
+        pos_ = 0;
+        state_ = hdr_[3] ? State::payload : State::crc;
+        return Result::more;
+      case State::payload:
+        payload_[pos_++] = b;
+        if (pos_ == hdr_[3]) {
+          pos_ = 0;
+          state_ = State::crc;
+        }
+        return Result::more;
+      case State::crc:
+      default:
+        crc_[pos_++] = b;
+        if (pos_ < 2) return Result::more;
+        state_ = State::magic0;
+        {
+          const uint16_t want = crc16(payload_, hdr_[3], crc16(hdr_, 4));
+          return (getU16(crc_) == want) ? Result::frame : Result::crc;
+        }
+    }
+  }
+
+  // A frame has started; every byte belongs to it until it completes or is dropped.
+  bool inFrame() const { return state_ != State::magic0; }
+  // False if b cannot continue (or start) a frame: anything but a magic byte while
+  // hunting, so text after a stray 0xA5 is left to the ASCII reader.
+  bool accepts(uint8_t b) const {
+    if (state_ == State::magic0) return b == kMagic0;
+    if (state_ == State::magic1) return b == kMagic0 || b == kMagic1;
+    return true;
+  }
+  // Drops a partial frame.
+  void reset() { state_ = State::magic0; }
+
+  Type type() const { return (Type)hdr_[0]; }
+  uint16_t seq() const { return getU16(hdr_ + 1); }
+  uint8_t len() const { return hdr_[3]; }
+  const uint8_t* payload() const { return payload_; }
+
+private:
+  enum class State : uint8_t { magic0, magic1, header, payload, crc };
+
+  State state_ = State::magic0;
+  uint8_t pos_ = 0;
+  uint8_t hdr_[4] = {};
+  uint8_t crc_[2] = {};
+  uint8_t payload_[kMaxPayload] = {};
+};
+
+} // namespace InjectFrame
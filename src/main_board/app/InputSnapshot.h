@@ -0,0 +1,132 @@
+#pragma once
+
+#include <stdint.h>
+
+// Bit-parallel digital input handling. The board samples every GPIO input once per
+// tick into a 64-bit snapshot (bit n = GPIOn); InputMap gathers the wired pins into
+// channel bits, and EdgeTracker derives edges and debounced state for all channels
+// with mask arithmetic.
+//
+// Channel-space bits match the sensor registry slots, so up to 32 channels.
+
+namespace InputSnapshot {
+
+inline uint64_t pinMask(uint8_t pin) {
+  return (pin < 64) ? ((uint64_t)1u << pin) : 0u;
+}
+
+inline bool pinHigh(uint64_t snapshot, uint8_t pin) {
+  return (snapshot & pinMask(pin)) != 0;
+}
+
+inline uint8_t lowestBit(uint32_t mask) {
+  return (uint8_t)__builtin_ctz(mask);
+}
+
+} // namespace InputSnapshot
+
+class InputMap {
+public:
+  static constexpr uint8_t kMaxChannels = 32;
+
+  bool add(uint8_t channel, uint8_t pin) {
+    if (channel >= kMaxChannels || count_ >= kMaxChannels) return false;
+    const uint64_t pm = InputSnapshot::pinMask(pin);
+    if (!pm) return false;
+    channel_[count_] = channel;
+    pinMask_[count_] = pm;
+    ++count_;
+    used_ |= pm;
+    valid_ = false;
+    return true;
+  }
+
+  // Channel bits for a snapshot. Unchanged mapped pins (the common tick) skip the walk.
+  uint32_t gather(uint64_t snapshot) {
+    const uint64_t mapped = snapshot & used_;
+    if (valid_ && mapped == lastMapped_) return lastLevel_;
+    uint32_t level = 0;
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (mapped & pinMask_[i]) level |= (uint32_t)1u << channel_[i];
+    }
+    lastMapped_ = mapped;
+    lastLevel_ = level;
+    valid_ = true;
+    return level;
+  }
+
+private:
+  uint64_t pinMask_[kMaxChannels] = {};
+  uint8_t channel_[kMaxChannels] = {};
+  uint8_t count_ = 0;
+  uint64_t used_ = 0;
+  uint64_t lastMapped_ = 0;
+  uint32_t lastLevel_ = 0;
+  bool valid_ = false;
+};
+
+// Edge detection by XOR against the previous sample, plus time debounce: a channel
+// settles once its raw level has held for its hold time. Only channels that flipped
+// or are still settling cost any work, so an idle tick is a few mask operations.
+class EdgeTracker {
+public:
+  struct Step {
+    uint32_t rose = 0;        // raw edges this sample
+    uint32_t fell = 0;
+    uint32_t settledRose = 0; // debounced edges this sample
+    uint32_t settledFell = 0;
+  };
+
+  void setHold(uint8_t ch, uint16_t holdMs) {
+    if (ch < InputMap::kMaxChannels) holdMs_[ch] = holdMs;
+  }
+
+  // Starts from a known level. Channels in `assumeLow` that are high report a settled
+  // rising edge once debounced (e.g. a door already open at boot).
+  void reset(uint32_t level, uint32_t nowMs, uint32_t assumeLow = 0) {
+    raw_ = level;
+    stable_ = level & ~assumeLow;
+    unsettled_ = level & assumeLow;
+    for (uint8_t ch = 0; ch < InputMap::kMaxChannels; ++ch) changeMs_[ch] = nowMs;
+  }
+
+  Step update(uint32_t level, uint32_t nowMs) {
+    Step s;
+    const uint32_t flips = level ^ raw_;
+    raw_ = level;
+    s.rose = flips & level;
+    s.fell = flips & ~level;
+
+    uint32_t m = flips;
+    while (m) {
+      changeMs_[InputSnapshot::lowestBit(m)] = nowMs;
+      m &= m - 1u;
+    }
+    unsettled_ |= flips;
+
+    m = unsettled_;
+    while (m) {
+      const uint8_t ch = InputSnapshot::lowestBit(m);
+      m &= m - 1u;
+      if ((uint32_t)(nowMs - changeMs_[ch]) >= holdMs_[ch]) unsettled_ &= ~((uint32_t)1u << ch);
+    }
+
+    const uint32_t next = (stable_ & unsettled_) | (raw_ & ~unsettled_);
+    const uint32_t changed = next ^ stable_;
+    stable_ = next;
+    s.settledRose = changed & next;
+    s.settledFell = changed & ~next;
+    return s;
+  }
+
+  uint32_t raw() const { return raw_; }
+  uint32_t stable() const { return stable_; }
+  bool idle() const { return unsettled_ == 0; }
+
+private:
+  uint32_t raw_ = 0;
+  uint32_t stable_ = 0;
+  uint32_t unsettled_ = 0;
+  uint32_t changeMs_[InputMap::kMaxChannels] = {};
+  uint16_t holdMs_[InputMap::kMaxChannels] = {};
+};
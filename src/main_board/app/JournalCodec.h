@@ -0,0 +1,145 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "app/Events.h"
+#include "app/SystemState.h"
+
+// Compact record format for the on-flash event journal.
+//
+// Every record starts with a tag byte followed by LEB128 varints:
+//   event: tag = type | (level << 5), varint(ts delta), varint(src), varint(zigzag(score delta))
+//   boot:  tag = kBootTag,            varint(boot id),  varint(absolute ts)
+// A tag never equals 0xFF, so erased flash terminates a sector. Timestamps are
+// delta-coded against the previous record, which keeps a typical event at 4-5 bytes.
+namespace JournalCodec {
+
+constexpr uint8_t kErased = 0xFF;
+constexpr uint8_t kBootTag = 0x7F;
+constexpr size_t kMaxRecordBytes = 1 + 5 + 5 + 3;
+constexpr uint8_t kTypeMask = 0x1F;
+
+// A new EventType must still fit the tag; level 3 stays unused so kBootTag (type 31,
+// level 3) cannot collide with an event.
+static_assert((unsigned)EventType::count <= kTypeMask + 1u, "EventType no longer fits the journal tag");
+static_assert((unsigned)AlarmLevel::alert < 3u, "AlarmLevel would collide with kBootTag");
+
+struct Record {
+  uint32_t boot = 0;
+  uint32_t ts_ms = 0;
+  EventType type = EventType::disarm;
+  uint8_t src = 0;
+  int16_t score_delta = 0;
+  AlarmLevel level = AlarmLevel::off;
+};
+
+static inline size_t putVarint(uint8_t* out, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80u) {
+    out[n++] = (uint8_t)(v | 0x80u);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+static inline bool getVarint(const uint8_t* in, size_t len, size_t& pos, uint32_t& out) {
+  uint32_t v = 0;
+  for (uint8_t shift = 0; shift < 35; shift = (uint8_t)(shift + 7)) {
+    if (pos >= len) return false;
+    const uint8_t b = in[pos++];
+    v |= (uint32_t)(b & 0x7Fu) << shift;
+    if ((b & 0x80u) == 0) {
+      out = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline uint32_t zigzag(int16_t v) {
+  return (uint32_t)(((int32_t)v << 1) ^ ((int32_t)v >> 31));
+}
+
+static inline int16_t unzigzag(uint32_t v) {
+  return (int16_t)((int32_t)(v >> 1) ^ -(int32_t)(v & 1u));
+}
+
+static inline size_t encodeBoot(uint8_t* out, uint32_t boot, uint32_t tsMs) {
+  size_t n = 0;
+  out[n++] = kBootTag;
+  n += putVarint(out + n, boot);
+  n += putVarint(out + n, tsMs);
+  return n;
+}
+
+static inline size_t encodeEvent(uint8_t* out, const Record& r, uint32_t prevTsMs) {
+  size_t n = 0;
+  out[n++] = (uint8_t)(((uint8_t)r.type & kTypeMask) | (((uint8_t)r.level & 0x03u) << 5));
+  n += putVarint(out + n, r.ts_ms - prevTsMs);
+  n += putVarint(out + n, r.src);
+  n += putVarint(out + n, zigzag(r.score_delta));
+  return n;
+}
+
+// Stateful decoder: tracks the boot id and running timestamp across records of one sector.
+class Decoder {
+public:
+  enum class Result : uint8_t { record, boot, end, truncated, corrupt };
+
+  void reset() {
+    boot_ = 0;
+    tsMs_ = 0;
+  }
+
+  Result next(const uint8_t* in, size_t len, size_t& pos, Record& out) {
+    if (pos >= len) return Result::truncated;
+    const size_t start = pos;
+    const uint8_t tag = in[pos];
+    if (tag == kErased) return Result::end;
+    ++pos;
+
+    uint32_t a = 0;
+    uint32_t b = 0;
+    if (tag == kBootTag) {
+      if (!getVarint(in, len, pos, a) || !getVarint(in, len, pos, b)) return rewind_(start, pos);
+      boot_ = a;
+      tsMs_ = b;
+      return Result::boot;
+    }
+
+    uint32_t c = 0;
+    if (!getVarint(in, len, pos, a) || !getVarint(in, len, pos, b) || !getVarint(in, len, pos, c)) {
+      return rewind_(start, pos);
+    }
+    const uint8_t type = (uint8_t)(tag & kTypeMask);
+    const uint8_t level = (uint8_t)((tag >> 5) & 0x03u);
+    if (type >= (uint8_t)EventType::count || level > (uint8_t)AlarmLevel::alert || b > 0xFFu) {
+      return Result::corrupt;
+    }
+    tsMs_ += a;
+    out.boot = boot_;
+    out.ts_ms = tsMs_;
+    out.type = (EventType)type;
+    out.src = (uint8_t)b;
+    out.score_delta = unzigzag(c);
+    out.level = (AlarmLevel)level;
+    return Result::record;
+  }
+
+  uint32_t boot() const { return boot_; }
+  uint32_t tsMs() const { return tsMs_; }
+
+private:
+  uint32_t boot_ = 0;
+  uint32_t tsMs_ = 0;
+
+  // A record cut by the end of the read window is retried from its tag byte.
+  static Result rewind_(size_t start, size_t& pos) {
+    pos = start;
+    return Result::truncated;
+  }
+};
+
+} // namespace JournalCodec
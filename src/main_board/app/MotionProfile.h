@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+
+// Trapezoidal move between two positions in a fixed time. Positions are in tenths of
+// a degree; the ramp is the share of the move spent accelerating (and again
+// decelerating), 0 = constant speed, 50 = triangular.
+//
+// Position is a pure function of elapsed time, so a late update() jumps to where the
+// horn should be instead of stretching the move.
+class MotionProfile {
+public:
+  void start(int16_t fromX10, int16_t toX10, uint32_t nowMs, uint16_t durationMs, uint8_t rampPct) {
+    from_ = fromX10;
+    to_ = toX10;
+    startMs_ = nowMs;
+    durationMs_ = (fromX10 == toX10) ? 0 : durationMs;
+    if (rampPct > 50) rampPct = 50;
+    rampMs_ = (uint16_t)(((uint32_t)durationMs_ * rampPct) / 100u);
+  }
+
+  // Holds a position with no move in progress.
+  void hold(int16_t posX10) {
+    from_ = posX10;
+    to_ = posX10;
+    durationMs_ = 0;
+    rampMs_ = 0;
+  }
+
+  int16_t target() const { return to_; }
+
+  int16_t positionAt(uint32_t nowMs) const {
+    const uint32_t t = elapsed_(nowMs);
+    if (t >= durationMs_) return to_;
+
+    const int64_t d = (int64_t)to_ - from_;
+    const int64_t T = durationMs_;
+    const int64_t Ta = rampMs_;
+    int64_t num;
+    int64_t den;
+    if (Ta == 0) {
+      num = d * (int64_t)t;
+      den = T;
+    } else if ((int64_t)t < Ta) {
+      num = d * (int64_t)t * (int64_t)t;
+      den = 2 * Ta * (T - Ta);
+    } else if ((int64_t)t <= T - Ta) {
+      num = d * (2 * (int64_t)t - Ta);
+      den = 2 * (T - Ta);
+    } else {
+      const int64_t r = T - (int64_t)t;
+      num = d * (2 * Ta * (T - Ta) - r * r);
+      den = 2 * Ta * (T - Ta);
+    }
+    return (int16_t)(from_ + num / den);
+  }
+
+  bool settled(uint32_t nowMs) const {
+    return elapsed_(nowMs) >= durationMs_;
+  }
+
+  uint32_t etaMs(uint32_t nowMs) const {
+    const uint32_t t = elapsed_(nowMs);
+    return (t >= durationMs_) ? 0u : (uint32_t)(durationMs_ - t);
+  }
+
+private:
+  int16_t from_ = 0;
+  int16_t to_ = 0;
+  uint32_t startMs_ = 0;
+  uint16_t durationMs_ = 0;
+  uint16_t rampMs_ = 0;
+
+  uint32_t elapsed_(uint32_t nowMs) const {
+    const int32_t dt = (int32_t)(nowMs - startMs_);
+    return (dt > 0) ? (uint32_t)dt : 0u;
+  }
+};
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// MQTT 3.1.1 packet encoding/decoding for the handful of packets the firmware uses.
+// No I/O here: encoders fill a caller buffer (returning 0 if it does not fit), the
+// Reader reassembles packets from bytes as they arrive.
+namespace MqttPacket {
+
+enum Type : uint8_t {
+  CONNECT = 1,
+  CONNACK = 2,
+  PUBLISH = 3,
+  PUBACK = 4,
+  SUBSCRIBE = 8,
+  SUBACK = 9,
+  PINGREQ = 12,
+  PINGRESP = 13,
+  DISCONNECT = 14
+};
+
+struct ConnectOpts {
+  const char* clientId = "";
+  const char* user = nullptr;     // nullptr or "" = no credentials
+  const char* password = nullptr;
+  const char* willTopic = nullptr;
+  const char* willMessage = nullptr;
+  uint8_t willQos = 0;
+  bool willRetain = false;
+  bool cleanSession = true;
+  uint16_t keepAliveS = 15;
+};
+
+class Writer {
+public:
+  Writer(uint8_t* buf, size_t cap) : buf_(buf), cap_(cap) {}
+
+  void u8(uint8_t v) {
+    if (n_ < cap_) buf_[n_] = v;
+    ++n_;
+  }
+  void u16(uint16_t v) {
+    u8((uint8_t)(v >> 8));
+    u8((uint8_t)v);
+  }
+  void bytes(const void* p, size_t len) {
+    if (n_ + len <= cap_ && len) memcpy(buf_ + n_, p, len);
+    n_ += len;
+  }
+  void str(const char* s) {
+    const size_t len = s ? strlen(s) : 0;
+    u16((uint16_t)len);
+    bytes(s, len);
+  }
+  void remainingLength(uint32_t len) {
+    do {
+      uint8_t b = (uint8_t)(len & 0x7Fu);
+      len >>= 7;
+      if (len) b |= 0x80u;
+      u8(b);
+    } while (len);
+  }
+
+  size_t size() const { return (n_ <= cap_) ? n_ : 0; }
+
+private:
+  uint8_t* buf_;
+  size_t cap_;
+  size_t n_ = 0;
+};
+
+inline size_t strField(const char* s) {
+  return 2u + (s ? strlen(s) : 0u);
+}
+
+inline bool has(const char* s) {
+  return s && s[0] != '\0';
+}
+
+inline size_t connect(uint8_t* out, size_t cap, const ConnectOpts& o) {
+  uint8_t flags = o.cleanSession ? 0x02u : 0u;
+  size_t body = 10u + strField(o.clientId);
+  if (has(o.willTopic)) {
+    flags |= 0x04u | (uint8_t)((o.willQos & 3u) << 3) | (o.willRetain ? 0x20u : 0u);
+    body += strField(o.willTopic) + strField(o.willMessage);
+  }
+  if (has(o.user)) {
+    flags |= 0x80u;
+    body += strField(o.user);
+    if (o.password) {
+      flags |= 0x40u;
+      body += strField(o.password);
+    }
+  }
+
+  Writer w(out, cap);
+  w.u8(CONNECT << 4);
+  w.remainingLength((uint32_t)body);
+  w.str("MQTT");
+  w.u8(4); // protocol level 3.1.1
+  w.u8(flags);
+  w.u16(o.keepAliveS);
+  w.str(o.clientId);
+  if (has(o.willTopic)) {
+    w.str(o.willTopic);
+    w.str(o.willMessage);
+  }
+  if (has(o.user)) {
+    w.str(o.user);
+    if (o.password) w.str(o.password);
+  }
+  return w.size();
+}
+
+// Fixed header, topic and packet id; the payload (payloadLen bytes) is sent after it.
+inline size_t publishHeader(uint8_t* out,
+                            size_t cap,
+                            const char* topic,
+                            size_t payloadLen,
+                            uint8_t qos,
+                            bool retain,
+                            bool dup,
+                            uint16_t packetId) {
+  qos &= 1u;
+  const size_t body = strField(topic) + (qos ? 2u : 0u) + payloadLen;
+  Writer w(out, cap);
+  w.u8((uint8_t)((PUBLISH << 4) | (dup && qos ? 0x08u : 0u) | (qos << 1) | (retain ? 1u : 0u)));
+  w.remainingLength((uint32_t)body);
+  w.str(topic);
+  if (qos) w.u16(packetId);
+  return w.size();
+}
+
+inline size_t subscribe(uint8_t* out, size_t cap, uint16_t packetId, const char* topic, uint8_t qos) {
+  Writer w(out, cap);
+  w.u8((SUBSCRIBE << 4) | 0x02u);
+  w.remainingLength((uint32_t)(2u + strField(topic) + 1u));
+  w.u16(packetId);
+  w.str(topic);
+  w.u8(qos & 1u);
+  return w.size();
+}
+
+inline size_t puback(uint8_t* out, size_t cap, uint16_t packetId) {
+  Writer w(out, cap);
+  w.u8(PUBACK << 4);
+  w.u8(2);
+  w.u16(packetId);
+  return w.size();
+}
+
+inline size_t simple(uint8_t* out, size_t cap, Type t) {
+  Writer w(out, cap);
+  w.u8((uint8_t)(t << 4));
+  w.u8(0);
+  return w.size();
+}
+
+// Reassembles one packet at a time. Bodies larger than the buffer are skipped and
+// reported with truncated() so the stream stays in sync.
+template <size_t Cap>
+class Reader {
+public:
+  // Returns true when a complete packet is available; read it before the next feed().
+  bool feed(uint8_t b) {
+    switch (state_) {
+      case State::header:
+        header_ = b;
+        len_ = 0;
+        mult_ = 1;
+        got_ = 0;
+        truncated_ = false;
+        state_ = State::length;
+        return false;
+      case State::length:
+        len_ += (uint32_t)(b & 0x7Fu) * mult_;
+        mult_ <<= 7;
+        if (b & 0x80u) {
+          if (mult_ > (1u << 21)) state_ = State::header; // malformed: resync
+          return false;
+        }
+        truncated_ = len_ > Cap;
+        if (len_ == 0) {
+          state_ = State::header;
+          return true;
+        }
+        state_ = State::body;
+        return false;
+      case State::body:
+      default:
+        if (got_ < Cap) buf_[got_] = b;
+        if (++got_ < len_) return false;
+        state_ = State::header;
+        return true;
+    }
+  }
+
+  uint8_t type() const { return (uint8_t)(header_ >> 4); }
+  uint8_t flags() const { return (uint8_t)(header_ & 0x0Fu); }
+  const uint8_t* body() const { return buf_; }
+  size_t length() const { return truncated_ ? 0 : (size_t)len_; }
+  bool truncated() const { return truncated_; }
+  void reset() { state_ = State::header; }
+
+  uint16_t packetId() const { return (length() >= 2) ? (uint16_t)((buf_[0] << 8) | buf_[1]) : 0; }
+
+  // PUBLISH fields; the topic is not NUL-terminated.
+  bool publish(const char*& topic, size_t& topicLen, uint16_t& packetId, const uint8_t*& payload, size_t& payloadLen) const {
+    const size_t n = length();
+    if (type() != PUBLISH || n < 2) return false;
+    topicLen = (size_t)((buf_[0] << 8) | buf_[1]);
+    size_t at = 2 + topicLen;
+    const uint8_t qos = (uint8_t)((flags() >> 1) & 3u);
+    if (at + (qos ? 2u : 0u) > n) return false;
+    topic = (const char*)(buf_ + 2);
+    packetId = 0;
+    if (qos) {
+      packetId = (uint16_t)((buf_[at] << 8) | buf_[at + 1]);
+      at += 2;
+    }
+    payload = buf_ + at;
+    payloadLen = n - at;
+    return true;
+  }
+
+private:
+  enum class State : uint8_t { header, length, body };
+  State state_ = State::header;
+  uint8_t header_ = 0;
+  uint32_t len_ = 0;
+  uint32_t mult_ = 1;
+  uint32_t got_ = 0;
+  bool truncated_ = false;
+  uint8_t buf_[Cap];
+};
+
+} // namespace MqttPacket
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+
+// Publish overload handling. As the pipeline fills, the least valuable traffic is
+// shed first: the status heartbeat is stretched, then queued statuses collapse into
+// the newest one, then ordinary events are sampled. Critical-lane events and command
+// acks are never shed.
+enum class DegradeLevel : uint8_t {
+  normal,
+  stretch_heartbeat,
+  collapse_status,
+  sample_events
+};
+
+class OverloadController {
+public:
+  static constexpr uint8_t kHysteresisPct = 15;
+  static constexpr uint32_t kHoldMs = 5000;        // calm time before stepping down a level
+  static constexpr uint8_t kHeartbeatStretch = 4;  // heartbeat period multiplier
+  static constexpr uint8_t kEventSampleEvery = 4;  // 1 in N ordinary events is published
+
+  // Load (percent of capacity) at which each level is entered.
+  static uint8_t enterPct(DegradeLevel l) {
+    switch (l) {
+      case DegradeLevel::stretch_heartbeat: return 50;
+      case DegradeLevel::collapse_status: return 70;
+      case DegradeLevel::sample_events: return 85;
+      case DegradeLevel::normal:
+      default: return 0;
+    }
+  }
+
+  static const char* name(DegradeLevel l) {
+    switch (l) {
+      case DegradeLevel::normal: return "normal";
+      case DegradeLevel::stretch_heartbeat: return "stretch_heartbeat";
+      case DegradeLevel::collapse_status: return "collapse_status";
+      case DegradeLevel::sample_events: return "sample_events";
+      default: return "unknown";
+    }
+  }
+
+  static uint8_t heartbeatStretch(DegradeLevel l) {
+    return (l >= DegradeLevel::stretch_heartbeat) ? kHeartbeatStretch : 1;
+  }
+
+  // Escalates at once to the level the load calls for; steps down one level at a
+  // time, only after the load has stayed below the level's threshold (minus the
+  // hysteresis) for kHoldMs. Returns true if the level changed.
+  bool update(uint8_t loadPct, uint32_t nowMs) {
+    loadPct_ = loadPct;
+    uint8_t target = 0;
+    while (target < kTop && loadPct >= enterPct((DegradeLevel)(target + 1))) ++target;
+
+    const uint8_t cur = level_;
+    if (target > cur) {
+      level_ = target;
+      calm_ = false;
+      ++changes_;
+      return true;
+    }
+    if (cur == 0 || loadPct + kHysteresisPct >= enterPct((DegradeLevel)cur)) {
+      calm_ = false;
+      return false;
+    }
+    if (!calm_) {
+      calm_ = true;
+      calmSinceMs_ = nowMs;
+      return false;
+    }
+    if (nowMs - calmSinceMs_ < kHoldMs) return false;
+    level_ = (uint8_t)(cur - 1);
+    calm_ = false;
+    ++changes_;
+    return true;
+  }
+
+  DegradeLevel level() const { return (DegradeLevel)level_; }
+  uint8_t loadPct() const { return loadPct_; }
+  uint32_t changes() const { return changes_; }
+
+  bool collapseStatus() const { return level() >= DegradeLevel::collapse_status; }
+  void noteCollapsed() { ++collapsed_; }
+  uint32_t collapsed() const { return collapsed_; }
+
+  // Producer side, ordinary (non-critical) events only: false if this one is shed.
+  bool admitEvent() {
+    if (level() < DegradeLevel::sample_events) return true;
+    if (sampleSeq_++ % kEventSampleEvery == 0) return true;
+    ++sampledOut_;
+    return false;
+  }
+  uint32_t sampledOut() const { return sampledOut_; }
+
+private:
+  static constexpr uint8_t kTop = (uint8_t)DegradeLevel::sample_events;
+
+  // Written by the MQTT task, read by producers on other tasks.
+  volatile uint8_t level_ = 0;
+  uint8_t loadPct_ = 0;
+  bool calm_ = false;
+  uint32_t calmSinceMs_ = 0;
+  uint32_t changes_ = 0;
+  uint32_t collapsed_ = 0;  // MQTT task
+  uint32_t sampleSeq_ = 0;  // producer
+  uint32_t sampledOut_ = 0; // producer
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "app/SystemState.h"
+
+// Compact copy of SystemState for queues, the offline store and telemetry.
+//
+// Flags and enums live in bitfields. Timestamps are stored as 16-bit ages (ms) behind
+// epoch_ms, the newest non-zero timestamp in the snapshot; 0 timestamps stay 0.
+// Conversion is exact while every timestamp is within kMaxAgeMs of the newest one.
+// Older timestamps clamp to kMaxAgeMs: every rule window is shorter than that, so a
+// clamped timestamp is still "expired" for RuleEngine purposes.
+struct PackedSystemState {
+  static constexpr uint16_t kAbsent = 0xFFFFu;
+  static constexpr uint16_t kMaxAgeMs = 0xFFFEu;
+
+  enum Ts : uint8_t {
+    ts_last_notify,
+    ts_last_indoor_activity,
+    ts_entry_deadline,
+    ts_last_suspicion_update,
+    ts_last_outdoor_motion,
+    ts_last_window_event,
+    ts_last_vibration,
+    ts_last_door_event,
+    ts_count
+  };
+
+  uint32_t epoch_ms;
+  uint16_t age_ms[ts_count];
+  uint8_t suspicion_score;
+  uint8_t mode : 2;
+  uint8_t level : 2;
+  uint8_t entry_pending : 1;
+  uint8_t keep_window_locked_when_disarmed : 1;
+  uint8_t door_locked : 1;
+  uint8_t window_locked : 1;
+  uint8_t door_open : 1;
+  uint8_t window_open : 1;
+
+  PackedSystemState()
+  : epoch_ms(0),
+    suspicion_score(0),
+    mode((uint8_t)Mode::disarm),
+    level((uint8_t)AlarmLevel::off),
+    entry_pending(0),
+    keep_window_locked_when_disarmed(0),
+    door_locked(0),
+    window_locked(0),
+    door_open(0),
+    window_open(0) {
+    for (uint8_t i = 0; i < ts_count; ++i) age_ms[i] = kAbsent;
+  }
+
+  Mode modeValue() const { return (Mode)mode; }
+  AlarmLevel levelValue() const { return (AlarmLevel)level; }
+
+  // Returns true when unpack() reproduces st exactly.
+  static bool pack(const SystemState& st, PackedSystemState& out) {
+    uint32_t ts[ts_count];
+    timestamps_(st, ts);
+
+    out = PackedSystemState{};
+    bool haveEpoch = false;
+    for (uint8_t i = 0; i < ts_count; ++i) {
+      if (ts[i] == 0) continue;
+      if (!haveEpoch || (int32_t)(ts[i] - out.epoch_ms) > 0) out.epoch_ms = ts[i];
+      haveEpoch = true;
+    }
+
+    bool exact = true;
+    for (uint8_t i = 0; i < ts_count; ++i) {
+      if (ts[i] == 0) continue;
+      const uint32_t age = out.epoch_ms - ts[i];
+      if (age > kMaxAgeMs) {
+        out.age_ms[i] = kMaxAgeMs;
+        exact = false;
+      } else {
+        out.age_ms[i] = (uint16_t)age;
+      }
+    }
+
+    out.suspicion_score = st.suspicion_score;
+    out.mode = (uint8_t)st.mode;
+    out.level = (uint8_t)st.level;
+    out.entry_pending = st.entry_pending ? 1 : 0;
+    out.keep_window_locked_when_disarmed = st.keep_window_locked_when_disarmed ? 1 : 0;
+    out.door_locked = st.door_locked ? 1 : 0;
+    out.window_locked = st.window_locked ? 1 : 0;
+    out.door_open = st.door_open ? 1 : 0;
+    out.window_open = st.window_open ? 1 : 0;
+    return exact;
+  }
+
+  static PackedSystemState from(const SystemState& st) {
+    PackedSystemState p;
+    pack(st, p);
+    return p;
+  }
+
+  SystemState unpack() const {
+    SystemState st;
+    st.mode = modeValue();
+    st.level = levelValue();
+    st.entry_pending = entry_pending != 0;
+    st.suspicion_score = suspicion_score;
+    st.keep_window_locked_when_disarmed = keep_window_locked_when_disarmed != 0;
+    st.door_locked = door_locked != 0;
+    st.window_locked = window_locked != 0;
+    st.door_open = door_open != 0;
+    st.window_open = window_open != 0;
+
+    st.last_notify_ms = timestamp_(ts_last_notify);
+    st.last_indoor_activity_ms = timestamp_(ts_last_indoor_activity);
+    st.entry_deadline_ms = timestamp_(ts_entry_deadline);
+    st.last_suspicion_update_ms = timestamp_(ts_last_suspicion_update);
+    st.last_outdoor_motion_ms = timestamp_(ts_last_outdoor_motion);
+    st.last_window_event_ms = timestamp_(ts_last_window_event);
+    st.last_vibration_ms = timestamp_(ts_last_vibration);
+    st.last_door_event_ms = timestamp_(ts_last_door_event);
+    return st;
+  }
+
+private:
+  uint32_t timestamp_(Ts t) const {
+    return (age_ms[t] == kAbsent) ? 0u : (uint32_t)(epoch_ms - age_ms[t]);
+  }
+
+  static void timestamps_(const SystemState& st, uint32_t* ts) {
+    ts[ts_last_notify] = st.last_notify_ms;
+    ts[ts_last_indoor_activity] = st.last_indoor_activity_ms;
+    ts[ts_entry_deadline] = st.entry_deadline_ms;
+    ts[ts_last_suspicion_update] = st.last_suspicion_update_ms;
+    ts[ts_last_outdoor_motion] = st.last_outdoor_motion_ms;
+    ts[ts_last_window_event] = st.last_window_event_ms;
+    ts[ts_last_vibration] = st.last_vibration_ms;
+    ts[ts_last_door_event] = st.last_door_event_ms;
+  }
+};
+
+// 24 bytes vs 56 for SystemState; PublishMsg queue/store slot sizes depend on it.
+static_assert(sizeof(PackedSystemState) <= 24, "PackedSystemState grew; review PublishMsg sizing");
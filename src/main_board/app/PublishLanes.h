@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+
+// Publish priority lanes, highest first. Each queued lane has its own live queue,
+// offline-store partition and QoS1 window; metrics are produced by the MQTT task
+// itself and only compete for send slots.
+enum class PublishLane : uint8_t {
+  critical, // alarm-carrying events (alert level, alert buzzer, tamper, help request)
+  ack,
+  event,
+  status,
+  metrics
+};
+
+namespace PublishLanes {
+
+constexpr uint8_t kCount = 5;
+constexpr uint8_t kQueued = 4; // lanes with a live queue and store partition
+
+inline uint8_t index(PublishLane l) {
+  return (uint8_t)l;
+}
+
+inline const char* name(uint8_t lane) {
+  static const char* const kNames[kCount] = {"critical", "ack", "event", "status", "metrics"};
+  return (lane < kCount) ? kNames[lane] : "unknown";
+}
+
+// Live queue depth per queued lane.
+inline uint8_t queueDepth(uint8_t lane) {
+  static const uint8_t kDepth[kQueued] = {8, 4, 12, 6};
+  return (lane < kQueued) ? kDepth[lane] : 0;
+}
+
+// Offline-store partition per queued lane, in sixteenths of the store.
+inline uint32_t storeShare(uint32_t storeCap, uint8_t lane) {
+  static const uint8_t kSixteenths[kQueued] = {4, 2, 6, 4};
+  return (lane < kQueued) ? storeCap * kSixteenths[lane] / 16u : 0;
+}
+
+// QoS1 packet ids are split by lane (top nibble), so a PUBACK finds its lane directly.
+constexpr uint16_t kIdSpan = 0x0FFF;
+
+inline uint16_t idBase(uint8_t lane) {
+  return (uint16_t)(lane << 12);
+}
+
+inline uint8_t laneOfPacketId(uint16_t packetId) {
+  return (uint8_t)(packetId >> 12);
+}
+
+} // namespace PublishLanes
+
+// Weighted draining across lanes. Critical is strict priority; the others share
+// send slots by weight (ack 4, event 3, status 2, metrics 1 per round), highest
+// priority first within a round, so telemetry still moves during an event burst.
+class LaneScheduler {
+public:
+  LaneScheduler() { refill_(); }
+
+  // readyMask: bit n set if lane n has something to send. Returns the lane to serve,
+  // or -1 if nothing is ready.
+  int8_t pick(uint8_t readyMask) {
+    if (!readyMask) return -1;
+    if (readyMask & 1u) return 0;
+    for (uint8_t pass = 0; pass < 2; ++pass) {
+      for (uint8_t l = 1; l < PublishLanes::kCount; ++l) {
+        if ((readyMask & (1u << l)) && credit_[l] > 0) {
+          --credit_[l];
+          return (int8_t)l;
+        }
+      }
+      refill_();
+    }
+    return -1;
+  }
+
+private:
+  uint8_t credit_[PublishLanes::kCount] = {};
+
+  void refill_() {
+    static const uint8_t kWeight[PublishLanes::kCount] = {0, 4, 3, 2, 1};
+    for (uint8_t l = 0; l < PublishLanes::kCount; ++l) credit_[l] = kWeight[l];
+  }
+};
+
+// Per-lane telemetry: depth, drops and enqueue-to-first-send wait.
+struct LaneStats {
+  uint32_t queued = 0; // waiting in the live queue
+  uint32_t stored = 0; // in the offline store (including in flight)
+  uint32_t drops = 0;
+  uint32_t evicted = 0; // removed from a full store to make room (StoreEviction)
+  uint32_t waitAvgMs = 0; // running mean (1/8 weight per sample)
+  uint32_t waitMaxMs = 0;
+  uint32_t waits = 0;
+
+  void addWait(uint32_t ms) {
+    ++waits;
+    waitAvgMs = (waits == 1) ? ms : waitAvgMs + ((int32_t)(ms - waitAvgMs) / 8);
+    if (ms > waitMaxMs) waitMaxMs = ms;
+  }
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+
+// Retry spacing for Wi-Fi/MQTT reconnects: base * 2^failures, capped, with "equal
+// jitter" (half fixed, half random) so devices that lost the broker together do not
+// retry in lockstep.
+class ReconnectBackoff {
+public:
+  ReconnectBackoff(uint32_t baseMs, uint32_t maxMs)
+  : baseMs_(baseMs ? baseMs : 1), maxMs_(maxMs < baseMs ? baseMs : maxMs) {}
+
+  // Delay before the next attempt; `random` is any uniformly distributed value.
+  uint32_t next(uint32_t random) {
+    uint32_t ceiling = baseMs_;
+    for (uint8_t i = 0; i < failures_ && ceiling < maxMs_; ++i) ceiling <<= 1;
+    if (ceiling > maxMs_) ceiling = maxMs_;
+    if (failures_ < 31) ++failures_;
+    const uint32_t half = ceiling / 2;
+    return half + random % (ceiling - half + 1);
+  }
+
+  void reset() { failures_ = 0; }
+  uint8_t failures() const { return failures_; }
+
+private:
+  uint32_t baseMs_;
+  uint32_t maxMs_;
+  uint8_t failures_ = 0;
+};
+
+// Time-to-reconnect: from the first moment the link was seen down to the moment it
+// is usable again.
+class ReconnectTimer {
+public:
+  void lost(uint32_t nowMs) {
+    if (down_) return;
+    down_ = true;
+    downMs_ = nowMs;
+  }
+
+  // Returns the outage length, or 0 if the link was not known to be down (first connect).
+  uint32_t restored(uint32_t nowMs) {
+    if (!down_) return 0;
+    down_ = false;
+    lastMs_ = nowMs - downMs_;
+    if (lastMs_ > maxMs_) maxMs_ = lastMs_;
+    ++count_;
+    return lastMs_;
+  }
+
+  bool down() const { return down_; }
+  uint32_t count() const { return count_; }
+  uint32_t lastMs() const { return lastMs_; }
+  uint32_t maxMs() const { return maxMs_; }
+
+private:
+  bool down_ = false;
+  uint32_t downMs_ = 0;
+  uint32_t count_ = 0;
+  uint32_t lastMs_ = 0;
+  uint32_t maxMs_ = 0;
+};
@@ -1,8 +1,11 @@
 #include "RuleEngine.h"
 
 namespace {
+// A reference stamped after nowMs (events delivered out of order) is not a match;
+// the unsigned difference would wrap and, worse, could pass as a tiny gap.
 static inline bool within(uint32_t nowMs, uint32_t refMs, uint32_t windowMs) {
-  return refMs != 0 && (nowMs - refMs) <= windowMs;
+  const int32_t dt = (int32_t)(nowMs - refMs);
+  return refMs != 0 && dt >= 0 && (uint32_t)dt <= windowMs;
 }
 
 static AlarmLevel levelFromScore(uint8_t score) {
@@ -21,7 +24,11 @@ static void applyDecay(SystemState& st, const Config& cfg, uint32_t nowMs) {
     return;
   }
 
-  const uint32_t elapsed = nowMs - st.last_suspicion_update_ms;
+  // An event older than the last update leaves the score alone instead of wrapping
+  // into a huge elapsed time that would decay it to zero.
+  const int32_t dt = (int32_t)(nowMs - st.last_suspicion_update_ms);
+  if (dt < 0) return;
+  const uint32_t elapsed = (uint32_t)dt;
   const uint32_t steps = elapsed / cfg.suspicion_decay_step_ms;
   if (steps == 0) return;
 
@@ -35,11 +42,12 @@ static void addScore(SystemState& st, uint8_t points) {
   st.suspicion_score = (s > 100) ? 100 : (uint8_t)s;
 }
 
-static uint8_t normalizeMotionSource(uint8_t src) {
-  if (src == kSerialSyntheticSrcPir1) return 1;
-  if (src == kSerialSyntheticSrcPir2) return 2;
-  if (src == kSerialSyntheticSrcPir3) return 3;
-  return src;
+// A measured hit scores by intensity, from 16 for a single knock to 40 for a hard
+// sustained impact (48+ pulses); an unmeasured spike (edge-triggered, serial) scores 22.
+static uint8_t vibrationPoints(uint8_t intensity) {
+  if (intensity == 0) return 22;
+  const uint8_t capped = (intensity > 48) ? 48 : intensity;
+  return (uint8_t)(16 + capped / 2);
 }
 
 static void resetForMode(SystemState& st, Mode mode, uint32_t nowMs) {
@@ -57,6 +65,10 @@ static void resetForMode(SystemState& st, Mode mode, uint32_t nowMs) {
 }
 } // namespace
 
+bool entryCountdownCancelled(const SystemState& prev, const SystemState& next) {
+  return prev.entry_pending && !next.entry_pending && next.level < AlarmLevel::alert;
+}
+
 Decision RuleEngine::handle(const SystemState& s, const Config& cfg, const Event& e) const {
   Decision d{ s, {CommandType::none, e.ts_ms} };
   applyDecay(d.next, cfg, e.ts_ms);
@@ -84,16 +96,15 @@ Decision RuleEngine::handle(const SystemState& s, const Config& cfg, const Event
 
   if (s.mode == Mode::disarm && cfg.auto_arm_away_on_exit_sequence) {
     // Exit sequence auto-arm:
-    // door_open -> (outdoor motion OR door chokepoint) within window.
+    // door_open -> (outdoor motion OR perimeter/door-zone chokepoint) within window.
     if (e.type == EventType::door_open) {
       d.next.last_door_event_ms = e.ts_ms;
     }
 
-    const uint8_t motionSrc = normalizeMotionSource(e.src);
     const bool outdoorExitMotion =
-      (e.type == EventType::motion) && (motionSrc == cfg.outdoor_pir_src);
+      (e.type == EventType::motion) && (e.zone == SensorZone::outdoor);
     const bool doorZoneChokepoint =
-      (e.type == EventType::chokepoint) && (e.src == cfg.door_ultrasonic_src);
+      (e.type == EventType::chokepoint) && (e.zone == SensorZone::perimeter);
 
     if (cfg.auto_arm_exit_sequence_window_ms > 0 &&
         (outdoorExitMotion || doorZoneChokepoint) &&
@@ -140,10 +151,8 @@ Decision RuleEngine::handle(const SystemState& s, const Config& cfg, const Event
 
   if (s.mode == Mode::away &&
       (e.type == EventType::motion || e.type == EventType::chokepoint)) {
-    const uint8_t motionSrc = normalizeMotionSource(e.src);
-    const bool isIndoorActivity =
-      (e.type == EventType::chokepoint) ||
-      (e.type == EventType::motion && motionSrc != cfg.outdoor_pir_src);
+    // Anything not placed outdoors counts as activity inside the protected area.
+    const bool isIndoorActivity = (e.zone != SensorZone::outdoor);
     if (isIndoorActivity) {
       d.next.last_indoor_activity_ms = e.ts_ms;
       addScore(d.next, 18);
@@ -161,7 +170,7 @@ Decision RuleEngine::handle(const SystemState& s, const Config& cfg, const Event
 
   if (s.mode == Mode::away && e.type == EventType::vib_spike) {
     d.next.last_vibration_ms = e.ts_ms;
-    addScore(d.next, 22);
+    addScore(d.next, vibrationPoints(e.value));
     if (within(e.ts_ms, s.last_outdoor_motion_ms, cfg.correlation_window_ms)) addScore(d.next, 12);
     if (within(e.ts_ms, s.last_window_event_ms, cfg.correlation_window_ms)) addScore(d.next, 10);
     d.next.level = levelFromScore(d.next.suspicion_score);
@@ -13,3 +13,7 @@ class RuleEngine {
 public:
   Decision handle(const SystemState& s, const Config& cfg, const Event& e) const;
 };
+
+// True when an entry countdown ended without turning into an alarm (disarm, re-arm).
+// The countdown pattern loops, so the caller has to silence it.
+bool entryCountdownCancelled(const SystemState& prev, const SystemState& next);
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Raw sensor samples packed into self-contained flash pages for offline replay.
+//
+// A page is a header (magic, page seq, capture id), a base record carrying the
+// absolute time, then records until erased (0xFF) bytes:
+//   sample: tag = 0x10 | channel, varint(ts delta), varint(zigzag(value delta))
+//   run:    tag = 0x20 | channel, varint(count), varint(period ms)
+// Deltas are per channel, against the channel's previous sample in the page (the
+// base time and value 0 at page start). A run repeats the channel's last value
+// count more times, period apart; repeats join a run while one period keeps each
+// of them within kRunJitterMs of its true time, so a ranger sampled a few ms late
+// each tick still collapses into one record. Channels interleave freely: decode is
+// per channel, and the player merges channels by time.
+namespace SampleCodec {
+
+constexpr uint16_t kPageBytes = 256;
+constexpr uint16_t kMagic = 0x4353; // "SC"
+constexpr uint8_t kHeaderBytes = 8; // magic u16, seq u32, capture u16
+constexpr uint8_t kChannels = 16;
+constexpr uint8_t kLevelsChannel = 15; // bit per registry slot (SensorBank levels)
+constexpr uint8_t kRunJitterMs = 8;
+constexpr uint8_t kErased = 0xFF;
+constexpr uint8_t kBaseTag = 0x70;
+constexpr uint8_t kSampleTag = 0x10;
+constexpr uint8_t kRunTag = 0x20;
+constexpr uint8_t kMaxRecordBytes = 1 + 5 + 5;
+
+struct Sample {
+  uint8_t channel = 0;
+  uint32_t tsMs = 0;
+  uint32_t value = 0;
+};
+
+inline size_t putVarint(uint8_t* out, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80u) {
+    out[n++] = (uint8_t)(v | 0x80u);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+inline bool getVarint(const uint8_t* in, size_t len, size_t& pos, uint32_t& out) {
+  uint32_t v = 0;
+  for (uint8_t shift = 0; shift < 35; shift = (uint8_t)(shift + 7)) {
+    if (pos >= len) return false;
+    const uint8_t b = in[pos++];
+    v |= (uint32_t)(b & 0x7Fu) << shift;
+    if ((b & 0x80u) == 0) {
+      out = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1u); }
+
+inline void putHeader(uint8_t* page, uint32_t seq, uint16_t captureId) {
+  page[0] = (uint8_t)kMagic;
+  page[1] = (uint8_t)(kMagic >> 8);
+  for (uint8_t i = 0; i < 4; ++i) page[2 + i] = (uint8_t)(seq >> (8 * i));
+  page[6] = (uint8_t)captureId;
+  page[7] = (uint8_t)(captureId >> 8);
+}
+
+// False if the page holds no capture data (erased or foreign).
+inline bool readHeader(const uint8_t* page, uint32_t& seq, uint16_t& captureId) {
+  if ((uint16_t)(page[0] | (page[1] << 8)) != kMagic) return false;
+  seq = (uint32_t)page[2] | ((uint32_t)page[3] << 8) | ((uint32_t)page[4] << 16) | ((uint32_t)page[5] << 24);
+  captureId = (uint16_t)(page[6] | (page[7] << 8));
+  return true;
+}
+
+class PageEncoder {
+public:
+  // Starts a page in `page` (kPageBytes, erased to 0xFF here) at tsMs.
+  void begin(uint8_t* page, uint32_t seq, uint16_t captureId, uint32_t tsMs) {
+    page_ = page;
+    for (uint16_t i = 0; i < kPageBytes; ++i) page_[i] = kErased;
+    putHeader(page_, seq, captureId);
+    used_ = kHeaderBytes;
+    page_[used_++] = kBaseTag;
+    used_ += (uint16_t)putVarint(page_ + used_, tsMs);
+    for (uint8_t c = 0; c < kChannels; ++c) ch_[c] = Channel{tsMs, tsMs, 0, 0, 0, 0};
+    openRuns_ = 0;
+  }
+
+  // False if the page is full: finish() it, begin() the next and add again. A sample
+  // older than the channel's last one is clamped to it.
+  bool add(const Sample& s) {
+    if (!page_ || s.channel >= kChannels) return false;
+    Channel& c = ch_[s.channel];
+    const uint32_t tsMs = ((int32_t)(s.tsMs - c.seenMs) < 0) ? c.seenMs : s.tsMs;
+
+    if (s.value == c.value && c.runCount > 0 && extendRun(c, tsMs)) {
+      c.seenMs = tsMs;
+      return true;
+    }
+    if (s.value == c.value && tsMs != c.seenMs) {
+      // Open a run, or close one that drifted off its period and start the next
+      // from where it ends.
+      if (!fits(kMaxRecordBytes)) return false;
+      if (c.runCount > 0) writeRun(s.channel);
+      if (extendRun(c, tsMs)) {
+        ++openRuns_;
+        c.seenMs = tsMs;
+        return true;
+      }
+    }
+
+    const bool closing = c.runCount > 0;
+    const uint32_t fromMs = closing ? runEndMs(c) : c.lastTsMs;
+    uint8_t rec[kMaxRecordBytes];
+    size_t n = 0;
+    rec[n++] = (uint8_t)(kSampleTag | s.channel);
+    n += putVarint(rec + n, ((int32_t)(tsMs - fromMs) < 0) ? 0u : tsMs - fromMs);
+    n += putVarint(rec + n, zigzag((int32_t)(s.value - c.value)));
+    // A run closed by this sample takes the room reserved for it.
+    if (!fits(n)) return false;
+    if (closing) writeRun(s.channel);
+    for (size_t i = 0; i < n; ++i) page_[used_++] = rec[i];
+    c.lastTsMs = ((int32_t)(tsMs - fromMs) < 0) ? fromMs : tsMs;
+    c.seenMs = tsMs;
+    c.value = s.value;
+    return true;
+  }
+
+  // Writes the open runs; the page is then complete.
+  void finish() {
+    for (uint8_t c = 0; c < kChannels; ++c) {
+      if (ch_[c].runCount) writeRun(c);
+    }
+  }
+
+  uint16_t used() const { return used_; }
+
+private:
+  // While a run is open, lastTsMs is the sample it repeats and [runLoMs, runHiMs]
+  // the periods that put every repeat within kRunJitterMs of its true time.
+  struct Channel {
+    uint32_t lastTsMs;
+    uint32_t seenMs;
+    uint32_t value;
+    uint32_t runCount;
+    uint32_t runLoMs;
+    uint32_t runHiMs;
+  };
+
+  // Narrows the period range to admit a repeat at tsMs; false if none is left.
+  static bool extendRun(Channel& c, uint32_t tsMs) {
+    if ((int32_t)(tsMs - c.lastTsMs) <= 0) return false;
+    if (c.runCount == 0) {
+      c.runLoMs = 1;
+      c.runHiMs = 0xFFFFFFFFu;
+    }
+    const uint64_t k = (uint64_t)c.runCount + 1u;
+    const uint64_t d = tsMs - c.lastTsMs;
+    const uint64_t lo = (d > kRunJitterMs) ? (d - kRunJitterMs + k - 1u) / k : 1u;
+    const uint64_t hi = (d + kRunJitterMs) / k;
+    const uint64_t newLo = lo > c.runLoMs ? lo : c.runLoMs;
+    const uint64_t newHi = hi < c.runHiMs ? hi : c.runHiMs;
+    if (newLo > newHi || newLo == 0) return false;
+    c.runLoMs = (uint32_t)newLo;
+    c.runHiMs = (uint32_t)newHi;
+    c.runCount = (uint32_t)k;
+    return true;
+  }
+
+  static uint32_t runPeriodMs(const Channel& c) { return c.runLoMs + (c.runHiMs - c.runLoMs) / 2u; }
+  static uint32_t runEndMs(const Channel& c) { return c.lastTsMs + c.runCount * runPeriodMs(c); }
+
+  // Room for n more bytes besides the records reserved for open runs.
+  bool fits(size_t n) const { return used_ + n + (size_t)openRuns_ * kMaxRecordBytes <= kPageBytes; }
+
+  void writeRun(uint8_t channel) {
+    Channel& c = ch_[channel];
+    const uint32_t period = runPeriodMs(c);
+    page_[used_++] = (uint8_t)(kRunTag | channel);
+    used_ += (uint16_t)putVarint(page_ + used_, c.runCount);
+    used_ += (uint16_t)putVarint(page_ + used_, period);
+    c.lastTsMs += c.runCount * period;
+    c.runCount = 0;
+    --openRuns_;
+  }
+
+  uint8_t* page_ = nullptr;
+  uint16_t used_ = 0;
+  uint8_t openRuns_ = 0;
+  Channel ch_[kChannels] = {};
+};
+
+// Expands one page back into samples, runs included, in record order.
+class PageDecoder {
+public:
+  bool open(const uint8_t* page, uint32_t& seq, uint16_t& captureId) {
+    page_ = page;
+    pos_ = kHeaderBytes;
+    runLeft_ = 0;
+    if (!readHeader(page, seq, captureId)) return false;
+    uint32_t base = 0;
+    if (page_[pos_++] != kBaseTag || !getVarint(page_, kPageBytes, pos_, base)) return false;
+    baseTsMs_ = base;
+    for (uint8_t c = 0; c < kChannels; ++c) {
+      lastTsMs_[c] = base;
+      value_[c] = 0;
+    }
+    return true;
+  }
+
+  uint32_t baseTsMs() const { return baseTsMs_; }
+
+  // False at the end of the page or at a damaged record.
+  bool next(Sample& out) {
+    if (runLeft_) {
+      --runLeft_;
+      lastTsMs_[runChannel_] += runPeriodMs_;
+      out.channel = runChannel_;
+      out.tsMs = lastTsMs_[runChannel_];
+      out.value = value_[runChannel_];
+      return true;
+    }
+    if (pos_ >= kPageBytes || page_[pos_] == kErased) return false;
+    const uint8_t tag = page_[pos_++];
+    const uint8_t channel = (uint8_t)(tag & 0x0Fu);
+    uint32_t a = 0;
+    uint32_t b = 0;
+    if (!getVarint(page_, kPageBytes, pos_, a) || !getVarint(page_, kPageBytes, pos_, b)) return false;
+    switch (tag & 0xF0u) {
+      case kSampleTag:
+        lastTsMs_[channel] += a;
+        value_[channel] += (uint32_t)unzigzag(b);
+        out.channel = channel;
+        out.tsMs = lastTsMs_[channel];
+        out.value = value_[channel];
+        return true;
+      case kRunTag:
+        if (a == 0) return false;
+        runChannel_ = channel;
+        runLeft_ = a;
+        runPeriodMs_ = b;
+        return next(out);
+      default:
+        return false;
+    }
+  }
+
+private:
+  const uint8_t* page_ = nullptr;
+  size_t pos_ = 0;
+  uint32_t baseTsMs_ = 0;
+  uint32_t lastTsMs_[kChannels] = {};
+  uint32_t value_[kChannels] = {};
+  uint8_t runChannel_ = 0;
+  uint32_t runLeft_ = 0;
+  uint32_t runPeriodMs_ = 0;
+};
+
+} // namespace SampleCodec
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "app/SystemState.h"
+
+// Sensor scan rates by situation. A disarmed house with nothing happening scans the
+// ultrasonic rangers and the keypad slowly; perimeter activity, an entry countdown,
+// an unlock session or a half-typed code boosts both. Digital inputs are read from one
+// GPIO snapshot per loop and are not throttled.
+enum class SamplingProfile : uint8_t {
+  idle,
+  normal,
+  boost
+};
+
+struct SamplingRates {
+  uint16_t ultrasonicMs = 200;     // ChokepointSensor sample period
+  uint16_t keypadScanGapMs = 0;    // polled keypad: pause between full row scans
+  uint16_t keypadBackstopMs = 200; // INT keypad: timeout backstop read
+};
+
+class SamplingPolicy {
+public:
+  static constexpr uint32_t kBoostHoldMs = 30000; // boost lasts this long after activity
+  static constexpr uint32_t kIdleAfterMs = 120000; // disarmed and quiet this long => idle
+
+  struct Inputs {
+    Mode mode = Mode::disarm;
+    bool entryPending = false;
+    bool doorSession = false;
+    bool keypadActive = false; // code entry in progress
+  };
+
+  static const char* name(SamplingProfile p) {
+    switch (p) {
+      case SamplingProfile::idle: return "idle";
+      case SamplingProfile::normal: return "normal";
+      case SamplingProfile::boost: return "boost";
+      default: return "unknown";
+    }
+  }
+
+  // normal is the previous fixed behaviour (200 ms ultrasonic, keypad every loop).
+  static SamplingRates rates(SamplingProfile p) {
+    SamplingRates r;
+    switch (p) {
+      case SamplingProfile::idle:
+        r.ultrasonicMs = 1000;
+        r.keypadScanGapMs = 80;
+        r.keypadBackstopMs = 1000;
+        break;
+      case SamplingProfile::boost:
+        r.ultrasonicMs = 100;
+        r.keypadScanGapMs = 0;
+        r.keypadBackstopMs = 100;
+        break;
+      case SamplingProfile::normal:
+      default:
+        break;
+    }
+    return r;
+  }
+
+  // Perimeter/intrusion sensor activity (door, window, PIR, vibration, chokepoint).
+  void noteActivity(uint32_t nowMs) {
+    lastActivityMs_ = nowMs;
+    seenActivity_ = true;
+  }
+
+  SamplingProfile select(const Inputs& in, uint32_t nowMs) const {
+    const uint32_t sinceMs = nowMs - lastActivityMs_;
+    if (in.entryPending || in.doorSession || in.keypadActive) return SamplingProfile::boost;
+    if (seenActivity_ && sinceMs < kBoostHoldMs) return SamplingProfile::boost;
+    if (in.mode != Mode::disarm) return SamplingProfile::normal;
+    return (seenActivity_ && sinceMs < kIdleAfterMs) ? SamplingProfile::normal : SamplingProfile::idle;
+  }
+
+private:
+  uint32_t lastActivityMs_ = 0;
+  bool seenActivity_ = false;
+};
+
+// Achieved scan rates and CPU time spent sampling per report window, and the time
+// saved against the fixed rates (every ranger each 200 ms, one keypad row per loop).
+class SamplingMeter {
+public:
+  static constexpr uint32_t kBaselineUltrasonicMs = 200;
+
+  struct Report {
+    SamplingProfile profile = SamplingProfile::normal;
+    uint32_t windowMs = 0;
+    uint32_t ultrasonicPeriodMs = 0; // achieved mean per ranger; 0 = no samples
+    uint32_t keypadScansPerSec = 0;  // polled keypad bus reads
+    uint32_t cpuUs = 0;
+    uint32_t savedUs = 0;
+  };
+
+  void begin(uint32_t nowMs) {
+    *this = SamplingMeter();
+    startMs_ = nowMs;
+  }
+
+  void addUltrasonic(uint32_t busyUs) {
+    ++usSamples_;
+    usBusyUs_ += busyUs;
+  }
+  void addKeypadScan(uint32_t busyUs) {
+    ++kpScans_;
+    kpBusyUs_ += busyUs;
+  }
+  // One main-loop keypad poll (the baseline scanned a row on each).
+  void addKeypadPoll() { ++kpPolls_; }
+
+  Report take(uint32_t nowMs, uint8_t rangers, SamplingProfile profile) {
+    Report r;
+    r.profile = profile;
+    r.windowMs = nowMs - startMs_;
+    if (rangers && usSamples_) r.ultrasonicPeriodMs = (uint32_t)((uint64_t)r.windowMs * rangers / usSamples_);
+    if (r.windowMs) r.keypadScansPerSec = (uint32_t)((uint64_t)kpScans_ * 1000u / r.windowMs);
+    r.cpuUs = usBusyUs_ + kpBusyUs_;
+
+    const uint32_t usBaseline = rangers * (r.windowMs / kBaselineUltrasonicMs);
+    if (usSamples_ && usBaseline > usSamples_) r.savedUs += (usBaseline - usSamples_) * (usBusyUs_ / usSamples_);
+    if (kpScans_ && kpPolls_ > kpScans_) r.savedUs += (kpPolls_ - kpScans_) * (kpBusyUs_ / kpScans_);
+
+    begin(nowMs);
+    return r;
+  }
+
+private:
+  uint32_t startMs_ = 0;
+  uint32_t usSamples_ = 0;
+  uint32_t usBusyUs_ = 0;
+  uint32_t kpScans_ = 0;
+  uint32_t kpBusyUs_ = 0;
+  uint32_t kpPolls_ = 0;
+};
@@ -1,5 +1,10 @@
 #include "app/SecurityOrchestrator.h"
 
+#include <esp_attr.h>
+#include <esp_system.h>
+
+#include "app/Clock.h"
+
 #ifndef FW_CMD_TOKEN
 #define FW_CMD_TOKEN ""
 #endif
@@ -46,7 +51,7 @@ static bool isManualActuatorEvent(EventType t) {
          t == EventType::manual_window_toggle;
 }
 
-static bool isSerialSyntheticSensorEvent(EventType t) {
+static bool isSensorEvent(EventType t) {
   return t == EventType::door_open ||
          t == EventType::window_open ||
          t == EventType::door_tamper ||
@@ -55,8 +60,51 @@ static bool isSerialSyntheticSensorEvent(EventType t) {
          t == EventType::chokepoint;
 }
 
+enum class RemoteCmd : uint8_t {
+  unknown,
+  buzz_warn,
+  alarm,
+  silence,
+  disarm,
+  arm_away,
+  status,
+  journal,
+  lock_door,
+  lock_window,
+  lock_all,
+  unlock_door,
+  unlock_window,
+  unlock_all
+};
+
+// "lock all; arm away; status" runs as one batch under a single token/nonce.
+constexpr char kRemoteBatchSeparator = ';';
+
+static bool isJournalRemoteCommand(const String& cmd) {
+  return cmd == "journal" || cmd.startsWith("journal ");
+}
+
 static bool isReadOnlyRemoteCommand(const String& cmd) {
-  return cmd == "status";
+  return cmd == "status" || isJournalRemoteCommand(cmd);
+}
+
+static RemoteCmd classifyRemoteCommand(const String& cmd) {
+  if (cmd == "buzz" || cmd == "buzzer" || cmd == "buzz warn" || cmd == "buzzer warn") return RemoteCmd::buzz_warn;
+  if (cmd == "alarm" || cmd == "alarm on" || cmd == "buzz alarm" || cmd == "buzz alert" || cmd == "buzzer alert") {
+    return RemoteCmd::alarm;
+  }
+  if (cmd == "silence" || cmd == "alarm off" || cmd == "buzz stop" || cmd == "buzzer stop") return RemoteCmd::silence;
+  if (cmd == "disarm" || cmd == "mode disarm") return RemoteCmd::disarm;
+  if (cmd == "arm away" || cmd == "arm_away" || cmd == "mode away") return RemoteCmd::arm_away;
+  if (cmd == "status") return RemoteCmd::status;
+  if (isJournalRemoteCommand(cmd)) return RemoteCmd::journal;
+  if (cmd == "lock door") return RemoteCmd::lock_door;
+  if (cmd == "lock window") return RemoteCmd::lock_window;
+  if (cmd == "lock all") return RemoteCmd::lock_all;
+  if (cmd == "unlock door") return RemoteCmd::unlock_door;
+  if (cmd == "unlock window") return RemoteCmd::unlock_window;
+  if (cmd == "unlock all") return RemoteCmd::unlock_all;
+  return RemoteCmd::unknown;
 }
 
 static bool parseAuthorizedRemoteCommand(const String& payload,
@@ -132,9 +180,32 @@ static bool restoreModeValue(uint8_t value, Mode& outMode) {
   }
 }
 
+static const char* resetReasonText(esp_reset_reason_t r) {
+  switch (r) {
+    case ESP_RST_POWERON:   return "poweron";
+    case ESP_RST_EXT:       return "ext";
+    case ESP_RST_SW:        return "sw";
+    case ESP_RST_PANIC:     return "panic";
+    case ESP_RST_INT_WDT:   return "int_wdt";
+    case ESP_RST_TASK_WDT:  return "task_wdt";
+    case ESP_RST_WDT:       return "wdt";
+    case ESP_RST_DEEPSLEEP: return "deepsleep";
+    case ESP_RST_BROWNOUT:  return "brownout";
+    case ESP_RST_SDIO:      return "sdio";
+    default:                return "unknown";
+  }
+}
+
 constexpr uint32_t STATUS_HEARTBEAT_MS = 5000;
+constexpr uint32_t SAMPLING_REPORT_MS = 60000;
+
+#ifndef SERIAL_INJECT_BURST
+#define SERIAL_INJECT_BURST 32
+#endif
 } // namespace
 
+RTC_NOINIT_ATTR uint32_t SecurityOrchestrator::warmWords_[WarmSnapshot::wordsFor(sizeof(WarmState))];
+
 void SecurityOrchestrator::printEventDecision(const Event& e,
                                               const Decision& d,
                                               const SystemState& prev) const {
@@ -178,17 +249,21 @@ void SecurityOrchestrator::syncLiveSnapshot() {
   state_.window_open = collector_.isWindowOpen();
 }
 
-void SecurityOrchestrator::publishStateStatus(const char* reason) {
+void SecurityOrchestrator::publishStateStatus(const char* reason, const BootProfile* boot) {
+  if (deferStatus_) return; // a remote batch publishes one status when it completes
   syncLiveSnapshot();
-  mqttBus_.publishStatus(state_, reason);
+  // Every decision and lock/lockout change ends in a status publish; refresh the RTC copy here.
+  saveWarmSnapshot();
+  mqttBus_.publishStatus(state_, reason, collector_.health().faultMask(), boot);
 }
 
-void SecurityOrchestrator::publishStateEvent(const Event& e, const Command& cmd) {
+void SecurityOrchestrator::publishStateEvent(const Event& e, const Command& cmd, int16_t scoreDelta) {
   syncLiveSnapshot();
+  journal_.append(e, scoreDelta, state_.level);
   mqttBus_.publishEvent(e, state_, cmd);
 }
 
-void SecurityOrchestrator::applyDecision(const Event& e) {
+void SecurityOrchestrator::applyDecision(const Event& e, bool trace) {
   // Use live actuator/sensor state for decision conditions (e.g. forced-open while locked).
   syncLiveSnapshot();
   const SystemState prevState = state_;
@@ -196,11 +271,47 @@ void SecurityOrchestrator::applyDecision(const Event& e) {
   const Decision d = engine_.handle(state_, cfg_, e);
   state_ = d.next;
   persistModeIfChanged(prevMode);
+  // A re-arm resets the state with no command, which would leave the countdown looping.
+  if (entryCountdownCancelled(prevState, state_)) buzzer_.stop();
   applyCommand(d.cmd, state_, acts_, &notifySvc_, &logger_);
   if (isArmedMode(state_.mode)) clearDoorUnlockSession(true);
-  publishStateEvent(e, d.cmd);
+  publishStateEvent(e, d.cmd, (int16_t)((int16_t)state_.suspicion_score - (int16_t)prevState.suspicion_score));
   publishStateStatus(toString(e.type));
-  printEventDecision(e, d, prevState);
+  if (trace) printEventDecision(e, d, prevState);
+  if (state_.entry_pending) clockWakeAt(state_.entry_deadline_ms);
+}
+
+const char* SecurityOrchestrator::serialPolicyBlock(const Event& e) const {
+  if (!isSerialSyntheticSource(e.src)) return nullptr;
+  if (isModeEvent(e.type) && !cfg_.allow_serial_mode_commands) return "serial_mode_blocked";
+  if (isManualActuatorEvent(e.type) && !cfg_.allow_serial_manual_commands) return "serial_manual_blocked";
+  if (isSensorEvent(e.type) && !cfg_.allow_serial_sensor_commands) return "serial_sensor_blocked";
+  return nullptr;
+}
+
+void SecurityOrchestrator::dispatchEvent(const Event& e, bool trace) {
+  if (processDoorHoldWarnSilenceEvent(e)) return;
+  if (processKeypadHelpRequestEvent(e)) return;
+  if (processManualActuatorEvent(e)) return;
+  if (isModeEvent(e.type)) {
+    processModeEvent(e, "SERIAL");
+    return;
+  }
+  applyDecision(e, trace);
+}
+
+void SecurityOrchestrator::drainInjected(uint32_t nowMs) {
+  Event e{};
+  bool trace = true;
+  for (uint8_t n = 0; n < SERIAL_INJECT_BURST && collector_.nextInjected(nowMs, e, trace); ++n) {
+    // Refusals are counted in the frame's ack; a status per refusal would flood MQTT.
+    const bool blocked = serialPolicyBlock(e) != nullptr;
+    if (!blocked) {
+      if (isSensorEvent(e.type)) sampling_.noteActivity(nowMs);
+      dispatchEvent(e, trace);
+    }
+    collector_.injectedDone(blocked);
+  }
 }
 
 void SecurityOrchestrator::startDoorUnlockSession(uint32_t nowMs) {
@@ -218,6 +329,7 @@ void SecurityOrchestrator::updateDoorUnlockSession(uint32_t nowMs) {
                       servo1_,
                       buzzer_,
                       notifySvc_);
+  doorSession_.requestWakeups(cfg_);
 }
 
 void SecurityOrchestrator::restorePersistedMode() {
@@ -235,7 +347,7 @@ void SecurityOrchestrator::restorePersistedMode() {
   state_.entry_pending = false;
   state_.entry_deadline_ms = 0;
   state_.suspicion_score = 0;
-  state_.last_suspicion_update_ms = millis();
+  state_.last_suspicion_update_ms = clockMs();
   state_.last_outdoor_motion_ms = 0;
   state_.last_window_event_ms = 0;
   state_.last_vibration_ms = 0;
@@ -246,6 +358,38 @@ void SecurityOrchestrator::restorePersistedMode() {
   Serial.println(toString(state_.mode));
 }
 
+bool SecurityOrchestrator::restoreWarmSnapshot(uint32_t nowMs) {
+  WarmState ws;
+  uint32_t takenMs = 0;
+  if (!WarmSnapshot::open(warmWords_, sizeof(warmWords_) / sizeof(warmWords_[0]), &ws, sizeof(ws), takenMs) ||
+      !WarmSnapshot::plausible(ws.state)) {
+    WarmSnapshot::invalidate(warmWords_);
+    return false;
+  }
+
+  // Time spent in reset is not counted: pending windows resume with the time they had left.
+  const uint32_t deltaMs = nowMs - takenMs;
+  state_ = ws.state;
+  WarmSnapshot::rebaseState(state_, deltaMs);
+  doorSession_ = ws.doorSession;
+  doorSession_.rebase(deltaMs);
+  keypadLockoutUntilMs_ = WarmSnapshot::rebase(ws.keypadLockoutUntilMs, deltaMs);
+  lastKeypadLockoutNotifyMs_ = WarmSnapshot::rebase(ws.lastKeypadLockoutNotifyMs, deltaMs);
+  badDoorCodeAttempts_ = ws.badDoorCodeAttempts;
+  return true;
+}
+
+void SecurityOrchestrator::saveWarmSnapshot() {
+  WarmState ws;
+  ws.state = state_;
+  ws.doorSession = doorSession_;
+  ws.keypadLockoutUntilMs = keypadLockoutUntilMs_;
+  ws.lastKeypadLockoutNotifyMs = lastKeypadLockoutNotifyMs_;
+  ws.badDoorCodeAttempts = badDoorCodeAttempts_;
+  warmSavedMs_ = clockMs();
+  WarmSnapshot::seal(warmWords_, sizeof(warmWords_) / sizeof(warmWords_[0]), &ws, sizeof(ws), warmSavedMs_);
+}
+
 void SecurityOrchestrator::persistModeIfChanged(Mode prevMode) {
   if (!noncePrefReady_) return;
   if (state_.mode == prevMode) return;
@@ -278,74 +422,86 @@ bool SecurityOrchestrator::acceptRemoteNonce(const String& nonce, uint32_t nowMs
 }
 
 void SecurityOrchestrator::updateSensorHealth(uint32_t nowMs) {
-  if (!cfg_.sensor_health_enabled) {
-    if (sensorFaultActive_) {
-      sensorFaultActive_ = false;
-      sensorFaultDetail_ = "";
-      notifySvc_.send("sensor health recovered");
-      publishStateStatus("sensor_health_recovered");
-    }
-    return;
+  SensorHealth& health = collector_.health();
+  if (!cfg_.sensor_health_enabled) health.clearFaults(nowMs);
+
+  bool newFault = false;
+  SensorHealth::Edge edge;
+  while (health.poll(nowMs, edge)) {
+    Serial.printf("[HEALTH] %s_%s %s at=%lu\n",
+                  health.name(edge.slot),
+                  health.label(edge.slot),
+                  edge.fault ? "fault" : "recovered",
+                  (unsigned long)edge.atMs);
+    if (edge.fault) newFault = true;
   }
 
-  if (nextSensorHealthCheckMs_ != 0 && !reached(nowMs, nextSensorHealthCheckMs_)) return;
-  nextSensorHealthCheckMs_ = nowMs + cfg_.sensor_health_check_period_ms;
-
-  EventCollector::HealthSnapshot hs{};
-  collector_.readHealth(nowMs,
-                        cfg_.pir_stuck_active_ms,
-                        cfg_.vib_stuck_active_ms,
-                        cfg_.ultrasonic_offline_ms,
-                        cfg_.ultrasonic_no_echo_threshold,
-                        hs);
-
-  String detail;
-  if (hs.pir1_stuck_active) detail += "pir1_stuck;";
-  if (hs.pir2_stuck_active) detail += "pir2_stuck;";
-  if (hs.pir3_stuck_active) detail += "pir3_stuck;";
-  if (hs.vib_stuck_active) detail += "vib_stuck;";
-  if (hs.us1_offline) detail += "us1_offline;";
-  if (hs.us2_offline) detail += "us2_offline;";
-  if (hs.us3_offline) detail += "us3_offline;";
-
-  const bool hasFault = detail.length() > 0;
-  if (!hasFault) {
+  const uint32_t faults = health.faultMask();
+  if (faults == 0) {
     if (sensorFaultActive_) {
       sensorFaultActive_ = false;
-      sensorFaultDetail_ = "";
       notifySvc_.send("sensor health recovered");
       publishStateStatus("sensor_health_recovered");
     }
     return;
   }
 
-  sensorFaultDetail_ = detail;
-  const bool shouldNotify = !sensorFaultActive_ ||
-                            cfg_.sensor_fault_notify_cooldown_ms == 0 ||
-                            reached(nowMs, lastSensorFaultNotifyMs_ + cfg_.sensor_fault_notify_cooldown_ms);
-  if (shouldNotify) {
-    lastSensorFaultNotifyMs_ = nowMs;
-    notifySvc_.send(String("sensor health degraded: ") + sensorFaultDetail_);
-    publishStateStatus("sensor_health_fault");
-    if (isArmedMode(state_.mode)) {
-      buzzer_.warn();
-    }
-  }
+  // New faults notify at once; a standing fault repeats after the cooldown (0 = edges only).
+  const bool shouldNotify = newFault || !sensorFaultActive_ ||
+                            (cfg_.sensor_fault_notify_cooldown_ms != 0 &&
+                             reached(nowMs, lastSensorFaultNotifyMs_ + cfg_.sensor_fault_notify_cooldown_ms));
   sensorFaultActive_ = true;
+  if (!shouldNotify) return;
+
+  char detail[96];
+  size_t used = 0;
+  detail[0] = '\0';
+  for (uint8_t slot = 0; slot < SensorHealth::kMaxSlots; ++slot) {
+    if (!(faults & ((uint32_t)1u << slot))) continue;
+    const int n = snprintf(detail + used, sizeof(detail) - used, "%s_%s;", health.name(slot), health.label(slot));
+    if (n < 0 || (size_t)n >= sizeof(detail) - used) break;
+    used += (size_t)n;
+  }
+
+  lastSensorFaultNotifyMs_ = nowMs;
+  notifySvc_.send(String("sensor health degraded: ") + detail);
+  publishStateStatus("sensor_health_fault");
+  if (isArmedMode(state_.mode)) {
+    buzzer_.play(BuzzerPattern::sensor_fault);
+  }
 }
 
 void SecurityOrchestrator::begin() {
+  const uint32_t bootStartMs = clockMs();
+  bootProfile_.start(bootStartMs);
+  const esp_reset_reason_t resetReason = esp_reset_reason();
+  const bool warm = (resetReason != ESP_RST_POWERON) && restoreWarmSnapshot(bootStartMs);
+
   logger_.begin();
   notifySvc_.begin();
   notifySvc_.setSerialEnabled(cfg_.serial_notify_enabled);
 
-  collector_.begin();
+  // Network first: Wi-Fi association (seconds) runs in the MQTT task while the
+  // peripherals below come up. The journal is attached now and becomes ready later.
+  mqttBus_.attachJournal(&journal_);
   mqttBus_.begin();
+  bootProfile_.mark("net", clockMs());
+
+  // Zero thresholds register the slots but never fault them.
+  const bool healthOn = cfg_.sensor_health_enabled;
+  collector_.configureHealth(healthOn ? cfg_.pir_stuck_active_ms : 0,
+                             healthOn ? cfg_.vib_stuck_active_ms : 0,
+                             healthOn ? cfg_.ultrasonic_offline_ms : 0,
+                             healthOn ? cfg_.ultrasonic_no_echo_threshold : 0);
+  collector_.begin(warm);
+  bootProfile_.mark("io", clockMs());
+  journal_.begin(clockMs());
+  bootProfile_.mark("journal", clockMs());
 
   noncePrefReady_ = noncePref_.begin("eshsecv2", false);
   if (noncePrefReady_) {
     lastRemoteNonce_ = noncePref_.getULong("rnonce", 0);
-    restorePersistedMode();
+    if (!warm) restorePersistedMode();
   } else {
     lastRemoteNonce_ = 0;
     if (cfg_.fail_closed_if_nonce_persistence_unavailable) {
@@ -354,24 +510,57 @@ void SecurityOrchestrator::begin() {
       notifySvc_.send("WARN: nonce persistence disabled");
     }
   }
+  bootProfile_.mark("nvs", clockMs());
 
   buzzer_.begin();
-  servo1_.begin();
-  servo2_.begin();
-  if (collector_.isDoorOpen()) {
-    notifySvc_.send("startup: door open, skip pre-lock");
-  } else {
-    servo1_.lock();
-  }
-  if (collector_.isWindowOpen()) {
-    notifySvc_.send("startup: window open, skip pre-lock");
+  if (warm) {
+    // Servos were holding these positions when the reset hit; write them directly.
+    servo1_.beginAt(state_.door_locked);
+    servo2_.beginAt(state_.window_locked);
+    if (state_.level == AlarmLevel::alert) {
+      buzzer_.alert();
+    } else if (state_.level == AlarmLevel::warn) {
+      buzzer_.play(state_.entry_pending ? BuzzerPattern::entry_countdown : BuzzerPattern::warn);
+    }
   } else {
-    servo2_.lock();
+    servo1_.begin();
+    servo2_.begin();
+    if (collector_.isDoorOpen()) {
+      notifySvc_.send("startup: door open, skip pre-lock");
+    } else {
+      servo1_.lock();
+    }
+    if (collector_.isWindowOpen()) {
+      notifySvc_.send("startup: window open, skip pre-lock");
+    } else {
+      servo2_.lock();
+    }
   }
   servo1WasLocked_ = servo1_.isLocked();
   servo2WasLocked_ = servo2_.isLocked();
-  updateSensorHealth(millis());
-  publishStateStatus("boot");
+  bootProfile_.mark("actuators", clockMs());
+  updateSensorHealth(clockMs());
+  bootProfile_.mark("health", clockMs());
+
+  char bootReason[32];
+  if (warm) {
+    snprintf(bootReason, sizeof(bootReason), "warm_boot_%s", resetReasonText(resetReason));
+  } else if (resetReason == ESP_RST_POWERON) {
+    snprintf(bootReason, sizeof(bootReason), "boot");
+  } else {
+    snprintf(bootReason, sizeof(bootReason), "boot_%s", resetReasonText(resetReason));
+  }
+  Serial.printf("[BOOT] reset=%s warm=%u mode=%s level=%s resumed_in=%lums\n",
+                resetReasonText(resetReason),
+                warm ? 1u : 0u,
+                toString(state_.mode),
+                toString(state_.level),
+                (unsigned long)bootProfile_.totalMs());
+  char bootTiming[160];
+  if (bootProfile_.toJson(bootTiming, sizeof(bootTiming)) > 0) {
+    Serial.printf("[BOOT] phases_ms=%s\n", bootTiming);
+  }
+  publishStateStatus(bootReason, &bootProfile_);
   nextStatusHeartbeatMs_ = 0;
 
   Serial.println("READY");
@@ -394,23 +583,32 @@ bool SecurityOrchestrator::processModeEvent(const Event& e, const char* origin)
   return true;
 }
 
+void SecurityOrchestrator::fillLockDetail(char* out, size_t outLen) const {
+  const int n = snprintf(
+    out,
+    outLen,
+    "dL=%u,wL=%u,dO=%u,wO=%u",
+    servo1_.isLocked() ? 1u : 0u,
+    servo2_.isLocked() ? 1u : 0u,
+    collector_.isDoorOpen() ? 1u : 0u,
+    collector_.isWindowOpen() ? 1u : 0u
+  );
+  // A move still in flight: when the lock state will be final.
+  const uint32_t nowMs = clockMs();
+  const uint32_t e1 = servo1_.etaMs(nowMs);
+  const uint32_t e2 = servo2_.etaMs(nowMs);
+  const uint32_t eta = (e1 > e2) ? e1 : e2;
+  if (eta != 0 && n > 0 && (size_t)n < outLen) {
+    snprintf(out + n, outLen - (size_t)n, ",eta=%lu", (unsigned long)eta);
+  }
+}
+
 void SecurityOrchestrator::processRemoteCommand(const String& payload) {
   String cmd;
   String nonce;
-  const uint32_t nowMs = millis();
+  const uint32_t nowMs = clockMs();
   const String configuredToken = normalize(String(FW_CMD_TOKEN));
   const bool requireNonce = (configuredToken.length() > 0) && cfg_.require_remote_nonce;
-  auto fillDetail = [&](char* out, size_t outLen) {
-    snprintf(
-      out,
-      outLen,
-      "dL=%u,wL=%u,dO=%u,wO=%u",
-      servo1_.isLocked() ? 1u : 0u,
-      servo2_.isLocked() ? 1u : 0u,
-      collector_.isDoorOpen() ? 1u : 0u,
-      collector_.isWindowOpen() ? 1u : 0u
-    );
-  };
   auto publishRemoteStatus = [&](const char* reason) {
     publishStateStatus(reason);
   };
@@ -445,184 +643,321 @@ void SecurityOrchestrator::processRemoteCommand(const String& payload) {
     return;
   }
 
-  // Buzzer/alarm test commands (useful when outputs aren't wired yet)
-  if (cmd == "buzz" || cmd == "buzzer" || cmd == "buzz warn" || cmd == "buzzer warn") {
-    buzzer_.warn();
-    Serial.println("[REMOTE] buzzer warn");
-    mqttBus_.publishAck("buzz warn", true, "ok");
-    publishRemoteStatus("remote_buzz_warn");
+  if (cmd.indexOf(kRemoteBatchSeparator) >= 0) {
+    processRemoteBatch(cmd, nowMs);
     return;
   }
 
-  if (cmd == "alarm" || cmd == "alarm on" || cmd == "buzz alarm" || cmd == "buzz alert" || cmd == "buzzer alert") {
-    buzzer_.alert();
-    Serial.println("[REMOTE] buzzer alert");
-    mqttBus_.publishAck("alarm", true, "ok");
-    publishRemoteStatus("remote_alarm");
-    return;
+  RemoteOutcome out;
+  executeRemoteCommand(cmd, nowMs, out);
+  mqttBus_.publishAck(out.ackCmd, out.ok, out.detail);
+  if (out.statusReason) publishRemoteStatus(out.statusReason);
+}
+
+void SecurityOrchestrator::processRemoteBatch(const String& cmd, uint32_t nowMs) {
+  String steps[kRemoteBatchMax];
+  uint8_t count = 0;
+  char detail[48];
+
+  int from = 0;
+  for (;;) {
+    const int sep = cmd.indexOf(kRemoteBatchSeparator, from);
+    String step = (sep < 0) ? cmd.substring(from) : cmd.substring(from, sep);
+    step.trim();
+    bool malformed = true;
+    if (count >= kRemoteBatchMax) {
+      snprintf(detail, sizeof(detail), "max %u steps", (unsigned)kRemoteBatchMax);
+    } else if (step.length() == 0) {
+      snprintf(detail, sizeof(detail), "step %u: empty", (unsigned)(count + 1u));
+    } else {
+      malformed = false;
+    }
+    if (malformed) {
+      mqttBus_.publishAck("batch", false, detail);
+      publishStateStatus("remote_batch_reject");
+      return;
+    }
+    steps[count++] = step;
+    if (sep < 0) break;
+    from = sep + 1;
   }
 
-  if (cmd == "silence" || cmd == "alarm off" || cmd == "buzz stop" || cmd == "buzzer stop") {
-    buzzer_.stop();
-    Serial.println("[REMOTE] buzzer stop");
-    mqttBus_.publishAck("silence", true, "ok");
-    publishRemoteStatus("remote_silence");
+  // Every precondition is checked against the state the earlier steps will produce
+  // before anything is executed, so a batch that can be foreseen to fail never starts.
+  if (!validateRemoteBatch(steps, count, detail, sizeof(detail))) {
+    notifySvc_.send(String("batch rejected: ") + detail);
+    mqttBus_.publishAck("batch", false, detail);
+    publishStateStatus("remote_batch_reject");
     return;
   }
 
-  if (cmd == "disarm" || cmd == "mode disarm" ||
-      cmd == "arm away" || cmd == "arm_away" || cmd == "mode away") {
-    EventType t = EventType::disarm;
-    const char* ackCmd = "disarm";
-    if (cmd == "arm away" || cmd == "arm_away" || cmd == "mode away") {
-      t = EventType::arm_away;
-      ackCmd = "arm away";
+  // One aggregated status at the end instead of one per step. A step that still fails
+  // (its precondition changed after validation) stops the batch; the steps before it stay applied and
+  // the ack names the failed one.
+  deferStatus_ = true;
+  uint8_t failedStep = 0;
+  RemoteOutcome out;
+  for (uint8_t i = 0; i < count; ++i) {
+    out = RemoteOutcome();
+    executeRemoteCommand(steps[i], nowMs, out);
+    if (!out.ok) {
+      failedStep = (uint8_t)(i + 1u);
+      break;
     }
-    processModeEvent({t, nowMs, 9}, "REMOTE");
-    mqttBus_.publishAck(ackCmd, true, "ok");
-    return;
   }
+  deferStatus_ = false;
 
-  if (cmd == "status") {
-    String msg = "mode=" + String((int)state_.mode) +
-                 " level=" + String((int)state_.level) +
-                 " door_open=" + String(collector_.isDoorOpen() ? "1" : "0") +
-                 " window_open=" + String(collector_.isWindowOpen() ? "1" : "0") +
-                 " door_locked=" + String(servo1_.isLocked() ? "1" : "0");
-    msg += " window_locked=" + String(servo2_.isLocked() ? "1" : "0");
-    notifySvc_.send(msg);
-    char detail[32];
-    fillDetail(detail, sizeof(detail));
-    mqttBus_.publishAck("status", true, detail);
-    publishRemoteStatus("remote_status");
-    return;
+  if (failedStep != 0) {
+    snprintf(detail, sizeof(detail), "step %u failed: %s", (unsigned)failedStep, out.detail);
+  } else {
+    const int n = snprintf(detail, sizeof(detail), "n=%u,", (unsigned)count);
+    fillLockDetail(detail + n, sizeof(detail) - (size_t)n);
   }
+  mqttBus_.publishAck("batch", failedStep == 0, detail);
+  publishStateStatus("remote_batch");
+}
 
-  if (cmd == "lock door") {
-    const bool ok = tryLockDoor(collector_, servo1_, notifySvc_, "lock door rejected");
-    if (ok) clearDoorUnlockSession(true);
-    if (ok) {
-      char detail[32];
-      fillDetail(detail, sizeof(detail));
-      mqttBus_.publishAck("lock door", true, detail);
-    } else {
-      mqttBus_.publishAck("lock door", false, "door open");
+bool SecurityOrchestrator::validateRemoteBatch(const String* steps,
+                                               uint8_t count,
+                                               char* why,
+                                               size_t whyLen) const {
+  Mode mode = state_.mode;
+  const bool doorOpen = collector_.isDoorOpen();
+  const bool windowOpen = collector_.isWindowOpen();
+  const bool sensorFaultBlocksUnlock = cfg_.fail_closed_on_sensor_fault && sensorFaultActive_;
+
+  for (uint8_t i = 0; i < count; ++i) {
+    const char* reason = nullptr;
+    switch (classifyRemoteCommand(steps[i])) {
+      case RemoteCmd::unknown:
+      case RemoteCmd::journal:
+        reason = "unsupported";
+        break;
+      case RemoteCmd::disarm:
+        mode = Mode::disarm;
+        break;
+      case RemoteCmd::arm_away:
+        mode = Mode::away;
+        break;
+      case RemoteCmd::lock_door:
+        if (doorOpen) reason = "door open";
+        break;
+      case RemoteCmd::lock_window:
+        if (windowOpen) reason = "window open";
+        break;
+      case RemoteCmd::lock_all:
+        if (doorOpen) reason = "door open";
+        else if (windowOpen) reason = "window open";
+        break;
+      case RemoteCmd::unlock_door:
+      case RemoteCmd::unlock_window:
+      case RemoteCmd::unlock_all:
+        if (sensorFaultBlocksUnlock) reason = "sensor fault";
+        else if (!unlockAllowed(mode)) reason = "disarm required";
+        break;
+      default:
+        break;
+    }
+    if (reason) {
+      snprintf(why, whyLen, "step %u: %s", (unsigned)(i + 1u), reason);
+      return false;
     }
-    publishRemoteStatus(ok ? "remote_lock_door" : "remote_lock_door_reject");
-    return;
   }
+  return true;
+}
 
-  if (cmd == "lock window") {
-    const bool ok = tryLockWindow(collector_, servo2_, notifySvc_, "lock window rejected");
-    if (!ok) {
-      mqttBus_.publishAck("lock window", false, "window open");
-      publishRemoteStatus("remote_lock_window_reject");
-      return;
+void SecurityOrchestrator::executeRemoteCommand(const String& cmd, uint32_t nowMs, RemoteOutcome& out) {
+  // detail == nullptr reports the live lock/open snapshot.
+  auto respond = [&](const char* ackCmd, bool ok, const char* detail, const char* statusReason) {
+    out.ackCmd = ackCmd;
+    out.ok = ok;
+    if (detail) {
+      snprintf(out.detail, sizeof(out.detail), "%s", detail);
+    } else {
+      fillLockDetail(out.detail, sizeof(out.detail));
     }
-    state_.keep_window_locked_when_disarmed = true;
-    char detail[32];
-    fillDetail(detail, sizeof(detail));
-    mqttBus_.publishAck("lock window", true, detail);
-    publishRemoteStatus("remote_lock_window");
-    return;
-  }
+    out.statusReason = statusReason;
+  };
 
-  if (cmd == "lock all") {
-    if (collector_.isDoorOpen()) {
-      notifySvc_.send("lock all rejected: door is open");
-      mqttBus_.publishAck("lock all", false, "door open");
-      publishRemoteStatus("remote_lock_all_reject_door");
+  const RemoteCmd kind = classifyRemoteCommand(cmd);
+  switch (kind) {
+    // Buzzer/alarm test commands (useful when outputs aren't wired yet)
+    case RemoteCmd::buzz_warn:
+      buzzer_.warn();
+      Serial.println("[REMOTE] buzzer warn");
+      respond("buzz warn", true, "ok", "remote_buzz_warn");
       return;
-    }
-    if (collector_.isWindowOpen()) {
-      notifySvc_.send("lock all rejected: window is open");
-      mqttBus_.publishAck("lock all", false, "window open");
-      publishRemoteStatus("remote_lock_all_reject_window");
+
+    case RemoteCmd::alarm:
+      buzzer_.alert();
+      Serial.println("[REMOTE] buzzer alert");
+      respond("alarm", true, "ok", "remote_alarm");
       return;
-    }
-    servo1_.lock();
-    clearDoorUnlockSession(true);
-    servo2_.lock();
-    state_.keep_window_locked_when_disarmed = true;
-    char detail[32];
-    fillDetail(detail, sizeof(detail));
-    mqttBus_.publishAck("lock all", true, detail);
-    publishRemoteStatus("remote_lock_all");
-    return;
-  }
 
-  if (cmd == "unlock door") {
-    if (cfg_.fail_closed_on_sensor_fault && sensorFaultActive_) {
-      notifySvc_.send("unlock door rejected: sensor fault");
-      mqttBus_.publishAck("unlock door", false, "sensor fault");
-      publishRemoteStatus("remote_unlock_door_reject_sensor_fault");
+    case RemoteCmd::silence:
+      buzzer_.stop();
+      Serial.println("[REMOTE] buzzer stop");
+      respond("silence", true, "ok", "remote_silence");
       return;
-    }
-    if (!unlockAllowed(state_.mode)) {
-      notifySvc_.send("unlock door rejected: disarm required");
-      mqttBus_.publishAck("unlock door", false, "disarm required");
-      publishRemoteStatus("remote_unlock_door_reject_mode");
+
+    case RemoteCmd::disarm:
+    case RemoteCmd::arm_away: {
+      const bool arm = (kind == RemoteCmd::arm_away);
+      processModeEvent({arm ? EventType::arm_away : EventType::disarm, nowMs, 9}, "REMOTE");
+      // applyDecision already published the status.
+      respond(arm ? "arm away" : "disarm", true, "ok", nullptr);
       return;
     }
-    servo1_.unlock();
-    clearDoorUnlockSession(true);
-    startDoorUnlockSession(nowMs);
-    char detail[32];
-    fillDetail(detail, sizeof(detail));
-    mqttBus_.publishAck("unlock door", true, detail);
-    publishRemoteStatus("remote_unlock_door");
-    return;
-  }
 
-  if (cmd == "unlock window") {
-    if (cfg_.fail_closed_on_sensor_fault && sensorFaultActive_) {
-      notifySvc_.send("unlock window rejected: sensor fault");
-      mqttBus_.publishAck("unlock window", false, "sensor fault");
-      publishRemoteStatus("remote_unlock_window_reject_sensor_fault");
+    case RemoteCmd::status: {
+      String msg = "mode=" + String((int)state_.mode) +
+                   " level=" + String((int)state_.level) +
+                   " door_open=" + String(collector_.isDoorOpen() ? "1" : "0") +
+                   " window_open=" + String(collector_.isWindowOpen() ? "1" : "0") +
+                   " door_locked=" + String(servo1_.isLocked() ? "1" : "0");
+      msg += " window_locked=" + String(servo2_.isLocked() ? "1" : "0");
+      const SerialInjector::Stats& inj = collector_.injectStats();
+      if (inj.frames || inj.crcErrors || inj.timeouts) {
+        msg += " inject_frames=" + String(inj.frames) +
+               " inject_events=" + String(inj.events) +
+               " inject_crc=" + String(inj.crcErrors) +
+               " inject_busy=" + String(inj.busy) +
+               " inject_dups=" + String(inj.dups) +
+               " inject_gaps=" + String(inj.gaps) +
+               " inject_timeouts=" + String(inj.timeouts);
+      }
+      notifySvc_.send(msg);
+      respond("status", true, nullptr, "remote_status");
       return;
     }
-    if (!unlockAllowed(state_.mode)) {
-      notifySvc_.send("unlock window rejected: disarm required");
-      mqttBus_.publishAck("unlock window", false, "disarm required");
-      publishRemoteStatus("remote_unlock_window_reject_mode");
+
+    case RemoteCmd::journal: {
+      // Timestamps restart at every boot, so a range applies to one boot: the
+      // current one unless named. A bare "journal" streams every boot in the ring.
+      uint32_t fromMs = 0;
+      uint32_t toMs = 0xFFFFFFFFu;
+      uint32_t boot = 0;
+      if (cmd != "journal") {
+        const String args = cmd.substring(8);
+        const int sep = args.indexOf(' ');
+        const int bootSep = (sep > 0) ? args.indexOf(' ', sep + 1) : -1;
+        boot = journal_.bootId();
+        if (sep <= 0 ||
+            !parseUint32Strict(args.substring(0, sep), fromMs) ||
+            !parseUint32Strict(args.substring(sep + 1, bootSep < 0 ? args.length() : bootSep), toMs) ||
+            (bootSep > 0 && (!parseUint32Strict(args.substring(bootSep + 1), boot) || boot == 0)) ||
+            toMs < fromMs) {
+          respond("journal", false, "usage: journal <from> <to> [boot]", "remote_journal_reject");
+          return;
+        }
+      }
+      if (!journal_.ready() || !mqttBus_.requestJournal(fromMs, toMs, boot)) {
+        respond("journal", false, "journal unavailable", "remote_journal_reject");
+        return;
+      }
+      char detail[32];
+      snprintf(detail, sizeof(detail), "boot=%lu", (unsigned long)journal_.bootId());
+      respond("journal", true, detail, "remote_journal");
       return;
     }
-    state_.keep_window_locked_when_disarmed = false;
-    servo2_.unlock();
-    char detail[32];
-    fillDetail(detail, sizeof(detail));
-    mqttBus_.publishAck("unlock window", true, detail);
-    publishRemoteStatus("remote_unlock_window");
-    return;
-  }
 
-  if (cmd == "unlock all") {
-    if (cfg_.fail_closed_on_sensor_fault && sensorFaultActive_) {
-      notifySvc_.send("unlock all rejected: sensor fault");
-      mqttBus_.publishAck("unlock all", false, "sensor fault");
-      publishRemoteStatus("remote_unlock_all_reject_sensor_fault");
+    case RemoteCmd::lock_door: {
+      const bool ok = tryLockDoor(collector_, servo1_, notifySvc_, "lock door rejected");
+      if (!ok) {
+        respond("lock door", false, "door open", "remote_lock_door_reject");
+        return;
+      }
+      clearDoorUnlockSession(true);
+      respond("lock door", true, nullptr, "remote_lock_door");
       return;
     }
-    if (!unlockAllowed(state_.mode)) {
-      notifySvc_.send("unlock all rejected: disarm required");
-      mqttBus_.publishAck("unlock all", false, "disarm required");
-      publishRemoteStatus("remote_unlock_all_reject_mode");
+
+    case RemoteCmd::lock_window: {
+      const bool ok = tryLockWindow(collector_, servo2_, notifySvc_, "lock window rejected");
+      if (!ok) {
+        respond("lock window", false, "window open", "remote_lock_window_reject");
+        return;
+      }
+      state_.keep_window_locked_when_disarmed = true;
+      respond("lock window", true, nullptr, "remote_lock_window");
       return;
     }
-    servo1_.unlock();
-    clearDoorUnlockSession(true);
-    startDoorUnlockSession(nowMs);
-    state_.keep_window_locked_when_disarmed = false;
-    servo2_.unlock();
-    char detail[32];
-    fillDetail(detail, sizeof(detail));
-    mqttBus_.publishAck("unlock all", true, detail);
-    publishRemoteStatus("remote_unlock_all");
-    return;
-  }
 
-  mqttBus_.publishAck("unknown", false, "unsupported command");
-  publishRemoteStatus("remote_unknown");
+    case RemoteCmd::lock_all:
+      if (collector_.isDoorOpen()) {
+        notifySvc_.send("lock all rejected: door is open");
+        respond("lock all", false, "door open", "remote_lock_all_reject_door");
+        return;
+      }
+      if (collector_.isWindowOpen()) {
+        notifySvc_.send("lock all rejected: window is open");
+        respond("lock all", false, "window open", "remote_lock_all_reject_window");
+        return;
+      }
+      servo1_.lock();
+      clearDoorUnlockSession(true);
+      servo2_.lock();
+      state_.keep_window_locked_when_disarmed = true;
+      respond("lock all", true, nullptr, "remote_lock_all");
+      return;
+
+    case RemoteCmd::unlock_door:
+      if (cfg_.fail_closed_on_sensor_fault && sensorFaultActive_) {
+        notifySvc_.send("unlock door rejected: sensor fault");
+        respond("unlock door", false, "sensor fault", "remote_unlock_door_reject_sensor_fault");
+        return;
+      }
+      if (!unlockAllowed(state_.mode)) {
+        notifySvc_.send("unlock door rejected: disarm required");
+        respond("unlock door", false, "disarm required", "remote_unlock_door_reject_mode");
+        return;
+      }
+      servo1_.unlock();
+      clearDoorUnlockSession(true);
+      startDoorUnlockSession(nowMs);
+      respond("unlock door", true, nullptr, "remote_unlock_door");
+      return;
+
+    case RemoteCmd::unlock_window:
+      if (cfg_.fail_closed_on_sensor_fault && sensorFaultActive_) {
+        notifySvc_.send("unlock window rejected: sensor fault");
+        respond("unlock window", false, "sensor fault", "remote_unlock_window_reject_sensor_fault");
+        return;
+      }
+      if (!unlockAllowed(state_.mode)) {
+        notifySvc_.send("unlock window rejected: disarm required");
+        respond("unlock window", false, "disarm required", "remote_unlock_window_reject_mode");
+        return;
+      }
+      state_.keep_window_locked_when_disarmed = false;
+      servo2_.unlock();
+      respond("unlock window", true, nullptr, "remote_unlock_window");
+      return;
+
+    case RemoteCmd::unlock_all:
+      if (cfg_.fail_closed_on_sensor_fault && sensorFaultActive_) {
+        notifySvc_.send("unlock all rejected: sensor fault");
+        respond("unlock all", false, "sensor fault", "remote_unlock_all_reject_sensor_fault");
+        return;
+      }
+      if (!unlockAllowed(state_.mode)) {
+        notifySvc_.send("unlock all rejected: disarm required");
+        respond("unlock all", false, "disarm required", "remote_unlock_all_reject_mode");
+        return;
+      }
+      servo1_.unlock();
+      clearDoorUnlockSession(true);
+      startDoorUnlockSession(nowMs);
+      state_.keep_window_locked_when_disarmed = false;
+      servo2_.unlock();
+      respond("unlock all", true, nullptr, "remote_unlock_all");
+      return;
+
+    case RemoteCmd::unknown:
+    default:
+      respond("unknown", false, "unsupported command", "remote_unknown");
+      return;
+  }
 }
 
 bool SecurityOrchestrator::processDoorHoldWarnSilenceEvent(const Event& e) {
@@ -714,6 +1049,36 @@ bool SecurityOrchestrator::processManualActuatorEvent(const Event& e) {
   return false;
 }
 
+void SecurityOrchestrator::updateSampling(uint32_t nowMs) {
+  SamplingPolicy::Inputs in;
+  in.mode = state_.mode;
+  in.entryPending = state_.entry_pending;
+  in.doorSession = doorSession_.isActive();
+  in.keypadActive = collector_.keypadActive();
+  const SamplingProfile p = sampling_.select(in, nowMs);
+  if (p != samplingProfile_) {
+    samplingProfile_ = p;
+    collector_.applySampling(p);
+    Serial.printf("[SAMPLING] profile=%s\n", SamplingPolicy::name(p));
+  }
+
+  if (nextSamplingReportMs_ == 0) {
+    nextSamplingReportMs_ = nowMs + SAMPLING_REPORT_MS;
+    clockWakeAt(nextSamplingReportMs_);
+  }
+  if (!reached(nowMs, nextSamplingReportMs_)) return;
+  nextSamplingReportMs_ = nowMs + SAMPLING_REPORT_MS;
+  clockWakeAt(nextSamplingReportMs_);
+  const SamplingMeter::Report r = collector_.takeSamplingReport(nowMs);
+  Serial.printf("[SAMPLING] profile=%s us_period_ms=%lu kp_scans_per_s=%lu cpu_us=%lu saved_us=%lu\n",
+                SamplingPolicy::name(r.profile),
+                (unsigned long)r.ultrasonicPeriodMs,
+                (unsigned long)r.keypadScansPerSec,
+                (unsigned long)r.cpuUs,
+                (unsigned long)r.savedUs);
+  mqttBus_.setSamplingTelemetry(r);
+}
+
 void SecurityOrchestrator::tick(uint32_t nowMs) {
   Event e;
 
@@ -722,6 +1087,10 @@ void SecurityOrchestrator::tick(uint32_t nowMs) {
   servo1_.update(nowMs);
   servo2_.update(nowMs);
 
+  // Status publishes save on every change; this keeps the snapshot's timestamp close to
+  // any reset so a restore does not hand pending deadlines back the time since.
+  if (WarmSnapshot::refreshDue(nowMs, warmSavedMs_)) saveWarmSnapshot();
+
   // If something unlocked the door while it's closed (e.g., DISARM command path),
   // start the auto-lock countdown.
   const bool prevServo1Locked = servo1WasLocked_;
@@ -769,21 +1138,24 @@ void SecurityOrchestrator::tick(uint32_t nowMs) {
 
   mqttBus_.update(nowMs);
   if (nextStatusHeartbeatMs_ == 0 || reached(nowMs, nextStatusHeartbeatMs_)) {
-    nextStatusHeartbeatMs_ = nowMs + STATUS_HEARTBEAT_MS;
+    // Stretched while the publish pipeline is overloaded (BR-33).
+    nextStatusHeartbeatMs_ = nowMs + STATUS_HEARTBEAT_MS * OverloadController::heartbeatStretch(mqttBus_.degradeLevel());
+    clockWakeAt(nextStatusHeartbeatMs_);
     publishStateStatus("periodic");
   }
+  updateSampling(nowMs);
 
   String remoteCmd;
   if (mqttBus_.pollCommand(remoteCmd)) {
     processRemoteCommand(remoteCmd);
-    const uint32_t t = millis();
+    const uint32_t t = clockMs();
     cdActive = doorSession_.countdown(t,
                                       servo1_.isLocked(),
                                       collector_.isDoorOpen(),
                                       cfg_,
                                       cdDeadline,
                                       cdWarnBefore);
-    collector_.updateOledStatus(millis(),
+    collector_.updateOledStatus(clockMs(),
                                 servo1_.isLocked(),
                                 collector_.isDoorOpen(),
                                 cdActive,
@@ -812,6 +1184,7 @@ void SecurityOrchestrator::tick(uint32_t nowMs) {
           lastKeypadLockoutNotifyMs_ = nowMs;
           notifySvc_.send("door code rejected: keypad lockout active");
         }
+        buzzer_.play(BuzzerPattern::lockout);
         mqttBus_.publishAck("door_code", false, "keypad lockout");
         publishStateStatus("keypad_unlock_reject_lockout");
         updateDoorUnlockSession(nowMs);
@@ -830,6 +1203,7 @@ void SecurityOrchestrator::tick(uint32_t nowMs) {
         buzzer_.alert();
         if (cfg_.keypad_lockout_ms > 0) {
           keypadLockoutUntilMs_ = nowMs + cfg_.keypad_lockout_ms;
+          clockWakeAt(keypadLockoutUntilMs_);
           lastKeypadLockoutNotifyMs_ = nowMs;
           notifySvc_.send("keypad lockout enabled");
           publishStateStatus("keypad_lockout_enabled");
@@ -845,6 +1219,7 @@ void SecurityOrchestrator::tick(uint32_t nowMs) {
           lastKeypadLockoutNotifyMs_ = nowMs;
           notifySvc_.send("door code accepted: unlock blocked (keypad lockout)");
         }
+        buzzer_.play(BuzzerPattern::lockout);
         mqttBus_.publishAck("door_code", false, "keypad lockout");
         publishStateStatus("keypad_unlock_reject_lockout");
         updateDoorUnlockSession(nowMs);
@@ -890,30 +1265,16 @@ void SecurityOrchestrator::tick(uint32_t nowMs) {
 
   const bool hasEvent = collector_.pollSensorOrSerial(nowMs, e);
   updateDoorUnlockSession(nowMs);
+  drainInjected(nowMs);
   if (!hasEvent) return;
+  if (isSensorEvent(e.type)) sampling_.noteActivity(nowMs);
 
-  if (isSerialSyntheticSource(e.src) && isModeEvent(e.type) && !cfg_.allow_serial_mode_commands) {
-    Serial.println("[SERIAL] mode blocked by policy");
-    publishStateStatus("serial_mode_blocked");
-    return;
-  }
-  if (isSerialSyntheticSource(e.src) && isManualActuatorEvent(e.type) && !cfg_.allow_serial_manual_commands) {
-    Serial.println("[SERIAL] manual actuator blocked by policy");
-    publishStateStatus("serial_manual_blocked");
-    return;
-  }
-  if (isSerialSyntheticSource(e.src) && isSerialSyntheticSensorEvent(e.type) && !cfg_.allow_serial_sensor_commands) {
-    Serial.println("[SERIAL] sensor event blocked by policy");
-    publishStateStatus("serial_sensor_blocked");
-    return;
-  }
-
-  if (processDoorHoldWarnSilenceEvent(e)) return;
-  if (processKeypadHelpRequestEvent(e)) return;
-  if (processManualActuatorEvent(e)) return;
-  if (isModeEvent(e.type)) {
-    processModeEvent(e, "SERIAL");
+  const char* blocked = serialPolicyBlock(e);
+  if (blocked) {
+    Serial.print("[SERIAL] blocked by policy: ");
+    Serial.println(blocked);
+    publishStateStatus(blocked);
     return;
   }
-  applyDecision(e);
+  dispatchEvent(e);
 }
@@ -5,17 +5,21 @@
 
 #include "actuators/Buzzer.h"
 #include "actuators/Servo.h"
+#include "app/BootProfile.h"
 #include "app/Config.h"
 #include "app/DoorUnlockSession.h"
 #include "app/Events.h"
 #include "app/HardwareConfig.h"
 #include "app/ReplayGuard.h"
 #include "app/RuleEngine.h"
+#include "app/SamplingPolicy.h"
 #include "app/SystemState.h"
+#include "app/WarmSnapshot.h"
 #include "pipelines/EventCollector.h"
 #include "pipelines/EventGate.h"
 #include "pipelines/TimeoutScheduler.h"
 #include "services/CommandDispatcher.h"
+#include "services/EventJournal.h"
 #include "services/Logger.h"
 #include "services/MqttBus.h"
 #include "services/Notify.h"
@@ -33,6 +37,8 @@ private:
   EventCollector collector_;
   TimeoutScheduler timeoutScheduler_;
   MqttBus mqttBus_;
+  EventJournal journal_;
+  BootProfile bootProfile_;
 
   Buzzer buzzer_{HwCfg::PIN_BUZZER, 0};
   Servo servo1_{HwCfg::PIN_SERVO1, 1, 1, 10, 90};
@@ -41,9 +47,27 @@ private:
   Notify notifySvc_;
   Actuators acts_{&buzzer_, &servo1_, &servo2_};
 
-  void applyDecision(const Event& e);
+  void applyDecision(const Event& e, bool trace = true);
+  // allow_serial_* policy: the status reason if a serial-injected event is refused.
+  const char* serialPolicyBlock(const Event& e) const;
+  void dispatchEvent(const Event& e, bool trace = true);
+  // Handles due events of binary injection frames, up to SERIAL_INJECT_BURST a tick.
+  void drainInjected(uint32_t nowMs);
   void printEventDecision(const Event& e, const Decision& d, const SystemState& prev) const;
+  // Result of one remote command; the caller publishes the ack and status.
+  struct RemoteOutcome {
+    const char* ackCmd = "unknown";
+    bool ok = false;
+    char detail[32] = {};
+    const char* statusReason = nullptr;
+  };
+  static constexpr uint8_t kRemoteBatchMax = 6;
+
   void processRemoteCommand(const String& payload);
+  void processRemoteBatch(const String& cmd, uint32_t nowMs);
+  bool validateRemoteBatch(const String* steps, uint8_t count, char* why, size_t whyLen) const;
+  void executeRemoteCommand(const String& cmd, uint32_t nowMs, RemoteOutcome& out);
+  void fillLockDetail(char* out, size_t outLen) const;
   bool processManualActuatorEvent(const Event& e);
   bool processDoorHoldWarnSilenceEvent(const Event& e);
   bool processKeypadHelpRequestEvent(const Event& e);
@@ -53,11 +77,27 @@ private:
   void startDoorUnlockSession(uint32_t nowMs);
   void clearDoorUnlockSession(bool stopBuzzer);
   void updateDoorUnlockSession(uint32_t nowMs);
+  void updateSampling(uint32_t nowMs);
   void restorePersistedMode();
+  bool restoreWarmSnapshot(uint32_t nowMs);
+  void saveWarmSnapshot();
   void persistModeIfChanged(Mode prevMode);
   void syncLiveSnapshot();
-  void publishStateStatus(const char* reason);
-  void publishStateEvent(const Event& e, const Command& cmd);
+  void publishStateStatus(const char* reason, const BootProfile* boot = nullptr);
+  void publishStateEvent(const Event& e, const Command& cmd, int16_t scoreDelta = 0);
+
+  // Runtime state mirrored to RTC memory so a watchdog/brownout reset resumes in place.
+  struct WarmState {
+    SystemState state;
+    DoorUnlockSession doorSession;
+    uint32_t keypadLockoutUntilMs;
+    uint32_t lastKeypadLockoutNotifyMs;
+    uint8_t badDoorCodeAttempts;
+  };
+  // RTC slow memory left out of startup init (RTC_NOINIT_ATTR), so it survives every
+  // reset but power-on; RTC_DATA_ATTR would be reloaded from the image on each reset.
+  static uint32_t warmWords_[WarmSnapshot::wordsFor(sizeof(WarmState))];
+  uint32_t warmSavedMs_ = 0;
 
   DoorUnlockSession doorSession_;
 
@@ -65,14 +105,17 @@ private:
   uint32_t keypadLockoutUntilMs_ = 0;
   uint32_t lastKeypadLockoutNotifyMs_ = 0;
 
+  bool deferStatus_ = false;
+
   bool servo1WasLocked_ = false;
   bool servo2WasLocked_ = false;
   uint32_t nextStatusHeartbeatMs_ = 0;
+  SamplingPolicy sampling_;
+  SamplingProfile samplingProfile_ = SamplingProfile::normal;
+  uint32_t nextSamplingReportMs_ = 0;
   ReplayGuard remoteNonceGuard_;
-  uint32_t nextSensorHealthCheckMs_ = 0;
   uint32_t lastSensorFaultNotifyMs_ = 0;
   bool sensorFaultActive_ = false;
-  String sensorFaultDetail_;
 
   Preferences noncePref_;
   bool noncePrefReady_ = false;
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <stdint.h>
+
+// Incremental sensor fault tracking, one bit per sensor slot.
+//
+// Sensors report level changes (PIR/vibration) or echo results (ultrasonic) as they
+// happen. poll() only examines the slots that have a deadline running (an active
+// level input or an echo sensor with a last-valid time), so an idle system costs a
+// couple of mask operations. Fault and recover edges come out of poll() one at a
+// time with the time the condition started or cleared.
+class SensorHealth {
+public:
+  static constexpr uint8_t kMaxSlots = 32;
+
+  struct Edge {
+    uint8_t slot = 0;
+    bool fault = false;
+    uint32_t atMs = 0;
+  };
+
+  // Level input: faults when active continuously for stuckMs (0 = never), but only
+  // after it has been seen inactive once (a floating/high input at boot is not "stuck").
+  bool addLevel(uint8_t slot, const char* name, uint32_t stuckMs) {
+    if (!add_(slot, name)) return false;
+    levelMask_ |= bit_(slot);
+    limitMs_[slot] = stuckMs;
+    return true;
+  }
+
+  // Echo sensor: faults after noEchoLimit consecutive misses (0 = off) or no valid echo
+  // for offlineMs (0 = off), once it has returned a valid echo at least once.
+  bool addEcho(uint8_t slot, const char* name, uint32_t offlineMs, uint16_t noEchoLimit) {
+    if (!add_(slot, name)) return false;
+    echoMask_ |= bit_(slot);
+    limitMs_[slot] = offlineMs;
+    noEchoLimit_[slot] = noEchoLimit;
+    return true;
+  }
+
+  void onLevel(uint8_t slot, bool active, uint32_t nowMs) {
+    if (!has_(levelMask_, slot)) return;
+    const uint32_t b = bit_(slot);
+    if (!active) {
+      active_ &= ~b;
+      seen_ |= b;
+      setFault_(slot, false, nowMs);
+      return;
+    }
+    if (!(active_ & b)) {
+      active_ |= b;
+      sinceMs_[slot] = nowMs;
+    }
+  }
+
+  void onEcho(uint8_t slot, bool valid, uint32_t nowMs) {
+    if (!has_(echoMask_, slot)) return;
+    const uint32_t b = bit_(slot);
+    if (valid) {
+      seen_ |= b;
+      noEcho_[slot] = 0;
+      sinceMs_[slot] = nowMs; // last valid echo
+      setFault_(slot, false, nowMs);
+      return;
+    }
+    if (noEcho_[slot] < 0xFFFFu) ++noEcho_[slot];
+    if ((seen_ & b) && noEchoLimit_[slot] != 0 && noEcho_[slot] >= noEchoLimit_[slot]) {
+      setFault_(slot, true, nowMs);
+    }
+  }
+
+  bool poll(uint32_t nowMs, Edge& out) {
+    // Deadlines: active level inputs and echo sensors that have seen a valid echo.
+    uint32_t pending = ((levelMask_ & active_) | echoMask_) & seen_ & ~fault_;
+    while (pending) {
+      const uint8_t s = lowest_(pending);
+      pending &= pending - 1u;
+      if (limitMs_[s] == 0) continue;
+      const uint32_t due = sinceMs_[s] + limitMs_[s];
+      if ((int32_t)(nowMs - due) >= 0) setFault_(s, true, due);
+    }
+
+    const uint32_t changed = fault_ ^ reported_;
+    if (!changed) return false;
+    const uint8_t s = lowest_(changed);
+    reported_ ^= bit_(s);
+    out.slot = s;
+    out.fault = (fault_ & bit_(s)) != 0;
+    out.atMs = edgeMs_[s];
+    return true;
+  }
+
+  // Faults as last returned by poll().
+  uint32_t faultMask() const { return reported_; }
+  uint32_t edgeMs(uint8_t slot) const { return (slot < kMaxSlots) ? edgeMs_[slot] : 0u; }
+  const char* name(uint8_t slot) const { return (slot < kMaxSlots && names_[slot]) ? names_[slot] : "?"; }
+  // Fault kind for messages: "stuck" (level inputs) or "offline" (echo sensors).
+  const char* label(uint8_t slot) const { return has_(echoMask_, slot) ? "offline" : "stuck"; }
+
+  // Forgets all faults (e.g. health checks disabled); poll() reports the recoveries.
+  // Deadlines and miss streaks restart from nowMs, so a sensor that is still silent
+  // faults again one full period later rather than on the next poll().
+  void clearFaults(uint32_t nowMs) {
+    uint32_t f = fault_;
+    while (f) {
+      const uint8_t s = lowest_(f);
+      f &= f - 1u;
+      setFault_(s, false, nowMs);
+    }
+    uint32_t all = levelMask_ | echoMask_;
+    while (all) {
+      const uint8_t s = lowest_(all);
+      all &= all - 1u;
+      sinceMs_[s] = nowMs;
+      noEcho_[s] = 0;
+    }
+  }
+
+private:
+  const char* names_[kMaxSlots] = {};
+  uint32_t limitMs_[kMaxSlots] = {};
+  uint32_t sinceMs_[kMaxSlots] = {};
+  uint32_t edgeMs_[kMaxSlots] = {};
+  uint16_t noEcho_[kMaxSlots] = {};
+  uint16_t noEchoLimit_[kMaxSlots] = {};
+
+  uint32_t levelMask_ = 0;
+  uint32_t echoMask_ = 0;
+  uint32_t active_ = 0;
+  uint32_t seen_ = 0;
+  uint32_t fault_ = 0;
+  uint32_t reported_ = 0;
+
+  static uint32_t bit_(uint8_t slot) { return (uint32_t)1u << slot; }
+  static bool has_(uint32_t mask, uint8_t slot) { return slot < kMaxSlots && (mask & bit_(slot)); }
+
+  static uint8_t lowest_(uint32_t mask) {
+    uint8_t s = 0;
+    while (!(mask & 1u)) {
+      mask >>= 1;
+      ++s;
+    }
+    return s;
+  }
+
+  bool add_(uint8_t slot, const char* name) {
+    if (slot >= kMaxSlots || ((levelMask_ | echoMask_) & bit_(slot))) return false;
+    names_[slot] = name;
+    return true;
+  }
+
+  void setFault_(uint8_t slot, bool fault, uint32_t atMs) {
+    const uint32_t b = bit_(slot);
+    if (((fault_ & b) != 0) == fault) return;
+    fault_ ^= b;
+    edgeMs_[slot] = atMs;
+  }
+};
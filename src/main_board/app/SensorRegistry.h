@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Events.h"
+
+// Table-driven sensor wiring. HardwareConfig.h lists every sensor as a constexpr
+// SensorDef row; the collector builds its polling state from that table, and the
+// row index is the sensor's slot (health bit, bank bit).
+enum class SensorKind : uint8_t {
+  door_contact,
+  window_contact,
+  pir,
+  vibration,
+  ultrasonic
+};
+
+struct SensorDef {
+  SensorKind kind;
+  uint8_t id;        // Event::src
+  uint8_t pin;       // input pin (echo pin for ultrasonic)
+  uint8_t trigPin;   // ultrasonic trigger; unused otherwise
+  SensorZone zone;
+  uint16_t holdMs;   // debounce (contacts) or re-fire cooldown (others)
+  const char* name;
+};
+
+namespace SensorRegistry {
+
+constexpr uint8_t kMaxSensors = 32;
+
+inline EventType eventFor(SensorKind k) {
+  switch (k) {
+    case SensorKind::door_contact: return EventType::door_open;
+    case SensorKind::window_contact: return EventType::window_open;
+    case SensorKind::pir: return EventType::motion;
+    case SensorKind::vibration: return EventType::vib_spike;
+    case SensorKind::ultrasonic:
+    default: return EventType::chokepoint;
+  }
+}
+
+// Digital inputs polled by level; ultrasonic rangers are sampled separately.
+inline bool isLevelInput(SensorKind k) {
+  return k != SensorKind::ultrasonic;
+}
+
+// Serial test sources stand in for real sensors (201 = PIR 1, 211 = ultrasonic 1).
+inline uint8_t physicalId(EventType t, uint8_t src) {
+  if (t == EventType::motion && src > kSerialSyntheticSrcGeneric && src <= kSerialSyntheticSrcPir3) {
+    return (uint8_t)(src - kSerialSyntheticSrcGeneric);
+  }
+  if (t == EventType::chokepoint && src >= kSerialSyntheticSrcUs1 && src <= kSerialSyntheticSrcUs3) {
+    return (uint8_t)(src - kSerialSyntheticSrcUs1 + 1);
+  }
+  return src;
+}
+
+inline SensorZone zoneOf(const SensorDef* defs, uint8_t count, EventType t, uint8_t src) {
+  const uint8_t id = physicalId(t, src);
+  for (uint8_t i = 0; i < count; ++i) {
+    if (eventFor(defs[i].kind) == t && defs[i].id == id) return defs[i].zone;
+  }
+  return SensorZone::none;
+}
+
+} // namespace SensorRegistry
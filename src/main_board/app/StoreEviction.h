@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "app/PublishLanes.h"
+
+// Eviction policy for a full offline-store partition. Entries are scored by kind, age
+// and supersession, and the least valuable one makes room for a new message:
+// superseded statuses go first, then stale telemetry, oldest first. Command acks
+// are retained: they are never evicted, a new one is refused instead. Alarm events
+// are ranked among themselves and a new alarm is never refused: a sustained alarm
+// echoes every event at alert level into the critical lane, and those echoes give
+// way first, oldest first, so a later burglary or tamper still gets through.
+namespace StoreEviction {
+
+// Why a critical-lane event is an alarm, least important first.
+enum class AlarmKind : uint8_t {
+  echo,          // only the state was at alert level
+  alert,         // carried the alert buzzer command
+  tamper_or_help // door tamper or keypad help request
+};
+
+struct Candidate {
+  PublishLane lane = PublishLane::event;
+  uint32_t ageMs = 0;
+  bool superseded = false; // a newer message carries the same information
+  AlarmKind alarm = AlarmKind::echo; // critical lane only
+};
+
+constexpr uint32_t kRetained = 0xFFFFFFFFu;
+
+// Value of an entry: a per-kind base that halves after one half-life of age, a third
+// after two, and so on, so an older entry of a kind is always worth less than a newer
+// one.
+inline uint32_t value(const Candidate& c) {
+  uint32_t base = 0;
+  uint32_t halfLifeMs = 0;
+  switch (c.lane) {
+    case PublishLane::critical: {
+      // Above every other kind and tiered by alarm kind; the age term (at most 1 << 24)
+      // only orders entries within a tier.
+      const uint32_t halfLife = 3600000u;
+      const uint32_t decayed = (uint32_t)((uint64_t)(1u << 24) * halfLife / ((uint64_t)halfLife + c.ageMs));
+      return (1u << 28) + ((uint32_t)c.alarm << 25) + decayed;
+    }
+    case PublishLane::ack:
+      return kRetained;
+    case PublishLane::event:
+      base = 1u << 20;
+      halfLifeMs = 3600000u;
+      break;
+    case PublishLane::status:
+      base = 1u << 16;
+      halfLifeMs = 600000u;
+      break;
+    case PublishLane::metrics:
+    default:
+      base = 1u << 12;
+      halfLifeMs = 60000u;
+      break;
+  }
+  if (c.superseded) return 0;
+  return (uint32_t)((uint64_t)base * halfLifeMs / ((uint64_t)halfLifeMs + c.ageMs));
+}
+
+// A new alarm (other than an echo) always gets a slot, at the cost of the least
+// valuable alarm already waiting.
+inline bool alwaysAdmit(const Candidate& c) {
+  return c.lane == PublishLane::critical && c.alarm != AlarmKind::echo;
+}
+
+// Picks the entry in [first, count) to evict for `incoming`: the least valuable one,
+// the oldest on a tie. Returns -1 if nothing is worth less than the incoming message
+// (and it is not alwaysAdmit()), which is then the one refused. at(i) returns the
+// Candidate for position i.
+template <typename CandidateAt>
+inline int32_t pickVictim(uint32_t first, uint32_t count, CandidateAt at, const Candidate& incoming) {
+  int32_t victim = -1;
+  uint32_t best = alwaysAdmit(incoming) ? kRetained : value(incoming);
+  uint32_t bestAge = 0;
+  for (uint32_t i = first; i < count; ++i) {
+    const Candidate c = at(i);
+    const uint32_t v = value(c);
+    if (v < best || (victim >= 0 && v == best && c.ageMs > bestAge)) {
+      victim = (int32_t)i;
+      best = v;
+      bestAge = c.ageMs;
+    }
+  }
+  return victim;
+}
+
+// Closes the gap left by evicting queue position pos from a ring of `cap` slots.
+template <typename T>
+inline void removeAt(T* ring, uint32_t cap, uint32_t head, uint32_t count, uint32_t pos) {
+  for (uint32_t n = pos; n + 1 < count; ++n) ring[(head + n) % cap] = ring[(head + n + 1) % cap];
+}
+
+} // namespace StoreEviction
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+// Groups the pulse trains of the vibration switches into hits. A hit starts with the
+// first pulse and ends after kQuietMs without one, or after maxHitMs of continuous
+// shaking (so a sustained impact reports at most once per maxHitMs). Its intensity is
+// the number of pulses it contained.
+class VibrationBurst {
+public:
+  static constexpr uint32_t kQuietMs = 100;
+
+  struct Hit {
+    uint32_t startMs = 0;
+    uint32_t durationMs = 0;
+    uint32_t pulses = 0;
+
+    uint8_t intensity() const { return (uint8_t)(pulses > 255u ? 255u : pulses); }
+  };
+
+  // pulses: counted since the previous call.
+  void feed(uint32_t pulses, uint32_t nowMs, uint32_t maxHitMs) {
+    if (pulses) {
+      if (!active_) {
+        active_ = true;
+        cur_ = Hit();
+        cur_.startMs = nowMs;
+      }
+      cur_.pulses += pulses;
+      lastPulseMs_ = nowMs;
+    }
+    if (!active_) return;
+    const bool quiet = (nowMs - lastPulseMs_) >= kQuietMs;
+    const bool tooLong = (nowMs - cur_.startMs) >= maxHitMs;
+    if (!quiet && !tooLong) return;
+
+    cur_.durationMs = lastPulseMs_ - cur_.startMs;
+    active_ = false;
+    // Not yet collected: fold into the waiting hit rather than lose it.
+    if (ready_) {
+      ready_hit_.pulses += cur_.pulses;
+      ready_hit_.durationMs = lastPulseMs_ - ready_hit_.startMs;
+    } else {
+      ready_hit_ = cur_;
+      ready_ = true;
+    }
+  }
+
+  // The finished hit, once; it stays queued until taken.
+  bool take(Hit& out) {
+    if (!ready_) return false;
+    out = ready_hit_;
+    ready_ = false;
+    return true;
+  }
+
+  bool active() const { return active_; }
+
+private:
+  Hit cur_;
+  Hit ready_hit_;
+  bool active_ = false;
+  bool ready_ = false;
+  uint32_t lastPulseMs_ = 0;
+};
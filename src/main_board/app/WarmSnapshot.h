@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "app/SystemState.h"
+
+// Checksummed frame for a runtime snapshot kept in RTC slow memory across warm resets
+// (watchdog, panic, brownout, software restart). The buffer must be RTC_NOINIT_ATTR:
+// only that section is left alone by the startup code on a reset. After power-on it
+// holds garbage, so an unset magic or a CRC mismatch simply means "cold boot".
+//
+// millis() restarts from zero after any reset; restored timestamps are rebased by
+// (now - takenMs) so remaining windows/deadlines resume where the snapshot left them.
+// The moment of the reset itself is unknown, so the owner re-seals at least every
+// kRefreshMs: whatever ran between the last seal and the reset is granted again, and
+// that must stay small or repeated resets keep a countdown from ever expiring.
+namespace WarmSnapshot {
+
+constexpr uint32_t kMagic = 0x314D5257u; // "WRM1"
+constexpr uint32_t kRefreshMs = 100;
+
+struct Header {
+  uint32_t magic;
+  uint32_t len;
+  uint32_t takenMs;
+  uint32_t crc;
+};
+
+constexpr size_t wordsFor(size_t payloadBytes) {
+  return (sizeof(Header) + payloadBytes + 3u) / 4u;
+}
+
+static inline uint32_t crc32(const void* data, size_t len, uint32_t crc = 0) {
+  const uint8_t* p = (const uint8_t*)data;
+  crc = ~crc;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= p[i];
+    for (uint8_t b = 0; b < 8; ++b) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+static inline uint32_t frameCrc_(const Header& h, const uint8_t* payload) {
+  uint32_t crc = crc32(&h, offsetof(Header, crc));
+  return crc32(payload, h.len, crc);
+}
+
+static inline bool seal(uint32_t* words, size_t wordCount, const void* payload, size_t len, uint32_t takenMs) {
+  if (wordsFor(len) > wordCount) return false;
+  uint8_t* base = (uint8_t*)words;
+  memcpy(base + sizeof(Header), payload, len);
+
+  Header h;
+  h.magic = kMagic;
+  h.len = (uint32_t)len;
+  h.takenMs = takenMs;
+  h.crc = frameCrc_(h, base + sizeof(Header));
+  memcpy(base, &h, sizeof(h));
+  return true;
+}
+
+static inline bool open(const uint32_t* words, size_t wordCount, void* payload, size_t len, uint32_t& takenMs) {
+  if (wordsFor(len) > wordCount) return false;
+  const uint8_t* base = (const uint8_t*)words;
+  Header h;
+  memcpy(&h, base, sizeof(h));
+  if (h.magic != kMagic || h.len != len) return false;
+  if (frameCrc_(h, base + sizeof(Header)) != h.crc) return false;
+
+  memcpy(payload, base + sizeof(Header), len);
+  takenMs = h.takenMs;
+  return true;
+}
+
+static inline bool refreshDue(uint32_t nowMs, uint32_t takenMs) {
+  return (uint32_t)(nowMs - takenMs) >= kRefreshMs;
+}
+
+static inline void invalidate(uint32_t* words) {
+  words[0] = 0;
+}
+
+// 0 means "unset" for every timestamp in this codebase; keep it that way.
+static inline uint32_t rebase(uint32_t ts, uint32_t deltaMs) {
+  return (ts == 0) ? 0u : (uint32_t)(ts + deltaMs);
+}
+
+static inline void rebaseState(SystemState& st, uint32_t deltaMs) {
+  st.last_notify_ms = rebase(st.last_notify_ms, deltaMs);
+  st.last_indoor_activity_ms = rebase(st.last_indoor_activity_ms, deltaMs);
+  st.entry_deadline_ms = rebase(st.entry_deadline_ms, deltaMs);
+  st.last_suspicion_update_ms = rebase(st.last_suspicion_update_ms, deltaMs);
+  st.last_outdoor_motion_ms = rebase(st.last_outdoor_motion_ms, deltaMs);
+  st.last_window_event_ms = rebase(st.last_window_event_ms, deltaMs);
+  st.last_vibration_ms = rebase(st.last_vibration_ms, deltaMs);
+  st.last_door_event_ms = rebase(st.last_door_event_ms, deltaMs);
+}
+
+static inline bool plausible(const SystemState& st) {
+  return (uint8_t)st.mode <= (uint8_t)Mode::away &&
+         (uint8_t)st.level <= (uint8_t)AlarmLevel::alert &&
+         st.suspicion_score <= 100;
+}
+
+} // namespace WarmSnapshot
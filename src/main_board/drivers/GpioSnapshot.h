@@ -0,0 +1,15 @@
+#pragma once
+#include <Arduino.h>
+#include <soc/gpio_reg.h>
+
+// Every GPIO input level in one go: GPIO_IN_REG holds GPIO0-31, the low byte of
+// GPIO_IN1_REG holds GPIO32-39. Two register loads replace a digitalRead() per pin.
+namespace GpioSnapshot {
+
+inline uint64_t read() {
+  const uint32_t lo = REG_READ(GPIO_IN_REG);
+  const uint32_t hi = REG_READ(GPIO_IN1_REG) & 0xFFu;
+  return ((uint64_t)hi << 32) | lo;
+}
+
+} // namespace GpioSnapshot
@@ -5,9 +5,9 @@ constexpr uint8_t ROW_MASK = 0x0F; // P0..P3
 constexpr uint8_t COL_MASK = 0xF0; // P4..P7
 }
 
-I2CKeypadDriver::I2CKeypadDriver(TwoWire* wire, uint8_t addr7,
+I2CKeypadDriver::I2CKeypadDriver(I2cBus* bus, uint8_t addr7,
                                  const char* keymap, uint32_t debounce_ms)
-: wire_(wire),
+: bus_(bus),
   addr7_(addr7),
   keymap_(keymap),
   debounce_ms_(debounce_ms),
@@ -15,38 +15,69 @@ I2CKeypadDriver::I2CKeypadDriver(TwoWire* wire, uint8_t addr7,
   waitingRelease_(false),
   lastKey_(0),
   lastKeyMs_(0),
-  shadow_(0xFF) {}
+  shadow_(0xFF),
+  idleCols_(COL_MASK) {}
 
 bool I2CKeypadDriver::writePort_(uint8_t value) {
-  if (!wire_) return false;
-  wire_->beginTransmission(addr7_);
-  wire_->write(value);
-  return wire_->endTransmission() == 0;
+  if (!bus_) return false;
+  I2cBus::Batch b(addr7_);
+  b.write1(value);
+  return bus_->run(b, I2cBus::Priority::input);
 }
 
-int I2CKeypadDriver::readColPressed_() {
-  if (!wire_) return -1;
-  int n = wire_->requestFrom((int)addr7_, 1);
-  if (n != 1) return -1;
-  uint8_t v = (uint8_t)wire_->read();
-
+int I2CKeypadDriver::colPressed_(uint8_t port) {
   for (uint8_t c = 0; c < 4; c++) {
     uint8_t bit = (uint8_t)(1u << (4u + c));
-    if ((v & bit) == 0) return (int)c;
+    if ((port & bit) == 0) return (int)c;
   }
   return -1;
 }
 
-bool I2CKeypadDriver::setAllRowsHigh_() {
+uint8_t I2CKeypadDriver::allRowsHighValue_() {
   shadow_ = (uint8_t)((shadow_ & (uint8_t)~ROW_MASK) | ROW_MASK);
-  return writePort_(shadow_);
+  return shadow_;
 }
 
-bool I2CKeypadDriver::setRowActive_(uint8_t r) {
-  if (r >= 4) return false;
-  shadow_ = (uint8_t)((shadow_ & (uint8_t)~ROW_MASK) | ROW_MASK);
-  shadow_ = (uint8_t)(shadow_ & (uint8_t)~(1u << r));
-  return writePort_(shadow_);
+uint8_t I2CKeypadDriver::rowActiveValue_(uint8_t r) {
+  const uint8_t high = (uint8_t)((shadow_ & (uint8_t)~ROW_MASK) | ROW_MASK);
+  return (uint8_t)(high & (uint8_t)~(1u << r));
+}
+
+uint8_t I2CKeypadDriver::allRowsLowValue_() {
+  shadow_ = (uint8_t)(shadow_ & (uint8_t)~ROW_MASK);
+  return shadow_;
+}
+
+// Drive one row low, sample the columns, release the row: one bus grant.
+bool I2CKeypadDriver::probeRow_(uint8_t r, int& col) {
+  col = -1;
+  if (!bus_ || r >= 4) return false;
+  uint8_t port = 0xFF;
+  I2cBus::Batch b(addr7_);
+  b.write1(rowActiveValue_(r));
+  b.read(&port, 1);
+  b.write1(allRowsHighValue_());
+  if (!bus_->run(b, I2cBus::Priority::input)) return false;
+  col = colPressed_(port);
+  return true;
+}
+
+// All four rows in one grant instead of up to four separate ones.
+bool I2CKeypadDriver::anyKeyDown_(bool& down) {
+  down = false;
+  if (!bus_) return false;
+  uint8_t ports[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+  I2cBus::Batch b(addr7_);
+  for (uint8_t r = 0; r < 4; r++) {
+    b.write1(rowActiveValue_(r));
+    b.read(&ports[r], 1);
+  }
+  b.write1(allRowsHighValue_());
+  if (!bus_->run(b, I2cBus::Priority::input)) return false;
+  for (uint8_t r = 0; r < 4; r++) {
+    if (colPressed_(ports[r]) >= 0) down = true;
+  }
+  return true;
 }
 
 char I2CKeypadDriver::mapKey_(uint8_t r, uint8_t c) const {
@@ -59,27 +90,23 @@ bool I2CKeypadDriver::begin() {
   lastKey_ = 0;
   lastKeyMs_ = 0;
   shadow_ = 0xFF;
-  return setAllRowsHigh_();
+  return writePort_(allRowsHighValue_());
 }
 
 char I2CKeypadDriver::update(uint32_t nowMs) {
   if (waitingRelease_) {
     bool anyDown = false;
-    for (uint8_t r = 0; r < 4; r++) {
-      if (!setRowActive_(r)) return 0;
-      if (readColPressed_() >= 0) {
-        anyDown = true;
-        break;
-      }
-    }
-    setAllRowsHigh_();
+    ++busReads_;
+    if (!anyKeyDown_(anyDown)) return 0;
     if (!anyDown) waitingRelease_ = false;
     return 0;
   }
 
-  if (!setRowActive_(scanRow_)) return 0;
-  int col = readColPressed_();
-  setAllRowsHigh_();
+  if (scanRow_ == 0 && scanGapMs_ != 0 && (int32_t)(nowMs - nextScanMs_) < 0) return 0;
+
+  int col = -1;
+  ++busReads_;
+  if (!probeRow_(scanRow_, col)) return 0;
 
   if (col >= 0) {
     char k = mapKey_(scanRow_, (uint8_t)col);
@@ -92,5 +119,72 @@ char I2CKeypadDriver::update(uint32_t nowMs) {
   }
 
   scanRow_ = (uint8_t)((scanRow_ + 1u) & 0x03u);
+  if (scanRow_ == 0) nextScanMs_ = nowMs + scanGapMs_;
+  return 0;
+}
+
+bool I2CKeypadDriver::beginIdleLow() {
+  scanRow_ = 0;
+  waitingRelease_ = false;
+  lastKey_ = 0;
+  lastKeyMs_ = 0;
+  shadow_ = 0xFF;
+  idleCols_ = COL_MASK;
+  if (!bus_) return false;
+
+  // Reading back the port also clears any INT left pending from boot.
+  uint8_t port = 0xFF;
+  I2cBus::Batch b(addr7_);
+  b.write1(allRowsLowValue_());
+  b.read(&port, 1);
+  if (!bus_->run(b, I2cBus::Priority::input)) return false;
+  idleCols_ = (uint8_t)(port & COL_MASK);
+  return true;
+}
+
+char I2CKeypadDriver::service(uint32_t edgeMs, bool edge) {
+  if (!bus_) return 0;
+
+  if (!edge) {
+    uint8_t port = 0xFF;
+    I2cBus::Batch probe(addr7_);
+    probe.read(&port, 1);
+    if (!bus_->run(probe, I2cBus::Priority::input)) return 0;
+    if ((uint8_t)(port & COL_MASK) == idleCols_) return 0;
+  }
+
+  // Full scan, then back to rows-low idle; the trailing read re-arms INT.
+  uint8_t ports[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+  uint8_t idle = 0xFF;
+  I2cBus::Batch b(addr7_);
+  for (uint8_t r = 0; r < 4; r++) {
+    b.write1(rowActiveValue_(r));
+    b.read(&ports[r], 1);
+  }
+  b.write1(allRowsLowValue_());
+  b.read(&idle, 1);
+  if (!bus_->run(b, I2cBus::Priority::input)) return 0;
+  idleCols_ = (uint8_t)(idle & COL_MASK);
+
+  int row = -1;
+  int col = -1;
+  for (uint8_t r = 0; r < 4 && row < 0; r++) {
+    col = colPressed_(ports[r]);
+    if (col >= 0) row = r;
+  }
+
+  if (row < 0) {
+    waitingRelease_ = false;
+    return 0;
+  }
+  if (waitingRelease_) return 0;
+
+  const char k = mapKey_((uint8_t)row, (uint8_t)col);
+  if ((edgeMs - lastKeyMs_) >= debounce_ms_ || k != lastKey_) {
+    lastKey_ = k;
+    lastKeyMs_ = edgeMs;
+    waitingRelease_ = true;
+    return k;
+  }
   return 0;
 }
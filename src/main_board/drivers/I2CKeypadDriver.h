@@ -1,19 +1,32 @@
 #pragma once
 #include <Arduino.h>
-#include <Wire.h>
+
+#include "drivers/I2cBus.h"
 
 class I2CKeypadDriver {
 public:
   // PCF8574 mapping:
   // P0..P3 -> rows, P4..P7 -> cols
-  I2CKeypadDriver(TwoWire* wire, uint8_t addr7,
+  I2CKeypadDriver(I2cBus* bus, uint8_t addr7,
                   const char* keymap, uint32_t debounce_ms = 60);
 
   bool begin();
+  // Polling mode: probes one row per call. After a full scan finds nothing, the next
+  // one starts gapMs later (0 = scan continuously); a held key is tracked every call.
   char update(uint32_t nowMs);
+  void setScanGapMs(uint16_t gapMs) { scanGapMs_ = gapMs; }
+  // Bus transactions issued by update() so far.
+  uint32_t busReads() const { return busReads_; }
+
+  // Interrupt mode (PCF8574 INT wired): rows idle low, so any press or release
+  // changes a column input and asserts INT. Call service() after each INT edge
+  // (edge=true) or periodically as a backstop (edge=false: one read, full scan
+  // only if the columns changed). Returns a key on press.
+  bool beginIdleLow();
+  char service(uint32_t edgeMs, bool edge);
 
 private:
-  TwoWire* wire_;
+  I2cBus* bus_;
   uint8_t addr7_;
   const char* keymap_;
   uint32_t debounce_ms_;
@@ -23,10 +36,17 @@ private:
   char lastKey_;
   uint32_t lastKeyMs_;
   uint8_t shadow_;
+  uint8_t idleCols_;
+  uint16_t scanGapMs_ = 0;
+  uint32_t nextScanMs_ = 0;
+  uint32_t busReads_ = 0;
 
   bool writePort_(uint8_t value);
-  int readColPressed_();
-  bool setRowActive_(uint8_t r);
-  bool setAllRowsHigh_();
+  bool probeRow_(uint8_t r, int& col);
+  bool anyKeyDown_(bool& down);
+  uint8_t rowActiveValue_(uint8_t r);
+  uint8_t allRowsHighValue_();
+  uint8_t allRowsLowValue_();
+  static int colPressed_(uint8_t port);
   char mapKey_(uint8_t r, uint8_t c) const;
 };
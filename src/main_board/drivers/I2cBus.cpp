@@ -0,0 +1,190 @@
+#include "I2cBus.h"
+
+#include "app/Clock.h"
+
+namespace {
+constexpr uint16_t kTimeoutMs = 20;        // per transaction; a stuck slave fails fast
+constexpr uint8_t kRecoverAfterErrors = 3; // consecutive failures before a bus reset
+constexpr uint8_t kRecoverPulses = 9;
+constexpr uint32_t kHalfClockUs = 5;       // ~100 kHz bit-bang during recovery
+} // namespace
+
+bool I2cBus::Batch::write(const uint8_t* data, uint8_t len, int16_t prefix) {
+  if (count_ >= kMaxOps) return false;
+  if (!data && len != 0) return false;
+  Op& op = ops_[count_++];
+  op.isRead = false;
+  op.prefix = prefix;
+  op.len = len;
+  op.inlineByte = 0;
+  op.tx = data;
+  op.rx = nullptr;
+  return true;
+}
+
+bool I2cBus::Batch::write1(uint8_t value) {
+  if (count_ >= kMaxOps) return false;
+  Op& op = ops_[count_++];
+  op.isRead = false;
+  op.prefix = -1;
+  op.len = 1;
+  op.inlineByte = value;
+  op.tx = nullptr; // use inlineByte
+  op.rx = nullptr;
+  return true;
+}
+
+bool I2cBus::Batch::read(uint8_t* out, uint8_t len) {
+  if (count_ >= kMaxOps || !out || len == 0) return false;
+  Op& op = ops_[count_++];
+  op.isRead = true;
+  op.prefix = -1;
+  op.len = len;
+  op.inlineByte = 0;
+  op.tx = nullptr;
+  op.rx = out;
+  return true;
+}
+
+I2cBus::I2cBus(TwoWire* wire, uint8_t sda, uint8_t scl, uint32_t hz)
+: wire_(wire),
+  sda_(sda),
+  scl_(scl),
+  hz_(hz) {}
+
+bool I2cBus::begin() {
+  if (!wire_) return false;
+  if (!mutex_) mutex_ = xSemaphoreCreateMutex();
+  if (!mutex_) return false;
+  if (!wire_->begin(sda_, scl_, hz_)) return false;
+  wire_->setTimeOut(kTimeoutMs);
+  windowStartUs_ = clockUs();
+  return true;
+}
+
+bool I2cBus::lock(Priority prio) {
+  if (!mutex_) return false;
+  if (prio == Priority::input) {
+    ++inputWaiting_;
+    const bool ok = xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE;
+    --inputWaiting_;
+    return ok;
+  }
+
+  // UI work yields to pending keypad scans; it only needs "soon", not "now".
+  while (inputWaiting_ != 0) vTaskDelay(1);
+  return xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE;
+}
+
+void I2cBus::unlock() {
+  if (mutex_) xSemaphoreGive(mutex_);
+}
+
+bool I2cBus::runOp_(uint8_t addr7, const Batch::Op& op) {
+  if (op.isRead) {
+    const uint8_t n = wire_->requestFrom(addr7, op.len);
+    if (n != op.len) return false;
+    for (uint8_t i = 0; i < n; ++i) op.rx[i] = (uint8_t)wire_->read();
+    return true;
+  }
+
+  wire_->beginTransmission(addr7);
+  if (op.prefix >= 0) wire_->write((uint8_t)op.prefix);
+  if (op.tx) {
+    wire_->write(op.tx, op.len);
+  } else if (op.len != 0) {
+    wire_->write(op.inlineByte);
+  }
+  return wire_->endTransmission() == 0;
+}
+
+bool I2cBus::run(Batch& batch, Priority prio) {
+  if (!lock(prio)) return false;
+
+  const uint32_t startUs = clockUs();
+  bool ok = true;
+  for (uint8_t i = 0; i < batch.count_ && ok; ++i) {
+    ok = runOp_(batch.addr7_, batch.ops_[i]);
+  }
+
+  if (ok) {
+    consecutiveErrors_ = 0;
+  } else if (++consecutiveErrors_ >= kRecoverAfterErrors) {
+    recover_();
+    consecutiveErrors_ = 0;
+  }
+  account_(batch.addr7_, ok, clockUs() - startUs);
+
+  unlock();
+  batch.count_ = 0;
+  return ok;
+}
+
+void I2cBus::account_(uint8_t addr7, bool ok, uint32_t busyUs) {
+  portENTER_CRITICAL(&statsMux_);
+  busyUs_ += busyUs;
+  DeviceStats* d = nullptr;
+  for (uint8_t i = 0; i < devCount_; ++i) {
+    if (dev_[i].addr == addr7) {
+      d = &dev_[i];
+      break;
+    }
+  }
+  if (!d && devCount_ < kMaxDevices) {
+    d = &dev_[devCount_++];
+    d->addr = addr7;
+  }
+  if (d) {
+    ++d->txns;
+    if (!ok) ++d->errors;
+  }
+  portEXIT_CRITICAL(&statsMux_);
+}
+
+// A slave that was mid-byte when the master timed out can hold SDA low forever.
+// Clocking SCL until it releases SDA, then issuing STOP, frees the bus.
+void I2cBus::recover_() {
+  wire_->end();
+
+  pinMode(sda_, INPUT_PULLUP);
+  pinMode(scl_, OUTPUT_OPEN_DRAIN);
+  for (uint8_t i = 0; i < kRecoverPulses && digitalRead(sda_) == LOW; ++i) {
+    digitalWrite(scl_, LOW);
+    delayMicroseconds(kHalfClockUs);
+    digitalWrite(scl_, HIGH);
+    delayMicroseconds(kHalfClockUs);
+  }
+
+  pinMode(sda_, OUTPUT_OPEN_DRAIN);
+  digitalWrite(sda_, LOW);
+  delayMicroseconds(kHalfClockUs);
+  digitalWrite(scl_, HIGH);
+  delayMicroseconds(kHalfClockUs);
+  digitalWrite(sda_, HIGH); // STOP
+  delayMicroseconds(kHalfClockUs);
+
+  wire_->begin(sda_, scl_, hz_);
+  wire_->setTimeOut(kTimeoutMs);
+
+  portENTER_CRITICAL(&statsMux_);
+  ++recoveries_;
+  portEXIT_CRITICAL(&statsMux_);
+  Serial.println("[I2C] WARN: bus recovered after repeated errors");
+}
+
+I2cBus::Stats I2cBus::stats(uint32_t nowUs) {
+  Stats s;
+  portENTER_CRITICAL(&statsMux_);
+  for (uint8_t i = 0; i < devCount_; ++i) s.dev[i] = dev_[i];
+  s.devCount = devCount_;
+  s.recoveries = recoveries_;
+  const uint32_t windowUs = nowUs - windowStartUs_;
+  if (windowUs != 0) {
+    const uint64_t pct = ((uint64_t)busyUs_ * 100u) / windowUs;
+    s.utilPct = (uint8_t)(pct > 100u ? 100u : pct);
+  }
+  busyUs_ = 0;
+  windowStartUs_ = nowUs;
+  portEXIT_CRITICAL(&statsMux_);
+  return s;
+}
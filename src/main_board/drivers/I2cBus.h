@@ -0,0 +1,95 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Owner of the shared I2C bus (keypad expander + OLED).
+//
+// Callers describe a short run of operations on one device as a Batch; run() executes
+// it back to back under a single bus grant. Grants are priority ordered: while an
+// input-priority caller is waiting, UI-priority callers hold off.
+// Repeated failures trigger a bus recovery (9 SCL pulses + STOP, then re-init).
+class I2cBus {
+public:
+  enum class Priority : uint8_t { ui = 0, input = 1 };
+
+  static constexpr uint8_t kMaxDevices = 4;
+  static constexpr uint8_t kMaxOps = 10;
+
+  class Batch {
+  public:
+    explicit Batch(uint8_t addr7) : addr7_(addr7) {}
+
+    // Data must stay valid until run() returns. prefix >= 0 is sent before data
+    // (register/control byte) in the same transmission.
+    bool write(const uint8_t* data, uint8_t len, int16_t prefix = -1);
+    bool write1(uint8_t value);
+    bool read(uint8_t* out, uint8_t len);
+
+    uint8_t addr() const { return addr7_; }
+    uint8_t size() const { return count_; }
+
+  private:
+    friend class I2cBus;
+    struct Op {
+      bool isRead;
+      int16_t prefix;
+      uint8_t len;
+      uint8_t inlineByte;
+      const uint8_t* tx;
+      uint8_t* rx;
+    };
+    uint8_t addr7_;
+    uint8_t count_ = 0;
+    Op ops_[kMaxOps];
+  };
+
+  struct DeviceStats {
+    uint8_t addr = 0;
+    uint32_t txns = 0;
+    uint32_t errors = 0;
+  };
+
+  struct Stats {
+    DeviceStats dev[kMaxDevices];
+    uint8_t devCount = 0;
+    uint32_t recoveries = 0;
+    uint8_t utilPct = 0; // busy time since the previous stats() call
+  };
+
+  I2cBus(TwoWire* wire, uint8_t sda, uint8_t scl, uint32_t hz = 100000);
+
+  bool begin();
+  // Runs every op in order; stops at the first failure. Returns true if all succeeded.
+  bool run(Batch& batch, Priority prio);
+
+  // Raw grant for third-party drivers that talk to TwoWire directly (Adafruit SSD1306).
+  bool lock(Priority prio);
+  void unlock();
+  TwoWire* wire() const { return wire_; }
+
+  Stats stats(uint32_t nowUs);
+
+private:
+  TwoWire* wire_;
+  uint8_t sda_;
+  uint8_t scl_;
+  uint32_t hz_;
+
+  SemaphoreHandle_t mutex_ = nullptr;
+  volatile uint8_t inputWaiting_ = 0;
+
+  portMUX_TYPE statsMux_ = portMUX_INITIALIZER_UNLOCKED;
+  DeviceStats dev_[kMaxDevices];
+  uint8_t devCount_ = 0;
+  uint32_t recoveries_ = 0;
+  uint32_t busyUs_ = 0;
+  uint32_t windowStartUs_ = 0;
+  uint8_t consecutiveErrors_ = 0;
+
+  bool runOp_(uint8_t addr7, const Batch::Op& op);
+  void account_(uint8_t addr7, bool ok, uint32_t busyUs);
+  void recover_();
+};
@@ -0,0 +1,49 @@
+#include "PulseCounter.h"
+
+#include <driver/pcnt.h>
+
+namespace {
+// The unit wraps to 0 here; take() is called far more often than 32767 pulses arrive.
+constexpr int16_t kHighLimit = 32767;
+} // namespace
+
+bool PulseCounter::begin(uint8_t pin, uint8_t unit, uint16_t glitchCycles) {
+  ready_ = false;
+  if (unit >= PCNT_UNIT_MAX) return false;
+  unit_ = unit;
+  const pcnt_unit_t u = (pcnt_unit_t)unit;
+
+  pcnt_config_t cfg = {};
+  cfg.pulse_gpio_num = pin;
+  cfg.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  cfg.lctrl_mode = PCNT_MODE_KEEP;
+  cfg.hctrl_mode = PCNT_MODE_KEEP;
+  cfg.pos_mode = PCNT_COUNT_INC;
+  cfg.neg_mode = PCNT_COUNT_DIS;
+  cfg.counter_h_lim = kHighLimit;
+  cfg.counter_l_lim = 0;
+  cfg.unit = u;
+  cfg.channel = PCNT_CHANNEL_0;
+  if (pcnt_unit_config(&cfg) != ESP_OK) return false;
+
+  pcnt_set_filter_value(u, glitchCycles > 1023 ? 1023 : glitchCycles);
+  pcnt_filter_enable(u);
+  pcnt_counter_pause(u);
+  pcnt_counter_clear(u);
+  pcnt_counter_resume(u);
+  last_ = 0;
+  total_ = 0;
+  ready_ = true;
+  return true;
+}
+
+// The counter is never cleared here, so no pulse can slip in between a read and a clear.
+uint32_t PulseCounter::take() {
+  if (!ready_) return 0;
+  int16_t now = 0;
+  if (pcnt_get_counter_value((pcnt_unit_t)unit_, &now) != ESP_OK) return 0;
+  const uint32_t n = (now >= last_) ? (uint32_t)(now - last_) : (uint32_t)(now + kHighLimit - last_);
+  last_ = now;
+  total_ += n;
+  return n;
+}
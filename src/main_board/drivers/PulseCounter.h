@@ -0,0 +1,20 @@
+#pragma once
+#include <Arduino.h>
+
+// Rising-edge counter on one ESP32 PCNT unit. The hardware counts every pulse on the
+// pin without CPU involvement; take() reads how many arrived since the last call.
+class PulseCounter {
+public:
+  // glitchCycles: pulses shorter than this many APB cycles (80 MHz, max 1023 =
+  // 12.8 us) are ignored.
+  bool begin(uint8_t pin, uint8_t unit, uint16_t glitchCycles = 1023);
+  uint32_t take();
+  bool ready() const { return ready_; }
+  uint32_t total() const { return total_; }
+
+private:
+  uint8_t unit_ = 0;
+  bool ready_ = false;
+  int16_t last_ = 0;
+  uint32_t total_ = 0;
+};
@@ -1,6 +1,6 @@
 #include "ServoDriver.h"
 #include "app/HardwareConfig.h"
-
+
 ServoDriver::ServoDriver(uint8_t pin, uint8_t channel, uint8_t resolution_bits)
 : pin_(pin), ch_(channel), res_(resolution_bits), min_us_(500), max_us_(2500) {}
 
@@ -26,7 +26,16 @@ void ServoDriver::writePulseUs(uint16_t us) {
 }
 
 void ServoDriver::writeAngle(uint8_t deg) {
-  if (deg > 180) deg = 180;
-  uint32_t us = (uint32_t)min_us_ + ((uint32_t)(max_us_ - min_us_) * deg) / 180u;
+  writeAngleX10((uint16_t)deg * 10u);
+}
+
+void ServoDriver::writeAngleX10(uint16_t degX10) {
+  if (degX10 > 1800) degX10 = 1800;
+  uint32_t us = (uint32_t)min_us_ + ((uint32_t)(max_us_ - min_us_) * degX10) / 1800u;
   writePulseUs((uint16_t)us);
 }
+
+void ServoDriver::release() {
+  if (pin_ == HwCfg::PIN_UNUSED) return;
+  ledcWrite(ch_, 0);
+}
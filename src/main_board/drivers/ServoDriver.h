@@ -8,6 +8,10 @@ public:
   void begin();
   void writePulseUs(uint16_t us);
   void writeAngle(uint8_t deg);
+  // Tenths of a degree, for smooth profiled moves.
+  void writeAngleX10(uint16_t degX10);
+  // Stops pulses; most hobby servos then go limp and quiet until the next write.
+  void release();
 
 private:
   uint8_t pin_;
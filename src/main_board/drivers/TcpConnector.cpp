@@ -0,0 +1,64 @@
+#include "TcpConnector.h"
+
+#include <lwip/sockets.h>
+
+bool TcpConnector::start(const IPAddress& ip, uint16_t port) {
+  abort();
+  error_ = 0;
+  const int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) {
+    error_ = errno;
+    return false;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = (uint32_t)ip;
+  if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+    error_ = errno;
+    close(fd);
+    return false;
+  }
+  fd_ = fd;
+  return true;
+}
+
+TcpConnector::Result TcpConnector::poll() {
+  if (fd_ < 0) return Result::failed;
+
+  fd_set wr;
+  FD_ZERO(&wr);
+  FD_SET(fd_, &wr);
+  timeval tv = {0, 0};
+  const int n = select(fd_ + 1, nullptr, &wr, nullptr, &tv);
+  if (n == 0) return Result::pending;
+
+  int err = 0;
+  socklen_t len = sizeof(err);
+  if (n < 0 || getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+    error_ = (n < 0 || err == 0) ? errno : err;
+    abort();
+    return Result::failed;
+  }
+
+  // WiFiClient expects a blocking socket (it polls with select/MSG_DONTWAIT itself).
+  fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL, 0) & ~O_NONBLOCK);
+  const int one = 1;
+  setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return Result::connected;
+}
+
+int TcpConnector::take() {
+  const int fd = fd_;
+  fd_ = -1;
+  return fd;
+}
+
+void TcpConnector::abort() {
+  if (fd_ < 0) return;
+  close(fd_);
+  fd_ = -1;
+}
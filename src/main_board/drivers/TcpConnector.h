@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Non-blocking TCP connect on an lwIP socket. WiFiClient::connect() waits for the
+// handshake; this starts it and is polled every tick, then hands the connected
+// socket to a WiFiClient.
+class TcpConnector {
+public:
+  enum class Result : uint8_t { pending, connected, failed };
+
+  ~TcpConnector() { abort(); }
+
+  bool start(const IPAddress& ip, uint16_t port);
+  Result poll();
+  // Ownership of the connected socket passes to the caller.
+  int take();
+  void abort();
+  bool active() const { return fd_ >= 0; }
+  int error() const { return error_; }
+
+private:
+  int fd_ = -1;
+  int error_ = 0;
+};
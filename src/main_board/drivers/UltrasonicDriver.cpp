@@ -1,5 +1,8 @@
 #include "UltrasonicDriver.h"
 #include "app/HardwareConfig.h"
+
+UltrasonicDriver::UltrasonicDriver()
+: trig_(HwCfg::PIN_UNUSED), echo_(HwCfg::PIN_UNUSED) {}
 
 UltrasonicDriver::UltrasonicDriver(uint8_t trigPin, uint8_t echoPin)
 : trig_(trigPin), echo_(echoPin) {}
@@ -3,6 +3,7 @@
 
 class UltrasonicDriver {
 public:
+  UltrasonicDriver(); // unwired until assigned
   UltrasonicDriver(uint8_t trigPin, uint8_t echoPin);
 
   void begin();
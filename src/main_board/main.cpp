@@ -1,14 +1,23 @@
 #include <Arduino.h>
 #include "app/App.h"
+#include "app/Clock.h"
+
+// Binary injection (docs/serial_test_codes.md) is limited by the link: about 2k
+// events/s at 115200, about 17k at 921600.
+#ifndef SERIAL_BAUD
+#define SERIAL_BAUD 115200
+#endif
 
 static App app;
 
 void setup() {
-  Serial.begin(115200);
+  // Room for a few full injection frames between loop iterations.
+  Serial.setRxBufferSize(1024);
+  Serial.begin(SERIAL_BAUD);
   delay(200);
   app.begin();
 }
 
 void loop() {
-  app.tick(millis());
+  app.tick(clockMs());
 }
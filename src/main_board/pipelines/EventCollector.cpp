@@ -1,5 +1,9 @@
 #include "pipelines/EventCollector.h"
 
+#include "app/Clock.h"
+#include "drivers/GpioSnapshot.h"
+#include "rtos/Tasks.h"
+
 #ifndef DOOR_CODE
 #define DOOR_CODE ""
 #endif
@@ -20,25 +24,28 @@ bool pinConfigured(uint8_t pin) {
 } // namespace
 
 EventCollector::EventCollector()
-: us1_(HwCfg::PIN_US_TRIG, HwCfg::PIN_US_ECHO),
-  chokep1_(&us1_, 1, 5, 10, 200, 1500),
-  us2_(HwCfg::PIN_US_TRIG_2, HwCfg::PIN_US_ECHO_2),
-  chokep2_(&us2_, 2, 5, 10, 200, 1500),
-  us3_(HwCfg::PIN_US_TRIG_3, HwCfg::PIN_US_ECHO_3),
-  chokep3_(&us3_, 3, 5, 10, 200, 1500),
-  reedDoor_(HwCfg::PIN_REED_1, 1, EventType::door_open, true, 80),
-  reedWindow_(HwCfg::PIN_REED_2, 2, EventType::window_open, true, 80),
-  pir1_(HwCfg::PIN_PIR_1, 1, 1500),
-  pir2_(HwCfg::PIN_PIR_2, 2, 1500),
-  pir3_(HwCfg::PIN_PIR_3, 3, 1500),
-  vibCombined_(HwCfg::PIN_VIB_1, 0, 700),
-  keypadDrv_(&Wire, HwCfg::KEYPAD_I2C_ADDR, HwCfg::KP_MAP, 60),
-  keypadIn_(0) {}
-
-void EventCollector::begin() {
-  Wire.begin(HwCfg::PIN_I2C_SDA, HwCfg::PIN_I2C_SCL);
-  oled_.begin();
-  keypadDrv_.begin();
+: keypadDrv_(&i2c_, HwCfg::KEYPAD_I2C_ADDR, HwCfg::KP_MAP, 60),
+  keypadIn_(0) {
+  for (uint8_t i = 0; i < HwCfg::SENSOR_COUNT && chokepCount_ < kMaxChokepoints; ++i) {
+    const SensorDef& d = HwCfg::SENSORS[i];
+    if (d.kind != SensorKind::ultrasonic) continue;
+    const uint8_t n = chokepCount_++;
+    usDrv_[n] = UltrasonicDriver(d.trigPin, d.pin);
+    chokep_[n] = ChokepointSensor(&usDrv_[n], d.id, 5, 10, 200, d.holdMs);
+    chokepSlot_[n] = i;
+  }
+}
+
+void EventCollector::begin(bool warmBoot) {
+  if (!i2c_.begin()) Serial.println("[I2C] WARN: bus init failed");
+  RtosTasks::attachI2cBus(&i2c_);
+  const bool oledOk = oled_.begin(!warmBoot);
+  if (oledOk) RtosTasks::attachOled(&oled_);
+  RtosTasks::attachKeypad(&keypadDrv_, HwCfg::PIN_KEYPAD_INT);
+  RtosTasks::startIfReady();
+  if (oledOk) oled_.setRenderedByWorker(RtosTasks::oledWorkerStarted());
+  keypadIrq_ = RtosTasks::keypadWorkerStarted();
+  if (!keypadIrq_) keypadDrv_.begin();
   keypadIn_.begin();
   hasPendingSerialEvent_ = false;
   pendingSerialEvent_ = {};
@@ -51,7 +58,7 @@ void EventCollector::begin() {
     keypadIn_.setDoorCode("ABCD");
     Serial.println("[KEYPAD] WARN: DOOR_CODE invalid; keypad unlock disabled");
   }
-  const uint32_t nowMs = millis();
+  const uint32_t nowMs = clockMs();
   if (pinConfigured(HwCfg::PIN_BTN_DOOR_TOGGLE)) {
     pinMode(HwCfg::PIN_BTN_DOOR_TOGGLE, INPUT_PULLUP);
     const bool doorPressed = (digitalRead(HwCfg::PIN_BTN_DOOR_TOGGLE) == LOW);
@@ -74,32 +81,73 @@ void EventCollector::begin() {
   }
   windowToggleLastChangeMs_ = nowMs;
 
-  reedDoor_.begin();
-  reedWindow_.begin();
-  pir1_.begin();
-  pir2_.begin();
-  pir3_.begin();
-  vibCombined_.begin();
-  us1_.begin();
-  chokep1_.begin();
-  us2_.begin();
-  chokep2_.begin();
-  us3_.begin();
-  chokep3_.begin();
+  bank_.begin(HwCfg::SENSORS, HwCfg::SENSOR_COUNT, nowMs);
+  vibCount_ = 0;
+  uint32_t counted = 0;
+  for (uint8_t i = 0; i < HwCfg::SENSOR_COUNT && vibCount_ < kMaxPulseSensors; ++i) {
+    const SensorDef& d = HwCfg::SENSORS[i];
+    if (d.kind != SensorKind::vibration || !pinConfigured(d.pin)) continue;
+    const uint8_t n = vibCount_;
+    if (!vibCounter_[n].begin(d.pin, n)) {
+      Serial.printf("[VIB] WARN: pulse counter init failed (%s); edge detection only\n", d.name);
+      continue;
+    }
+    vibBurst_[n] = VibrationBurst();
+    vibSlot_[n] = i;
+    counted |= (uint32_t)1u << i;
+    ++vibCount_;
+  }
+  bank_.setPulseCounted(counted);
+  for (uint8_t n = 0; n < chokepCount_; ++n) {
+    usDrv_[n].begin();
+    chokep_[n].begin();
+  }
+  samplingMeter_.begin(nowMs);
+  capture_.begin();
+}
+
+void EventCollector::applySampling(SamplingProfile profile) {
+  samplingProfile_ = profile;
+  const SamplingRates r = SamplingPolicy::rates(profile);
+  for (uint8_t n = 0; n < chokepCount_; ++n) chokep_[n].setSamplePeriodMs(r.ultrasonicMs);
+  keypadDrv_.setScanGapMs(r.keypadScanGapMs);
+  RtosTasks::setKeypadBackstopMs(r.keypadBackstopMs);
+}
+
+SamplingMeter::Report EventCollector::takeSamplingReport(uint32_t nowMs) {
+  return samplingMeter_.take(nowMs, chokepCount_, samplingProfile_);
 }
 
 bool EventCollector::pollKeypad(uint32_t nowMs, Event& out) {
-  const char k = keypadDrv_.update(nowMs);
+  if (keypadIrq_) {
+    // Keys arrive from the INT-driven worker stamped with their edge time.
+    RtosQueues::KeypadMsg msg;
+    while (RtosTasks::dequeueKeypad(msg)) {
+      if (handleKey(msg.key, msg.tsMs, out)) return true;
+    }
+  } else {
+    const uint32_t reads = keypadDrv_.busReads();
+    const uint32_t t0 = clockUs();
+    const char k = keypadDrv_.update(nowMs);
+    samplingMeter_.addKeypadPoll();
+    if (keypadDrv_.busReads() != reads) samplingMeter_.addKeypadScan(clockUs() - t0);
+    if (handleKey(k, nowMs, out)) return true;
+  }
+  oled_.update(nowMs);
+  return keypadIn_.poll(nowMs, out);
+}
+
+bool EventCollector::handleKey(char k, uint32_t tsMs, Event& out) {
   if (k == 'A') {
-    out = {EventType::door_hold_warn_silence, nowMs, 0};
+    out = {EventType::door_hold_warn_silence, tsMs, 0};
     return true;
   }
   if (k == 'B') {
-    out = {EventType::keypad_help_request, nowMs, 0};
+    out = {EventType::keypad_help_request, tsMs, 0};
     return true;
   }
   if (k) {
-    keypadIn_.feedKey(k, nowMs);
+    keypadIn_.feedKey(k, tsMs);
     oled_.showCode(keypadIn_.buf(), keypadIn_.len());
 
     KeypadInput::SubmitResult sr;
@@ -107,8 +155,7 @@ bool EventCollector::pollKeypad(uint32_t nowMs, Event& out) {
       oled_.showResult(sr == KeypadInput::SubmitResult::ok);
     }
   }
-  oled_.update(nowMs);
-  return keypadIn_.poll(nowMs, out);
+  return false;
 }
 
 void EventCollector::updateOledStatus(uint32_t nowMs,
@@ -150,6 +197,8 @@ void EventCollector::printSerialHelp() const {
   Serial.println("  321 chokepoint_us2(window)");
   Serial.println("  322 chokepoint_us3(between_room)");
   Serial.println("[SERIAL-TEST] Legacy single-key still supported. Send '?' for this help.");
+  Serial.println("[SERIAL-TEST] Binary frames (0xA5 0x5A ...) inject batches; see docs/serial_test_codes.md");
+  Serial.println("[SERIAL-TEST] capture on|off|dump records raw samples for tools/capture_player");
 }
 
 bool EventCollector::parseSerialEvent(char c, uint32_t nowMs, Event& out) const {
@@ -238,17 +287,16 @@ bool EventCollector::parseSerialEvent(const String& token, uint32_t nowMs, Event
 
 bool EventCollector::readSerialEvent(uint32_t nowMs, Event& out) {
   while (Serial.available()) {
-    const char c = (char)Serial.read();
+    const uint8_t b = (uint8_t)Serial.read();
+    if (injector_.feed(b, nowMs)) continue;
+    const char c = (char)b;
     if (c == '\r') continue;
 
     serialLineLastByteMs_ = nowMs;
 
     if (c == '\n') {
       if (serialLineLen_ == 0) continue;
-      serialLineBuf_[serialLineLen_] = '\0';
-      const String token(serialLineBuf_);
-      serialLineLen_ = 0;
-      return parseSerialEvent(token, nowMs, out);
+      return commitSerialLine(nowMs, out);
     }
 
     if (serialLineLen_ >= (sizeof(serialLineBuf_) - 1)) {
@@ -261,15 +309,76 @@ bool EventCollector::readSerialEvent(uint32_t nowMs, Event& out) {
 
   // Support "No line ending" in serial monitor by auto-committing after idle.
   if (serialLineLen_ > 0 && (nowMs - serialLineLastByteMs_) >= 40) {
-    serialLineBuf_[serialLineLen_] = '\0';
-    const String token(serialLineBuf_);
-    serialLineLen_ = 0;
-    return parseSerialEvent(token, nowMs, out);
+    return commitSerialLine(nowMs, out);
   }
 
   return false;
 }
 
+void EventCollector::pumpInjectFrames(uint32_t nowMs) {
+  while (Serial.available()) {
+    const int b = Serial.peek();
+    if (b < 0 || !injector_.accepts((uint8_t)b, nowMs)) return;
+    injector_.feed((uint8_t)Serial.read(), nowMs);
+  }
+}
+
+bool EventCollector::commitSerialLine(uint32_t nowMs, Event& out) {
+  serialLineBuf_[serialLineLen_] = '\0';
+  const String token(serialLineBuf_);
+  serialLineLen_ = 0;
+  if (captureCommand(token, nowMs)) return false;
+  return parseSerialEvent(token, nowMs, out);
+}
+
+bool EventCollector::captureCommand(const String& line, uint32_t nowMs) {
+  String t = line;
+  t.trim();
+  if (!t.startsWith("capture")) return false;
+
+  if (t == "capture on") {
+    if (capture_.start(nowMs)) {
+      captureLevelsSent_ = false;
+      Serial.printf("[CAPTURE] on id=%u\n", (unsigned)capture_.captureId());
+    } else {
+      Serial.println("[CAPTURE] cannot start (no partition or dump running)");
+    }
+  } else if (t == "capture off") {
+    capture_.stop();
+    const SampleCapture::Stats& st = capture_.stats();
+    Serial.printf("[CAPTURE] off id=%u samples=%lu pages=%lu bytes=%lu\n",
+                  (unsigned)capture_.captureId(),
+                  (unsigned long)st.samples,
+                  (unsigned long)st.pages,
+                  (unsigned long)st.bytes);
+  } else if (t == "capture dump") {
+    capture_.startDump();
+  } else {
+    Serial.println("[CAPTURE] use: capture on | capture off | capture dump");
+  }
+  return true;
+}
+
+bool EventCollector::nextInjected(uint32_t nowMs, Event& out, bool& trace) {
+  InjectFrame::Record rec;
+  uint32_t tsMs = 0;
+  bool quiet = false;
+  while (injector_.next(nowMs, rec, tsMs, quiet)) {
+    if (parseSerialCode(rec.code, tsMs, out)) {
+      out.zone = SensorRegistry::zoneOf(HwCfg::SENSORS, HwCfg::SENSOR_COUNT, out.type, out.src);
+      out.value = rec.value;
+      trace = !quiet;
+      return true;
+    }
+    injector_.done(SerialInjector::Outcome::rejected);
+  }
+  return false;
+}
+
+void EventCollector::injectedDone(bool blocked) {
+  injector_.done(blocked ? SerialInjector::Outcome::blocked : SerialInjector::Outcome::accepted);
+}
+
 bool EventCollector::pollSensorOrSerial(uint32_t nowMs, Event& out) {
   Event first{};
   bool hasFirst = false;
@@ -279,27 +388,61 @@ bool EventCollector::pollSensorOrSerial(uint32_t nowMs, Event& out) {
     hasFirst = true;
   };
 
+  // One register snapshot per tick feeds the buttons and every digital sensor.
+  const uint64_t gpio = GpioSnapshot::read();
+  bank_.update(nowMs, gpio);
+  capture_.pumpDump();
+  if (capture_.active() && (!captureLevelsSent_ || bank_.levels() != capturedLevels_)) {
+    capturedLevels_ = bank_.levels();
+    captureLevelsSent_ = true;
+    capture_.add(SampleCodec::kLevelsChannel, nowMs, capturedLevels_);
+  }
+
   Event e{};
-  capture(pollManualButtons(nowMs, e), e);
-  capture(reedDoor_.poll(nowMs, e), e);
-  capture(reedWindow_.poll(nowMs, e), e);
-  capture(pir1_.poll(nowMs, e), e);
-  capture(pir2_.poll(nowMs, e), e);
-  capture(pir3_.poll(nowMs, e), e);
-  capture(vibCombined_.poll(nowMs, e), e);
-  capture(chokep1_.poll(nowMs, e), e);
-  capture(chokep2_.poll(nowMs, e), e);
-  capture(chokep3_.poll(nowMs, e), e);
+  capture(pollManualButtons(nowMs, gpio, e), e);
+  // The bank queues simultaneous events, so only take one when it can be delivered.
+  if (!hasFirst) capture(bank_.next(e), e);
+  for (uint8_t n = 0; n < vibCount_; ++n) {
+    const SensorDef& d = HwCfg::SENSORS[vibSlot_[n]];
+    const uint32_t pulses = vibCounter_[n].take();
+    if (pulses && vibSlot_[n] < SampleCodec::kLevelsChannel) capture_.add(vibSlot_[n], nowMs, pulses);
+    vibBurst_[n].feed(pulses, nowMs, d.holdMs);
+    VibrationBurst::Hit hit;
+    // A finished hit waits in the burst until it can be delivered. It is stamped when
+    // delivered, not when it started: events from other sensors during the hit have
+    // already gone out, and the rules expect timestamps in delivery order.
+    if (!hasFirst && vibBurst_[n].take(hit)) {
+      capture(true, Event(EventType::vib_spike, nowMs, d.id, d.zone, hit.intensity()));
+    }
+  }
+  for (uint8_t n = 0; n < chokepCount_; ++n) {
+    const uint32_t samples = chokep_[n].samples();
+    const uint32_t t0 = clockUs();
+    const bool fired = chokep_[n].poll(nowMs, e);
+    if (chokep_[n].samples() != samples) {
+      samplingMeter_.addUltrasonic(clockUs() - t0);
+      if (chokepSlot_[n] < SampleCodec::kLevelsChannel) {
+        capture_.add(chokepSlot_[n], nowMs, (uint32_t)(chokep_[n].lastCm() + 1));
+      }
+    }
+    if (fired) {
+      e.zone = HwCfg::SENSORS[chokepSlot_[n]].zone;
+      capture(true, e);
+    }
+  }
 
   // Keep serial as lowest priority. If another source already fired, queue one serial event
   // so it won't be dropped or starved indefinitely by busy sensors.
+  // Frames keep flowing meanwhile: their events have a queue of their own.
   if (hasPendingSerialEvent_) {
+    pumpInjectFrames(nowMs);
     if (!hasFirst) {
       out = pendingSerialEvent_;
       hasPendingSerialEvent_ = false;
       return true;
     }
   } else if (readSerialEvent(nowMs, e)) {
+    e.zone = SensorRegistry::zoneOf(HwCfg::SENSORS, HwCfg::SENSOR_COUNT, e.type, e.src);
     if (!hasFirst) {
       first = e;
       hasFirst = true;
@@ -315,6 +458,7 @@ bool EventCollector::pollSensorOrSerial(uint32_t nowMs, Event& out) {
 }
 
 bool EventCollector::pollManualButton(uint8_t pin,
+                                      uint64_t gpio,
                                       uint32_t nowMs,
                                       uint32_t debounceMs,
                                       bool& lastRawPressed,
@@ -324,7 +468,7 @@ bool EventCollector::pollManualButton(uint8_t pin,
                                       Event& out) {
   if (!pinConfigured(pin)) return false;
 
-  const bool rawPressed = (digitalRead(pin) == LOW);
+  const bool rawPressed = !InputSnapshot::pinHigh(gpio, pin);
   if (rawPressed != lastRawPressed) {
     lastRawPressed = rawPressed;
     lastChangeMs = nowMs;
@@ -340,9 +484,10 @@ bool EventCollector::pollManualButton(uint8_t pin,
   return true;
 }
 
-bool EventCollector::pollManualButtons(uint32_t nowMs, Event& out) {
+bool EventCollector::pollManualButtons(uint32_t nowMs, uint64_t gpio, Event& out) {
   static constexpr uint32_t kDebounceMs = 40;
   if (pollManualButton(HwCfg::PIN_BTN_DOOR_TOGGLE,
+                       gpio,
                        nowMs,
                        kDebounceMs,
                        doorToggleLastRawPressed_,
@@ -353,6 +498,7 @@ bool EventCollector::pollManualButtons(uint32_t nowMs, Event& out) {
     return true;
   }
   return pollManualButton(HwCfg::PIN_BTN_WINDOW_TOGGLE,
+                          gpio,
                           nowMs,
                           kDebounceMs,
                           windowToggleLastRawPressed_,
@@ -363,29 +509,30 @@ bool EventCollector::pollManualButtons(uint32_t nowMs, Event& out) {
 }
 
 bool EventCollector::isDoorOpen() const {
-  return reedDoor_.isOpen();
+  return bank_.isOpen(SensorKind::door_contact);
 }
 
 bool EventCollector::isWindowOpen() const {
-  return reedWindow_.isOpen();
+  return bank_.isOpen(SensorKind::window_contact);
 }
 
-void EventCollector::readHealth(uint32_t nowMs,
-                                uint32_t pirStuckActiveMs,
-                                uint32_t vibStuckActiveMs,
-                                uint32_t ultrasonicOfflineMs,
-                                uint16_t ultrasonicNoEchoThreshold,
-                                HealthSnapshot& out) const {
-  out = {};
-  const bool us1Configured = pinConfigured(HwCfg::PIN_US_TRIG) && pinConfigured(HwCfg::PIN_US_ECHO);
-  const bool us2Configured = pinConfigured(HwCfg::PIN_US_TRIG_2) && pinConfigured(HwCfg::PIN_US_ECHO_2);
-  const bool us3Configured = pinConfigured(HwCfg::PIN_US_TRIG_3) && pinConfigured(HwCfg::PIN_US_ECHO_3);
-
-  out.pir1_stuck_active = pir1_.isStuckActive(nowMs, pirStuckActiveMs);
-  out.pir2_stuck_active = pir2_.isStuckActive(nowMs, pirStuckActiveMs);
-  out.pir3_stuck_active = pir3_.isStuckActive(nowMs, pirStuckActiveMs);
-  out.vib_stuck_active = vibCombined_.isStuckActive(nowMs, vibStuckActiveMs);
-  out.us1_offline = us1Configured && chokep1_.isOffline(nowMs, ultrasonicOfflineMs, ultrasonicNoEchoThreshold);
-  out.us2_offline = us2Configured && chokep2_.isOffline(nowMs, ultrasonicOfflineMs, ultrasonicNoEchoThreshold);
-  out.us3_offline = us3Configured && chokep3_.isOffline(nowMs, ultrasonicOfflineMs, ultrasonicNoEchoThreshold);
+void EventCollector::configureHealth(uint32_t pirStuckActiveMs,
+                                     uint32_t vibStuckActiveMs,
+                                     uint32_t ultrasonicOfflineMs,
+                                     uint16_t ultrasonicNoEchoThreshold) {
+  for (uint8_t i = 0; i < HwCfg::SENSOR_COUNT; ++i) {
+    const SensorDef& d = HwCfg::SENSORS[i];
+    if (d.kind == SensorKind::pir) {
+      health_.addLevel(i, d.name, pirStuckActiveMs);
+    } else if (d.kind == SensorKind::vibration) {
+      health_.addLevel(i, d.name, vibStuckActiveMs);
+    } else if (d.kind == SensorKind::ultrasonic && pinConfigured(d.pin) && pinConfigured(d.trigPin)) {
+      health_.addEcho(i, d.name, ultrasonicOfflineMs, ultrasonicNoEchoThreshold);
+    }
+  }
+
+  bank_.attachHealth(&health_);
+  for (uint8_t n = 0; n < chokepCount_; ++n) {
+    chokep_[n].attachHealth(&health_, chokepSlot_[n]);
+  }
 }
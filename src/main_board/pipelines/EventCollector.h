@@ -4,43 +4,51 @@
 
 #include "app/Events.h"
 #include "app/HardwareConfig.h"
+#include "app/SamplingPolicy.h"
+#include "app/SensorHealth.h"
+#include "app/VibrationBurst.h"
+#include "drivers/PulseCounter.h"
 #include "drivers/UltrasonicDriver.h"
+#include "pipelines/SerialInjector.h"
+#include "services/SampleCapture.h"
 #include "sensors/ChokepointSensor.h"
 #include "sensors/KeypadInput.h"
-#include "sensors/PirSensor.h"
-#include "sensors/ReedSensor.h"
-#include "sensors/VibrationSensor.h"
+#include "sensors/SensorBank.h"
 #include "ui/OledCodeUi.h"
 
 #include <Wire.h>
 #include "drivers/I2CKeypadDriver.h"
+#include "drivers/I2cBus.h"
 
 class EventCollector {
 public:
-  struct HealthSnapshot {
-    bool pir1_stuck_active = false;
-    bool pir2_stuck_active = false;
-    bool pir3_stuck_active = false;
-    bool vib_stuck_active = false;
-    bool us1_offline = false;
-    bool us2_offline = false;
-    bool us3_offline = false;
-  };
-
   EventCollector();
 
-  void begin();
+  void begin(bool warmBoot = false);
   bool pollKeypad(uint32_t nowMs, Event& out);
   bool pollSensorOrSerial(uint32_t nowMs, Event& out);
   void printSerialHelp() const;
+  // Next due event of a binary injection frame, mapped like the ASCII codes; report
+  // its outcome with injectedDone() before asking for another. trace is false for
+  // frames sent quiet.
+  bool nextInjected(uint32_t nowMs, Event& out, bool& trace);
+  void injectedDone(bool blocked);
+  const SerialInjector::Stats& injectStats() const { return injector_.stats(); }
   bool isDoorOpen() const;
   bool isWindowOpen() const;
-  void readHealth(uint32_t nowMs,
-                  uint32_t pirStuckActiveMs,
-                  uint32_t vibStuckActiveMs,
-                  uint32_t ultrasonicOfflineMs,
-                  uint16_t ultrasonicNoEchoThreshold,
-                  HealthSnapshot& out) const;
+  // Registers health slots (= HwCfg::SENSORS rows); call before begin() so initial
+  // sensor levels are seen.
+  void configureHealth(uint32_t pirStuckActiveMs,
+                       uint32_t vibStuckActiveMs,
+                       uint32_t ultrasonicOfflineMs,
+                       uint16_t ultrasonicNoEchoThreshold);
+  SensorHealth& health() { return health_; }
+  // Scan rates from SamplingPolicy; applied to the rangers and the keypad at once.
+  void applySampling(SamplingProfile profile);
+  // A door code is partly typed.
+  bool keypadActive() const { return keypadIn_.len() > 0; }
+  // Achieved rates and sampling CPU time since the previous report.
+  SamplingMeter::Report takeSamplingReport(uint32_t nowMs);
   void updateOledStatus(uint32_t nowMs,
                         bool doorLocked,
                         bool doorOpen,
@@ -49,28 +57,39 @@ public:
                         uint32_t countdownWarnBeforeMs);
 
 private:
-  UltrasonicDriver us1_;
-  ChokepointSensor chokep1_;
-  UltrasonicDriver us2_;
-  ChokepointSensor chokep2_;
-  UltrasonicDriver us3_;
-  ChokepointSensor chokep3_;
+  // Ultrasonic rangers block in pulseIn(), so a board carries only a few.
+  static constexpr uint8_t kMaxChokepoints = 4;
+
+  // Contacts, PIR and vibration rows of HwCfg::SENSORS.
+  SensorBank bank_;
+
+  UltrasonicDriver usDrv_[kMaxChokepoints];
+  ChokepointSensor chokep_[kMaxChokepoints];
+  uint8_t chokepSlot_[kMaxChokepoints] = {};
+  uint8_t chokepCount_ = 0;
 
-  ReedSensor reedDoor_;
-  ReedSensor reedWindow_;
-  PirSensor pir1_;
-  PirSensor pir2_;
-  PirSensor pir3_;
+  // Vibration rows counted by PCNT units, so every pulse of a hit is seen and its
+  // intensity reported; a row whose unit fails to start stays edge-triggered.
+  static constexpr uint8_t kMaxPulseSensors = 2;
+  PulseCounter vibCounter_[kMaxPulseSensors];
+  VibrationBurst vibBurst_[kMaxPulseSensors];
+  uint8_t vibSlot_[kMaxPulseSensors] = {};
+  uint8_t vibCount_ = 0;
 
-  // Multiple vibration switches wired together into one input.
-  VibrationSensor vibCombined_;
+  SensorHealth health_;
 
-  OledCodeUi oled_{HwCfg::OLED_I2C_ADDR};
+  I2cBus i2c_{&Wire, HwCfg::PIN_I2C_SDA, HwCfg::PIN_I2C_SCL};
+  OledCodeUi oled_{&i2c_, HwCfg::OLED_I2C_ADDR};
 
   I2CKeypadDriver keypadDrv_;
   KeypadInput keypadIn_;
+  bool keypadIrq_ = false;
+
+  SamplingProfile samplingProfile_ = SamplingProfile::normal;
+  SamplingMeter samplingMeter_;
 
   bool pollManualButton(uint8_t pin,
+                        uint64_t gpio,
                         uint32_t nowMs,
                         uint32_t debounceMs,
                         bool& lastRawPressed,
@@ -78,11 +97,18 @@ private:
                         uint32_t& lastChangeMs,
                         EventType pressEvent,
                         Event& out);
-  bool pollManualButtons(uint32_t nowMs, Event& out);
+  bool pollManualButtons(uint32_t nowMs, uint64_t gpio, Event& out);
+  bool handleKey(char k, uint32_t tsMs, Event& out);
   bool parseSerialEvent(char c, uint32_t nowMs, Event& out) const;
   bool parseSerialEvent(const String& token, uint32_t nowMs, Event& out) const;
   bool parseSerialCode(uint16_t code, uint32_t nowMs, Event& out) const;
   bool readSerialEvent(uint32_t nowMs, Event& out);
+  // Feeds the injector while the bytes waiting are frame bytes; stops at the first
+  // ASCII byte, which stays in the port for readSerialEvent().
+  void pumpInjectFrames(uint32_t nowMs);
+  bool commitSerialLine(uint32_t nowMs, Event& out);
+  // "capture on|off|dump"; true if the line was one.
+  bool captureCommand(const String& line, uint32_t nowMs);
 
   bool doorToggleLastRawPressed_ = false;
   bool doorToggleStablePressed_ = false;
@@ -97,4 +123,12 @@ private:
   char serialLineBuf_[48] = {0};
   uint8_t serialLineLen_ = 0;
   uint32_t serialLineLastByteMs_ = 0;
+  SerialInjector injector_;
+
+  // Raw samples for offline replay: level rows on SampleCodec::kLevelsChannel when
+  // they change, each ranger sample (cm + 1, 0 = no echo) and each non-zero pulse
+  // count on its registry slot.
+  SampleCapture capture_;
+  uint32_t capturedLevels_ = 0;
+  bool captureLevelsSent_ = false;
 };
@@ -0,0 +1,161 @@
+#include "pipelines/SerialInjector.h"
+
+#include "app/Clock.h"
+
+using namespace InjectFrame;
+
+bool SerialInjector::accepts(uint8_t b, uint32_t nowMs) {
+  if (dec_.inFrame() && (nowMs - lastByteMs_) >= kByteTimeoutMs) {
+    dec_.reset();
+    ++stats_.timeouts;
+  }
+  return dec_.accepts(b);
+}
+
+bool SerialInjector::feed(uint8_t b, uint32_t nowMs) {
+  if (!accepts(b, nowMs)) {
+    dec_.reset();
+    return false;
+  }
+  lastByteMs_ = nowMs;
+  switch (dec_.feed(b)) {
+    case Decoder::Result::frame:
+      onFrame(nowMs);
+      break;
+    case Decoder::Result::crc: {
+      ++stats_.crcErrors;
+      Ack a;
+      a.status = Status::crc;
+      sendAck(dec_.seq(), a);
+      break;
+    }
+    case Decoder::Result::more:
+    case Decoder::Result::resync:
+    default:
+      break;
+  }
+  return true;
+}
+
+void SerialInjector::onFrame(uint32_t nowMs) {
+  const uint16_t seq = dec_.seq();
+  Ack a;
+  if (dec_.type() != Type::events || !validEvents(dec_.len())) {
+    a.status = Status::bad;
+    sendAck(seq, a);
+    return;
+  }
+
+  if (duplicate(seq)) {
+    ++stats_.dups;
+    return;
+  }
+
+  const uint8_t n = recordCount(dec_.len());
+  if (n > queueFree() || batchCount_ >= kMaxBatches) {
+    ++stats_.busy;
+    a.status = Status::busy;
+    sendAck(seq, a);
+    return;
+  }
+
+  if (haveSeq_ && seq != (uint16_t)(lastSeq_ + 1)) ++stats_.gaps;
+  haveSeq_ = true;
+  lastSeq_ = seq;
+  ++stats_.frames;
+  stats_.events += n;
+  if (n == 0) {
+    remember(seq, a);
+    sendAck(seq, a);
+    return;
+  }
+
+  Batch& bt = batches_[(batchHead_ + batchCount_) % kMaxBatches];
+  bt.seq = seq;
+  bt.remaining = n;
+  bt.quiet = (dec_.payload()[0] & kFlagQuiet) != 0;
+  bt.rxUs = clockUs();
+  bt.ack = Ack();
+  ++batchCount_;
+
+  for (uint8_t i = 0; i < n; ++i) {
+    Pending& p = queue_[(head_ + count_) % kQueueDepth];
+    p.rec = record(dec_.payload(), i);
+    p.tsMs = nowMs + p.rec.offsetMs;
+    ++count_;
+  }
+}
+
+bool SerialInjector::next(uint32_t nowMs, Record& rec, uint32_t& tsMs, bool& quiet) {
+  if (!count_) return false;
+  const Pending& p = queue_[head_];
+  if ((int32_t)(nowMs - p.tsMs) < 0) return false;
+  rec = p.rec;
+  tsMs = p.tsMs;
+  quiet = batches_[batchHead_].quiet;
+  if (!started_) {
+    started_ = true;
+    eventStartUs_ = clockUs();
+  }
+  return true;
+}
+
+void SerialInjector::done(Outcome outcome) {
+  if (!count_ || !batchCount_) return;
+  Batch& bt = batches_[batchHead_];
+  const uint32_t tookUs = clockUs() - eventStartUs_;
+  if (tookUs > bt.ack.maxEventUs) bt.ack.maxEventUs = tookUs;
+  switch (outcome) {
+    case Outcome::accepted: ++bt.ack.accepted; break;
+    case Outcome::blocked: ++bt.ack.blocked; break;
+    case Outcome::rejected:
+    default: ++bt.ack.rejected; break;
+  }
+  started_ = false;
+  head_ = (uint8_t)((head_ + 1) % kQueueDepth);
+  --count_;
+  if (--bt.remaining == 0) finishBatch();
+}
+
+void SerialInjector::finishBatch() {
+  Batch& bt = batches_[batchHead_];
+  bt.ack.status = Status::ok;
+  bt.ack.latencyUs = clockUs() - bt.rxUs;
+  remember(bt.seq, bt.ack);
+  sendAck(bt.seq, bt.ack);
+  batchHead_ = (uint8_t)((batchHead_ + 1) % kMaxBatches);
+  --batchCount_;
+}
+
+void SerialInjector::remember(uint16_t seq, const Ack& ack) {
+  acked_[ackedNext_].seq = seq;
+  acked_[ackedNext_].ack = ack;
+  ackedNext_ = (uint8_t)((ackedNext_ + 1) % kAckHistory);
+  if (ackedCount_ < kAckHistory) ++ackedCount_;
+}
+
+bool SerialInjector::duplicate(uint16_t seq) {
+  // Still in progress: its ack is on the way.
+  for (uint8_t i = 0; i < batchCount_; ++i) {
+    if (batches_[(batchHead_ + i) % kMaxBatches].seq == seq) return true;
+  }
+  for (uint8_t i = 0; i < ackedCount_; ++i) {
+    Acked& d = acked_[(ackedNext_ + kAckHistory - 1 - i) % kAckHistory];
+    if (d.seq != seq) continue;
+    Ack a = d.ack;
+    a.status = Status::dup;
+    sendAck(seq, a);
+    return true;
+  }
+  return false;
+}
+
+void SerialInjector::sendAck(uint16_t seq, Ack& ack) {
+  ack.gaps = stats_.gaps;
+  ack.queueFree = queueFree();
+  uint8_t payload[kAckSize];
+  encodeAck(payload, ack);
+  uint8_t frame[kOverhead + kAckSize];
+  const size_t n = encode(frame, Type::ack, seq, payload, kAckSize);
+  Serial.write(frame, n);
+}
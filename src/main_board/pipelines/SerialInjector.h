@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "app/InjectFrame.h"
+
+// Receives binary injection frames (app/InjectFrame.h) from the serial port, queues
+// their events by due time and acks each frame once its last event is handled.
+// Frames are acked in arrival order; one that does not fit the queue is refused
+// with status busy and may be resent under the same seq.
+class SerialInjector {
+public:
+  static constexpr uint8_t kQueueDepth = 128;
+  static constexpr uint8_t kMaxBatches = 4;
+  // Acks kept for resending when the host retransmits a frame whose ack it lost.
+  static constexpr uint8_t kAckHistory = 8;
+
+  enum class Outcome : uint8_t { accepted, blocked, rejected };
+
+  struct Stats {
+    uint32_t frames = 0;
+    uint32_t events = 0;
+    uint32_t crcErrors = 0;
+    uint32_t busy = 0;
+    uint32_t dups = 0;
+    uint16_t gaps = 0;
+    uint32_t timeouts = 0; // partial frames abandoned after InjectFrame::kByteTimeoutMs
+  };
+
+  // True if b would be consumed by feed(). A frame stalled for kByteTimeoutMs is
+  // dropped first, so the byte is judged against a fresh hunt.
+  bool accepts(uint8_t b, uint32_t nowMs);
+  // True if the byte belongs to a frame; the ASCII reader must not see it.
+  bool feed(uint8_t b, uint32_t nowMs);
+  // The front queued event once due; it stays at the front until done().
+  bool next(uint32_t nowMs, InjectFrame::Record& rec, uint32_t& tsMs, bool& quiet);
+  void done(Outcome outcome);
+  const Stats& stats() const { return stats_; }
+
+private:
+  struct Pending {
+    InjectFrame::Record rec;
+    uint32_t tsMs;
+  };
+  struct Acked {
+    uint16_t seq;
+    InjectFrame::Ack ack;
+  };
+  struct Batch {
+    uint16_t seq;
+    uint8_t remaining;
+    bool quiet;
+    uint32_t rxUs;
+    InjectFrame::Ack ack;
+  };
+
+  void onFrame(uint32_t nowMs);
+  void finishBatch();
+  void remember(uint16_t seq, const InjectFrame::Ack& ack);
+  // True if seq was already taken; a finished one has its ack resent.
+  bool duplicate(uint16_t seq);
+  void sendAck(uint16_t seq, InjectFrame::Ack& ack);
+  uint8_t queueFree() const { return (uint8_t)(kQueueDepth - count_); }
+
+  InjectFrame::Decoder dec_;
+  Pending queue_[kQueueDepth];
+  uint8_t head_ = 0;
+  uint8_t count_ = 0;
+  Batch batches_[kMaxBatches];
+  uint8_t batchHead_ = 0;
+  uint8_t batchCount_ = 0;
+
+  bool haveSeq_ = false;
+  uint16_t lastSeq_ = 0;
+  Acked acked_[kAckHistory];
+  uint8_t ackedNext_ = 0;
+  uint8_t ackedCount_ = 0;
+  bool started_ = false;
+  uint32_t eventStartUs_ = 0;
+  uint32_t lastByteMs_ = 0;
+  Stats stats_;
+};
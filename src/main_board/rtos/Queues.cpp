@@ -2,15 +2,21 @@
 
 namespace RtosQueues {
 
-QueueHandle_t mqttPubQ = nullptr;
+QueueHandle_t mqttPubQ[PublishLanes::kQueued] = {};
 QueueHandle_t mqttCmdQ = nullptr;
 QueueHandle_t chokepointQ = nullptr;
+QueueHandle_t keypadQ = nullptr;
 
 bool init() {
-  if (!mqttPubQ) mqttPubQ = xQueueCreate(16, sizeof(PublishMsg));
+  bool pubOk = true;
+  for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) {
+    if (!mqttPubQ[l]) mqttPubQ[l] = xQueueCreate(PublishLanes::queueDepth(l), sizeof(PublishMsg));
+    pubOk = pubOk && mqttPubQ[l];
+  }
   if (!mqttCmdQ) mqttCmdQ = xQueueCreate(8, sizeof(CmdMsg));
   if (!chokepointQ) chokepointQ = xQueueCreate(8, sizeof(ChokepointMsg));
-  return mqttPubQ && mqttCmdQ && chokepointQ;
+  if (!keypadQ) keypadQ = xQueueCreate(8, sizeof(KeypadMsg));
+  return pubOk && mqttCmdQ && chokepointQ && keypadQ;
 }
 
 } // namespace RtosQueues
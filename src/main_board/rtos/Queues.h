@@ -4,7 +4,8 @@
 
 #include "app/Commands.h"
 #include "app/Events.h"
-#include "app/SystemState.h"
+#include "app/PackedSystemState.h"
+#include "app/PublishLanes.h"
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
@@ -17,16 +18,37 @@ enum class PublishKind : uint8_t {
   ack
 };
 
+// Queued and persisted in the offline store, so the state snapshot is kept packed.
 struct PublishMsg {
   PublishKind kind = PublishKind::event;
   Event e{};
-  SystemState st{};
+  PackedSystemState st{};
   Command cmd{CommandType::none, 0};
   bool ok = false;
+  bool bootProfile = false; // status only: append the boot timing breakdown
+  uint32_t healthMask = 0;  // status only: SensorHealth fault bits
   char text1[32]{};
   char text2[32]{};
+  uint32_t queuedMs = 0; // enqueue time, for lane wait metrics
 };
 
+inline PublishLane laneOf(const PublishMsg& msg) {
+  switch (msg.kind) {
+    case PublishKind::ack:
+      return PublishLane::ack;
+    case PublishKind::status:
+      return PublishLane::status;
+    case PublishKind::event:
+    default:
+      break;
+  }
+  const bool alarm = msg.st.levelValue() == AlarmLevel::alert ||
+                     msg.cmd.type == CommandType::buzzer_alert ||
+                     msg.e.type == EventType::door_tamper ||
+                     msg.e.type == EventType::keypad_help_request;
+  return alarm ? PublishLane::critical : PublishLane::event;
+}
+
 struct CmdMsg {
   char payload[128]{};
 };
@@ -36,9 +58,16 @@ struct ChokepointMsg {
   int cm = -1;
 };
 
-extern QueueHandle_t mqttPubQ;
+struct KeypadMsg {
+  char key = 0;
+  uint32_t tsMs = 0; // INT edge time
+};
+
+// One live queue per queued lane (PublishLanes::kQueued), indexed by lane.
+extern QueueHandle_t mqttPubQ[PublishLanes::kQueued];
 extern QueueHandle_t mqttCmdQ;
 extern QueueHandle_t chokepointQ;
+extern QueueHandle_t keypadQ;
 
 bool init();
 
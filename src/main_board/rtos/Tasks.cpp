@@ -3,21 +3,50 @@
 #include <cstdio>
 #include <cstring>
 
+#include "app/Clock.h"
+#include "app/HardwareConfig.h"
+#include "app/InflightWindow.h"
+#include "app/OverloadControl.h"
+#include "app/PublishLanes.h"
+#include "app/StoreEviction.h"
 #include "rtos/Queues.h"
 
 #include <Preferences.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+#ifndef OLED_MAX_FPS
+#define OLED_MAX_FPS 10
+#endif
+
+#ifndef KEYPAD_BACKSTOP_MS
+#define KEYPAD_BACKSTOP_MS 200
+#endif
+
+#ifndef MQTT_INFLIGHT_WINDOW
+#define MQTT_INFLIGHT_WINDOW 8
+#endif
+
 namespace RtosTasks {
 
 static MqttClient* gMqtt = nullptr;
 static ChokepointSensor* gChokepoint = nullptr;
+static EventJournal* gJournal = nullptr;
+static OledCodeUi* gOled = nullptr;
+static I2cBus* gI2c = nullptr;
+static I2CKeypadDriver* gKeypad = nullptr;
+static uint8_t gKeypadIntPin = HwCfg::PIN_UNUSED;
 
 static TaskHandle_t hMqtt = nullptr;
 static TaskHandle_t hChokepoint = nullptr;
+static TaskHandle_t hOled = nullptr;
+static TaskHandle_t hKeypad = nullptr;
 static bool mqttStarted = false;
 static bool chokepointStarted = false;
+static bool oledStarted = false;
+static bool keypadStarted = false;
+static volatile uint32_t gKeypadEdgeMs = 0;
+static volatile uint32_t gKeypadBackstopMs = KEYPAD_BACKSTOP_MS;
 
 static volatile uint32_t gPubDrops = 0;
 static volatile uint32_t gCmdDrops = 0;
@@ -30,9 +59,36 @@ static volatile uint32_t gSensorDepth = 0;
 static Preferences pref;
 static bool prefReady = false;
 static RtosQueues::PublishMsg store[MQTT_STORE_CAP];
-static uint32_t storeHead = 0;
-static uint32_t storeTail = 0;
-static uint32_t storeCount = 0;
+
+// The offline store is partitioned into one ring per queued lane, each with its own
+// QoS1 window (and packet-id range), so a backlog in one lane never holds up another.
+struct StoreLane {
+  uint32_t base = 0; // first slot in store[]
+  uint32_t cap = 0;
+  uint32_t head = 0;
+  uint32_t count = 0;
+  // Entries at the ring front that are also in NVS. While the broker is reachable the
+  // store is only a QoS1 send queue and is not written to flash; it is persisted when
+  // the link drops or a message has to wait offline.
+  uint32_t persisted = 0;
+  InflightWindow inflight;
+};
+static StoreLane lanes[PublishLanes::kQueued];
+static uint32_t storeCount = 0; // all lanes
+static LaneScheduler gScheduler;
+static LaneStats gLaneStats[PublishLanes::kCount]; // MQTT task only
+static volatile uint32_t gLaneQueueDrops[PublishLanes::kQueued] = {};
+static OverloadController gOverload;
+
+static portMUX_TYPE journalMux = portMUX_INITIALIZER_UNLOCKED;
+static bool journalRequested = false;
+static uint32_t journalFromMs = 0;
+static uint32_t journalToMs = 0;
+static uint32_t journalBoot = 0;
+
+static portMUX_TYPE samplingMux = portMUX_INITIALIZER_UNLOCKED;
+static SamplingMeter::Report gSampling;
+static bool gSamplingValid = false;
 
 static inline bool reached(uint32_t nowMs, uint32_t targetMs) {
   return (int32_t)(nowMs - targetMs) >= 0;
@@ -50,11 +106,14 @@ static void slotKey(uint32_t idx, char* out, size_t outLen) {
   std::snprintf(out, outLen, "s%02lu", (unsigned long)idx);
 }
 
-static void persistMeta() {
+static void persistMeta(uint8_t l) {
   if (!prefReady) return;
-  pref.putUInt("h", storeHead);
-  pref.putUInt("t", storeTail);
-  pref.putUInt("c", storeCount);
+  const StoreLane& sl = lanes[l];
+  char key[4];
+  std::snprintf(key, sizeof(key), "h%u", (unsigned)l);
+  pref.putUInt(key, sl.head);
+  std::snprintf(key, sizeof(key), "c%u", (unsigned)l);
+  pref.putUInt(key, sl.persisted);
 }
 
 static void persistSlot(uint32_t idx, const RtosQueues::PublishMsg& msg) {
@@ -64,74 +123,266 @@ static void persistSlot(uint32_t idx, const RtosQueues::PublishMsg& msg) {
   pref.putBytes(key, &msg, sizeof(RtosQueues::PublishMsg));
 }
 
-static void resetStore() {
-  storeHead = 0;
-  storeTail = 0;
-  storeCount = 0;
-  persistMeta();
+static inline uint32_t laneSlot(const StoreLane& sl, uint32_t pos) {
+  return sl.base + (sl.head + pos) % sl.cap;
+}
+
+static void initLanes() {
+  uint32_t base = 0;
+  for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) {
+    StoreLane& sl = lanes[l];
+    sl.base = base;
+    sl.cap = PublishLanes::storeShare(MQTT_STORE_CAP, l);
+    base += sl.cap;
+    sl.inflight.setWindow(MQTT_INFLIGHT_WINDOW);
+    sl.inflight.setIdSpace(PublishLanes::idBase(l), PublishLanes::kIdSpan);
+  }
+}
+
+static void resetLane(uint8_t l) {
+  StoreLane& sl = lanes[l];
+  sl.head = 0;
+  sl.count = 0;
+  sl.persisted = 0;
+  sl.inflight.clear();
+  persistMeta(l);
+}
+
+// Erases a store namespace left behind by an older slot layout; its blobs would
+// otherwise sit in the NVS partition shared with nonce and mode persistence. The
+// read-only probe keeps an absent namespace from being created just to clear it.
+static void clearRetiredStore(const char* ns) {
+  Preferences old;
+  if (!old.begin(ns, true)) return;
+  old.end();
+  if (!old.begin(ns, false)) return;
+  if (old.clear()) Serial.printf("[MQTT] cleared retired store namespace %s\n", ns);
+  old.end();
 }
 
 static void loadStore() {
-  prefReady = pref.begin("eshmqv1", false);
-  if (!prefReady) {
-    resetStore();
-    return;
+  initLanes();
+  clearRetiredStore("eshmqv1");
+  clearRetiredStore("eshmqv2");
+  // v3: per-lane partitions and PublishMsg::queuedMs; v2 slots use a different layout.
+  prefReady = pref.begin("eshmqv3", false);
+
+  storeCount = 0;
+  const uint32_t nowMs = clockMs();
+  for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) {
+    StoreLane& sl = lanes[l];
+    if (!prefReady) {
+      resetLane(l);
+      continue;
+    }
+    char key[4];
+    std::snprintf(key, sizeof(key), "h%u", (unsigned)l);
+    sl.head = pref.getUInt(key, 0);
+    std::snprintf(key, sizeof(key), "c%u", (unsigned)l);
+    sl.count = pref.getUInt(key, 0);
+    if (sl.head >= sl.cap || sl.count > sl.cap) {
+      resetLane(l);
+      continue;
+    }
+
+    // Only occupied slots are read back; an empty store costs no slot reads.
+    for (uint32_t n = 0; n < sl.count; ++n) {
+      const uint32_t i = laneSlot(sl, n);
+      char slot[8];
+      slotKey(i, slot, sizeof(slot));
+      if (pref.getBytesLength(slot) == sizeof(RtosQueues::PublishMsg)) {
+        pref.getBytes(slot, &store[i], sizeof(RtosQueues::PublishMsg));
+      }
+      store[i].queuedMs = nowMs; // the saved time belongs to a previous boot
+    }
+    sl.persisted = sl.count;
+    storeCount += sl.count;
   }
+}
 
-  storeHead = pref.getUInt("h", 0);
-  storeTail = pref.getUInt("t", 0);
-  storeCount = pref.getUInt("c", 0);
+// Writes the not-yet-persisted tail of a lane to NVS.
+static void flushLane(uint8_t l) {
+  StoreLane& sl = lanes[l];
+  if (sl.persisted == sl.count) return;
+  for (uint32_t n = sl.persisted; n < sl.count; ++n) {
+    const uint32_t i = laneSlot(sl, n);
+    persistSlot(i, store[i]);
+  }
+  sl.persisted = sl.count;
+  persistMeta(l);
+}
+
+static void flushStore() {
+  for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) flushLane(l);
+}
 
-  if (storeHead >= MQTT_STORE_CAP || storeTail >= MQTT_STORE_CAP || storeCount > MQTT_STORE_CAP) {
-    resetStore();
+static StoreEviction::Candidate evictionCandidate(const RtosQueues::PublishMsg& msg,
+                                                  bool newerStatus,
+                                                  uint32_t nowMs) {
+  StoreEviction::Candidate c;
+  c.lane = RtosQueues::laneOf(msg);
+  c.ageMs = nowMs - msg.queuedMs;
+  // Every status is a full state snapshot; the boot profile is only in its own.
+  c.superseded = newerStatus && msg.kind == RtosQueues::PublishKind::status && !msg.bootProfile;
+  if (msg.e.type == EventType::door_tamper || msg.e.type == EventType::keypad_help_request) {
+    c.alarm = StoreEviction::AlarmKind::tamper_or_help;
+  } else if (msg.cmd.type == CommandType::buzzer_alert) {
+    c.alarm = StoreEviction::AlarmKind::alert;
   }
+  return c;
+}
 
-  for (uint32_t i = 0; i < MQTT_STORE_CAP; ++i) {
-    char key[8];
-    slotKey(i, key, sizeof(key));
-    if (pref.getBytesLength(key) == sizeof(RtosQueues::PublishMsg)) {
-      pref.getBytes(key, &store[i], sizeof(RtosQueues::PublishMsg));
-    }
+// A full lane makes room by evicting its least valuable entry that is not in flight
+// (counted in the lane's `evicted`); false if the incoming message is itself the
+// least valuable (counted in `drops`).
+static bool storeEvict(uint8_t l, const RtosQueues::PublishMsg& incoming, uint32_t nowMs) {
+  StoreLane& sl = lanes[l];
+  RtosQueues::PublishMsg* ring = store + sl.base;
+  const bool incomingStatus = incoming.kind == RtosQueues::PublishKind::status;
+  const int32_t victim = StoreEviction::pickVictim(
+    sl.inflight.count(),
+    sl.count,
+    [&](uint32_t pos) {
+      const bool newer = incomingStatus || pos + 1 < sl.count;
+      return evictionCandidate(ring[(sl.head + pos) % sl.cap], newer, nowMs);
+    },
+    evictionCandidate(incoming, false, nowMs));
+  if (victim < 0) return false;
+
+  StoreEviction::removeAt(ring, sl.cap, sl.head, sl.count, (uint32_t)victim);
+  --sl.count;
+  --storeCount;
+  ++gLaneStats[l].evicted;
+  // NVS slots from the gap on no longer match; they are rewritten on the next flush.
+  if (sl.persisted > (uint32_t)victim) {
+    sl.persisted = (uint32_t)victim;
+    persistMeta(l);
   }
+  return true;
 }
 
-static bool storePush(const RtosQueues::PublishMsg& msg) {
-  if (storeCount >= MQTT_STORE_CAP) return false;
-  store[storeTail] = msg;
-  persistSlot(storeTail, msg);
-  storeTail = (storeTail + 1) % MQTT_STORE_CAP;
+static bool storePush(uint8_t l, const RtosQueues::PublishMsg& msg, bool persist, uint32_t nowMs) {
+  StoreLane& sl = lanes[l];
+  if (sl.count >= sl.cap && !storeEvict(l, msg, nowMs)) return false;
+  store[laneSlot(sl, sl.count)] = msg;
+  ++sl.count;
   ++storeCount;
-  persistMeta();
+  if (persist) flushLane(l);
   return true;
 }
 
-static bool storePeek(RtosQueues::PublishMsg& out) {
-  if (storeCount == 0) return false;
-  out = store[storeHead];
+// Under overload only the newest state snapshot matters: a status replaces the newest
+// one still waiting in the store, unless that one is in flight or carries the boot
+// profile.
+static bool collapseStatus(uint8_t l, const RtosQueues::PublishMsg& msg) {
+  StoreLane& sl = lanes[l];
+  if (sl.count <= sl.inflight.count()) return false;
+  const uint32_t i = laneSlot(sl, sl.count - 1);
+  if (store[i].bootProfile) return false;
+  store[i] = msg;
+  if (sl.count <= sl.persisted) persistSlot(i, msg);
   return true;
 }
 
-static void storePop() {
-  if (storeCount == 0) return;
-  storeHead = (storeHead + 1) % MQTT_STORE_CAP;
+// Fill (live queue plus store partition) of the fullest lane, in percent.
+static uint8_t publishLoadPct() {
+  uint32_t worst = 0;
+  for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) {
+    const uint32_t cap = PublishLanes::queueDepth(l) + lanes[l].cap;
+    if (cap == 0) continue;
+    QueueHandle_t q = RtosQueues::mqttPubQ[l];
+    const uint32_t queued = q ? (uint32_t)uxQueueMessagesWaiting(q) : 0;
+    const uint32_t pct = (queued + lanes[l].count) * 100u / cap;
+    if (pct > worst) worst = pct;
+  }
+  return (uint8_t)(worst > 100 ? 100 : worst);
+}
+
+static void storePop(uint8_t l) {
+  StoreLane& sl = lanes[l];
+  if (sl.count == 0) return;
+  sl.head = (sl.head + 1) % sl.cap;
+  --sl.count;
   --storeCount;
-  persistMeta();
+  if (sl.persisted > 0) {
+    --sl.persisted;
+    persistMeta(l);
+  }
 }
 
-static bool publishMsg(const RtosQueues::PublishMsg& msg) {
+static bool publishMsg(const RtosQueues::PublishMsg& msg, const PublishQos& qos) {
   if (!gMqtt) return false;
   switch (msg.kind) {
     case RtosQueues::PublishKind::event:
-      return gMqtt->publishEvent(msg.e, msg.st, msg.cmd);
+      // Critical and event lanes drain out of order; only the event lane owns the
+      // retained copy, so an older ordinary event never replaces a newer retained one.
+      return gMqtt->publishEvent(msg.e, msg.st, msg.cmd, qos,
+                                 RtosQueues::laneOf(msg) == PublishLane::event);
     case RtosQueues::PublishKind::status:
-      return gMqtt->publishStatus(msg.st, msg.text1);
+      return gMqtt->publishStatus(msg.st, msg.text1, msg.bootProfile, msg.healthMask, qos);
     case RtosQueues::PublishKind::ack:
-      return gMqtt->publishAck(msg.text1, msg.ok, msg.text2);
+      return gMqtt->publishAck(msg.text1, msg.ok, msg.text2, qos);
     default:
       return false;
   }
 }
 
+static bool takeJournalRequest(uint32_t& fromMs, uint32_t& toMs, uint32_t& boot) {
+  portENTER_CRITICAL(&journalMux);
+  const bool pending = journalRequested;
+  journalRequested = false;
+  fromMs = journalFromMs;
+  toMs = journalToMs;
+  boot = journalBoot;
+  portEXIT_CRITICAL(&journalMux);
+  return pending;
+}
+
+// Runs inside gMqtt->update() on the MQTT task, like the command callback.
+static void onMqttAck(uint16_t packetId) {
+  const uint8_t l = PublishLanes::laneOfPacketId(packetId);
+  if (l < PublishLanes::kQueued) lanes[l].inflight.ack(packetId, clockMs());
+}
+
+static void publishMetricsNow();
+
+// Releases acked messages from each lane front, then hands out send slots by lane
+// priority/weight. Within a lane, retransmissions after a reconnect go first, then
+// new messages in order. Due metrics compete as the lowest lane.
+static void pumpStore(uint32_t nowMs, bool& metricsDue, uint32_t metricsDueMs) {
+  for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) {
+    for (uint8_t n = lanes[l].inflight.takeAcked(); n > 0; --n) storePop(l);
+  }
+
+  const uint8_t metricsLane = PublishLanes::index(PublishLane::metrics);
+  uint32_t burst = 0;
+  while (burst < MQTT_STORE_FLUSH_BURST) {
+    uint8_t ready = metricsDue ? (uint8_t)(1u << metricsLane) : 0;
+    for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) {
+      if (lanes[l].inflight.nextToSend(lanes[l].count) >= 0) ready |= (uint8_t)(1u << l);
+    }
+    const int8_t l = gScheduler.pick(ready);
+    if (l < 0) break;
+    ++burst;
+
+    if (l == metricsLane) {
+      metricsDue = false;
+      gLaneStats[metricsLane].addWait(nowMs - metricsDueMs);
+      publishMetricsNow();
+      continue;
+    }
+
+    StoreLane& sl = lanes[l];
+    const int16_t pos = sl.inflight.nextToSend(sl.count);
+    const RtosQueues::PublishMsg& msg = store[laneSlot(sl, (uint32_t)pos)];
+    PublishQos qos;
+    qos.packetId = sl.inflight.sent(pos, nowMs, qos.dup);
+    if (!qos.dup) gLaneStats[l].addWait(nowMs - msg.queuedMs);
+    // A failed write drops the link; the entry is resent after the reconnect.
+    if (!publishMsg(msg, qos)) break;
+  }
+}
+
 static void onMqttCommand(const String&, const String& payloadRaw) {
   if (!RtosQueues::mqttCmdQ) return;
   RtosQueues::CmdMsg msg{};
@@ -141,57 +392,130 @@ static void onMqttCommand(const String&, const String& payloadRaw) {
   }
 }
 
+static void publishMetricsNow() {
+  I2cBus* bus = gI2c;
+  I2cBus::Stats i2c;
+  if (bus) i2c = bus->stats(clockUs());
+
+  SamplingMeter::Report sampling;
+  portENTER_CRITICAL(&samplingMux);
+  const bool haveSampling = gSamplingValid;
+  sampling = gSampling;
+  portEXIT_CRITICAL(&samplingMux);
+
+  LaneStats laneStats[PublishLanes::kCount];
+  const InflightWindow* windows[PublishLanes::kQueued];
+  uint32_t pubDepth = 0;
+  for (uint8_t l = 0; l < PublishLanes::kCount; ++l) {
+    laneStats[l] = gLaneStats[l];
+    if (l >= PublishLanes::kQueued) continue;
+    windows[l] = &lanes[l].inflight;
+    laneStats[l].queued = RtosQueues::mqttPubQ[l] ? (uint32_t)uxQueueMessagesWaiting(RtosQueues::mqttPubQ[l]) : 0;
+    laneStats[l].stored = lanes[l].count;
+    laneStats[l].drops += gLaneQueueDrops[l];
+    pubDepth += laneStats[l].queued;
+  }
+
+  gMqtt->publishMetrics(
+    gSensorDrops,
+    gPubDrops,
+    gCmdDrops,
+    gStoreDrops,
+    gSensorDepth,
+    pubDepth,
+    RtosQueues::mqttCmdQ ? (uint32_t)uxQueueMessagesWaiting(RtosQueues::mqttCmdQ) : 0,
+    storeCount,
+    bus ? &i2c : nullptr,
+    windows,
+    PublishLanes::kQueued,
+    laneStats,
+    &gOverload,
+    haveSampling ? &sampling : nullptr
+  );
+}
+
 static void mqttTask(void*) {
   if (!gMqtt) vTaskDelete(nullptr);
 
-  loadStore();
+  // Start Wi-Fi association first; the store reload overlaps it.
   gMqtt->begin(onMqttCommand);
+  gMqtt->setAckCallback(onMqttAck);
+  gMqtt->update(clockMs());
+  loadStore();
 
   const TickType_t period = pdMS_TO_TICKS(10);
   TickType_t last = xTaskGetTickCount();
   uint32_t nextMetricsMs = 0;
+  bool metricsDue = false;
+  uint32_t metricsDueMs = 0;
+  EventJournal::Cursor journalCursor;
+  uint32_t journalChunk = 0;
+  bool journalActive = false;
+  bool linkUp = false;
+  uint32_t linkSession = 0;
 
   for (;;) {
-    const uint32_t nowMs = millis();
+    const uint32_t nowMs = clockMs();
     gMqtt->update(nowMs);
 
-    if (gMqtt->ready()) {
-      RtosQueues::PublishMsg msg{};
-      uint32_t burst = 0;
-      while (burst < MQTT_STORE_FLUSH_BURST && storePeek(msg)) {
-        if (!publishMsg(msg)) break;
-        storePop();
-        ++burst;
-      }
+    // Events, statuses and command acks all go through the store at QoS1 and leave it
+    // only once PUBACKed.
+    const bool up = gMqtt->ready();
+    if (linkUp && !up) flushStore();
+    linkUp = up;
+    // A new session (possibly reconnected within update()) never acks the old one's
+    // packets: everything in flight goes out again with DUP set.
+    if (gMqtt->sessions() != linkSession) {
+      linkSession = gMqtt->sessions();
+      for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) lanes[l].inflight.rewind();
     }
 
-    if (RtosQueues::mqttPubQ) {
+    if (gOverload.update(publishLoadPct(), nowMs)) {
+      Serial.printf("[MQTT] overload level=%s load=%u%%\n",
+                    OverloadController::name(gOverload.level()),
+                    (unsigned)gOverload.loadPct());
+      gMqtt->setDegradeLevel(gOverload.level());
+    }
+
+    // Critical messages are always moved in full; the other lanes share the burst in
+    // priority order.
+    const uint8_t statusLane = PublishLanes::index(PublishLane::status);
+    uint32_t burst = 0;
+    for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) {
+      QueueHandle_t q = RtosQueues::mqttPubQ[l];
+      if (!q) continue;
       RtosQueues::PublishMsg msg{};
-      uint32_t burst = 0;
-      while (burst < MQTT_PUB_DRAIN_BURST && xQueueReceive(RtosQueues::mqttPubQ, &msg, 0) == pdTRUE) {
-        if (gMqtt->ready() && storeCount == 0) {
-          if (!publishMsg(msg) && !storePush(msg)) {
-            ++gStoreDrops;
-          }
-        } else if (!storePush(msg)) {
+      while ((l == 0 || burst < MQTT_PUB_DRAIN_BURST) && xQueueReceive(q, &msg, 0) == pdTRUE) {
+        ++burst;
+        if (l == statusLane && gOverload.collapseStatus() && collapseStatus(l, msg)) {
+          gOverload.noteCollapsed();
+          continue;
+        }
+        if (!storePush(l, msg, !up, nowMs)) {
           ++gStoreDrops;
+          ++gLaneStats[l].drops;
         }
-        ++burst;
       }
     }
 
     if (reached(nowMs, nextMetricsMs)) {
       nextMetricsMs = nowMs + MQTT_METRICS_PERIOD_MS;
-      gMqtt->publishMetrics(
-        gSensorDrops,
-        gPubDrops,
-        gCmdDrops,
-        gStoreDrops,
-        gSensorDepth,
-        RtosQueues::mqttPubQ ? (uint32_t)uxQueueMessagesWaiting(RtosQueues::mqttPubQ) : 0,
-        RtosQueues::mqttCmdQ ? (uint32_t)uxQueueMessagesWaiting(RtosQueues::mqttCmdQ) : 0,
-        storeCount
-      );
+      if (!metricsDue) metricsDueMs = nowMs;
+      metricsDue = true;
+    }
+
+    if (up) pumpStore(nowMs, metricsDue, metricsDueMs);
+
+    uint32_t jFromMs = 0;
+    uint32_t jToMs = 0;
+    uint32_t jBoot = 0;
+    if (gJournal && takeJournalRequest(jFromMs, jToMs, jBoot)) {
+      journalActive = gJournal->openCursor(journalCursor, jFromMs, jToMs, jBoot);
+      journalChunk = 0;
+    }
+    // One chunk per cycle keeps alarm/status traffic flowing during a long dump.
+    if (journalActive && gMqtt->ready()) {
+      journalActive = gMqtt->pumpJournal(*gJournal, journalCursor, journalChunk);
     }
 
     gStoreDepth = storeCount;
@@ -210,7 +534,7 @@ static void chokepointTask(void*) {
 
   for (;;) {
     Event e;
-    const uint32_t nowMs = millis();
+    const uint32_t nowMs = clockMs();
     if (gChokepoint && gChokepoint->poll(nowMs, e)) {
       RtosQueues::ChokepointMsg msg{};
       msg.e = e;
@@ -224,6 +548,45 @@ static void chokepointTask(void*) {
   }
 }
 
+// Lowest priority on the network core: the display only gets idle time, and I2C
+// transfers (arbitrated with the keypad by I2cBus) never run inside tick().
+static void oledTask(void*) {
+  const TickType_t period = pdMS_TO_TICKS(1000 / OLED_MAX_FPS);
+  TickType_t last = xTaskGetTickCount();
+
+  for (;;) {
+    if (gOled) gOled->renderFrame(clockMs());
+    vTaskDelayUntil(&last, period);
+  }
+}
+
+// millis(), not clockMs(): the clock is a virtual call into flash, which an IRAM
+// ISR must not make (see Clock.h). Simulations have no keypad interrupt.
+static void IRAM_ATTR onKeypadInt() {
+  gKeypadEdgeMs = millis();
+  BaseType_t woken = pdFALSE;
+  if (hKeypad) vTaskNotifyGiveFromISR(hKeypad, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+// Sleeps until the PCF8574 INT edge; the timeout is a cheap one-read backstop for a
+// missed edge. Keys keep the edge timestamp, not the time the loop picks them up.
+static void keypadTask(void*) {
+  if (!gKeypad->beginIdleLow()) Serial.println("[KEYPAD] WARN: idle-low init failed");
+
+  for (;;) {
+    const bool edge = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(gKeypadBackstopMs)) > 0;
+    const uint32_t edgeMs = edge ? gKeypadEdgeMs : clockMs();
+    const char k = gKeypad->service(edgeMs, edge);
+    if (k) {
+      RtosQueues::KeypadMsg msg;
+      msg.key = k;
+      msg.tsMs = edgeMs;
+      xQueueSend(RtosQueues::keypadQ, &msg, 0);
+    }
+  }
+}
+
 void attachMqtt(MqttClient* client) {
   gMqtt = client;
 }
@@ -232,6 +595,23 @@ void attachChokepoint(ChokepointSensor* sensor) {
   gChokepoint = sensor;
 }
 
+void attachJournal(EventJournal* journal) {
+  gJournal = journal;
+}
+
+void attachOled(OledCodeUi* oled) {
+  gOled = oled;
+}
+
+void attachI2cBus(I2cBus* bus) {
+  gI2c = bus;
+}
+
+void attachKeypad(I2CKeypadDriver* keypad, uint8_t intPin) {
+  gKeypad = keypad;
+  gKeypadIntPin = intPin;
+}
+
 void startIfReady() {
   if (!RtosQueues::init()) return;
 
@@ -246,6 +626,20 @@ void startIfReady() {
       chokepointStarted = true;
     }
   }
+
+  if (gOled && !oledStarted) {
+    if (xTaskCreatePinnedToCore(oledTask, "Oled", 3072, nullptr, tskIDLE_PRIORITY, &hOled, 0) == pdPASS) {
+      oledStarted = true;
+    }
+  }
+
+  if (gKeypad && gKeypadIntPin != HwCfg::PIN_UNUSED && !keypadStarted) {
+    if (xTaskCreatePinnedToCore(keypadTask, "Keypad", 3072, nullptr, 2, &hKeypad, 0) == pdPASS) {
+      pinMode(gKeypadIntPin, INPUT_PULLUP);
+      attachInterrupt(digitalPinToInterrupt(gKeypadIntPin), onKeypadInt, FALLING);
+      keypadStarted = true;
+    }
+  }
 }
 
 bool mqttWorkerStarted() {
@@ -256,11 +650,30 @@ bool chokepointWorkerStarted() {
   return chokepointStarted;
 }
 
+bool oledWorkerStarted() {
+  return oledStarted;
+}
+
+bool keypadWorkerStarted() {
+  return keypadStarted;
+}
+
 void setSensorTelemetry(uint32_t drops, uint32_t depth) {
   gSensorDrops = drops;
   gSensorDepth = depth;
 }
 
+void setSamplingReport(const SamplingMeter::Report& report) {
+  portENTER_CRITICAL(&samplingMux);
+  gSampling = report;
+  gSamplingValid = true;
+  portEXIT_CRITICAL(&samplingMux);
+}
+
+void setKeypadBackstopMs(uint32_t ms) {
+  if (ms) gKeypadBackstopMs = ms;
+}
+
 Stats stats() {
   Stats s{};
   s.pubDrops = gPubDrops;
@@ -274,14 +687,25 @@ Stats stats() {
 }
 
 bool enqueuePublish(const RtosQueues::PublishMsg& msg) {
-  if (!RtosQueues::mqttPubQ) return false;
-  if (xQueueSend(RtosQueues::mqttPubQ, &msg, 0) != pdTRUE) {
+  const uint8_t l = PublishLanes::index(RtosQueues::laneOf(msg));
+  QueueHandle_t q = RtosQueues::mqttPubQ[l];
+  if (!q) return false;
+  // Shed ordinary events under heavy overload; they are still in the event journal.
+  if (l == PublishLanes::index(PublishLane::event) && !gOverload.admitEvent()) return false;
+  RtosQueues::PublishMsg m = msg;
+  m.queuedMs = clockMs();
+  if (xQueueSend(q, &m, 0) != pdTRUE) {
     ++gPubDrops;
+    ++gLaneQueueDrops[l];
     return false;
   }
   return true;
 }
 
+DegradeLevel degradeLevel() {
+  return gOverload.level();
+}
+
 bool dequeueCommand(RtosQueues::CmdMsg& out) {
   if (!RtosQueues::mqttCmdQ) return false;
   return xQueueReceive(RtosQueues::mqttCmdQ, &out, 0) == pdTRUE;
@@ -292,4 +716,20 @@ bool dequeueChokepoint(RtosQueues::ChokepointMsg& out) {
   return xQueueReceive(RtosQueues::chokepointQ, &out, 0) == pdTRUE;
 }
 
+bool dequeueKeypad(RtosQueues::KeypadMsg& out) {
+  if (!RtosQueues::keypadQ) return false;
+  return xQueueReceive(RtosQueues::keypadQ, &out, 0) == pdTRUE;
+}
+
+bool requestJournal(uint32_t fromMs, uint32_t toMs, uint32_t boot) {
+  if (!gJournal || !gJournal->ready()) return false;
+  portENTER_CRITICAL(&journalMux);
+  journalFromMs = fromMs;
+  journalToMs = toMs;
+  journalBoot = boot;
+  journalRequested = true;
+  portEXIT_CRITICAL(&journalMux);
+  return true;
+}
+
 } // namespace RtosTasks
@@ -2,10 +2,16 @@
 
 #include <Arduino.h>
 
+#include "app/OverloadControl.h"
+#include "app/SamplingPolicy.h"
+#include "drivers/I2CKeypadDriver.h"
+#include "drivers/I2cBus.h"
 #include "drivers/UltrasonicDriver.h"
 #include "rtos/Queues.h"
 #include "sensors/ChokepointSensor.h"
+#include "services/EventJournal.h"
 #include "services/MqttClient.h"
+#include "ui/OledCodeUi.h"
 
 namespace RtosTasks {
 
@@ -21,15 +27,30 @@ struct Stats {
 
 void attachMqtt(MqttClient* client);
 void attachChokepoint(ChokepointSensor* sensor);
+void attachJournal(EventJournal* journal);
+void attachOled(OledCodeUi* oled);
+void attachI2cBus(I2cBus* bus);
+// intPin: PCF8574 INT line; the worker only starts when it is wired.
+void attachKeypad(I2CKeypadDriver* keypad, uint8_t intPin);
 void startIfReady();
 bool mqttWorkerStarted();
 bool chokepointWorkerStarted();
+bool oledWorkerStarted();
+bool keypadWorkerStarted();
 
 void setSensorTelemetry(uint32_t drops, uint32_t depth);
+// Latest sampling report, published with the next metrics.
+void setSamplingReport(const SamplingMeter::Report& report);
+// INT keypad worker: timeout of the backstop read (SamplingPolicy).
+void setKeypadBackstopMs(uint32_t ms);
 Stats stats();
 
 bool enqueuePublish(const RtosQueues::PublishMsg& msg);
+// Current publish overload degradation (set by the MQTT task).
+DegradeLevel degradeLevel();
 bool dequeueCommand(RtosQueues::CmdMsg& out);
 bool dequeueChokepoint(RtosQueues::ChokepointMsg& out);
+bool dequeueKeypad(RtosQueues::KeypadMsg& out);
+bool requestJournal(uint32_t fromMs, uint32_t toMs, uint32_t boot);
 
 } // namespace RtosTasks
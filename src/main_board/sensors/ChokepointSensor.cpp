@@ -6,6 +6,9 @@ inline bool reached(uint32_t nowMs, uint32_t targetMs) {
 }
 } // namespace
 
+ChokepointSensor::ChokepointSensor()
+: ChokepointSensor(nullptr, 0) {}
+
 ChokepointSensor::ChokepointSensor(UltrasonicDriver* drv, uint8_t id,
                                    int near_cm, int far_cm,
                                    uint32_t sample_period_ms, uint32_t cooldown_ms)
@@ -34,10 +37,21 @@ void ChokepointSensor::begin() {
   seen_valid_once_ = false;
 }
 
+void ChokepointSensor::attachHealth(SensorHealth* health, uint8_t slot) {
+  health_ = health;
+  health_slot_ = slot;
+}
+
 int ChokepointSensor::lastCm() const {
   return last_cm_;
 }
 
+void ChokepointSensor::setSamplePeriodMs(uint32_t ms) {
+  if (ms == 0 || ms == sample_period_ms_) return;
+  if (ms < sample_period_ms_) next_sample_ms_ = 0;
+  sample_period_ms_ = ms;
+}
+
 bool ChokepointSensor::poll(uint32_t nowMs, Event& out) {
   if (!drv_) return false;
   if (next_sample_ms_ != 0 && !reached(nowMs, next_sample_ms_)) return false;
@@ -46,7 +60,9 @@ bool ChokepointSensor::poll(uint32_t nowMs, Event& out) {
 
   int cm = drv_->readCm();
   last_cm_ = cm;
+  ++samples_;
 
+  if (health_) health_->onEcho(health_slot_, cm >= 0, nowMs);
   if (cm < 0) {
     if (consecutive_no_echo_ < 0xFFFFu) consecutive_no_echo_++;
     return false;
@@ -75,15 +91,6 @@ bool ChokepointSensor::poll(uint32_t nowMs, Event& out) {
   return false;
 }
 
-bool ChokepointSensor::isOffline(uint32_t nowMs, uint32_t noValidMs, uint16_t noEchoCount) const {
-  if (!seen_valid_once_) return false;
-  const bool noEchoTooMany = (noEchoCount > 0 && consecutive_no_echo_ >= noEchoCount);
-  if (noValidMs == 0) return noEchoTooMany;
-
-  const bool noValidTooLong = (int32_t)(nowMs - (last_valid_ms_ + noValidMs)) >= 0;
-  return noEchoTooMany || noValidTooLong;
-}
-
 uint16_t ChokepointSensor::consecutiveNoEcho() const {
   return consecutive_no_echo_;
 }
@@ -1,10 +1,12 @@
 #pragma once
 #include <Arduino.h>
 #include "app/Events.h"
+#include "app/SensorHealth.h"
 #include "drivers/UltrasonicDriver.h"
 
 class ChokepointSensor {
 public:
+  ChokepointSensor(); // no driver until assigned
   ChokepointSensor(UltrasonicDriver* drv, uint8_t id,
                    int near_cm = 35,
                    int far_cm = 55,
@@ -15,7 +17,14 @@ public:
   bool poll(uint32_t nowMs, Event& out);
 
   int lastCm() const;
-  bool isOffline(uint32_t nowMs, uint32_t noValidMs, uint16_t noEchoCount) const;
+  // Runtime sample period (SamplingPolicy); a shorter period takes effect at once.
+  // Not synchronized: call it from the task that polls (the loop, through
+  // EventCollector::applySampling and pollSensorOrSerial).
+  void setSamplePeriodMs(uint32_t ms);
+  uint32_t samplePeriodMs() const { return sample_period_ms_; }
+  uint32_t samples() const { return samples_; }
+  // Every sample (echo or miss) is reported to the health engine (offline tracking).
+  void attachHealth(SensorHealth* health, uint8_t slot);
   uint16_t consecutiveNoEcho() const;
   uint32_t lastValidMs() const;
 
@@ -36,4 +45,8 @@ private:
   uint16_t consecutive_no_echo_;
   uint32_t last_valid_ms_;
   bool seen_valid_once_;
+  uint32_t samples_ = 0;
+
+  SensorHealth* health_ = nullptr;
+  uint8_t health_slot_ = 0;
 };
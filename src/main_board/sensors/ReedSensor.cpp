@@ -1,65 +0,0 @@
-#include "ReedSensor.h"
-#include "app/HardwareConfig.h"
-
-ReedSensor::ReedSensor(uint8_t pin, uint8_t id, EventType open_event, bool open_is_high, uint32_t debounce_ms)
-: pin_(pin),
-  id_(id),
-  open_event_(open_event),
-  open_is_high_(open_is_high),
-  debounce_ms_(debounce_ms),
-  stable_open_(false),
-  last_raw_(false),
-  last_flip_ms_(0),
-  fired_open_(false)
-{}
-
-void ReedSensor::begin() {
-  if (pin_ == HwCfg::PIN_UNUSED) {
-    stable_open_ = false;
-    last_raw_ = false;
-    last_flip_ms_ = millis();
-    fired_open_ = false;
-    return;
-  }
-  pinMode(pin_, INPUT_PULLUP);
-  stable_open_ = readOpenRaw_();
-  last_raw_ = stable_open_;
-  last_flip_ms_ = millis();
-  fired_open_ = false;
-}
-
-bool ReedSensor::poll(uint32_t nowMs, Event& out) {
-  if (pin_ == HwCfg::PIN_UNUSED) return false;
-  bool raw = readOpenRaw_();
-
-  if (raw != last_raw_) {
-    last_raw_ = raw;
-    last_flip_ms_ = nowMs;
-  }
-
-  if ((nowMs - last_flip_ms_) < debounce_ms_) return false;
-
-  if (stable_open_ != raw) {
-    stable_open_ = raw;
-    if (stable_open_) fired_open_ = false;
-  }
-
-  if (stable_open_ && !fired_open_) {
-    fired_open_ = true;
-    out = {open_event_, nowMs, id_};
-    return true;
-  }
-
-  return false;
-}
-
-bool ReedSensor::isOpen() const {
-  return stable_open_;
-}
-
-bool ReedSensor::readOpenRaw_() const {
-  if (pin_ == HwCfg::PIN_UNUSED) return false;
-  int v = digitalRead(pin_);
-  bool high = (v == HIGH);
-  return open_is_high_ ? high : !high;
-}
@@ -0,0 +1,83 @@
+#include "SensorBank.h"
+#include "app/HardwareConfig.h"
+#include "drivers/GpioSnapshot.h"
+
+void SensorBank::begin(const SensorDef* defs, uint8_t count, uint32_t nowMs) {
+  defs_ = defs;
+  count_ = (count > SensorRegistry::kMaxSensors) ? SensorRegistry::kMaxSensors : count;
+  map_ = InputMap();
+  edges_ = EdgeTracker();
+  contacts_ = 0;
+  pending_ = 0;
+
+  for (uint8_t i = 0; i < count_; ++i) {
+    const SensorDef& d = defs_[i];
+    if (!SensorRegistry::isLevelInput(d.kind) || d.pin == HwCfg::PIN_UNUSED) continue;
+    if (!map_.add(i, d.pin)) continue;
+    // PIR modules drive the line; contacts and vibration switches need the pull-up.
+    pinMode(d.pin, (d.kind == SensorKind::pir) ? INPUT : INPUT_PULLUP);
+    if (d.kind == SensorKind::door_contact || d.kind == SensorKind::window_contact) {
+      contacts_ |= (uint32_t)1u << i;
+      edges_.setHold(i, d.holdMs);
+    }
+    fireMs_[i] = 0;
+  }
+
+  // A contact already open at boot reports once it has been stable for its hold time.
+  const uint32_t level = map_.gather(GpioSnapshot::read());
+  edges_.reset(level, nowMs, contacts_);
+
+  // A channel that boots active is not "stuck" until it has been seen inactive once
+  // (floating/high at boot); the health engine applies that rule.
+  if (health_) {
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (contacts_ & ((uint32_t)1u << i)) continue;
+      health_->onLevel(i, (level >> i) & 1u, nowMs);
+    }
+  }
+}
+
+void SensorBank::queue_(uint32_t slots, uint32_t nowMs) {
+  pending_ |= slots;
+  while (slots) {
+    pendingMs_[InputSnapshot::lowestBit(slots)] = nowMs;
+    slots &= slots - 1u;
+  }
+}
+
+void SensorBank::update(uint32_t nowMs, uint64_t gpio) {
+  const EdgeTracker::Step s = edges_.update(map_.gather(gpio), nowMs);
+
+  // Contacts report the debounced open.
+  if (s.settledRose & contacts_) queue_(s.settledRose & contacts_, nowMs);
+
+  // PIR/vibration: raw edges go to health; rising edges fire outside the cooldown.
+  uint32_t m = (s.rose | s.fell) & ~contacts_;
+  while (m) {
+    const uint8_t i = InputSnapshot::lowestBit(m);
+    const uint32_t b = (uint32_t)1u << i;
+    m &= m - 1u;
+    const bool active = (s.rose & b) != 0;
+    if (health_) health_->onLevel(i, active, nowMs);
+    if (!active || (counted_ & b) || (nowMs - fireMs_[i]) < defs_[i].holdMs) continue;
+    fireMs_[i] = nowMs;
+    queue_(b, nowMs);
+  }
+}
+
+bool SensorBank::next(Event& out) {
+  if (!pending_) return false;
+  const uint8_t i = InputSnapshot::lowestBit(pending_);
+  pending_ &= pending_ - 1u;
+  const SensorDef& d = defs_[i];
+  out = {SensorRegistry::eventFor(d.kind), pendingMs_[i], d.id, d.zone};
+  return true;
+}
+
+bool SensorBank::isOpen(SensorKind contact) const {
+  for (uint8_t i = 0; i < count_; ++i) {
+    const uint32_t b = (uint32_t)1u << i;
+    if (defs_[i].kind == contact && (contacts_ & b)) return (edges_.stable() & b) != 0;
+  }
+  return false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <Arduino.h>
+#include "app/Events.h"
+#include "app/InputSnapshot.h"
+#include "app/SensorHealth.h"
+#include "app/SensorRegistry.h"
+
+// All digital sensor rows of the registry (contacts, PIR, vibration) handled in one
+// pass over a GPIO snapshot. State is kept per field across sensors -- one bitmask
+// or array per field, bit/index = registry slot -- so an idle pass is a gather plus
+// a few mask operations no matter how many inputs are wired.
+//
+// Every level input reads HIGH when active (contact open, PIR motion, vibration
+// switch open under pull-up). Events found in the same pass are queued and handed
+// out one per next(), lowest slot first.
+class SensorBank {
+public:
+  void begin(const SensorDef* defs, uint8_t count, uint32_t nowMs);
+  // Level changes are reported to the health engine under the registry slot.
+  void attachHealth(SensorHealth* health) { health_ = health; }
+  // Feeds this tick's GpioSnapshot::read(); every call advances edges and debounce.
+  void update(uint32_t nowMs, uint64_t gpio);
+  // Next queued event, if any.
+  bool next(Event& out);
+  // Slots whose events come from a pulse counter instead of level edges; their edges
+  // still feed the health engine.
+  void setPulseCounted(uint32_t slots) { counted_ = slots; }
+
+  // Raw level of every row as of the last update(), bit = registry slot.
+  uint32_t levels() const { return edges_.raw(); }
+
+  // Debounced state of the first contact of that kind; false if none is wired.
+  bool isOpen(SensorKind contact) const;
+
+private:
+  const SensorDef* defs_ = nullptr;
+  uint8_t count_ = 0;
+  SensorHealth* health_ = nullptr;
+
+  InputMap map_;
+  EdgeTracker edges_;
+  uint32_t contacts_ = 0; // debounced open/close rows
+  uint32_t pending_ = 0;  // events waiting for poll()
+  uint32_t counted_ = 0;  // events reported by EventCollector's pulse counters
+
+  uint32_t fireMs_[SensorRegistry::kMaxSensors] = {};    // last event (cooldown)
+  uint32_t pendingMs_[SensorRegistry::kMaxSensors] = {}; // queued event time
+
+  void queue_(uint32_t slots, uint32_t nowMs);
+};
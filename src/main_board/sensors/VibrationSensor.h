@@ -1,23 +0,0 @@
-#pragma once
-#include <Arduino.h>
-#include "app/Events.h"
-
-class VibrationSensor {
-public:
-  // Vibration switch wired to GND (NC) with pull-up on the input.
-  // A "spike" is detected on a LOW->HIGH transition (brief open circuit) with cooldown.
-  VibrationSensor(uint8_t pin, uint8_t id, uint32_t cooldown_ms = 500);
-
-  void begin();
-  bool poll(uint32_t nowMs, Event& out);
-  bool isStuckActive(uint32_t nowMs, uint32_t thresholdMs) const;
-
-private:
-  uint8_t pin_;
-  uint8_t id_;
-  uint32_t cooldown_ms_;
-  uint32_t last_fire_ms_;
-  bool last_active_;
-  uint32_t active_since_ms_ = 0;
-  bool seen_inactive_since_begin_ = false;
-};
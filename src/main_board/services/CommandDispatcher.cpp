@@ -20,10 +20,11 @@ void applyCommand(const Command& cmd, const SystemState& st, Actuators& acts, No
     if (acts.servo1) acts.servo1->lock();
     if (acts.servo2) acts.servo2->lock();
   }
-
+
   switch (cmd.type) {
     case CommandType::buzzer_warn:
-      if (acts.buzzer) acts.buzzer->warn();
+      // An entry delay gets the countdown tick until disarm or the alarm preempts it.
+      if (acts.buzzer) acts.buzzer->play(st.entry_pending ? BuzzerPattern::entry_countdown : BuzzerPattern::warn);
       break;
 
     case CommandType::buzzer_alert:
@@ -39,6 +40,6 @@ void applyCommand(const Command& cmd, const SystemState& st, Actuators& acts, No
     default:
       break;
   }
-
+
   if (logger) logger->logCommand(cmd, st);
 }
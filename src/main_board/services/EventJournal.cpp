@@ -0,0 +1,242 @@
+#include "services/EventJournal.h"
+
+#include <cstring>
+
+namespace {
+// ESP32 SPI flash erase granularity.
+constexpr uint32_t kFlashSectorBytes = 4096;
+constexpr size_t kReadWindowBytes = 64;
+
+using JournalCodec::Decoder;
+using JournalCodec::Record;
+
+template <typename Fn>
+uint32_t walkSector(const esp_partition_t* part,
+                    uint32_t sectorBase,
+                    uint32_t sectorBytes,
+                    uint32_t offset,
+                    Decoder& dec,
+                    bool& clean,
+                    Fn&& onRecord) {
+  clean = true;
+  uint8_t buf[kReadWindowBytes];
+  while (offset < sectorBytes) {
+    const size_t n = (sectorBytes - offset) < sizeof(buf) ? (size_t)(sectorBytes - offset) : sizeof(buf);
+    if (esp_partition_read(part, sectorBase + offset, buf, n) != ESP_OK) {
+      clean = false;
+      return offset;
+    }
+
+    size_t pos = 0;
+    for (;;) {
+      const size_t start = pos;
+      Record rec;
+      const Decoder::Result r = dec.next(buf, n, pos, rec);
+      if (r == Decoder::Result::record || r == Decoder::Result::boot) {
+        if (!onRecord(r, rec)) return offset + (uint32_t)pos;
+        continue;
+      }
+      if (r == Decoder::Result::end) return offset + (uint32_t)start;
+      if (r == Decoder::Result::truncated && start > 0) break;
+      // Corrupt tag or a record that cannot fit a full window: damaged tail (e.g. power cut mid-write).
+      clean = false;
+      return offset + (uint32_t)start;
+    }
+    offset += (uint32_t)pos;
+  }
+  return offset;
+}
+} // namespace
+
+bool EventJournal::begin(uint32_t nowMs) {
+  part_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "journal");
+  if (!part_) {
+    Serial.println("[JOURNAL] WARN: no 'journal' partition; event journal disabled");
+    return false;
+  }
+
+  sectorBytes_ = kFlashSectorBytes;
+  sectorCount_ = (uint16_t)(part_->size / sectorBytes_);
+  if (sectorCount_ < 2) {
+    Serial.println("[JOURNAL] WARN: journal partition too small; event journal disabled");
+    part_ = nullptr;
+    return false;
+  }
+
+  bool found = false;
+  for (uint16_t i = 0; i < sectorCount_; ++i) {
+    uint32_t seq = 0;
+    if (!readHeader_(i, seq)) continue;
+    if (!found || (int32_t)(seq - headSeq_) > 0) {
+      found = true;
+      headSeq_ = seq;
+      headSector_ = i;
+    }
+  }
+
+  if (!found) {
+    boot_ = 1;
+    if (!openSector_(0, 1, nowMs)) {
+      part_ = nullptr;
+      return false;
+    }
+  } else {
+    uint32_t maxBoot = 0;
+    headOffset_ = scanSector_(headSector_, maxBoot);
+    boot_ = maxBoot + 1;
+
+    uint8_t buf[JournalCodec::kMaxRecordBytes];
+    const size_t n = JournalCodec::encodeBoot(buf, boot_, nowMs);
+    lastTsMs_ = nowMs;
+    if (headOffset_ == 0 || headOffset_ + n > sectorBytes_ || !write_(buf, n)) {
+      if (!openSector_((uint16_t)((headSector_ + 1u) % sectorCount_), headSeq_ + 1u, nowMs)) {
+        part_ = nullptr;
+        return false;
+      }
+    }
+  }
+
+  Serial.printf("[JOURNAL] ready boot=%lu sectors=%u head=%u off=%lu\n",
+                (unsigned long)boot_,
+                (unsigned)sectorCount_,
+                (unsigned)headSector_,
+                (unsigned long)headOffset_);
+  return true;
+}
+
+bool EventJournal::ready() const {
+  return part_ != nullptr;
+}
+
+void EventJournal::append(const Event& e, int16_t scoreDelta, AlarmLevel level) {
+  if (!part_) return;
+
+  Record r;
+  r.boot = boot_;
+  r.ts_ms = e.ts_ms;
+  r.type = e.type;
+  r.src = e.src;
+  r.score_delta = scoreDelta;
+  r.level = level;
+  // Events from worker queues can arrive slightly out of order; keep deltas non-negative.
+  if ((int32_t)(r.ts_ms - lastTsMs_) < 0) r.ts_ms = lastTsMs_;
+
+  uint8_t buf[JournalCodec::kMaxRecordBytes];
+  size_t n = JournalCodec::encodeEvent(buf, r, lastTsMs_);
+  if (headOffset_ + n > sectorBytes_) {
+    if (!openSector_((uint16_t)((headSector_ + 1u) % sectorCount_), headSeq_ + 1u, r.ts_ms)) return;
+    n = JournalCodec::encodeEvent(buf, r, lastTsMs_);
+  }
+  if (write_(buf, n)) lastTsMs_ = r.ts_ms;
+}
+
+bool EventJournal::openCursor(Cursor& c, uint32_t fromMs, uint32_t toMs, uint32_t boot) const {
+  c = Cursor{};
+  if (!part_) return false;
+
+  bool found = false;
+  for (uint16_t i = 0; i < sectorCount_; ++i) {
+    uint32_t seq = 0;
+    if (!readHeader_(i, seq)) continue;
+    if (!found || (int32_t)(seq - c.nextSeq) < 0) {
+      found = true;
+      c.nextSeq = seq;
+      c.sector = i;
+    }
+  }
+  if (!found) return false;
+
+  c.fromMs = fromMs;
+  c.toMs = toMs;
+  c.boot = boot;
+  c.sectorsLeft = sectorCount_;
+  c.offset = kHeaderBytes;
+  c.done = false;
+  return true;
+}
+
+size_t EventJournal::read(Cursor& c, Record* out, size_t maxOut) const {
+  size_t count = 0;
+  if (!part_ || !out) {
+    c.done = true;
+    return 0;
+  }
+
+  while (!c.done && count < maxOut) {
+    if (c.offset == kHeaderBytes) {
+      uint32_t seq = 0;
+      if (c.sectorsLeft == 0 || !readHeader_(c.sector, seq) || seq != c.nextSeq) {
+        c.done = true;
+        break;
+      }
+      c.dec.reset();
+    }
+
+    bool clean = true;
+    const uint32_t stop = walkSector(part_, (uint32_t)c.sector * sectorBytes_, sectorBytes_, c.offset, c.dec, clean,
+      [&](Decoder::Result r, const Record& rec) {
+        if (r != Decoder::Result::record) return true;
+        if (c.boot != 0 && rec.boot != c.boot) return true;
+        if (rec.ts_ms >= c.fromMs && rec.ts_ms <= c.toMs) out[count++] = rec;
+        return count < maxOut;
+      });
+
+    if (count >= maxOut && clean && stop < sectorBytes_) {
+      c.offset = stop;
+      break;
+    }
+
+    c.sector = (uint16_t)((c.sector + 1u) % sectorCount_);
+    c.nextSeq++;
+    c.sectorsLeft--;
+    c.offset = kHeaderBytes;
+  }
+  return count;
+}
+
+bool EventJournal::readHeader_(uint16_t sector, uint32_t& seq) const {
+  uint32_t hdr[2] = {0, 0};
+  if (esp_partition_read(part_, (uint32_t)sector * sectorBytes_, hdr, sizeof(hdr)) != ESP_OK) return false;
+  if (hdr[0] != kMagic) return false;
+  seq = hdr[1];
+  return true;
+}
+
+bool EventJournal::openSector_(uint16_t sector, uint32_t seq, uint32_t nowMs) {
+  const uint32_t base = (uint32_t)sector * sectorBytes_;
+  if (esp_partition_erase_range(part_, base, sectorBytes_) != ESP_OK) {
+    Serial.println("[JOURNAL] WARN: sector erase failed");
+    return false;
+  }
+  const uint32_t hdr[2] = {kMagic, seq};
+  if (esp_partition_write(part_, base, hdr, sizeof(hdr)) != ESP_OK) return false;
+
+  headSector_ = sector;
+  headSeq_ = seq;
+  headOffset_ = kHeaderBytes;
+  lastTsMs_ = nowMs;
+
+  uint8_t buf[JournalCodec::kMaxRecordBytes];
+  const size_t n = JournalCodec::encodeBoot(buf, boot_, nowMs);
+  return write_(buf, n);
+}
+
+uint32_t EventJournal::scanSector_(uint16_t sector, uint32_t& maxBoot) const {
+  maxBoot = 0;
+  Decoder dec;
+  bool clean = true;
+  const uint32_t stop = walkSector(part_, (uint32_t)sector * sectorBytes_, sectorBytes_, kHeaderBytes, dec, clean,
+    [&](Decoder::Result r, const Record&) {
+      if (r == Decoder::Result::boot && dec.boot() > maxBoot) maxBoot = dec.boot();
+      return true;
+    });
+  // A damaged tail cannot be appended to in place (flash bits only clear); 0 forces a rotate.
+  return clean ? stop : 0;
+}
+
+bool EventJournal::write_(const uint8_t* data, size_t len) {
+  const uint32_t addr = (uint32_t)headSector_ * sectorBytes_ + headOffset_;
+  if (esp_partition_write(part_, addr, data, len) != ESP_OK) return false;
+  headOffset_ += (uint32_t)len;
+  return true;
+}
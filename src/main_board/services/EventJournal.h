@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+#include "app/Events.h"
+#include "app/JournalCodec.h"
+#include "app/SystemState.h"
+
+// Append-only event journal kept in a dedicated flash partition ("journal").
+// The partition is used as a ring of erase sectors; each sector starts with a small
+// header (magic + sequence) followed by a boot marker and varint-coded records.
+// Appends run on the security loop; readers (MQTT streaming) only need a Cursor.
+//
+// Rotating to a new sector erases it inline, which holds the loop for a sector erase
+// (typically 30-50 ms) about once per 800 records. That is an accepted cost: the
+// ESP32 parks the other core while flash is erased, so handing the erase to another
+// task would not let the loop run meanwhile, and a spare erased ahead would cost a
+// sector of history. Deadlines are time-based, so an erase delays them, never skips.
+class EventJournal {
+public:
+  struct Cursor {
+    uint32_t fromMs = 0;
+    uint32_t toMs = 0xFFFFFFFFu;
+    uint32_t boot = 0; // 0 = any boot; timestamps restart at every boot
+    uint32_t nextSeq = 0;
+    uint16_t sectorsLeft = 0;
+    uint16_t sector = 0;
+    uint32_t offset = 0;
+    JournalCodec::Decoder dec;
+    bool done = true;
+  };
+
+  bool begin(uint32_t nowMs);
+  bool ready() const;
+  void append(const Event& e, int16_t scoreDelta, AlarmLevel level);
+
+  bool openCursor(Cursor& c, uint32_t fromMs, uint32_t toMs, uint32_t boot) const;
+  // Fills up to maxOut matching records; returns how many were written. c.done marks the end.
+  size_t read(Cursor& c, JournalCodec::Record* out, size_t maxOut) const;
+
+  uint32_t bootId() const { return boot_; }
+
+private:
+  static constexpr uint32_t kMagic = 0x314A4845u; // "EHJ1"
+  static constexpr uint32_t kHeaderBytes = 8;
+
+  const esp_partition_t* part_ = nullptr;
+  uint32_t sectorBytes_ = 0;
+  uint16_t sectorCount_ = 0;
+
+  uint16_t headSector_ = 0;
+  uint32_t headSeq_ = 0;
+  uint32_t headOffset_ = 0;
+  uint32_t boot_ = 0;
+  uint32_t lastTsMs_ = 0;
+
+  bool readHeader_(uint16_t sector, uint32_t& seq) const;
+  bool openSector_(uint16_t sector, uint32_t seq, uint32_t nowMs);
+  uint32_t scanSector_(uint16_t sector, uint32_t& maxBoot) const;
+  bool write_(const uint8_t* data, size_t len);
+};
@@ -2,6 +2,7 @@
 
 #include <cstring>
 
+#include "app/Clock.h"
 #include "rtos/Queues.h"
 #include "rtos/Tasks.h"
 #include "services/MqttClient.h"
@@ -10,6 +11,10 @@ namespace {
 MqttClient gClient;
 String gPendingCmd;
 bool gHasPendingCmd = false;
+EventJournal* gJournal = nullptr;
+EventJournal::Cursor gJournalCursor;
+uint32_t gJournalChunk = 0;
+bool gJournalActive = false;
 
 void onDirectCommand(const String&, const String& payload) {
   gPendingCmd = payload;
@@ -29,33 +34,45 @@ void MqttBus::begin() {
 
   Serial.println("[MQTTBUS] mode=direct (RTOS worker unavailable)");
   gClient.begin(onDirectCommand);
+  // Kick off Wi-Fi association now so it overlaps the rest of boot.
+  gClient.update(clockMs());
 }
 
 void MqttBus::update(uint32_t nowMs) {
-  if (!useRtos_) gClient.update(nowMs);
+  if (useRtos_) return;
+  gClient.update(nowMs);
+  if (gJournalActive && gJournal && gClient.ready()) {
+    gJournalActive = gClient.pumpJournal(*gJournal, gJournalCursor, gJournalChunk);
+  }
 }
 
 void MqttBus::publishEvent(const Event& e, const SystemState& st, const Command& cmd) {
   if (!useRtos_) {
-    gClient.publishEvent(e, st, cmd);
+    gClient.publishEvent(e, PackedSystemState::from(st), cmd);
     return;
   }
   RtosQueues::PublishMsg msg{};
   msg.kind = RtosQueues::PublishKind::event;
   msg.e = e;
-  msg.st = st;
+  msg.st = PackedSystemState::from(st);
   msg.cmd = cmd;
   RtosTasks::enqueuePublish(msg);
 }
 
-void MqttBus::publishStatus(const SystemState& st, const char* reason) {
+void MqttBus::publishStatus(const SystemState& st,
+                            const char* reason,
+                            uint32_t sensorFaults,
+                            const BootProfile* boot) {
+  if (boot) gClient.setBootProfile(boot);
   if (!useRtos_) {
-    gClient.publishStatus(st, reason);
+    gClient.publishStatus(PackedSystemState::from(st), reason, boot != nullptr, sensorFaults);
     return;
   }
   RtosQueues::PublishMsg msg{};
   msg.kind = RtosQueues::PublishKind::status;
-  msg.st = st;
+  msg.st = PackedSystemState::from(st);
+  msg.bootProfile = (boot != nullptr);
+  msg.healthMask = sensorFaults;
   if (reason) {
     std::strncpy(msg.text1, reason, sizeof(msg.text1) - 1);
     msg.text1[sizeof(msg.text1) - 1] = '\0';
@@ -96,11 +113,29 @@ bool MqttBus::pollCommand(String& outPayload) {
   return true;
 }
 
+void MqttBus::attachJournal(EventJournal* journal) {
+  gJournal = journal;
+  RtosTasks::attachJournal(journal);
+}
+
+bool MqttBus::requestJournal(uint32_t fromMs, uint32_t toMs, uint32_t boot) {
+  if (useRtos_) return RtosTasks::requestJournal(fromMs, toMs, boot);
+  if (!gJournal) return false;
+  gJournalActive = gJournal->openCursor(gJournalCursor, fromMs, toMs, boot);
+  gJournalChunk = 0;
+  return gJournalActive;
+}
+
 void MqttBus::setSensorTelemetry(uint32_t drops, uint32_t depth) {
   if (!useRtos_) return;
   RtosTasks::setSensorTelemetry(drops, depth);
 }
 
+void MqttBus::setSamplingTelemetry(const SamplingMeter::Report& report) {
+  if (!useRtos_) return;
+  RtosTasks::setSamplingReport(report);
+}
+
 MqttBus::Stats MqttBus::stats() const {
   MqttBus::Stats out{};
   if (!useRtos_) return out;
@@ -110,7 +145,13 @@ MqttBus::Stats MqttBus::stats() const {
   out.storeDrops = s.storeDrops;
   out.tickOverruns = s.tickOverruns;
   out.storeDepth = s.storeDepth;
-  out.pubQueueDepth = RtosQueues::mqttPubQ ? (uint32_t)uxQueueMessagesWaiting(RtosQueues::mqttPubQ) : 0;
+  for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) {
+    if (RtosQueues::mqttPubQ[l]) out.pubQueueDepth += (uint32_t)uxQueueMessagesWaiting(RtosQueues::mqttPubQ[l]);
+  }
   out.cmdQueueDepth = RtosQueues::mqttCmdQ ? (uint32_t)uxQueueMessagesWaiting(RtosQueues::mqttCmdQ) : 0;
   return out;
 }
+
+DegradeLevel MqttBus::degradeLevel() const {
+  return useRtos_ ? RtosTasks::degradeLevel() : DegradeLevel::normal;
+}
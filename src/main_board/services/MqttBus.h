@@ -2,9 +2,13 @@
 
 #include <Arduino.h>
 
+#include "app/BootProfile.h"
 #include "app/Commands.h"
 #include "app/Events.h"
+#include "app/OverloadControl.h"
+#include "app/SamplingPolicy.h"
 #include "app/SystemState.h"
+#include "services/EventJournal.h"
 
 class MqttBus {
 public:
@@ -22,13 +26,24 @@ public:
   void update(uint32_t nowMs);
 
   void publishEvent(const Event& e, const SystemState& st, const Command& cmd);
-  void publishStatus(const SystemState& st, const char* reason);
+  // A non-null boot profile is appended to this status (it must outlive the bus).
+  void publishStatus(const SystemState& st,
+                     const char* reason,
+                     uint32_t sensorFaults,
+                     const BootProfile* boot = nullptr);
   void publishAck(const char* cmd, bool ok, const char* detail);
 
   bool pollCommand(String& outPayload);
 
+  void attachJournal(EventJournal* journal);
+  // Starts streaming journal records in [fromMs, toMs]; replaces any query in progress.
+  bool requestJournal(uint32_t fromMs, uint32_t toMs, uint32_t boot);
+
   void setSensorTelemetry(uint32_t drops, uint32_t depth);
+  void setSamplingTelemetry(const SamplingMeter::Report& report);
   Stats stats() const;
+  // Publish overload degradation; always normal in direct mode.
+  DegradeLevel degradeLevel() const;
 
 private:
   class Impl;
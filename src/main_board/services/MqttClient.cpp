@@ -1,10 +1,25 @@
 #include "MqttClient.h"
 
 #include <cstring>
+#include <esp_system.h>
+
+#include "app/Clock.h"
+
+#ifndef WIFI_RECONNECT_MAX_MS
+#define WIFI_RECONNECT_MAX_MS 60000
+#endif
+
+#ifndef MQTT_RECONNECT_MAX_MS
+#define MQTT_RECONNECT_MAX_MS 60000
+#endif
 
 MqttClient* MqttClient::self_ = nullptr;
 
 namespace {
+constexpr size_t kJournalChunkRecords = 6;
+// Rejoin attempts that reuse the cached BSSID/channel before falling back to a scan.
+constexpr uint8_t kFastRejoinAttempts = 2;
+
 inline bool reached(uint32_t nowMs, uint32_t targetMs) {
   return (int32_t)(nowMs - targetMs) >= 0;
 }
@@ -26,16 +41,16 @@ static const char* wlStatusText(wl_status_t st) {
 
 static const char* mqttStateText(int rc) {
   switch (rc) {
-    case MQTT_CONNECTION_TIMEOUT:     return "CONNECTION_TIMEOUT";
-    case MQTT_CONNECTION_LOST:        return "CONNECTION_LOST";
-    case MQTT_CONNECT_FAILED:         return "CONNECT_FAILED";
-    case MQTT_DISCONNECTED:           return "DISCONNECTED";
-    case MQTT_CONNECTED:              return "CONNECTED";
-    case MQTT_CONNECT_BAD_PROTOCOL:   return "BAD_PROTOCOL";
-    case MQTT_CONNECT_BAD_CLIENT_ID:  return "BAD_CLIENT_ID";
-    case MQTT_CONNECT_UNAVAILABLE:    return "SERVER_UNAVAILABLE";
-    case MQTT_CONNECT_BAD_CREDENTIALS:return "BAD_CREDENTIALS";
-    case MQTT_CONNECT_UNAUTHORIZED:   return "UNAUTHORIZED";
+    case MqttLink::kTimeout:          return "CONNECTION_TIMEOUT";
+    case MqttLink::kConnectionLost:   return "CONNECTION_LOST";
+    case MqttLink::kConnectFailed:    return "CONNECT_FAILED";
+    case MqttLink::kDisconnected:     return "DISCONNECTED";
+    case MqttLink::kConnected:        return "CONNECTED";
+    case 1:                           return "BAD_PROTOCOL";
+    case 2:                           return "BAD_CLIENT_ID";
+    case 3:                           return "SERVER_UNAVAILABLE";
+    case 4:                           return "BAD_CREDENTIALS";
+    case 5:                           return "UNAUTHORIZED";
     default:                          return "UNKNOWN";
   }
 }
@@ -50,20 +65,23 @@ static const char* levelText(AlarmLevel lv) {
 }
 
 MqttClient::MqttClient()
-: mqtt_(wifiClient_) {}
+: mqtt_(wifiClient_),
+  wifiBackoff_(WIFI_RECONNECT_MS, WIFI_RECONNECT_MAX_MS),
+  mqttBackoff_(MQTT_RECONNECT_MS, MQTT_RECONNECT_MAX_MS) {}
 
 void MqttClient::begin(CommandCallback cb) {
   cmdCb_ = cb;
   self_ = this;
 
+  // Rejoin is driven from connectWifi() (cached BSSID/channel, backoff), not by the
+  // Wi-Fi stack's own full-scan reconnect.
   WiFi.mode(WIFI_STA);
-  WiFi.setAutoReconnect(true);
+  WiFi.setAutoReconnect(false);
   WiFi.persistent(false);
 
   mqtt_.setServer(MQTT_BROKER, MQTT_PORT);
-  mqtt_.setKeepAlive(MQTT_KEEPALIVE_S);
   mqtt_.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
-  mqtt_.setCallback(onMqttMessage);
+  mqtt_.setCallbacks(onMqttMessage, onMqttAck);
 
   Serial.printf("[MQTT] cfg broker=%s port=%u client_id=%s auth=%s\n",
                 MQTT_BROKER,
@@ -84,12 +102,30 @@ void MqttClient::connectWifi(uint32_t nowMs) {
     lastWifiStatus_ = st;
   }
 
-  if (st == WL_CONNECTED) return;
+  if (st == WL_CONNECTED) {
+    if (!wifiUp_) {
+      wifiUp_ = true;
+      wifiBackoff_.reset();
+      const uint8_t* bssid = WiFi.BSSID();
+      if (bssid) {
+        memcpy(bssid_, bssid, sizeof(bssid_));
+        channel_ = WiFi.channel();
+        haveBssid_ = true;
+      }
+      const uint32_t outageMs = wifiOutage_.restored(nowMs);
+      if (outageMs) Serial.printf("[WIFI] rejoined in %lu ms\n", (unsigned long)outageMs);
+    }
+    return;
+  }
+  if (wifiUp_) {
+    wifiUp_ = false;
+    wifiOutage_.lost(nowMs);
+    nextWifiRetryMs_ = nowMs; // first rejoin right away
+  }
   if (!reached(nowMs, nextWifiRetryMs_)) return;
 
-  nextWifiRetryMs_ = nowMs + WIFI_RECONNECT_MS;
-
   if (strlen(WIFI_SSID) == 0) {
+    nextWifiRetryMs_ = nowMs + WIFI_RECONNECT_MS;
     static bool warnedEmptySsid = false;
     if (!warnedEmptySsid) {
       warnedEmptySsid = true;
@@ -97,94 +133,134 @@ void MqttClient::connectWifi(uint32_t nowMs) {
     }
     return;
   }
-  Serial.printf("[WIFI] connect ssid=%s\n", WIFI_SSID);
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+
+  // Skipping the scan saves most of a rejoin when the AP is unchanged; after a few
+  // misses it may have moved channel, so scan again.
+  const bool fast = haveBssid_ && wifiBackoff_.failures() < kFastRejoinAttempts;
+  nextWifiRetryMs_ = nowMs + wifiBackoff_.next(esp_random());
+  if (fast) {
+    Serial.printf("[WIFI] rejoin ssid=%s ch=%ld\n", WIFI_SSID, (long)channel_);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, channel_, bssid_, true);
+  } else {
+    Serial.printf("[WIFI] connect ssid=%s\n", WIFI_SSID);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  }
 }
 
 void MqttClient::connectMqtt(uint32_t nowMs) {
+  if (attempting_) {
+    if (mqtt_.connecting()) return;
+    attempting_ = false;
+    if (mqtt_.connected()) {
+      onConnected(nowMs);
+      return;
+    }
+    const int rc = mqtt_.state();
+    nextMqttRetryMs_ = nowMs + mqttBackoff_.next(esp_random());
+    Serial.printf("[MQTT] connect failed rc=%d %s; retry in %lu ms\n",
+                  rc,
+                  mqttStateText(rc),
+                  (unsigned long)(nextMqttRetryMs_ - nowMs));
+    return;
+  }
+
   if (WiFi.status() != WL_CONNECTED) return;
   if (mqtt_.connected()) return;
   if (!reached(nowMs, nextMqttRetryMs_)) return;
 
-  nextMqttRetryMs_ = nowMs + MQTT_RECONNECT_MS;
-
-  const bool hasAuth = strlen(MQTT_USERNAME) > 0;
-  bool connected = false;
-
   Serial.printf("[MQTT] connect attempt %s:%u client_id=%s\n",
                 MQTT_BROKER,
                 (unsigned)MQTT_PORT,
                 MQTT_CLIENT_ID);
 
-  if (hasAuth) {
-    connected = mqtt_.connect(
-      MQTT_CLIENT_ID,
-      MQTT_USERNAME,
-      MQTT_PASSWORD,
-      MQTT_TOPIC_STATUS,
-      1,
-      true,
-      "{\"reason\":\"offline\"}"
-    );
-  } else {
-    connected = mqtt_.connect(
-      MQTT_CLIENT_ID,
-      MQTT_TOPIC_STATUS,
-      1,
-      true,
-      "{\"reason\":\"offline\"}"
-    );
-  }
-
-  if (!connected) {
-    const int rc = mqtt_.state();
-    Serial.print("[MQTT] connect failed rc=");
-    Serial.print(rc);
-    Serial.print(" ");
-    Serial.println(mqttStateText(rc));
-    return;
+  MqttPacket::ConnectOpts opts;
+  opts.clientId = MQTT_CLIENT_ID;
+  opts.user = MQTT_USERNAME;
+  opts.password = MQTT_PASSWORD;
+  opts.willTopic = MQTT_TOPIC_STATUS;
+  opts.willMessage = "{\"reason\":\"offline\"}";
+  opts.willQos = 1;
+  opts.willRetain = true;
+  opts.keepAliveS = MQTT_KEEPALIVE_S;
+
+  // Progresses in mqtt_.loop(); the outcome is picked up on a later tick.
+  attempting_ = mqtt_.beginConnect(opts, nowMs);
+  if (!attempting_) {
+    nextMqttRetryMs_ = nowMs + mqttBackoff_.next(esp_random());
+    Serial.printf("[MQTT] connect failed rc=%d %s\n", mqtt_.state(), mqttStateText(mqtt_.state()));
   }
+}
 
-  if (!mqtt_.subscribe(MQTT_TOPIC_CMD)) {
+void MqttClient::onConnected(uint32_t nowMs) {
+  if (!mqtt_.subscribe(MQTT_TOPIC_CMD, 0)) {
     Serial.println("[MQTT] WARN subscribe failed");
   }
 
   lastConnected_ = true;
-  mqtt_.publish(MQTT_TOPIC_STATUS, "{\"reason\":\"online\"}", false);
-  Serial.println("[MQTT] connected");
+  ++sessions_;
+  mqttBackoff_.reset();
+  if (firstConnectMs_ == 0) firstConnectMs_ = clockMs();
+
+  const uint32_t outageMs = outage_.restored(nowMs);
+  char online[64];
+  snprintf(online, sizeof(online), "{\"reason\":\"online\",\"reconnect_ms\":%lu}", (unsigned long)outageMs);
+  mqtt_.publish(MQTT_TOPIC_STATUS, online, false);
+  Serial.printf("[MQTT] connected reconnect_ms=%lu\n", (unsigned long)outageMs);
 }
 
 void MqttClient::update(uint32_t nowMs) {
   if (lastConnected_ && !mqtt_.connected()) {
     lastConnected_ = false;
+    outage_.lost(nowMs);
+    nextMqttRetryMs_ = nowMs; // first retry right away, then back off
     Serial.println("[MQTT] disconnected");
   }
 
   connectWifi(nowMs);
+  mqtt_.loop(nowMs);
   connectMqtt(nowMs);
-
-  if (mqtt_.connected()) {
-    mqtt_.loop();
-  }
 }
 
 bool MqttClient::ready() {
   return mqtt_.connected();
 }
 
-bool MqttClient::publishEvent(const Event& e, const SystemState& st, const Command& cmd) {
+void MqttClient::setAckCallback(AckCallback cb) {
+  ackCb_ = cb;
+}
+
+bool MqttClient::publish_(const char* topic, const String& payload, bool retain, const PublishQos& qos) {
+  return mqtt_.publish(topic,
+                       (const uint8_t*)payload.c_str(),
+                       payload.length(),
+                       retain,
+                       qos.packetId ? 1 : 0,
+                       qos.packetId,
+                       qos.dup);
+}
+
+bool MqttClient::publishEvent(const Event& e, const PackedSystemState& st, const Command& cmd,
+                              const PublishQos& qos, bool retain) {
   if (!ready()) return false;
 
   String payload = "{\"event\":\"";
   payload += toString(e.type);
   payload += "\",\"src\":";
   payload += String(e.src);
-  payload += ",\"cmd\":\"";
+  payload += ",\"zone\":\"";
+  payload += toString(e.zone);
+  if (e.type == EventType::vib_spike && e.value) {
+    payload += "\",\"intensity\":";
+    payload += String(e.value);
+    payload += ",\"cmd\":\"";
+  } else {
+    payload += "\",\"cmd\":\"";
+  }
   payload += toString(cmd.type);
   payload += "\",\"mode\":\"";
-  payload += toString(st.mode);
+  payload += toString(st.modeValue());
   payload += "\",\"level\":\"";
-  payload += levelText(st.level);
+  payload += levelText(st.levelValue());
   payload += "\",\"door_locked\":";
   payload += st.door_locked ? "true" : "false";
   payload += ",\"window_locked\":";
@@ -197,18 +273,22 @@ bool MqttClient::publishEvent(const Event& e, const SystemState& st, const Comma
   payload += String(e.ts_ms);
   payload += "}";
 
-  return mqtt_.publish(MQTT_TOPIC_EVENT, payload.c_str(), true);
+  return publish_(MQTT_TOPIC_EVENT, payload, retain, qos);
 }
 
-bool MqttClient::publishStatus(const SystemState& st, const char* reason) {
+bool MqttClient::publishStatus(const PackedSystemState& st,
+                               const char* reason,
+                               bool withBootProfile,
+                               uint32_t sensorFaults,
+                               const PublishQos& qos) {
   if (!ready()) return false;
 
   String payload = "{\"reason\":\"";
   payload += (reason ? reason : "unknown");
   payload += "\",\"mode\":\"";
-  payload += toString(st.mode);
+  payload += toString(st.modeValue());
   payload += "\",\"level\":\"";
-  payload += levelText(st.level);
+  payload += levelText(st.levelValue());
   payload += "\",\"door_locked\":";
   payload += st.door_locked ? "true" : "false";
   payload += ",\"window_locked\":";
@@ -217,14 +297,34 @@ bool MqttClient::publishStatus(const SystemState& st, const char* reason) {
   payload += st.door_open ? "true" : "false";
   payload += ",\"window_open\":";
   payload += st.window_open ? "true" : "false";
+  payload += ",\"sensor_faults\":";
+  payload += String(sensorFaults);
   payload += ",\"uptime_ms\":";
-  payload += String(millis());
+  payload += String(clockMs());
+  if (degrade_ != DegradeLevel::normal) {
+    payload += ",\"degrade\":\"";
+    payload += OverloadController::name(degrade_);
+    payload += "\"";
+  }
+  if (withBootProfile && bootProfile_) {
+    char boot[160];
+    if (bootProfile_->toJson(boot, sizeof(boot)) > 0) {
+      payload += ",\"boot_ms\":";
+      payload += boot;
+      payload += ",\"mqtt_up_ms\":";
+      payload += String(firstConnectMs_);
+    }
+  }
   payload += "}";
 
-  return mqtt_.publish(MQTT_TOPIC_STATUS, payload.c_str(), true);
+  return publish_(MQTT_TOPIC_STATUS, payload, true, qos);
 }
 
-bool MqttClient::publishAck(const char* cmd, bool ok, const char* detail) {
+void MqttClient::setBootProfile(const BootProfile* profile) {
+  bootProfile_ = profile;
+}
+
+bool MqttClient::publishAck(const char* cmd, bool ok, const char* detail, const PublishQos& qos) {
   if (!ready()) return false;
 
   String payload = "{\"cmd\":\"";
@@ -234,10 +334,10 @@ bool MqttClient::publishAck(const char* cmd, bool ok, const char* detail) {
   payload += ",\"detail\":\"";
   payload += (detail ? detail : "");
   payload += "\",\"uptime_ms\":";
-  payload += String(millis());
+  payload += String(clockMs());
   payload += "}";
 
-  return mqtt_.publish(MQTT_TOPIC_ACK, payload.c_str(), false);
+  return publish_(MQTT_TOPIC_ACK, payload, false, qos);
 }
 
 bool MqttClient::publishMetrics(
@@ -248,7 +348,13 @@ bool MqttClient::publishMetrics(
   uint32_t usQueueDepth,
   uint32_t pubQueueDepth,
   uint32_t cmdQueueDepth,
-  uint32_t storeDepth
+  uint32_t storeDepth,
+  const I2cBus::Stats* i2c,
+  const InflightWindow* const* qos1,
+  uint8_t qos1Count,
+  const LaneStats* lanes,
+  const OverloadController* overload,
+  const SamplingMeter::Report* sampling
 ) {
   if (!ready()) return false;
 
@@ -268,22 +374,179 @@ bool MqttClient::publishMetrics(
   payload += String(cmdQueueDepth);
   payload += ",\"q_store\":";
   payload += String(storeDepth);
+  if (i2c) {
+    payload += ",\"i2c\":{\"util_pct\":";
+    payload += String(i2c->utilPct);
+    payload += ",\"recoveries\":";
+    payload += String(i2c->recoveries);
+    payload += ",\"dev\":{";
+    for (uint8_t i = 0; i < i2c->devCount; ++i) {
+      char key[8];
+      snprintf(key, sizeof(key), "0x%02X", i2c->dev[i].addr);
+      if (i) payload += ",";
+      payload += "\"";
+      payload += key;
+      payload += "\":{\"tx\":";
+      payload += String(i2c->dev[i].txns);
+      payload += ",\"err\":";
+      payload += String(i2c->dev[i].errors);
+      payload += "}";
+    }
+    payload += "}}";
+  }
+  if (qos1 && qos1Count > 0) {
+    uint32_t inflight = 0;
+    uint32_t acked = 0;
+    uint32_t resent = 0;
+    uint64_t ackSum = 0;
+    uint32_t ackMax = 0;
+    for (uint8_t i = 0; i < qos1Count; ++i) {
+      const InflightWindow::Stats& q = qos1[i]->stats();
+      inflight += qos1[i]->count();
+      acked += q.acked;
+      resent += q.resent;
+      ackSum += (uint64_t)q.ackAvgMs * q.acked;
+      if (q.ackMaxMs > ackMax) ackMax = q.ackMaxMs;
+    }
+    payload += ",\"qos1\":{\"window\":";
+    payload += String(qos1[0]->window());
+    payload += ",\"inflight\":";
+    payload += String(inflight);
+    payload += ",\"acked\":";
+    payload += String(acked);
+    payload += ",\"resent\":";
+    payload += String(resent);
+    payload += ",\"ack_avg_ms\":";
+    payload += String(acked ? (uint32_t)(ackSum / acked) : 0u);
+    payload += ",\"ack_max_ms\":";
+    payload += String(ackMax);
+    payload += "}";
+  }
+  if (lanes) {
+    payload += ",\"lanes\":{";
+    for (uint8_t l = 0; l < PublishLanes::kCount; ++l) {
+      const LaneStats& ls = lanes[l];
+      if (l) payload += ",";
+      payload += "\"";
+      payload += PublishLanes::name(l);
+      payload += "\":{\"q\":";
+      payload += String(ls.queued);
+      payload += ",\"store\":";
+      payload += String(ls.stored);
+      payload += ",\"drops\":";
+      payload += String(ls.drops);
+      payload += ",\"evicted\":";
+      payload += String(ls.evicted);
+      payload += ",\"wait_avg_ms\":";
+      payload += String(ls.waitAvgMs);
+      payload += ",\"wait_max_ms\":";
+      payload += String(ls.waitMaxMs);
+      payload += "}";
+    }
+    payload += "}";
+  }
+  if (overload) {
+    payload += ",\"overload\":{\"level\":\"";
+    payload += OverloadController::name(overload->level());
+    payload += "\",\"load_pct\":";
+    payload += String(overload->loadPct());
+    payload += ",\"changes\":";
+    payload += String(overload->changes());
+    payload += ",\"collapsed\":";
+    payload += String(overload->collapsed());
+    payload += ",\"sampled_out\":";
+    payload += String(overload->sampledOut());
+    payload += "}";
+  }
+  if (sampling) {
+    payload += ",\"sampling\":{\"profile\":\"";
+    payload += SamplingPolicy::name(sampling->profile);
+    payload += "\",\"window_ms\":";
+    payload += String(sampling->windowMs);
+    payload += ",\"us_period_ms\":";
+    payload += String(sampling->ultrasonicPeriodMs);
+    payload += ",\"kp_scans_per_s\":";
+    payload += String(sampling->keypadScansPerSec);
+    payload += ",\"cpu_us\":";
+    payload += String(sampling->cpuUs);
+    payload += ",\"saved_us\":";
+    payload += String(sampling->savedUs);
+    payload += "}";
+  }
+  payload += ",\"reconnect\":{\"count\":";
+  payload += String(outage_.count());
+  payload += ",\"last_ms\":";
+  payload += String(outage_.lastMs());
+  payload += ",\"max_ms\":";
+  payload += String(outage_.maxMs());
+  payload += ",\"wifi_last_ms\":";
+  payload += String(wifiOutage_.lastMs());
+  payload += "}";
   payload += ",\"uptime_ms\":";
-  payload += String(millis());
+  payload += String(clockMs());
   payload += "}";
 
-  return mqtt_.publish(MQTT_TOPIC_METRICS, payload.c_str(), false);
+  return publish_(MQTT_TOPIC_METRICS, payload, false);
+}
+
+bool MqttClient::publishJournalChunk(const JournalCodec::Record* recs, size_t count, uint32_t chunk, bool last) {
+  if (!ready()) return false;
+
+  String payload = "{\"chunk\":";
+  payload += String(chunk);
+  payload += ",\"last\":";
+  payload += last ? "true" : "false";
+  payload += ",\"records\":[";
+  for (size_t i = 0; i < count; ++i) {
+    const JournalCodec::Record& r = recs[i];
+    if (i > 0) payload += ",";
+    payload += "[";
+    payload += String(r.boot);
+    payload += ",";
+    payload += String(r.ts_ms);
+    payload += ",\"";
+    payload += toString(r.type);
+    payload += "\",";
+    payload += String(r.src);
+    payload += ",";
+    payload += String((int)r.score_delta);
+    payload += ",\"";
+    payload += levelText(r.level);
+    payload += "\"]";
+  }
+  payload += "]}";
+
+  return publish_(MQTT_TOPIC_JOURNAL, payload, false);
 }
 
-void MqttClient::onMqttMessage(char* topic, uint8_t* payload, unsigned int length) {
+bool MqttClient::pumpJournal(const EventJournal& journal, EventJournal::Cursor& cursor, uint32_t& chunk) {
+  // A failed chunk is re-read from the same place next time, so the stream has no gaps.
+  const EventJournal::Cursor before = cursor;
+  JournalCodec::Record recs[kJournalChunkRecords];
+  const size_t n = journal.read(cursor, recs, kJournalChunkRecords);
+  const bool last = cursor.done;
+  if (!publishJournalChunk(recs, n, chunk, last)) {
+    Serial.println("[MQTT] WARN journal chunk publish failed; retrying");
+    cursor = before;
+    return true;
+  }
+  ++chunk;
+  return !last;
+}
+
+void MqttClient::onMqttMessage(const char* topic, const uint8_t* payload, size_t length) {
   if (!self_ || !self_->cmdCb_) return;
 
   String t = topic ? String(topic) : String("");
   String p;
   p.reserve(length);
-  for (unsigned int i = 0; i < length; ++i) {
+  for (size_t i = 0; i < length; ++i) {
     p += (char)payload[i];
   }
 
   self_->cmdCb_(t, p);
 }
+
+void MqttClient::onMqttAck(uint16_t packetId) {
+  if (self_ && self_->ackCb_) self_->ackCb_(packetId);
+}
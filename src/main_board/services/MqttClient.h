@@ -2,15 +2,31 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <PubSubClient.h>
 
+#include "app/BootProfile.h"
 #include "app/Commands.h"
 #include "app/Events.h"
-#include "app/SystemState.h"
+#include "app/InflightWindow.h"
+#include "app/OverloadControl.h"
+#include "app/PackedSystemState.h"
+#include "app/PublishLanes.h"
+#include "app/SamplingPolicy.h"
+#include "app/Reconnect.h"
+#include "drivers/I2cBus.h"
+#include "services/EventJournal.h"
+#include "services/MqttLink.h"
+
+// Delivery for one publishEvent/publishStatus/publishAck: packetId 0 is QoS0, any
+// other id QoS1. Everything else is always QoS0.
+struct PublishQos {
+  uint16_t packetId = 0;
+  bool dup = false;
+};
 
 class MqttClient {
 public:
   using CommandCallback = void (*)(const String& topic, const String& payload);
+  using AckCallback = void (*)(uint16_t packetId);
 
   MqttClient();
 
@@ -18,9 +34,19 @@ public:
   void update(uint32_t nowMs);
 
   bool ready();
-  bool publishEvent(const Event& e, const SystemState& st, const Command& cmd);
-  bool publishStatus(const SystemState& st, const char* reason);
-  bool publishAck(const char* cmd, bool ok, const char* detail);
+  // PUBACKs for QoS1 publishes are reported here.
+  void setAckCallback(AckCallback cb);
+  // Successful broker connects so far; a change means unacked publishes were lost
+  // with the old session.
+  uint32_t sessions() const { return sessions_; }
+  bool publishEvent(const Event& e, const PackedSystemState& st, const Command& cmd,
+                    const PublishQos& qos = PublishQos(), bool retain = true);
+  bool publishStatus(const PackedSystemState& st,
+                     const char* reason,
+                     bool withBootProfile = false,
+                     uint32_t sensorFaults = 0,
+                     const PublishQos& qos = PublishQos());
+  bool publishAck(const char* cmd, bool ok, const char* detail, const PublishQos& qos = PublishQos());
   bool publishMetrics(
     uint32_t usDrops,
     uint32_t pubDrops,
@@ -29,22 +55,57 @@ public:
     uint32_t usQueueDepth,
     uint32_t pubQueueDepth,
     uint32_t cmdQueueDepth,
-    uint32_t storeDepth
+    uint32_t storeDepth,
+    const I2cBus::Stats* i2c = nullptr,
+    const InflightWindow* const* qos1 = nullptr, // summed over qos1Count windows
+    uint8_t qos1Count = 0,
+    const LaneStats* lanes = nullptr, // PublishLanes::kCount entries
+    const OverloadController* overload = nullptr,
+    const SamplingMeter::Report* sampling = nullptr
   );
+  bool publishJournalChunk(const JournalCodec::Record* recs, size_t count, uint32_t chunk, bool last);
+  // Streams the next chunk of a journal query; returns false once the query has finished.
+  bool pumpJournal(const EventJournal& journal, EventJournal::Cursor& cursor, uint32_t& chunk);
+
+  // Must outlive the client; read when a status is published with withBootProfile.
+  void setBootProfile(const BootProfile* profile);
+  // Reported in every status while not normal.
+  void setDegradeLevel(DegradeLevel level) { degrade_ = level; }
 
 private:
   static MqttClient* self_;
 
   WiFiClient wifiClient_;
-  PubSubClient mqtt_;
+  MqttLink mqtt_;
   CommandCallback cmdCb_ = nullptr;
+  AckCallback ackCb_ = nullptr;
+  uint32_t sessions_ = 0;
   bool lastConnected_ = false;
+  bool attempting_ = false;
   wl_status_t lastWifiStatus_ = WL_IDLE_STATUS;
+  bool wifiUp_ = false;
+
+  // Last associated AP, for a scan-free rejoin.
+  uint8_t bssid_[6] = {};
+  int32_t channel_ = 0;
+  bool haveBssid_ = false;
+
+  ReconnectBackoff wifiBackoff_;
+  ReconnectBackoff mqttBackoff_;
+  ReconnectTimer wifiOutage_;
+  ReconnectTimer outage_;
+
+  const BootProfile* bootProfile_ = nullptr;
+  DegradeLevel degrade_ = DegradeLevel::normal;
+  uint32_t firstConnectMs_ = 0;
 
   uint32_t nextWifiRetryMs_ = 0;
   uint32_t nextMqttRetryMs_ = 0;
 
-  static void onMqttMessage(char* topic, uint8_t* payload, unsigned int length);
+  static void onMqttMessage(const char* topic, const uint8_t* payload, size_t length);
+  static void onMqttAck(uint16_t packetId);
+  bool publish_(const char* topic, const String& payload, bool retain, const PublishQos& qos = PublishQos());
   void connectWifi(uint32_t nowMs);
   void connectMqtt(uint32_t nowMs);
+  void onConnected(uint32_t nowMs);
 };
@@ -0,0 +1,225 @@
+#include "MqttLink.h"
+
+#include "app/Clock.h"
+
+using namespace MqttPacket;
+
+namespace {
+constexpr size_t kTopicMax = 128;
+constexpr size_t kReadChunk = 64;
+} // namespace
+
+MqttLink::MqttLink(WiFiClient& net)
+: net_(net) {}
+
+void MqttLink::setServer(const char* host, uint16_t port) {
+  host_ = host ? host : "";
+  port_ = port;
+  resolved_ = false;
+}
+
+void MqttLink::setSocketTimeout(uint16_t seconds) {
+  socketTimeoutS_ = seconds;
+}
+
+void MqttLink::setCallbacks(MessageFn onMessage, AckFn onAck) {
+  onMessage_ = onMessage;
+  onAck_ = onAck;
+}
+
+bool MqttLink::send_(const uint8_t* data, size_t len) {
+  if (len == 0) return true;
+  if (net_.write(data, len) != len) {
+    drop_(kConnectionLost);
+    return false;
+  }
+  lastTxMs_ = clockMs();
+  return true;
+}
+
+void MqttLink::drop_(int state) {
+  tcp_.abort();
+  net_.stop();
+  phase_ = Phase::idle;
+  pingOutstanding_ = false;
+  state_ = state;
+  rx_.reset();
+}
+
+bool MqttLink::phaseExpired_(uint32_t nowMs) const {
+  return (uint32_t)(nowMs - phaseMs_) >= (uint32_t)socketTimeoutS_ * 1000u;
+}
+
+bool MqttLink::beginConnect(const ConnectOpts& opts, uint32_t nowMs) {
+  if (phase_ != Phase::idle) drop_(kDisconnected);
+
+  // Resolved once and kept: a hostname lookup is the only step that can still block.
+  if (!resolved_) {
+    resolved_ = brokerIp_.fromString(host_) || WiFi.hostByName(host_, brokerIp_) == 1;
+    if (!resolved_) {
+      state_ = kConnectFailed;
+      return false;
+    }
+  }
+  if (!tcp_.start(brokerIp_, port_)) {
+    state_ = kConnectFailed;
+    return false;
+  }
+  opts_ = opts;
+  keepAliveS_ = opts.keepAliveS;
+  phase_ = Phase::tcp;
+  phaseMs_ = nowMs;
+  return true;
+}
+
+void MqttLink::stepConnect_(uint32_t nowMs) {
+  if (phase_ == Phase::tcp) {
+    const TcpConnector::Result r = tcp_.poll();
+    if (r == TcpConnector::Result::pending) {
+      if (phaseExpired_(nowMs)) drop_(kTimeout);
+      return;
+    }
+    if (r == TcpConnector::Result::failed) {
+      // A refused/unreachable broker may have moved: look it up again next time.
+      resolved_ = false;
+      drop_(kConnectFailed);
+      return;
+    }
+    net_ = WiFiClient(tcp_.take());
+    rx_.reset();
+    const size_t n = MqttPacket::connect(tx_, sizeof(tx_), opts_);
+    if (n == 0 || net_.write(tx_, n) != n) {
+      drop_(kConnectFailed);
+      return;
+    }
+    phase_ = Phase::connack;
+    phaseMs_ = nowMs;
+    return;
+  }
+
+  // Phase::connack: dispatch_() completes it.
+  if (phaseExpired_(nowMs)) drop_(kTimeout);
+}
+
+bool MqttLink::subscribe(const char* topic, uint8_t qos) {
+  if (phase_ != Phase::up) return false;
+  if (++subId_ == 0) subId_ = 1;
+  const size_t n = MqttPacket::subscribe(tx_, sizeof(tx_), subId_, topic, qos);
+  return n > 0 && send_(tx_, n);
+}
+
+bool MqttLink::publish(const char* topic,
+                       const uint8_t* payload,
+                       size_t len,
+                       bool retain,
+                       uint8_t qos,
+                       uint16_t packetId,
+                       bool dup) {
+  if (phase_ != Phase::up) return false;
+  const size_t hdr = publishHeader(tx_, sizeof(tx_), topic, len, qos, retain, dup, packetId);
+  if (hdr == 0) return false;
+  // One write per packet when it fits, so a pipelined window is not split into
+  // header/payload segments.
+  if (hdr + len <= sizeof(tx_)) {
+    if (len) memcpy(tx_ + hdr, payload, len);
+    return send_(tx_, hdr + len);
+  }
+  return send_(tx_, hdr) && send_(payload, len);
+}
+
+void MqttLink::dispatch_(uint32_t nowMs) {
+  lastRxMs_ = nowMs;
+  if (rx_.truncated()) return;
+
+  if (phase_ == Phase::connack) {
+    if (rx_.type() != CONNACK || rx_.length() < 2) return;
+    const uint8_t rc = rx_.body()[1];
+    if (rc != 0) {
+      drop_(rc);
+      return;
+    }
+    phase_ = Phase::up;
+    state_ = kConnected;
+    lastTxMs_ = nowMs;
+    return;
+  }
+
+  switch (rx_.type()) {
+    case PUBLISH: {
+      const char* topic = nullptr;
+      size_t topicLen = 0;
+      uint16_t packetId = 0;
+      const uint8_t* payload = nullptr;
+      size_t len = 0;
+      if (!rx_.publish(topic, topicLen, packetId, payload, len)) return;
+      char t[kTopicMax];
+      if (topicLen >= sizeof(t)) topicLen = sizeof(t) - 1;
+      memcpy(t, topic, topicLen);
+      t[topicLen] = '\0';
+      if (onMessage_) onMessage_(t, payload, len);
+      if (packetId != 0 && phase_ == Phase::up) {
+        const size_t n = puback(tx_, sizeof(tx_), packetId);
+        send_(tx_, n);
+      }
+      return;
+    }
+    case PUBACK:
+      if (onAck_) onAck_(rx_.packetId());
+      return;
+    case PINGRESP:
+      pingOutstanding_ = false;
+      return;
+    default:
+      return; // SUBACK carries nothing the firmware acts on
+  }
+}
+
+void MqttLink::loop(uint32_t nowMs) {
+  if (phase_ == Phase::idle) return;
+  if (phase_ == Phase::tcp) {
+    stepConnect_(nowMs);
+    if (phase_ != Phase::connack) return;
+  }
+  if (!net_.connected()) {
+    drop_(kConnectionLost);
+    return;
+  }
+
+  uint8_t chunk[kReadChunk];
+  while (phase_ != Phase::idle && net_.available() > 0) {
+    const int got = net_.read(chunk, sizeof(chunk));
+    if (got <= 0) break;
+    for (int i = 0; i < got && phase_ != Phase::idle; ++i) {
+      if (rx_.feed(chunk[i])) dispatch_(nowMs);
+    }
+  }
+  if (phase_ == Phase::connack) stepConnect_(nowMs);
+  if (phase_ != Phase::up || keepAliveS_ == 0) return;
+
+  // Same rule as PubSubClient: ping after a quiet keepalive, drop if it goes unanswered.
+  const uint32_t keepMs = (uint32_t)keepAliveS_ * 1000u;
+  if ((uint32_t)(nowMs - lastRxMs_) > keepMs || (uint32_t)(nowMs - lastTxMs_) > keepMs) {
+    if (pingOutstanding_) {
+      drop_(kTimeout);
+      return;
+    }
+    const size_t n = simple(tx_, sizeof(tx_), PINGREQ);
+    if (!send_(tx_, n)) return;
+    lastRxMs_ = nowMs;
+    lastTxMs_ = nowMs;
+    pingOutstanding_ = true;
+  }
+}
+
+bool MqttLink::connected() {
+  if (phase_ == Phase::up && !net_.connected()) drop_(kConnectionLost);
+  return phase_ == Phase::up;
+}
+
+void MqttLink::disconnect() {
+  if (phase_ == Phase::up) {
+    const size_t n = simple(tx_, sizeof(tx_), DISCONNECT);
+    net_.write(tx_, n);
+  }
+  drop_(kDisconnected);
+}
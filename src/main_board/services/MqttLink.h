@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include "app/MqttPacket.h"
+#include "drivers/TcpConnector.h"
+
+// Minimal MQTT 3.1.1 client over a WiFiClient. Unlike PubSubClient it publishes at
+// QoS1 with caller-chosen packet ids and reports PUBACKs, so the offline store can
+// keep a message until the broker has it.
+//
+// Connecting never blocks: beginConnect() starts a non-blocking TCP connect and
+// loop() carries it through CONNECT/CONNACK across ticks.
+class MqttLink {
+public:
+  using MessageFn = void (*)(const char* topic, const uint8_t* payload, size_t len);
+  using AckFn = void (*)(uint16_t packetId);
+
+  // Connection result codes (CONNACK return codes are >= 1).
+  static constexpr int kConnected = 0;
+  static constexpr int kDisconnected = -1;
+  static constexpr int kConnectFailed = -2;
+  static constexpr int kConnectionLost = -3;
+  static constexpr int kTimeout = -4;
+
+  static constexpr size_t kBufferBytes = 512;
+
+  explicit MqttLink(WiFiClient& net);
+
+  void setServer(const char* host, uint16_t port);
+  void setSocketTimeout(uint16_t seconds);
+  void setCallbacks(MessageFn onMessage, AckFn onAck);
+
+  // Starts a connect attempt; false if it could not even start (state() says why).
+  // Each phase (TCP, CONNACK) fails after the socket timeout.
+  bool beginConnect(const MqttPacket::ConnectOpts& opts, uint32_t nowMs);
+  bool connecting() const { return phase_ != Phase::idle && phase_ != Phase::up; }
+  bool subscribe(const char* topic, uint8_t qos);
+  // qos 0 ignores packetId/dup.
+  bool publish(const char* topic,
+               const uint8_t* payload,
+               size_t len,
+               bool retain,
+               uint8_t qos = 0,
+               uint16_t packetId = 0,
+               bool dup = false);
+  bool publish(const char* topic, const char* payload, bool retain) {
+    return publish(topic, (const uint8_t*)payload, strlen(payload), retain);
+  }
+
+  // Advances a connect attempt, reads and dispatches incoming packets and keeps the
+  // session alive.
+  void loop(uint32_t nowMs);
+  bool connected();
+  void disconnect();
+  int state() const { return state_; }
+
+private:
+  enum class Phase : uint8_t { idle, tcp, connack, up };
+
+  WiFiClient& net_;
+  TcpConnector tcp_;
+  IPAddress brokerIp_;
+  bool resolved_ = false;
+  MqttPacket::ConnectOpts opts_;
+  Phase phase_ = Phase::idle;
+  uint32_t phaseMs_ = 0;
+  const char* host_ = "";
+  uint16_t port_ = 1883;
+  uint16_t socketTimeoutS_ = 15;
+  uint16_t keepAliveS_ = 15;
+
+  MessageFn onMessage_ = nullptr;
+  AckFn onAck_ = nullptr;
+
+  MqttPacket::Reader<kBufferBytes> rx_;
+  uint8_t tx_[kBufferBytes];
+  uint16_t subId_ = 0;
+  int state_ = kDisconnected;
+  uint32_t lastTxMs_ = 0;
+  uint32_t lastRxMs_ = 0;
+  bool pingOutstanding_ = false;
+
+  bool send_(const uint8_t* data, size_t len);
+  void dispatch_(uint32_t nowMs);
+  void drop_(int state);
+  void stepConnect_(uint32_t nowMs);
+  bool phaseExpired_(uint32_t nowMs) const;
+};
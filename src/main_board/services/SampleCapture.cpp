@@ -0,0 +1,165 @@
+#include "services/SampleCapture.h"
+
+#include <cstdio>
+
+namespace {
+constexpr uint32_t kFlashSectorBytes = 4096;
+constexpr char kHex[] = "0123456789abcdef";
+} // namespace
+
+bool SampleCapture::begin() {
+  part_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "capture");
+  if (!part_) {
+    Serial.println("[CAPTURE] WARN: no 'capture' partition; sample capture disabled");
+    return false;
+  }
+  pageCount_ = (uint16_t)((part_->size / kFlashSectorBytes) * kPagesPerSector);
+  if (pageCount_ < 2u * kPagesPerSector) {
+    Serial.println("[CAPTURE] WARN: capture partition too small; sample capture disabled");
+    part_ = nullptr;
+    return false;
+  }
+
+  // Sectors fill front to back, so the newest sector is found from first pages alone.
+  bool found = false;
+  uint32_t headSeq = 0;
+  uint16_t headSector = 0;
+  for (uint16_t p = 0; p < pageCount_; p = (uint16_t)(p + kPagesPerSector)) {
+    uint32_t seq = 0;
+    uint16_t id = 0;
+    if (!readPageHeader_(p, seq, id)) continue;
+    if (!found || (int32_t)(seq - headSeq) > 0) {
+      found = true;
+      headSeq = seq;
+      headSector = p;
+    }
+  }
+
+  headPage_ = 0;
+  if (found) {
+    for (uint16_t p = headSector; p < headSector + kPagesPerSector; ++p) {
+      uint32_t seq = 0;
+      uint16_t id = 0;
+      if (!readPageHeader_(p, seq, id)) break;
+      nextSeq_ = seq + 1u;
+      captureId_ = id;
+      headPage_ = (uint16_t)((p + 1u) % pageCount_);
+    }
+  }
+
+  Serial.printf("[CAPTURE] ready pages=%u head=%u last_capture=%u\n",
+                (unsigned)pageCount_,
+                (unsigned)headPage_,
+                (unsigned)captureId_);
+  return true;
+}
+
+bool SampleCapture::start(uint32_t nowMs) {
+  if (!part_ || dumping_) return false;
+  if (active_) stop();
+  ++captureId_;
+  stats_ = Stats();
+  enc_.begin(page_, nextSeq_, captureId_, nowMs);
+  pageOpen_ = false;
+  active_ = true;
+  return true;
+}
+
+void SampleCapture::stop() {
+  if (!active_) return;
+  if (pageOpen_) writePage_();
+  active_ = false;
+}
+
+void SampleCapture::add(uint8_t channel, uint32_t tsMs, uint32_t value) {
+  if (!active_) return;
+  SampleCodec::Sample s;
+  s.channel = channel;
+  s.tsMs = tsMs;
+  s.value = value;
+  if (!enc_.add(s)) {
+    if (!writePage_()) return;
+    enc_.begin(page_, nextSeq_, captureId_, tsMs);
+    if (!enc_.add(s)) return;
+  }
+  pageOpen_ = true;
+  ++stats_.samples;
+}
+
+bool SampleCapture::writePage_() {
+  enc_.finish();
+  pageOpen_ = false;
+  const uint32_t addr = (uint32_t)headPage_ * SampleCodec::kPageBytes;
+  bool ok = true;
+  if (headPage_ % kPagesPerSector == 0) {
+    ok = esp_partition_erase_range(part_, addr, kFlashSectorBytes) == ESP_OK;
+  }
+  ok = ok && esp_partition_write(part_, addr, page_, SampleCodec::kPageBytes) == ESP_OK;
+  if (!ok) {
+    ++stats_.writeErrors;
+    active_ = false;
+    Serial.println("[CAPTURE] WARN: flash write failed; capture stopped");
+    return false;
+  }
+  ++stats_.pages;
+  stats_.bytes += enc_.used();
+  ++nextSeq_;
+  headPage_ = (uint16_t)((headPage_ + 1u) % pageCount_);
+  return true;
+}
+
+bool SampleCapture::readPageHeader_(uint16_t page, uint32_t& seq, uint16_t& captureId) const {
+  uint8_t hdr[SampleCodec::kHeaderBytes];
+  if (esp_partition_read(part_, (uint32_t)page * SampleCodec::kPageBytes, hdr, sizeof(hdr)) != ESP_OK) return false;
+  return SampleCodec::readHeader(hdr, seq, captureId);
+}
+
+void SampleCapture::startDump() {
+  if (!part_) return;
+  stop();
+  // Oldest first: the slot after the head is the next to be overwritten.
+  dumpPage_ = headPage_;
+  dumpLeft_ = pageCount_;
+  dumpSent_ = 0;
+  dumpChunk_ = kDumpChunks;
+  dumping_ = true;
+  Serial.printf("[CAPTURE] dump begin last_capture=%u\n", (unsigned)captureId_);
+}
+
+bool SampleCapture::loadDumpPage_() {
+  while (dumpLeft_) {
+    const uint16_t p = dumpPage_;
+    dumpPage_ = (uint16_t)((dumpPage_ + 1u) % pageCount_);
+    --dumpLeft_;
+    uint32_t seq = 0;
+    uint16_t id = 0;
+    if (!readPageHeader_(p, seq, id)) continue;
+    if (esp_partition_read(part_, (uint32_t)p * SampleCodec::kPageBytes, page_, sizeof(page_)) != ESP_OK) continue;
+    ++dumpSent_;
+    dumpChunk_ = 0;
+    return true;
+  }
+  return false;
+}
+
+void SampleCapture::pumpDump() {
+  while (dumping_) {
+    if (dumpChunk_ >= kDumpChunks && !loadDumpPage_()) {
+      dumping_ = false;
+      Serial.printf("[CAPTURE] dump end pages=%u\n", (unsigned)dumpSent_);
+      return;
+    }
+    // Whole lines only, so log lines from elsewhere cannot split one.
+    if (Serial.availableForWrite() < (int)kLineBytes) return;
+    char line[kLineBytes];
+    int n = snprintf(line, sizeof(line), "[CAPTURE] p %u %u ", (unsigned)dumpSent_, (unsigned)dumpChunk_);
+    const uint8_t* chunk = page_ + (size_t)dumpChunk_ * kDumpChunkBytes;
+    for (uint8_t i = 0; i < kDumpChunkBytes; ++i) {
+      line[n++] = kHex[chunk[i] >> 4];
+      line[n++] = kHex[chunk[i] & 0x0F];
+    }
+    line[n++] = '\n';
+    Serial.write((const uint8_t*)line, (size_t)n);
+    ++dumpChunk_;
+  }
+}
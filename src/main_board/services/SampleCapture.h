@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+#include "app/SampleCodec.h"
+
+// Raw sensor samples recorded to a dedicated flash partition ("capture") so that
+// false alarms and missed detections can be replayed offline against the real
+// sensor classes (tools/capture_player). Pages (app/SampleCodec.h) fill in RAM and
+// are written whole; the partition is a ring, so the oldest pages are erased a
+// sector at a time as it wraps. Runs on the security loop, like EventJournal, and
+// like it accepts the stall of an inline sector erase (every fourth page, and only
+// while a capture is on; see EventJournal.h).
+class SampleCapture {
+public:
+  struct Stats {
+    uint32_t samples = 0;
+    uint32_t pages = 0;     // pages written for this capture
+    uint32_t bytes = 0;     // encoded bytes in those pages
+    uint32_t writeErrors = 0;
+  };
+
+  bool begin();
+  bool ready() const { return part_ != nullptr; }
+
+  // Starts a new capture id; the previous one stays in flash until overwritten.
+  bool start(uint32_t nowMs);
+  // Writes the partial page.
+  void stop();
+  bool active() const { return active_; }
+  uint16_t captureId() const { return captureId_; }
+  const Stats& stats() const { return stats_; }
+
+  void add(uint8_t channel, uint32_t tsMs, uint32_t value);
+
+  // Streams every stored page, oldest first, as "[CAPTURE] p <page> <chunk> <hex>"
+  // lines of kDumpChunkBytes each. pumpDump() writes only what fits the TX buffer,
+  // so a long dump never stalls the loop; recording stops meanwhile.
+  void startDump();
+  void pumpDump();
+  bool dumping() const { return dumping_; }
+
+private:
+  static constexpr uint16_t kPagesPerSector = 4096 / SampleCodec::kPageBytes;
+  static constexpr uint8_t kDumpChunkBytes = 32;
+  static constexpr uint8_t kDumpChunks = SampleCodec::kPageBytes / kDumpChunkBytes;
+  // "[CAPTURE] p <page> <chunk> " + hex chunk + newline
+  static constexpr uint8_t kLineBytes = 24 + 2 * kDumpChunkBytes + 1;
+
+  bool readPageHeader_(uint16_t page, uint32_t& seq, uint16_t& captureId) const;
+  bool writePage_();
+  bool loadDumpPage_();
+
+  const esp_partition_t* part_ = nullptr;
+  uint16_t pageCount_ = 0;
+  uint16_t headPage_ = 0; // next page to write
+  uint32_t nextSeq_ = 1;
+  uint16_t captureId_ = 0;
+  bool active_ = false;
+  bool pageOpen_ = false;
+  uint8_t page_[SampleCodec::kPageBytes]; // open page, or the page being dumped
+  SampleCodec::PageEncoder enc_;
+  Stats stats_;
+
+  bool dumping_ = false;
+  uint16_t dumpPage_ = 0;
+  uint16_t dumpLeft_ = 0;
+  uint16_t dumpSent_ = 0;
+  uint8_t dumpChunk_ = 0;
+};
@@ -2,9 +2,14 @@
 
 #include <Wire.h>
 
+#include <string.h>
+
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 
+#include "app/Clock.h"
+#include "drivers/I2cBus.h"
+
 namespace {
 inline bool reached(uint32_t nowMs, uint32_t targetMs) {
   return (int32_t)(nowMs - targetMs) >= 0;
@@ -18,10 +23,19 @@ inline uint32_t remainingMs(uint32_t nowMs, uint32_t targetMs) {
   const int32_t delta = (int32_t)(targetMs - nowMs);
   return (delta > 0) ? (uint32_t)delta : 0u;
 }
+
+// SSD1306 control bytes. Data goes out in short transactions (same 32-byte framing as
+// the Adafruit driver); one page span is a single bus batch.
+constexpr uint8_t kCtrlCommand = 0x00;
+constexpr uint8_t kCtrlData = 0x40;
+constexpr uint8_t kCmdColumnAddr = 0x21;
+constexpr uint8_t kCmdPageAddr = 0x22;
+constexpr uint8_t kDataChunk = 31; // + control byte
 } // namespace
 
-OledCodeUi::OledCodeUi(uint8_t addr7, uint8_t w, uint8_t h)
-: addr7_(addr7),
+OledCodeUi::OledCodeUi(I2cBus* bus, uint8_t addr7, uint8_t w, uint8_t h)
+: bus_(bus),
+  addr7_(addr7),
   w_(w),
   h_(h),
   disp_(nullptr),
@@ -32,30 +46,48 @@ OledCodeUi::OledCodeUi(uint8_t addr7, uint8_t w, uint8_t h)
   code_[0] = '\0';
 }
 
-bool OledCodeUi::begin() {
+bool OledCodeUi::begin(bool splash) {
   if (disp_) return true;
+  if (!bus_) return false;
 
   // -1 reset pin: common I2C modules omit reset.
-  disp_ = new Adafruit_SSD1306(w_, h_, &Wire, -1);
+  disp_ = new Adafruit_SSD1306(w_, h_, bus_->wire(), -1);
   if (!disp_) return false;
 
-  // Use explicit I2C address.
-  if (!disp_->begin(SSD1306_SWITCHCAPVCC, addr7_)) {
+  // Use explicit I2C address; periphBegin=false because the bus is already configured.
+  bus_->lock(I2cBus::Priority::ui);
+  const bool ok = disp_->begin(SSD1306_SWITCHCAPVCC, addr7_, true, false);
+  bus_->unlock();
+  if (!ok) {
     delete disp_;
     disp_ = nullptr;
     return false;
   }
 
+  const size_t fbLen = (size_t)w_ * ((h_ + 7u) / 8u);
+  sent_ = new uint8_t[fbLen];
+  sentValid_ = false;
+
   disp_->clearDisplay();
   disp_->setTextColor(SSD1306_WHITE);
   disp_->setTextSize(1);
-  disp_->setCursor(0, 0);
-  disp_->println("EmbeddedSecurity");
-  disp_->println("Keypad ready");
-  disp_->display();
-  delay(250);
-
-  render_();
+  if (splash) {
+    disp_->setCursor(0, 0);
+    disp_->println("EmbeddedSecurity");
+    disp_->println("Keypad ready");
+    // Boot continues; the first frame after the banner expires replaces it.
+    splashUntilMs_ = clockMs() + 250;
+    if (splashUntilMs_ == 0) splashUntilMs_ = 1;
+  }
+  // Full frame once so the shadow copy matches the panel; later frames send diffs only.
+  displayAll_();
+  const uint8_t* fb = disp_->getBuffer();
+  if (sent_ && fb) {
+    memcpy(sent_, fb, fbLen);
+    sentValid_ = true;
+  }
+  drawnVersion_ = 0;
+  if (!splash) renderFrame(clockMs());
   return true;
 }
 
@@ -64,6 +96,7 @@ void OledCodeUi::showCode(const char* code, uint8_t len) {
   if (!code) code = "";
   if (len > 4) len = 4;
 
+  portENTER_CRITICAL(&mux_);
   len_ = len;
   for (uint8_t i = 0; i < len_; ++i) {
     code_[i] = code[i];
@@ -73,17 +106,19 @@ void OledCodeUi::showCode(const char* code, uint8_t len) {
   // If user is typing, hide result screen.
   showing_result_ = false;
   result_until_ms_ = 0;
-  dirty_ = true;
-  render_();
+  ++version_;
+  portEXIT_CRITICAL(&mux_);
 }
 
 void OledCodeUi::showResult(bool ok) {
   if (!disp_) return;
+  const uint32_t untilMs = clockMs() + 1200;
+  portENTER_CRITICAL(&mux_);
   showing_result_ = true;
   last_ok_ = ok;
-  result_until_ms_ = millis() + 1200;
-  dirty_ = true;
-  render_();
+  result_until_ms_ = untilMs;
+  ++version_;
+  portEXIT_CRITICAL(&mux_);
 }
 
 void OledCodeUi::setDoorStatus(bool doorLocked,
@@ -93,6 +128,7 @@ void OledCodeUi::setDoorStatus(bool doorLocked,
                                uint32_t countdownWarnBeforeMs) {
   if (!disp_) return;
 
+  portENTER_CRITICAL(&mux_);
   bool changed = false;
   if (doorLocked_ != doorLocked) { doorLocked_ = doorLocked; changed = true; }
   if (doorOpen_ != doorOpen) { doorOpen_ = doorOpen; changed = true; }
@@ -101,59 +137,77 @@ void OledCodeUi::setDoorStatus(bool doorLocked,
   if (countdownDeadlineMs_ != countdownDeadlineMs) { countdownDeadlineMs_ = countdownDeadlineMs; changed = true; }
   if (countdownWarnBeforeMs_ != countdownWarnBeforeMs) { countdownWarnBeforeMs_ = countdownWarnBeforeMs; changed = true; }
 
-  if (changed) {
-    dirty_ = true;
-    render_();
-  }
+  if (changed) ++version_;
+  portEXIT_CRITICAL(&mux_);
+}
+
+void OledCodeUi::setRenderedByWorker(bool worker) {
+  renderedByWorker_ = worker;
 }
 
 void OledCodeUi::update(uint32_t nowMs) {
+  if (renderedByWorker_) return;
+  renderFrame(nowMs);
+}
+
+void OledCodeUi::renderFrame(uint32_t nowMs) {
   if (!disp_) return;
+  if (splashUntilMs_ != 0) {
+    if (!reached(nowMs, splashUntilMs_)) return;
+    splashUntilMs_ = 0;
+  }
+
+  View v;
+  uint32_t version;
+  portENTER_CRITICAL(&mux_);
   if (showing_result_ && result_until_ms_ != 0 && reached(nowMs, result_until_ms_)) {
     showing_result_ = false;
     result_until_ms_ = 0;
-    dirty_ = true;
-    render_();
-    return;
+    ++version_;
   }
+  memcpy(v.code, code_, sizeof(v.code));
+  v.len = len_;
+  v.showingResult = showing_result_;
+  v.lastOk = last_ok_;
+  v.doorLocked = doorLocked_;
+  v.doorOpen = doorOpen_;
+  v.countdownActive = countdownActive_;
+  v.countdownDeadlineMs = countdownDeadlineMs_;
+  v.countdownWarnBeforeMs = countdownWarnBeforeMs_;
+  version = version_;
+  portEXIT_CRITICAL(&mux_);
 
   // Re-render when countdown display should change (once per second).
   int secLeft = -1;
   bool urgent = false;
-  if (countdownActive_ && countdownDeadlineMs_ != 0 && beforeOrAt(nowMs, countdownDeadlineMs_)) {
-    const uint32_t msLeft = remainingMs(nowMs, countdownDeadlineMs_);
+  if (v.countdownActive && v.countdownDeadlineMs != 0 && beforeOrAt(nowMs, v.countdownDeadlineMs)) {
+    const uint32_t msLeft = remainingMs(nowMs, v.countdownDeadlineMs);
     secLeft = (int)((msLeft + 999u) / 1000u);
-    urgent = (countdownWarnBeforeMs_ != 0) && ((uint32_t)secLeft * 1000u <= countdownWarnBeforeMs_);
+    urgent = (v.countdownWarnBeforeMs != 0) && ((uint32_t)secLeft * 1000u <= v.countdownWarnBeforeMs);
   }
 
-  if (dirty_ || secLeft != lastCountdownSec_ || urgent != lastCountdownUrgent_) {
-    lastCountdownSec_ = secLeft;
-    lastCountdownUrgent_ = urgent;
-    render_();
-  }
-}
+  if (version == drawnVersion_ && secLeft == lastCountdownSec_ && urgent == lastCountdownUrgent_) return;
+  drawnVersion_ = version;
+  lastCountdownSec_ = secLeft;
+  lastCountdownUrgent_ = urgent;
 
-void OledCodeUi::render_() {
-  if (!disp_) return;
-
-  dirty_ = false;
+  draw_(v, secLeft, urgent);
+  flush_();
+}
 
+void OledCodeUi::draw_(const View& v, int secLeft, bool urgent) {
   disp_->clearDisplay();
   disp_->setTextColor(SSD1306_WHITE);
   disp_->setTextSize(1);
   disp_->setCursor(0, 0);
   disp_->print("DOOR: ");
-  disp_->print(doorLocked_ ? "LOCK" : "UNLOCK");
-  if (doorOpen_) disp_->print(" OPEN");
+  disp_->print(v.doorLocked ? "LOCK" : "UNLOCK");
+  if (v.doorOpen) disp_->print(" OPEN");
 
-  const uint32_t nowMs = millis();
-  if (countdownActive_ && countdownDeadlineMs_ != 0 && beforeOrAt(nowMs, countdownDeadlineMs_)) {
-    const uint32_t msLeft = remainingMs(nowMs, countdownDeadlineMs_);
-    const uint32_t secLeft = (msLeft + 999u) / 1000u;
+  if (secLeft >= 0) {
     disp_->print(" ");
     disp_->print(secLeft);
     disp_->print("s");
-    const bool urgent = (countdownWarnBeforeMs_ != 0) && (secLeft * 1000u <= countdownWarnBeforeMs_);
     if (urgent) disp_->print("!");
   }
   disp_->println();
@@ -162,22 +216,75 @@ void OledCodeUi::render_() {
 
   disp_->setTextSize(2);
   disp_->setCursor(0, 16);
-  if (len_ == 0) {
+  if (v.len == 0) {
     disp_->println("____");
   } else {
     // Show the digits as entered (per request).
-    disp_->print(code_);
-    for (uint8_t i = len_; i < 4; ++i) disp_->print('_');
+    disp_->print(v.code);
+    for (uint8_t i = v.len; i < 4; ++i) disp_->print('_');
     disp_->println();
   }
 
   disp_->setTextSize(2);
   disp_->setCursor(0, 44);
-  if (showing_result_) {
-    disp_->print(last_ok_ ? "OK" : "ERR");
+  if (v.showingResult) {
+    disp_->print(v.lastOk ? "OK" : "ERR");
   } else {
     disp_->print("    ");
   }
+}
+
+// Sends only the changed column span of each 8-row page. A digit change touches two
+// pages of ~24 columns instead of the full 1 KiB frame.
+void OledCodeUi::flush_() {
+  const uint8_t* fb = disp_->getBuffer();
+  if (!fb || !sent_ || !sentValid_) {
+    displayAll_();
+    if (fb && sent_) {
+      memcpy(sent_, fb, (size_t)w_ * ((h_ + 7u) / 8u));
+      sentValid_ = true;
+    }
+    return;
+  }
 
+  const uint8_t pages = (uint8_t)((h_ + 7u) / 8u);
+  for (uint8_t page = 0; page < pages; ++page) {
+    const size_t row = (size_t)page * w_;
+    int first = -1;
+    int last = -1;
+    for (uint8_t col = 0; col < w_; ++col) {
+      if (fb[row + col] != sent_[row + col]) {
+        if (first < 0) first = col;
+        last = col;
+      }
+    }
+    if (first < 0) continue;
+
+    if (!sendSpan_(page, (uint8_t)first, (uint8_t)last, fb + row + first)) {
+      sentValid_ = false; // panel contents unknown; next frame goes out in full
+      return;
+    }
+    memcpy(sent_ + row + first, fb + row + first, (size_t)(last - first + 1));
+  }
+}
+
+void OledCodeUi::displayAll_() {
+  bus_->lock(I2cBus::Priority::ui);
   disp_->display();
+  bus_->unlock();
+}
+
+bool OledCodeUi::sendSpan_(uint8_t page, uint8_t firstCol, uint8_t lastCol, const uint8_t* data) {
+  const uint8_t cmd[] = {kCmdColumnAddr, firstCol, lastCol, kCmdPageAddr, page, page};
+  I2cBus::Batch b(addr7_);
+  b.write(cmd, sizeof(cmd), kCtrlCommand);
+
+  uint8_t left = (uint8_t)(lastCol - firstCol + 1);
+  while (left > 0) {
+    const uint8_t n = (left > kDataChunk) ? kDataChunk : left;
+    b.write(data, n, kCtrlData);
+    data += n;
+    left = (uint8_t)(left - n);
+  }
+  return bus_->run(b, I2cBus::Priority::ui);
 }
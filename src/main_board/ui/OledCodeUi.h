@@ -3,12 +3,20 @@
 #include <Arduino.h>
 
 class Adafruit_SSD1306;
+class I2cBus;
 
+// Keypad/door-status screen.
+//
+// Setters only update a small view model (cheap, safe from the security loop).
+// renderFrame() draws the view into the GFX buffer and sends just the SSD1306 page
+// column spans that differ from the last frame sent. It runs from the UI worker
+// task when one is attached, otherwise update() renders inline.
 class OledCodeUi {
 public:
-  OledCodeUi(uint8_t addr7, uint8_t w = 128, uint8_t h = 64);
+  OledCodeUi(I2cBus* bus, uint8_t addr7, uint8_t w = 128, uint8_t h = 64);
 
-  bool begin();
+  // The splash banner stays up for 250 ms without blocking; splash=false skips it (warm restart).
+  bool begin(bool splash = true);
   void showCode(const char* code, uint8_t len);
   void showResult(bool ok);
   // Updates the door status line (does not change keypad/PIN UX).
@@ -19,7 +27,24 @@ public:
                      uint32_t countdownWarnBeforeMs);
   void update(uint32_t nowMs);
 
+  // Once set, update() leaves rendering to the worker calling renderFrame().
+  void setRenderedByWorker(bool worker);
+  void renderFrame(uint32_t nowMs);
+
 private:
+  struct View {
+    char code[5];
+    uint8_t len;
+    bool showingResult;
+    bool lastOk;
+    bool doorLocked;
+    bool doorOpen;
+    bool countdownActive;
+    uint32_t countdownDeadlineMs;
+    uint32_t countdownWarnBeforeMs;
+  };
+
+  I2cBus* bus_;
   uint8_t addr7_;
   uint8_t w_;
   uint8_t h_;
@@ -28,6 +53,10 @@ private:
   // (reduces compile impact on non-UI files).
   Adafruit_SSD1306* disp_;
 
+  // View model; written by the security loop, read by the renderer (guarded by mux_).
+  portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+  uint32_t version_ = 1;
+
   char code_[5];
   uint8_t len_;
 
@@ -42,10 +71,18 @@ private:
   bool countdownActive_ = false;
   uint32_t countdownDeadlineMs_ = 0;
   uint32_t countdownWarnBeforeMs_ = 0;
+
+  // Renderer state (renderer context only).
+  bool renderedByWorker_ = false;
+  uint32_t drawnVersion_ = 0;
   int lastCountdownSec_ = -1;
   bool lastCountdownUrgent_ = false;
+  uint32_t splashUntilMs_ = 0;
+  uint8_t* sent_ = nullptr; // last framebuffer sent to the panel
+  bool sentValid_ = false;
 
-  bool dirty_ = true;
-
-  void render_();
+  void draw_(const View& v, int secLeft, bool urgent);
+  void flush_();
+  void displayAll_();
+  bool sendSpan_(uint8_t page, uint8_t firstCol, uint8_t lastCol, const uint8_t* data);
 };
@@ -0,0 +1,132 @@
+// Host benchmark: per-channel (one object per input, as the old sensor classes did)
+// vs bit-parallel (InputMap + EdgeTracker) edge detection and debounce.
+//
+// Both paths consume the same pre-generated GPIO snapshots, so the numbers compare
+// only the edge/debounce logic; on the target the per-channel path also pays one
+// digitalRead() per input, the snapshot path two register loads per tick.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "app/InputSnapshot.h"
+
+namespace {
+
+struct ScalarChannel {
+  uint8_t pin;
+  uint16_t holdMs;
+  bool lastRaw;
+  bool stable;
+  uint32_t lastFlipMs;
+};
+
+struct Counts {
+  uint32_t rose = 0;
+  uint32_t settledRose = 0;
+};
+
+// Deterministic xorshift so runs are repeatable.
+uint32_t rng(uint32_t& s) {
+  s ^= s << 13;
+  s ^= s >> 17;
+  s ^= s << 5;
+  return s;
+}
+
+std::vector<uint64_t> makeSnapshots(const std::vector<uint8_t>& pins, size_t ticks) {
+  std::vector<uint64_t> out(ticks);
+  uint32_t seed = 0x1234567u;
+  uint64_t level = 0;
+  for (size_t t = 0; t < ticks; ++t) {
+    // ~2% of ticks toggle one input; a toggle bounces for a few ticks.
+    if ((rng(seed) % 100u) < 2u) {
+      const uint8_t pin = pins[rng(seed) % pins.size()];
+      level ^= (uint64_t)1u << pin;
+      if ((rng(seed) & 3u) == 0 && t + 3 < ticks) {
+        out[t] = level ^ ((uint64_t)1u << pin); // bounce
+        ++t;
+      }
+    }
+    out[t] = level;
+  }
+  return out;
+}
+
+Counts runScalar(std::vector<ScalarChannel> ch, const std::vector<uint64_t>& snaps, double& nsPerTick) {
+  Counts c;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < snaps.size(); ++t) {
+    const uint32_t nowMs = (uint32_t)t;
+    const uint64_t gpio = snaps[t];
+    for (size_t i = 0; i < ch.size(); ++i) {
+      ScalarChannel& s = ch[i];
+      const bool raw = InputSnapshot::pinHigh(gpio, s.pin);
+      if (raw != s.lastRaw) {
+        if (raw) ++c.rose;
+        s.lastRaw = raw;
+        s.lastFlipMs = nowMs;
+      }
+      if ((nowMs - s.lastFlipMs) < s.holdMs) continue;
+      if (s.stable != raw) {
+        s.stable = raw;
+        if (raw) ++c.settledRose;
+      }
+    }
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  nsPerTick = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / (double)snaps.size();
+  return c;
+}
+
+Counts runParallel(const std::vector<uint8_t>& pins, uint16_t holdMs, const std::vector<uint64_t>& snaps, double& nsPerTick) {
+  InputMap map;
+  EdgeTracker edges;
+  for (size_t i = 0; i < pins.size(); ++i) {
+    map.add((uint8_t)i, pins[i]);
+    edges.setHold((uint8_t)i, holdMs);
+  }
+  edges.reset(0, 0);
+
+  Counts c;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < snaps.size(); ++t) {
+    const EdgeTracker::Step s = edges.update(map.gather(snaps[t]), (uint32_t)t);
+    c.rose += (uint32_t)__builtin_popcount(s.rose);
+    c.settledRose += (uint32_t)__builtin_popcount(s.settledRose);
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  nsPerTick = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / (double)snaps.size();
+  return c;
+}
+
+} // namespace
+
+int main() {
+  const size_t kTicks = 2000000;
+  const uint16_t kHoldMs = 5; // one tick = 1 ms here
+  bool ok = true;
+
+  std::printf("channels  scalar_ns/tick  parallel_ns/tick  speedup\n");
+  for (size_t n : {4u, 8u, 16u, 32u}) {
+    std::vector<uint8_t> pins;
+    for (size_t i = 0; i < n; ++i) pins.push_back((uint8_t)((i * 7u) % 40u));
+
+    std::vector<ScalarChannel> ch;
+    for (uint8_t p : pins) ch.push_back({p, kHoldMs, false, false, 0});
+
+    const std::vector<uint64_t> snaps = makeSnapshots(pins, kTicks);
+    double scalarNs = 0;
+    double parallelNs = 0;
+    const Counts a = runScalar(ch, snaps, scalarNs);
+    const Counts b = runParallel(pins, kHoldMs, snaps, parallelNs);
+    if (a.rose != b.rose || a.settledRose != b.settledRose) {
+      std::fprintf(stderr, "mismatch at %zu channels: rose %u/%u settled %u/%u\n",
+                   n, a.rose, b.rose, a.settledRose, b.settledRose);
+      ok = false;
+    }
+    std::printf("%8zu  %14.1f  %16.1f  %6.2fx\n", n, scalarNs, parallelNs, scalarNs / parallelNs);
+  }
+  return ok ? 0 : 1;
+}
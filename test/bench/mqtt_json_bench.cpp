@@ -0,0 +1,192 @@
+// Host benchmark: main-status field extraction on the auto board, the old
+// per-field extractor vs the single-pass tokenizer (app/MainStatusScan.h).
+//
+// The old path is reproduced here on std::string as it ran in onMqttMessage: copy
+// the payload byte by byte into a string, then one search from the start per key
+// (mode, isSomeoneHome, someone_home), each building a quoted needle. The new path
+// reads the payload buffer once and allocates nothing. Payloads are status messages
+// as the main board publishes them (MqttClient::publishStatus), plus presence
+// variants from other publishers.
+//
+//   tools/run_mqtt_json_bench.sh [iterations]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "auto_board/app/MainStatusScan.h"
+
+namespace {
+
+const char* const kPayloads[] = {
+  "{\"reason\":\"heartbeat\",\"mode\":\"away\",\"level\":\"normal\",\"door_locked\":true,"
+  "\"window_locked\":true,\"door_open\":false,\"window_open\":false,\"sensor_faults\":0,"
+  "\"uptime_ms\":8412203}",
+  "{\"reason\":\"mode_change\",\"mode\":\"disarm\",\"level\":\"normal\",\"door_locked\":false,"
+  "\"window_locked\":false,\"door_open\":true,\"window_open\":false,\"sensor_faults\":0,"
+  "\"uptime_ms\":913377}",
+  "{\"reason\":\"heartbeat\",\"mode\":\"night\",\"level\":\"alert\",\"door_locked\":true,"
+  "\"window_locked\":true,\"door_open\":false,\"window_open\":false,\"sensor_faults\":2,"
+  "\"uptime_ms\":40211876,\"degrade\":\"stretch_heartbeat\"}",
+  "{\"reason\":\"boot\",\"mode\":\"startup_safe\",\"level\":\"normal\",\"door_locked\":true,"
+  "\"window_locked\":true,\"door_open\":false,\"window_open\":false,\"sensor_faults\":0,"
+  "\"uptime_ms\":2114,\"boot_ms\":{\"pre\":312,\"nvs\":18,\"sensors\":407,\"wifi\":1190,"
+  "\"mqtt\":173,\"total\":1788},\"mqtt_up_ms\":2101}",
+  "{\"mode\":\"Away \",\"isSomeoneHome\":false,\"source\":\"phone\"}",
+  "{\"someone_home\":true,\"mode\":\"disarm\",\"ts\":1718000000}",
+  "{\"isSomeoneHome\" : true , \"someone_home\" : false}",
+  "{\"reason\":\"online\",\"reconnect_ms\":5210}",
+};
+
+constexpr size_t kPayloadCount = sizeof(kPayloads) / sizeof(kPayloads[0]);
+
+struct Fields {
+  bool hasMode = false;
+  std::string mode;
+  bool hasPresence = false;
+  bool someoneHome = false;
+};
+
+bool sameFields(const Fields& a, const Fields& b) {
+  return a.hasMode == b.hasMode && (!a.hasMode || a.mode == b.mode) &&
+         a.hasPresence == b.hasPresence && (!a.hasPresence || a.someoneHome == b.someoneHome);
+}
+
+// --- old extractor ---------------------------------------------------------------
+
+bool isJsonWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool isJsonDelimiter(char c) {
+  return c == ',' || c == '}' || c == ']' || isJsonWhitespace(c);
+}
+
+int findJsonValueStart(const std::string& payload, const char* key) {
+  const std::string needle = std::string("\"") + std::string(key) + std::string("\"");
+  size_t from = 0;
+  while (from < payload.size()) {
+    const size_t keyPos = payload.find(needle, from);
+    if (keyPos == std::string::npos) return -1;
+    size_t pos = keyPos + needle.size();
+    while (pos < payload.size() && isJsonWhitespace(payload[pos])) ++pos;
+    if (pos >= payload.size() || payload[pos] != ':') {
+      from = keyPos + 1;
+      continue;
+    }
+    ++pos;
+    while (pos < payload.size() && isJsonWhitespace(payload[pos])) ++pos;
+    if (pos >= payload.size()) return -1;
+    return (int)pos;
+  }
+  return -1;
+}
+
+bool extractJsonStringField(const std::string& payload, const char* key, std::string& out) {
+  const int valueStart = findJsonValueStart(payload, key);
+  if (valueStart < 0 || payload[valueStart] != '"') return false;
+  out = "";
+  bool escaping = false;
+  for (size_t i = (size_t)valueStart + 1; i < payload.size(); ++i) {
+    const char c = payload[i];
+    if (escaping) {
+      out += c;
+      escaping = false;
+      continue;
+    }
+    if (c == '\\') {
+      escaping = true;
+      continue;
+    }
+    if (c == '"') return true;
+    out += c;
+  }
+  return false;
+}
+
+bool extractJsonBoolField(const std::string& payload, const char* key, bool& out) {
+  const int valueStart = findJsonValueStart(payload, key);
+  if (valueStart < 0) return false;
+  for (int v = 1; v >= 0; --v) {
+    const char* word = v ? "true" : "false";
+    const size_t n = strlen(word);
+    if (payload.compare((size_t)valueStart, n, word) != 0) continue;
+    const size_t end = (size_t)valueStart + n;
+    if (end >= payload.size() || isJsonDelimiter(payload[end])) {
+      out = v != 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+Fields extractOld(const uint8_t* payload, size_t length) {
+  std::string raw;
+  raw.reserve(length);
+  for (size_t i = 0; i < length; ++i) raw += static_cast<char>(payload[i]);
+  Fields f;
+  f.hasMode = extractJsonStringField(raw, "mode", f.mode);
+  f.hasPresence = extractJsonBoolField(raw, "isSomeoneHome", f.someoneHome) ||
+                  extractJsonBoolField(raw, "someone_home", f.someoneHome);
+  return f;
+}
+
+// --- single pass -----------------------------------------------------------------
+
+Fields extractScan(const uint8_t* payload, size_t length) {
+  const MainStatusFields s = scanMainStatus(payload, length);
+  Fields f;
+  f.hasMode = s.hasMode;
+  if (s.hasMode) f.mode = s.mode;
+  f.hasPresence = s.hasPresence;
+  f.someoneHome = s.someoneHome;
+  return f;
+}
+
+template <typename Fn>
+double nsPerPayload(Fn fn, size_t iterations, uint32_t& sink) {
+  const auto t0 = std::chrono::steady_clock::now();
+  for (size_t it = 0; it < iterations; ++it) {
+    for (size_t i = 0; i < kPayloadCount; ++i) {
+      const uint8_t* p = reinterpret_cast<const uint8_t*>(kPayloads[i]);
+      const Fields f = fn(p, strlen(kPayloads[i]));
+      sink += (uint32_t)f.hasMode + (uint32_t)f.someoneHome + (uint32_t)f.mode.size();
+    }
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+  return ns / (double)(iterations * kPayloadCount);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t iterations = (argc > 1) ? (size_t)strtoul(argv[1], nullptr, 10) : 200000u;
+  bool ok = true;
+
+  for (size_t i = 0; i < kPayloadCount; ++i) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(kPayloads[i]);
+    const size_t n = strlen(kPayloads[i]);
+    const Fields a = extractOld(p, n);
+    const Fields b = extractScan(p, n);
+    if (!sameFields(a, b)) {
+      std::fprintf(stderr, "mismatch on payload %zu: mode %d'%s'/%d'%s' presence %d%d/%d%d\n",
+                   i, a.hasMode, a.mode.c_str(), b.hasMode, b.mode.c_str(),
+                   a.hasPresence, a.someoneHome, b.hasPresence, b.someoneHome);
+      ok = false;
+    }
+  }
+
+  uint32_t sink = 0;
+  const double oldNs = nsPerPayload(extractOld, iterations, sink);
+  const double scanNs = nsPerPayload(extractScan, iterations, sink);
+  std::printf("payloads=%zu iterations=%zu\n", kPayloadCount, iterations);
+  std::printf("extractor      ns/payload\n");
+  std::printf("per-field      %10.1f\n", oldNs);
+  std::printf("single-pass    %10.1f  (%.2fx)\n", scanNs, oldNs / scanNs);
+  std::printf("checksum %u\n", sink);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+// Host benchmark: QoS1 publish throughput and PUBACK latency per in-flight window,
+// against a real broker (default a local Mosquitto on 127.0.0.1:1883).
+//
+// Uses the firmware's MqttPacket encoder/reader and InflightWindow over a plain
+// POSIX socket, so only the transport differs from the board. Latency is measured
+// in microseconds (InflightWindow only subtracts timestamps).
+//
+//   tools/run_mqtt_qos_bench.sh [host] [port] [messages]
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#include "app/InflightWindow.h"
+#include "app/MqttPacket.h"
+
+namespace {
+
+const char* kTopic = "esh/bench/qos1";
+
+uint32_t nowUs() {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+int openSocket(const char* host, const char* port) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* res = nullptr;
+  if (getaddrinfo(host, port, &hints, &res) != 0) return -1;
+  int fd = -1;
+  for (addrinfo* a = res; a; a = a->ai_next) {
+    fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd < 0) continue;
+    if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(res);
+  if (fd >= 0) {
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  return fd;
+}
+
+bool sendAll(int fd, const uint8_t* p, size_t n) {
+  while (n) {
+    const ssize_t w = send(fd, p, n, 0);
+    if (w <= 0) return false;
+    p += w;
+    n -= (size_t)w;
+  }
+  return true;
+}
+
+class Session {
+public:
+  explicit Session(int fd) : fd_(fd) {}
+
+  bool connect() {
+    MqttPacket::ConnectOpts o;
+    o.clientId = "esh-qos-bench";
+    o.keepAliveS = 60;
+    uint8_t buf[64];
+    const size_t n = MqttPacket::connect(buf, sizeof(buf), o);
+    if (!n || !sendAll(fd_, buf, n)) return false;
+    while (readPacket(2000)) {
+      if (rx_.type() == MqttPacket::CONNACK) return rx_.length() >= 2 && rx_.body()[1] == 0;
+    }
+    return false;
+  }
+
+  // Waits up to timeoutMs for one complete packet.
+  bool readPacket(int timeoutMs) {
+    for (;;) {
+      while (at_ < got_) {
+        if (rx_.feed(in_[at_++])) return true;
+      }
+      pollfd p{fd_, POLLIN, 0};
+      if (poll(&p, 1, timeoutMs) <= 0) return false;
+      const ssize_t r = recv(fd_, in_, sizeof(in_), 0);
+      if (r <= 0) return false;
+      at_ = 0;
+      got_ = (size_t)r;
+    }
+  }
+
+  bool hasBuffered() const { return at_ < got_; }
+  const MqttPacket::Reader<256>& rx() const { return rx_; }
+  int fd() const { return fd_; }
+
+private:
+  int fd_;
+  MqttPacket::Reader<256> rx_;
+  uint8_t in_[4096];
+  size_t at_ = 0;
+  size_t got_ = 0;
+};
+
+struct Result {
+  double msgsPerS = 0;
+  InflightWindow::Stats stats;
+  bool ok = false;
+};
+
+// Publishes `messages` event-sized payloads; a message only counts once PUBACKed.
+Result run(Session& s, uint8_t window, uint32_t messages) {
+  static const char kPayload[] =
+    "{\"event\":\"door_open\",\"src\":1,\"zone\":\"perimeter\",\"cmd\":\"none\",\"mode\":\"away\","
+    "\"level\":\"warn\",\"door_locked\":false,\"window_locked\":true,\"door_open\":true,"
+    "\"window_open\":false,\"ts_ms\":123456}";
+  const size_t payloadLen = sizeof(kPayload) - 1;
+
+  Result r;
+  InflightWindow w(window);
+  uint32_t remaining = messages;
+  uint8_t pkt[512];
+  const auto t0 = std::chrono::steady_clock::now();
+
+  while (remaining > 0) {
+    int16_t pos;
+    while ((pos = w.nextToSend(remaining)) >= 0) {
+      bool dup = false;
+      const uint16_t pid = w.sent(pos, nowUs(), dup);
+      const size_t hdr = MqttPacket::publishHeader(pkt, sizeof(pkt), kTopic, payloadLen, 1, false, dup, pid);
+      std::memcpy(pkt + hdr, kPayload, payloadLen);
+      if (!sendAll(s.fd(), pkt, hdr + payloadLen)) return r;
+    }
+    if (!s.readPacket(5000)) return r;
+    // Drain everything already received before sending more.
+    do {
+      if (s.rx().type() == MqttPacket::PUBACK) w.ack(s.rx().packetId(), nowUs());
+    } while (s.hasBuffered() && s.readPacket(0));
+    remaining -= w.takeAcked();
+  }
+
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  r.msgsPerS = (double)messages / secs;
+  r.stats = w.stats();
+  r.ok = true;
+  return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* host = (argc > 1) ? argv[1] : "127.0.0.1";
+  const char* port = (argc > 2) ? argv[2] : "1883";
+  const uint32_t messages = (argc > 3) ? (uint32_t)std::strtoul(argv[3], nullptr, 10) : 5000u;
+
+  const int fd = openSocket(host, port);
+  if (fd < 0) {
+    std::fprintf(stderr, "cannot reach broker at %s:%s\n", host, port);
+    return 1;
+  }
+  Session s(fd);
+  if (!s.connect()) {
+    std::fprintf(stderr, "CONNECT rejected or timed out\n");
+    close(fd);
+    return 1;
+  }
+
+  bool ok = true;
+  std::printf("broker %s:%s, %u messages per run\n", host, port, (unsigned)messages);
+  std::printf("window  msgs/s    ack_avg_us  ack_max_us\n");
+  for (uint8_t window : {1, 2, 4, 8, 16}) {
+    const Result r = run(s, window, messages);
+    if (!r.ok || r.stats.acked != messages) {
+      std::fprintf(stderr, "window %u: run failed (%u acked)\n", (unsigned)window, (unsigned)r.stats.acked);
+      ok = false;
+      break;
+    }
+    std::printf("%6u  %8.0f  %10u  %10u\n", (unsigned)window, r.msgsPerS, (unsigned)r.stats.ackAvgMs,
+                (unsigned)r.stats.ackMaxMs);
+  }
+
+  uint8_t bye[2];
+  sendAll(fd, bye, MqttPacket::simple(bye, sizeof(bye), MqttPacket::DISCONNECT));
+  close(fd);
+  return ok ? 0 : 1;
+}
@@ -1,8 +1,32 @@
 #include <iostream>
 
+#include <cstring>
+#include <vector>
+
+#include "app/BootProfile.h"
+#include "app/BuzzerPatterns.h"
+#include "app/Clock.h"
+#include "app/InflightWindow.h"
+#include "app/InjectFrame.h"
+#include "app/InputSnapshot.h"
+#include "app/JournalCodec.h"
 #include "app/ModeOverrideWindow.h"
+#include "app/MqttPacket.h"
+#include "app/MotionProfile.h"
+#include "app/OverloadControl.h"
+#include "app/PackedSystemState.h"
+#include "app/PublishLanes.h"
+#include "app/Reconnect.h"
 #include "app/ReplayGuard.h"
 #include "app/RuleEngine.h"
+#include "app/SampleCodec.h"
+#include "app/SamplingPolicy.h"
+#include "app/SensorHealth.h"
+#include "app/SensorRegistry.h"
+#include "app/StoreEviction.h"
+#include "app/VibrationBurst.h"
+#include "app/WarmSnapshot.h"
+#include "auto_board/app/MainStatusScan.h"
 
 namespace {
 
@@ -47,6 +71,29 @@ bool test_armed_door_open_starts_entry_countdown() {
   return true;
 }
 
+bool test_rearm_during_entry_countdown_cancels_the_countdown() {
+  RuleEngine engine;
+  Config cfg;
+  SystemState st;
+  st.mode = Mode::away;
+
+  const SystemState counting = engine.handle(st, cfg, {EventType::door_open, 1000, 1}).next;
+  CHECK(counting.entry_pending);
+
+  // arm_away while counting down resets the state without a buzzer command.
+  const Decision rearm = engine.handle(counting, cfg, {EventType::arm_away, 3000, 9});
+  CHECK(rearm.next.mode == Mode::away && !rearm.next.entry_pending);
+  CHECK(rearm.cmd.type == CommandType::none);
+  CHECK(entryCountdownCancelled(counting, rearm.next));
+
+  CHECK(entryCountdownCancelled(counting, engine.handle(counting, cfg, {EventType::disarm, 3000, 9}).next));
+  // Ending in an alarm hands the buzzer to the alert pattern instead.
+  const Decision timeout = engine.handle(counting, cfg, {EventType::entry_timeout, 1000 + cfg.entry_delay_ms, 0});
+  CHECK(timeout.cmd.type == CommandType::buzzer_alert && !entryCountdownCancelled(counting, timeout.next));
+  CHECK(!entryCountdownCancelled(st, rearm.next));
+  return true;
+}
+
 bool test_locked_door_open_escalates_alert_in_any_mode() {
   RuleEngine engine;
   Config cfg;
@@ -105,6 +152,950 @@ bool test_replay_guard_blocks_replay_and_allows_after_expiry() {
   return true;
 }
 
+bool test_journal_codec_roundtrip_with_deltas_and_erased_tail() {
+  uint8_t buf[64];
+  std::memset(buf, 0xFF, sizeof(buf));
+
+  JournalCodec::Record a;
+  a.ts_ms = 0xFFFFFF00u;
+  a.type = EventType::door_open;
+  a.src = 1;
+  a.score_delta = 15;
+  a.level = AlarmLevel::warn;
+  JournalCodec::Record b;
+  b.ts_ms = 0x00000010u; // millis() wrap between records
+  b.type = EventType::disarm;
+  b.src = 9;
+  b.score_delta = -100;
+  b.level = AlarmLevel::off;
+
+  size_t n = JournalCodec::encodeBoot(buf, 7, 0xFFFFFE00u);
+  n += JournalCodec::encodeEvent(buf + n, a, 0xFFFFFE00u);
+  n += JournalCodec::encodeEvent(buf + n, b, a.ts_ms);
+  CHECK(n <= 3 * JournalCodec::kMaxRecordBytes);
+
+  JournalCodec::Decoder dec;
+  JournalCodec::Record r;
+  size_t pos = 0;
+  CHECK(dec.next(buf, sizeof(buf), pos, r) == JournalCodec::Decoder::Result::boot);
+  CHECK(dec.boot() == 7);
+  CHECK(dec.next(buf, sizeof(buf), pos, r) == JournalCodec::Decoder::Result::record);
+  CHECK(r.boot == 7 && r.ts_ms == a.ts_ms && r.type == a.type && r.src == 1);
+  CHECK(r.score_delta == 15 && r.level == AlarmLevel::warn);
+  CHECK(dec.next(buf, sizeof(buf), pos, r) == JournalCodec::Decoder::Result::record);
+  CHECK(r.ts_ms == b.ts_ms && r.type == EventType::disarm && r.score_delta == -100);
+  CHECK(dec.next(buf, sizeof(buf), pos, r) == JournalCodec::Decoder::Result::end);
+
+  // Every event type decodes, up to the last one; the type after it is corruption.
+  JournalCodec::Record last = b;
+  last.type = (EventType)((uint8_t)EventType::count - 1u);
+  size_t tail = pos;
+  tail += JournalCodec::encodeEvent(buf + tail, last, b.ts_ms);
+  CHECK(dec.next(buf, sizeof(buf), pos, r) == JournalCodec::Decoder::Result::record && r.type == last.type);
+  last.type = EventType::count;
+  JournalCodec::encodeEvent(buf + tail, last, b.ts_ms);
+  CHECK(dec.next(buf, sizeof(buf), pos, r) == JournalCodec::Decoder::Result::corrupt);
+
+  // A record cut by the read window rewinds so the caller can refill from its tag byte.
+  size_t cut = 0;
+  dec.reset();
+  CHECK(dec.next(buf, 2, cut, r) == JournalCodec::Decoder::Result::truncated);
+  CHECK(cut == 0);
+  return true;
+}
+
+bool test_packed_system_state_roundtrip_and_clamp() {
+  SystemState st;
+  st.mode = Mode::away;
+  st.level = AlarmLevel::alert;
+  st.suspicion_score = 87;
+  st.entry_pending = true;
+  st.door_locked = true;
+  st.window_open = true;
+  st.last_door_event_ms = 0xFFFFFFF0u;
+  st.last_vibration_ms = 0x00000020u; // newest, after millis() wrap
+  st.entry_deadline_ms = 0xFFFFF000u;
+
+  PackedSystemState p;
+  CHECK(PackedSystemState::pack(st, p));
+  CHECK(p.modeValue() == Mode::away && p.levelValue() == AlarmLevel::alert);
+  const SystemState u = p.unpack();
+  CHECK(u.mode == st.mode && u.level == st.level && u.suspicion_score == 87);
+  CHECK(u.entry_pending && u.door_locked && !u.window_locked && u.window_open && !u.door_open);
+  CHECK(u.last_door_event_ms == st.last_door_event_ms);
+  CHECK(u.last_vibration_ms == st.last_vibration_ms);
+  CHECK(u.entry_deadline_ms == st.entry_deadline_ms);
+  CHECK(u.last_notify_ms == 0 && u.last_outdoor_motion_ms == 0);
+
+  // Timestamps far behind the newest one clamp but stay non-zero and ordered.
+  st.last_notify_ms = 0x00000020u - 200000u;
+  CHECK(!PackedSystemState::pack(st, p));
+  const SystemState c = p.unpack();
+  CHECK(c.last_notify_ms != 0);
+  CHECK((uint32_t)(st.last_vibration_ms - c.last_notify_ms) == PackedSystemState::kMaxAgeMs);
+  CHECK(c.last_vibration_ms == st.last_vibration_ms);
+  return true;
+}
+
+bool test_warm_snapshot_seal_open_rejects_corruption_and_rebases() {
+  SystemState st;
+  st.mode = Mode::away;
+  st.level = AlarmLevel::warn;
+  st.entry_pending = true;
+  st.entry_deadline_ms = 0xFFFFF000u + 30000u; // pending deadline across millis() wrap
+  st.suspicion_score = 42;
+
+  uint32_t words[WarmSnapshot::wordsFor(sizeof(SystemState))] = {};
+  SystemState out;
+  uint32_t takenMs = 0;
+  CHECK(!WarmSnapshot::open(words, sizeof(words) / 4, &out, sizeof(out), takenMs)); // zeroed = cold
+  // RTC_NOINIT memory after power-on: arbitrary bits, even a matching magic.
+  for (size_t i = 0; i < sizeof(words) / 4; ++i) words[i] = 0x9E3779B9u * (uint32_t)(i + 1);
+  words[0] = WarmSnapshot::kMagic;
+  words[1] = sizeof(SystemState);
+  CHECK(!WarmSnapshot::open(words, sizeof(words) / 4, &out, sizeof(out), takenMs));
+
+  CHECK(WarmSnapshot::seal(words, sizeof(words) / 4, &st, sizeof(st), 0xFFFFF000u));
+  CHECK(WarmSnapshot::open(words, sizeof(words) / 4, &out, sizeof(out), takenMs));
+  CHECK(takenMs == 0xFFFFF000u && out.mode == Mode::away && out.suspicion_score == 42);
+  CHECK(WarmSnapshot::plausible(out));
+
+  // Resumed 150 ms into the new boot: the deadline keeps its 30 s remaining.
+  WarmSnapshot::rebaseState(out, 150u - takenMs);
+  CHECK(out.entry_deadline_ms == 150u + 30000u);
+  CHECK(out.last_notify_ms == 0);
+
+  reinterpret_cast<uint8_t*>(words)[sizeof(WarmSnapshot::Header) + 3] ^= 0x10u;
+  CHECK(!WarmSnapshot::open(words, sizeof(words) / 4, &out, sizeof(out), takenMs));
+  return true;
+}
+
+bool test_entry_delay_expires_across_two_warm_resets() {
+  SystemState st;
+  st.mode = Mode::away;
+  st.entry_pending = true;
+  uint32_t now = 1000;
+  st.entry_deadline_ms = now + 30000u;
+
+  // The loop re-seals every kRefreshMs; each boot resets off that grid.
+  uint32_t words[WarmSnapshot::wordsFor(sizeof(SystemState))] = {};
+  uint32_t takenMs = now;
+  CHECK(WarmSnapshot::seal(words, sizeof(words) / 4, &st, sizeof(st), takenMs));
+  const uint32_t runMs[] = {12345, 9876, 60000};
+  uint32_t ran = 0;
+  bool expired = false;
+  for (size_t boot = 0; boot < 3 && !expired; ++boot) {
+    for (uint32_t t = 0; t < runMs[boot]; t += 10, now += 10, ran += 10) {
+      if ((int32_t)(now - st.entry_deadline_ms) >= 0) {
+        expired = true;
+        break;
+      }
+      if (!WarmSnapshot::refreshDue(now, takenMs)) continue;
+      takenMs = now;
+      CHECK(WarmSnapshot::seal(words, sizeof(words) / 4, &st, sizeof(st), takenMs));
+    }
+    if (expired) break;
+    // Reset: millis() restarts, and the snapshot is restored 150 ms into the boot.
+    now = 150;
+    CHECK(WarmSnapshot::open(words, sizeof(words) / 4, &st, sizeof(st), takenMs));
+    WarmSnapshot::rebaseState(st, now - takenMs);
+    CHECK(st.entry_pending);
+    takenMs = now;
+    CHECK(WarmSnapshot::seal(words, sizeof(words) / 4, &st, sizeof(st), takenMs));
+  }
+  // Only the time since the last seal is granted again, once per reset.
+  CHECK(expired && ran >= 30000u && ran <= 30000u + 2u * WarmSnapshot::kRefreshMs);
+  return true;
+}
+
+bool test_boot_profile_phases_and_json() {
+  BootProfile p;
+  p.start(200);
+  p.mark("net", 203);
+  p.mark("io", 260);
+  p.mark("nvs", 265);
+  CHECK(p.count() == 3 && p.phaseMs(1) == 57 && p.totalMs() == 65);
+
+  char buf[96];
+  CHECK(p.toJson(buf, sizeof(buf)) > 0);
+  CHECK(std::strcmp(buf, "{\"pre\":200,\"net\":3,\"io\":57,\"nvs\":5,\"total\":65}") == 0);
+
+  char tiny[16];
+  CHECK(p.toJson(tiny, sizeof(tiny)) == 0 && tiny[0] == '\0');
+  return true;
+}
+
+bool test_motion_profile_trapezoid_reaches_target_on_time() {
+  MotionProfile p;
+  p.start(900, 100, 0xFFFFFF00u, 400, 25); // 90 -> 10 deg across millis() wrap
+  CHECK(!p.settled(0xFFFFFF00u) && p.etaMs(0xFFFFFF00u) == 400);
+  CHECK(p.positionAt(0xFFFFFF00u) == 900);
+
+  // Ramps are slower than cruise: first 100 ms covers 1/6 of the travel.
+  const int16_t afterRamp = p.positionAt(0xFFFFFF00u + 100u);
+  CHECK(afterRamp < 900 && 900 - afterRamp == 800 / 6);
+  CHECK(p.positionAt(0xFFFFFF00u + 200u) == 500); // symmetric midpoint
+
+  int16_t prev = 900;
+  for (uint32_t t = 0; t <= 400; t += 10) {
+    const int16_t pos = p.positionAt(0xFFFFFF00u + t);
+    CHECK(pos <= prev && pos >= 100);
+    prev = pos;
+  }
+  CHECK(p.settled(0x00000090u) && p.positionAt(0x00000090u) == 100 && p.etaMs(0x00000090u) == 0);
+
+  p.start(100, 100, 5, 400, 25);
+  CHECK(p.settled(5));
+  return true;
+}
+
+bool test_tone_sequencer_priority_and_resume() {
+  ToneSequencer seq;
+  uint16_t hz = 0;
+  uint16_t ms = 0;
+
+  CHECK(seq.request(BuzzerPattern::entry_countdown));
+  CHECK(seq.next(hz, ms) && hz == 2600 && ms == 80);
+  CHECK(seq.next(hz, ms) && hz == 0 && ms == 920);
+  CHECK(seq.next(hz, ms) && hz == 2600); // loops
+
+  // A one-shot warn interrupts the countdown and hands the buzzer back afterwards.
+  CHECK(seq.request(BuzzerPattern::warn));
+  for (uint8_t i = 0; i < 6; ++i) {
+    CHECK(seq.next(hz, ms) && hz == 2200 && ms == 180);
+    CHECK(seq.next(hz, ms) && hz == 0 && ms == 220);
+  }
+  CHECK(seq.next(hz, ms) && hz == 2600 && seq.active() == BuzzerPattern::entry_countdown);
+
+  CHECK(seq.request(BuzzerPattern::alert));
+  CHECK(!seq.request(BuzzerPattern::sensor_fault)); // lower priority never cuts the alarm
+  CHECK(seq.active() == BuzzerPattern::alert);
+
+  seq.stop();
+  CHECK(!seq.next(hz, ms));
+  CHECK(seq.request(BuzzerPattern::sensor_fault));
+  CHECK(seq.next(hz, ms) && seq.next(hz, ms) && seq.next(hz, ms) && seq.next(hz, ms));
+  CHECK(!seq.next(hz, ms) && seq.active() == BuzzerPattern::none);
+  return true;
+}
+
+bool test_sensor_health_edges_and_deadlines() {
+  SensorHealth h;
+  CHECK(h.addLevel(0, "pir1_stuck", 1000));
+  CHECK(h.addEcho(4, "us1_offline", 5000, 3));
+  SensorHealth::Edge e;
+
+  // Active at boot without ever being seen inactive is not "stuck".
+  h.onLevel(0, true, 0);
+  CHECK(!h.poll(5000, e));
+
+  h.onLevel(0, false, 5000);
+  h.onLevel(0, true, 6000);
+  CHECK(!h.poll(6999, e));
+  CHECK(h.poll(7100, e) && e.slot == 0 && e.fault && e.atMs == 7000);
+  CHECK(!h.poll(7200, e) && h.faultMask() == 0x1u);
+  h.onLevel(0, false, 7500);
+  CHECK(h.poll(7500, e) && e.slot == 0 && !e.fault && h.faultMask() == 0);
+
+  // Echo: misses before the first valid echo never fault; afterwards the streak does.
+  h.onEcho(4, false, 8000);
+  h.onEcho(4, false, 8100);
+  h.onEcho(4, false, 8200);
+  CHECK(!h.poll(8200, e));
+  h.onEcho(4, true, 8300);
+  h.onEcho(4, false, 8400);
+  h.onEcho(4, false, 8500);
+  CHECK(!h.poll(8500, e));
+  h.onEcho(4, false, 8600);
+  CHECK(h.poll(8600, e) && e.slot == 4 && e.fault && h.faultMask() == 0x10u);
+  h.onEcho(4, true, 8700);
+  CHECK(h.poll(8700, e) && !e.fault);
+
+  // Offline deadline wraps cleanly across the millis() rollover.
+  h.onEcho(4, true, 0xFFFFF000u);
+  CHECK(!h.poll(0x00000300u, e));
+  CHECK(h.poll(0x00000400u, e) && e.fault && e.atMs == 0x00000388u);
+  h.onEcho(4, true, 0x00000500u);
+  CHECK(h.poll(0x00000500u, e) && !e.fault && h.faultMask() == 0);
+
+  // Clearing an overdue sensor re-arms its deadline: it stays clear for one period.
+  CHECK(h.poll(0x00002000u, e) && e.fault && h.faultMask() == 0x10u);
+  h.clearFaults(0x00002000u);
+  CHECK(h.poll(0x00002000u, e) && !e.fault && h.faultMask() == 0);
+  CHECK(!h.poll(0x00002000u + 4999u, e));
+  CHECK(h.poll(0x00002000u + 5000u, e) && e.fault && e.atMs == 0x00002000u + 5000u);
+  h.onEcho(4, true, 0x00004000u);
+  CHECK(h.poll(0x00004000u, e) && !e.fault);
+  return true;
+}
+
+bool test_sensor_zone_drives_outdoor_and_exit_rules() {
+  static const SensorDef kDefs[] = {
+    {SensorKind::pir, 1, 35, 255, SensorZone::indoor, 1500, "pir1"},
+    {SensorKind::pir, 7, 36, 255, SensorZone::outdoor, 1500, "yard"},
+    {SensorKind::ultrasonic, 1, 14, 13, SensorZone::perimeter, 1500, "us1"},
+  };
+  CHECK(SensorRegistry::zoneOf(kDefs, 3, EventType::motion, 7) == SensorZone::outdoor);
+  CHECK(SensorRegistry::zoneOf(kDefs, 3, EventType::motion, kSerialSyntheticSrcPir1) == SensorZone::indoor);
+  CHECK(SensorRegistry::zoneOf(kDefs, 3, EventType::chokepoint, kSerialSyntheticSrcUs1) == SensorZone::perimeter);
+  CHECK(SensorRegistry::zoneOf(kDefs, 3, EventType::vib_spike, 0) == SensorZone::none);
+
+  RuleEngine engine;
+  Config cfg;
+  SystemState away;
+  away.mode = Mode::away;
+  const Decision outdoor = engine.handle(away, cfg, {EventType::motion, 1000, 7, SensorZone::outdoor});
+  CHECK(outdoor.next.last_outdoor_motion_ms == 1000 && outdoor.next.suspicion_score == 10);
+  const Decision indoor = engine.handle(away, cfg, {EventType::motion, 1000, 7, SensorZone::indoor});
+  CHECK(indoor.next.last_indoor_activity_ms == 1000 && indoor.next.suspicion_score == 18);
+
+  // Disarmed exit: door open, then the door-zone (perimeter) chokepoint arms away.
+  SystemState home;
+  const Decision opened = engine.handle(home, cfg, {EventType::door_open, 2000, 1, SensorZone::perimeter});
+  const Decision inside = engine.handle(opened.next, cfg, {EventType::chokepoint, 2500, 2, SensorZone::indoor});
+  CHECK(inside.next.mode == Mode::disarm);
+  const Decision exited = engine.handle(opened.next, cfg, {EventType::chokepoint, 2500, 1, SensorZone::perimeter});
+  CHECK(exited.next.mode == Mode::away);
+  return true;
+}
+
+bool test_input_snapshot_edges_and_debounce() {
+  InputMap map;
+  CHECK(map.add(0, 32)); // contact on GPIO32 (GPIO_IN1_REG bit 0)
+  CHECK(map.add(3, 5));  // PIR on GPIO5
+  CHECK(!map.add(4, 255));
+  const uint64_t door = InputSnapshot::pinMask(32);
+  const uint64_t pir = InputSnapshot::pinMask(5);
+  CHECK(map.gather(door | pir | InputSnapshot::pinMask(6)) == 0x9u);
+
+  EdgeTracker edges;
+  edges.setHold(0, 80);
+  edges.reset(map.gather(0), 1000);
+
+  EdgeTracker::Step s = edges.update(map.gather(pir), 1001);
+  CHECK(s.rose == 0x8u && s.settledRose == 0x8u); // no hold: settles at once
+
+  // Contact bounce restarts the hold; only the settled open is reported.
+  s = edges.update(map.gather(pir | door), 1010);
+  CHECK(s.rose == 0x1u && s.settledRose == 0);
+  s = edges.update(map.gather(pir), 1020);
+  CHECK(s.fell == 0x1u && s.settledFell == 0);
+  s = edges.update(map.gather(pir | door), 1030);
+  CHECK(s.settledRose == 0 && !edges.idle());
+  s = edges.update(map.gather(pir | door), 1109);
+  CHECK(s.settledRose == 0);
+  s = edges.update(map.gather(pir | door), 1110);
+  CHECK(s.settledRose == 0x1u && edges.stable() == 0x9u && edges.idle());
+
+  // Open at reset: reported once debounced.
+  edges.reset(0x1u, 2000, 0x1u);
+  CHECK(edges.update(0x1u, 2079).settledRose == 0);
+  CHECK(edges.update(0x1u, 2080).settledRose == 0x1u);
+  return true;
+}
+
+bool test_mqtt_qos1_packets_and_inflight_window() {
+  uint8_t buf[64];
+  const size_t hdr = MqttPacket::publishHeader(buf, sizeof(buf), "esh/x", 3, 1, true, true, 0x1234);
+  CHECK(hdr == 11 && buf[0] == 0x3B && buf[1] == 12);
+  std::memcpy(buf + hdr, "abc", 3);
+  CHECK(MqttPacket::publishHeader(buf, 4, "esh/x", 3, 1, false, false, 1) == 0);
+
+  MqttPacket::Reader<32> rx;
+  for (size_t i = 0; i + 1 < hdr + 3; ++i) CHECK(!rx.feed(buf[i]));
+  CHECK(rx.feed(buf[hdr + 2]));
+  const char* topic = nullptr;
+  size_t topicLen = 0;
+  uint16_t pid = 0;
+  const uint8_t* payload = nullptr;
+  size_t len = 0;
+  CHECK(rx.publish(topic, topicLen, pid, payload, len));
+  CHECK(topicLen == 5 && std::memcmp(topic, "esh/x", 5) == 0 && pid == 0x1234);
+  CHECK(len == 3 && std::memcmp(payload, "abc", 3) == 0);
+
+  const size_t n = MqttPacket::puback(buf, sizeof(buf), 0x0102);
+  for (size_t i = 0; i + 1 < n; ++i) CHECK(!rx.feed(buf[i]));
+  CHECK(rx.feed(buf[n - 1]) && rx.type() == MqttPacket::PUBACK && rx.packetId() == 0x0102);
+
+  // Window of 2 over a 3-entry queue; acks out of order release only the prefix.
+  InflightWindow w(2);
+  bool dup = true;
+  CHECK(w.nextToSend(3) == 0);
+  const uint16_t a = w.sent(0, 100, dup);
+  CHECK(!dup && w.nextToSend(3) == 1);
+  const uint16_t b = w.sent(1, 101, dup);
+  CHECK(w.nextToSend(3) == -1);
+  CHECK(w.ack(b, 120) && w.takeAcked() == 0);
+  CHECK(w.ack(a, 130) && !w.ack(a, 131) && w.takeAcked() == 2);
+  CHECK(w.stats().acked == 2 && w.stats().ackMaxMs == 30);
+
+  // Reconnect: the unacked entry goes out again with the same id and DUP.
+  CHECK(w.nextToSend(1) == 0);
+  const uint16_t c = w.sent(0, 200, dup);
+  w.rewind();
+  CHECK(w.nextToSend(1) == 0 && w.sent(0, 300, dup) == c && dup);
+  CHECK(w.nextToSend(1) == -1 && w.stats().resent == 1);
+  CHECK(w.ack(c, 310) && w.takeAcked() == 1 && w.count() == 0);
+  return true;
+}
+
+bool test_reconnect_backoff_jitter_and_outage_timer() {
+  ReconnectBackoff b(1000, 8000);
+  // Equal jitter: each delay lies in [ceiling/2, ceiling], the ceiling doubles up to max.
+  CHECK(b.next(0) == 500);
+  CHECK(b.next(0xFFFFFFFFu) >= 1000 && b.next(0) == 2000);
+  CHECK(b.next(4000) == 4000 + 4000 % 4001);
+  CHECK(b.next(0) == 4000 && b.failures() == 5);
+  b.reset();
+  CHECK(b.next(499) == 999);
+
+  ReconnectTimer t;
+  CHECK(t.restored(100) == 0 && t.count() == 0); // first connect is not a reconnect
+  t.lost(0xFFFFFF00u);
+  t.lost(0xFFFFFF80u); // still the same outage
+  CHECK(t.down() && t.restored(0x40u) == 0x140u);
+  t.lost(1000);
+  CHECK(t.restored(1100) == 100 && t.count() == 2 && t.maxMs() == 0x140u && t.lastMs() == 100);
+  return true;
+}
+
+bool test_publish_lanes_weighted_pick_and_packet_ids() {
+  LaneScheduler sched;
+  const uint8_t all = 0x1Fu;
+  CHECK(sched.pick(0) == -1);
+  CHECK(sched.pick(all) == 0); // critical is strict
+
+  // Without critical, one round serves ack 4, event 3, status 2, metrics 1.
+  uint8_t served[PublishLanes::kCount] = {};
+  for (int i = 0; i < 10; ++i) ++served[sched.pick(all & ~1u)];
+  CHECK(served[1] == 4 && served[2] == 3 && served[3] == 2 && served[4] == 1);
+  CHECK(sched.pick(1u << 4) == 4); // an idle higher lane does not block a lower one
+
+  // Lane-partitioned packet ids route acks back to their lane and wrap inside it.
+  InflightWindow w(1);
+  w.setIdSpace(PublishLanes::idBase(3), PublishLanes::kIdSpan);
+  bool dup = false;
+  uint16_t id = 0;
+  for (uint32_t i = 0; i < PublishLanes::kIdSpan + 1u; ++i) {
+    id = w.sent(w.nextToSend(1), i, dup);
+    CHECK(PublishLanes::laneOfPacketId(id) == 3 && (id & 0x0FFFu) != 0);
+    CHECK(w.ack(id, i) && w.takeAcked() == 1);
+  }
+  CHECK(id == 0x3001u);
+  CHECK(PublishLanes::storeShare(64, 0) + PublishLanes::storeShare(64, 1) + PublishLanes::storeShare(64, 2) +
+          PublishLanes::storeShare(64, 3) == 64);
+  return true;
+}
+
+bool test_overload_controller_escalates_and_steps_down_with_hold() {
+  OverloadController oc;
+  CHECK(!oc.update(40, 0) && oc.level() == DegradeLevel::normal);
+  CHECK(OverloadController::heartbeatStretch(oc.level()) == 1 && oc.admitEvent());
+
+  // Escalation is immediate and may skip levels.
+  CHECK(oc.update(90, 100) && oc.level() == DegradeLevel::sample_events && oc.collapseStatus());
+  uint32_t admitted = 0;
+  for (int i = 0; i < 16; ++i) admitted += oc.admitEvent() ? 1u : 0u;
+  CHECK(admitted == 16u / OverloadController::kEventSampleEvery && oc.sampledOut() == 12);
+
+  // Inside the hysteresis band nothing changes; below it, one level per hold period.
+  CHECK(!oc.update(75, 200) && oc.level() == DegradeLevel::sample_events);
+  CHECK(!oc.update(60, 300));
+  CHECK(!oc.update(60, 300 + OverloadController::kHoldMs - 1));
+  CHECK(oc.update(60, 300 + OverloadController::kHoldMs) && oc.level() == DegradeLevel::collapse_status);
+  CHECK(!oc.update(60, 400 + OverloadController::kHoldMs)); // 60 + 15 >= 70: hold here
+  CHECK(OverloadController::heartbeatStretch(oc.level()) == OverloadController::kHeartbeatStretch);
+  CHECK(oc.admitEvent());
+
+  // A spike restarts the calm period.
+  CHECK(!oc.update(10, 10000) && !oc.update(72, 12000) && !oc.update(10, 14000));
+  CHECK(!oc.update(10, 14000 + OverloadController::kHoldMs - 1));
+  CHECK(oc.update(10, 14000 + OverloadController::kHoldMs) && oc.level() == DegradeLevel::stretch_heartbeat);
+  CHECK(oc.changes() == 3);
+  return true;
+}
+
+bool test_store_eviction_keeps_alarms_through_long_outage() {
+  // Offline store model: one ring per queued lane, sized like the firmware's partitions.
+  using StoreEviction::AlarmKind;
+  struct Msg {
+    uint32_t ts = 0;
+    bool bootProfile = false;
+    AlarmKind alarm = AlarmKind::echo;
+  };
+  struct Ring {
+    Msg slots[64];
+    uint32_t cap = 0, head = 0, count = 0, refused = 0, evicted = 0;
+  };
+  // MQTT_STORE_CAP as platformio.ini sets it: the critical lane gets 16 slots.
+  Ring rings[PublishLanes::kQueued];
+  for (uint8_t l = 0; l < PublishLanes::kQueued; ++l) rings[l].cap = PublishLanes::storeShare(64, l);
+  CHECK(rings[0].cap == 16);
+
+  auto push = [&](uint8_t l, const Msg& m, uint32_t now) {
+    Ring& r = rings[l];
+    const PublishLane lane = (PublishLane)l;
+    auto cand = [&](const Msg& x, bool newer) {
+      StoreEviction::Candidate c;
+      c.lane = lane;
+      c.ageMs = now - x.ts;
+      c.superseded = newer && lane == PublishLane::status && !x.bootProfile;
+      c.alarm = x.alarm;
+      return c;
+    };
+    if (r.count >= r.cap) {
+      const int32_t v = StoreEviction::pickVictim(
+        0, r.count, [&](uint32_t pos) { return cand(r.slots[(r.head + pos) % r.cap], true); }, cand(m, false));
+      if (v < 0) {
+        ++r.refused;
+        return;
+      }
+      StoreEviction::removeAt(r.slots, r.cap, r.head, r.count, (uint32_t)v);
+      --r.count;
+      ++r.evicted;
+    }
+    r.slots[(r.head + r.count++) % r.cap] = m;
+  };
+
+  // Six hours offline: 5 s heartbeats, an ordinary event every 47 s, a command ack every
+  // 15 min, and a burglary after four hours. The alarm then holds for an hour: every
+  // event lands in the critical lane as an alert-level echo (one each 20 s), with the
+  // alert buzzer re-issued every 10 min. A door tamper and a help request follow.
+  const uint32_t kEnd = 6u * 3600u * 1000u;
+  const uint32_t kAlarmAt = 4u * 3600000u;
+  uint32_t echoes = 0;
+  for (uint32_t t = 0; t <= kEnd; t += 1000) {
+    if (t % 5000 == 0) {
+      Msg m;
+      m.ts = t;
+      m.bootProfile = (t == 0);
+      push(3, m, t);
+    }
+    if (t % 47000 == 0) push(2, Msg{t, false}, t);
+    if (t % 900000 == 0) push(1, Msg{t, false}, t);
+    if (t >= kAlarmAt && t <= kAlarmAt + 3600000u) {
+      if ((t - kAlarmAt) % 600000 == 0) {
+        push(0, Msg{t, false, AlarmKind::alert}, t);
+      } else if (t % 20000 == 0) {
+        push(0, Msg{t, false, AlarmKind::echo}, t);
+        ++echoes;
+      }
+    }
+    if (t == kAlarmAt + 5400000u || t == kAlarmAt + 5460000u) push(0, Msg{t, false, AlarmKind::tamper_or_help}, t);
+  }
+
+  auto at = [&](uint8_t l, uint32_t pos) { return rings[l].slots[(rings[l].head + pos) % rings[l].cap]; };
+  // The echoes give way, oldest first: all 7 alert alarms and both tamper/help
+  // requests survive, the rest of the lane holds the newest echoes, nothing is refused.
+  CHECK(rings[0].count == 16 && rings[0].refused == 0 && rings[0].evicted == echoes - 7);
+  uint32_t alerts = 0, tampers = 0, lastEcho = 0;
+  for (uint32_t i = 0; i < rings[0].count; ++i) {
+    const Msg m = at(0, i);
+    if (m.alarm == AlarmKind::alert) ++alerts;
+    if (m.alarm == AlarmKind::tamper_or_help) ++tampers;
+    if (m.alarm == AlarmKind::echo) lastEcho = m.ts;
+  }
+  CHECK(alerts == 7 && tampers == 2 && at(0, 0).ts == kAlarmAt);
+  CHECK(lastEcho == (kAlarmAt + 3600000u - 20000u));
+  // Acks are retained, so later ones are refused instead.
+  CHECK(rings[1].count == rings[1].cap && rings[1].evicted == 0 && at(1, 0).ts == 0);
+  CHECK(rings[1].refused == 25 - rings[1].cap);
+  // Statuses: the boot-profile one plus the newest snapshots; thousands evicted.
+  CHECK(at(3, 0).bootProfile && at(3, rings[3].count - 1).ts == kEnd && rings[3].refused == 0);
+  CHECK(rings[3].evicted == kEnd / 5000 + 1 - rings[3].cap);
+  // Events: oldest go first, so the ring holds the most recent ones in order.
+  const uint32_t lastEvent = kEnd / 47000 * 47000;
+  CHECK(rings[2].count == rings[2].cap && rings[2].refused == 0);
+  for (uint32_t i = 0; i < rings[2].count; ++i) {
+    CHECK(at(2, i).ts == lastEvent - (rings[2].count - 1 - i) * 47000u);
+  }
+
+  // By kind: a superseded status < stale status < fresh status < stale event < alarm.
+  StoreEviction::Candidate c;
+  c.lane = PublishLane::status;
+  c.superseded = true;
+  const uint32_t superseded = StoreEviction::value(c);
+  c.superseded = false;
+  c.ageMs = 3600000;
+  const uint32_t staleStatus = StoreEviction::value(c);
+  c.ageMs = 0;
+  const uint32_t freshStatus = StoreEviction::value(c);
+  c.lane = PublishLane::event;
+  c.ageMs = 3600000;
+  const uint32_t staleEvent = StoreEviction::value(c);
+  c.lane = PublishLane::critical;
+  c.alarm = AlarmKind::alert;
+  const uint32_t staleAlert = StoreEviction::value(c);
+  c.ageMs = 0;
+  c.alarm = AlarmKind::echo;
+  const uint32_t freshEcho = StoreEviction::value(c);
+  CHECK(superseded < staleStatus && staleStatus < freshStatus && freshStatus < staleEvent);
+  CHECK(staleEvent < freshEcho && freshEcho < staleAlert && staleAlert < StoreEviction::kRetained);
+  c.lane = PublishLane::ack;
+  CHECK(StoreEviction::value(c) == StoreEviction::kRetained);
+
+  // A lane full of newer tamper alarms still admits the next one, evicting the oldest;
+  // an echo arriving then is the one refused.
+  Ring& crit = rings[0];
+  crit = Ring();
+  crit.cap = PublishLanes::storeShare(64, 0);
+  for (uint32_t i = 0; i < 20; ++i) push(0, Msg{1000u * i, false, AlarmKind::tamper_or_help}, 1000u * i);
+  CHECK(crit.count == 16 && crit.refused == 0 && crit.evicted == 4 && at(0, 0).ts == 4000 && at(0, 15).ts == 19000);
+  push(0, Msg{20000, false, AlarmKind::echo}, 20000);
+  CHECK(crit.refused == 1 && at(0, 15).ts == 19000);
+  return true;
+}
+
+bool test_sampling_policy_profiles_and_meter() {
+  SamplingPolicy sp;
+  SamplingPolicy::Inputs in;
+  in.mode = Mode::disarm;
+  CHECK(sp.select(in, 1000) == SamplingProfile::idle);
+  in.mode = Mode::away;
+  CHECK(sp.select(in, 1000) == SamplingProfile::normal);
+  in.entryPending = true;
+  CHECK(sp.select(in, 1000) == SamplingProfile::boost);
+  in.entryPending = false;
+
+  // Activity boosts for the hold time, then disarmed decays to normal and then idle.
+  in.mode = Mode::disarm;
+  sp.noteActivity(0xFFFFF000u);
+  CHECK(sp.select(in, 0xFFFFF000u + SamplingPolicy::kBoostHoldMs - 1) == SamplingProfile::boost);
+  CHECK(sp.select(in, 0xFFFFF000u + SamplingPolicy::kBoostHoldMs) == SamplingProfile::normal);
+  CHECK(sp.select(in, 0xFFFFF000u + SamplingPolicy::kIdleAfterMs) == SamplingProfile::idle);
+  in.keypadActive = true;
+  CHECK(sp.select(in, 0xFFFFF000u + SamplingPolicy::kIdleAfterMs) == SamplingProfile::boost);
+
+  const SamplingRates idle = SamplingPolicy::rates(SamplingProfile::idle);
+  const SamplingRates normal = SamplingPolicy::rates(SamplingProfile::normal);
+  const SamplingRates boost = SamplingPolicy::rates(SamplingProfile::boost);
+  CHECK(normal.ultrasonicMs == SamplingMeter::kBaselineUltrasonicMs && normal.keypadScanGapMs == 0);
+  CHECK(idle.ultrasonicMs > normal.ultrasonicMs && boost.ultrasonicMs < normal.ultrasonicMs);
+  CHECK(idle.keypadScanGapMs > 0 && idle.keypadBackstopMs > boost.keypadBackstopMs);
+
+  // 10 s idle window, 2 rangers at 1 s, keypad scanned on 100 of 1000 loop polls.
+  SamplingMeter m;
+  m.begin(5000);
+  for (int i = 0; i < 20; ++i) m.addUltrasonic(3000);
+  for (int i = 0; i < 1000; ++i) m.addKeypadPoll();
+  for (int i = 0; i < 100; ++i) m.addKeypadScan(200);
+  const SamplingMeter::Report r = m.take(15000, 2, SamplingProfile::idle);
+  CHECK(r.windowMs == 10000 && r.ultrasonicPeriodMs == 1000 && r.keypadScansPerSec == 10);
+  CHECK(r.cpuUs == 20u * 3000u + 100u * 200u);
+  CHECK(r.savedUs == (100u - 20u) * 3000u + (1000u - 100u) * 200u);
+  CHECK(m.take(15000, 2, SamplingProfile::idle).cpuUs == 0); // the window restarts
+  return true;
+}
+
+bool test_vibration_bursts_carry_intensity_into_scoring() {
+  VibrationBurst vb;
+  VibrationBurst::Hit hit;
+  // A knock: two pulses, then quiet.
+  vb.feed(2, 1000, 700);
+  vb.feed(0, 1050, 700);
+  CHECK(!vb.take(hit) && vb.active());
+  vb.feed(0, 1000 + VibrationBurst::kQuietMs, 700);
+  CHECK(vb.take(hit) && hit.startMs == 1000 && hit.pulses == 2 && hit.durationMs == 0);
+  CHECK(!vb.take(hit));
+
+  // Sustained shaking is cut at maxHitMs; an uncollected hit absorbs the next one.
+  for (uint32_t t = 2000; t <= 2700; t += 10) vb.feed(3, t, 700);
+  for (uint32_t t = 2710; t <= 2800; t += 10) vb.feed(3, t, 700);
+  vb.feed(0, 2900, 700);
+  CHECK(vb.take(hit) && hit.startMs == 2000 && hit.pulses == 3u * 81u && hit.intensity() == 243);
+  CHECK(hit.durationMs == 800);
+
+  RuleEngine engine;
+  Config cfg;
+  SystemState away;
+  away.mode = Mode::away;
+  const Decision knock = engine.handle(away, cfg, Event(EventType::vib_spike, 1000, 0, SensorZone::perimeter, 1));
+  const Decision legacy = engine.handle(away, cfg, Event(EventType::vib_spike, 1000, 0, SensorZone::perimeter));
+  const Decision impact = engine.handle(away, cfg, Event(EventType::vib_spike, 1000, 0, SensorZone::perimeter, 200));
+  CHECK(knock.next.suspicion_score == 16 && legacy.next.suspicion_score == 22);
+  CHECK(impact.next.suspicion_score == 40 && impact.next.level == AlarmLevel::warn);
+  return true;
+}
+
+bool test_motion_inside_a_vibration_hit_correlates_in_delivery_order() {
+  RuleEngine engine;
+  Config cfg;
+  SystemState away;
+  away.mode = Mode::away;
+  away.last_suspicion_update_ms = 4000;
+
+  // Shaking from 5000 to 5300; outdoor motion at 5150 goes out while the hit is open.
+  VibrationBurst vb;
+  VibrationBurst::Hit hit;
+  SystemState s = away;
+  for (uint32_t t = 5000; t <= 5300; t += 10) {
+    vb.feed(2, t, 700);
+    if (t == 5150) s = engine.handle(s, cfg, Event(EventType::motion, t, 0, SensorZone::outdoor)).next;
+  }
+  const uint32_t deliveredMs = 5300 + VibrationBurst::kQuietMs;
+  vb.feed(0, deliveredMs, 700);
+  CHECK(vb.take(hit) && hit.startMs == 5000);
+  CHECK(s.suspicion_score == 10);
+
+  // Stamped at delivery: the motion counts and the score builds on it.
+  const Decision ok = engine.handle(s, cfg, Event(EventType::vib_spike, deliveredMs, 0, SensorZone::perimeter, hit.intensity()));
+  CHECK(ok.next.suspicion_score == 10 + 40 + 12);
+
+  // A spike stamped before the last update neither matches nor wipes the score.
+  const Decision late = engine.handle(s, cfg, Event(EventType::vib_spike, hit.startMs, 0, SensorZone::perimeter, hit.intensity()));
+  CHECK(late.next.suspicion_score == 10 + 40);
+  CHECK(late.next.last_suspicion_update_ms == s.last_suspicion_update_ms);
+  return true;
+}
+
+bool test_inject_frames_roundtrip_and_resync_after_corruption() {
+  using namespace InjectFrame;
+  CHECK(crc16(reinterpret_cast<const uint8_t*>("123456789"), 9) == 0x29B1); // CCITT-FALSE check value
+
+  uint8_t payload[kMaxPayload] = {};
+  payload[0] = kFlagQuiet;
+  Record r;
+  r.code = 303;
+  r.offsetMs = 40;
+  r.value = 77;
+  putRecord(payload, 0, r);
+  r.code = 310;
+  r.offsetMs = 65535;
+  r.value = 0;
+  putRecord(payload, 1, r);
+  const uint8_t len = 1 + 2 * kRecordSize;
+  uint8_t frame[kOverhead + kMaxPayload];
+  const size_t n = encode(frame, Type::events, 0xBEEF, payload, len);
+  CHECK(n == kOverhead + len);
+
+  // Log noise, a stray magic byte, a truncated frame, a corrupted copy, then the real one.
+  uint8_t stream[256];
+  size_t s = 0;
+  const char noise[] = "310\n";
+  for (size_t i = 0; i + 1 < sizeof(noise); ++i) stream[s++] = (uint8_t)noise[i];
+  stream[s++] = kMagic0;
+  for (size_t i = 0; i < n; ++i) stream[s++] = frame[i];
+  stream[s - 3] ^= 0x10;
+  for (size_t i = 0; i < 5; ++i) stream[s++] = frame[i];
+  stream[s++] = 0xFF; // the truncated frame claims a 255-byte payload
+  for (size_t i = 0; i < n; ++i) stream[s++] = frame[i];
+
+  Decoder d;
+  uint8_t frames = 0;
+  uint8_t crcErrors = 0;
+  for (size_t i = 0; i < s; ++i) {
+    const Decoder::Result res = d.feed(stream[i]);
+    if (res == Decoder::Result::crc) ++crcErrors;
+    if (res != Decoder::Result::frame) continue;
+    ++frames;
+    CHECK(d.type() == Type::events && d.seq() == 0xBEEF && validEvents(d.len()));
+    CHECK(recordCount(d.len()) == 2 && (d.payload()[0] & kFlagQuiet));
+    const Record a = record(d.payload(), 0);
+    const Record b = record(d.payload(), 1);
+    CHECK(a.code == 303 && a.offsetMs == 40 && a.value == 77);
+    CHECK(b.code == 310 && b.offsetMs == 65535);
+  }
+  CHECK(frames == 1 && crcErrors == 1 && !d.inFrame());
+
+  // Text after a stray magic byte is not the decoder's; a stalled frame can be dropped.
+  CHECK(!d.accepts('3') && d.accepts(kMagic0));
+  d.feed(kMagic0);
+  CHECK(d.inFrame() && d.accepts(kMagic1) && d.accepts(kMagic0) && !d.accepts('3'));
+  d.feed(kMagic1);
+  d.feed((uint8_t)Type::events);
+  CHECK(d.inFrame() && d.accepts('3'));
+  d.reset();
+  CHECK(!d.inFrame() && !d.accepts('3'));
+  CHECK(!validEvents(0) && !validEvents(3) && validEvents(1 + kMaxRecords * kRecordSize));
+
+  Ack ack;
+  ack.accepted = 48;
+  ack.blocked = 2;
+  ack.latencyUs = 123456;
+  ack.maxEventUs = 900;
+  ack.gaps = 3;
+  ack.queueFree = 78;
+  uint8_t ap[kAckSize];
+  encodeAck(ap, ack);
+  Ack back;
+  CHECK(decodeAck(ap, kAckSize, back) && !decodeAck(ap, kAckSize - 1, back));
+  CHECK(back.status == Status::ok && back.accepted == 48 && back.blocked == 2 && back.latencyUs == 123456);
+  CHECK(back.maxEventUs == 900 && back.gaps == 3 && back.queueFree == 78);
+  return true;
+}
+
+bool test_sim_clock_runs_days_of_deadlines_in_few_steps() {
+  SimClock clk(1000);
+  clk.wakeAt(5000);
+  clk.wakeAt(3000);
+  clk.wakeAt(3000);
+  CHECK(clk.pending() == 2);
+  CHECK(clk.step(10000) && clk.ms() == 3000);
+  CHECK(clk.step(10000) && clk.ms() == 5000);
+  CHECK(!clk.step(10000) && clk.ms() == 10000);
+  clk.wakeAt(9000); // already passed: due at once
+  CHECK(clk.step(20000) && clk.ms() == 10000);
+  clk.advanceUs(1500);
+  CHECK(clk.ms() == 10001 && clk.us() == 10001500u);
+
+  // Three days armed away, starting an hour before millis() wraps: a 5 s heartbeat,
+  // and each evening the door opens and nobody disarms.
+  auto due = [](uint32_t now, uint32_t at) { return (int32_t)(now - at) >= 0; };
+  const uint32_t kDayMs = 86400000u;
+  const uint32_t start = 0xFFFFFFFFu - 3600000u;
+  SimClock sim(start);
+  RuleEngine engine;
+  Config cfg;
+  SystemState st;
+  st.mode = Mode::away;
+  uint32_t nextHeartbeat = start + 5000;
+  uint32_t nextDoor = start + 18u * 3600000u + 1234u; // off the heartbeat grid
+  sim.wakeAt(nextHeartbeat);
+  sim.wakeAt(nextDoor);
+
+  uint32_t steps = 0;
+  uint32_t heartbeats = 0;
+  uint32_t alarms = 0;
+  while (sim.step(start + 3 * kDayMs)) {
+    const uint32_t now = sim.ms();
+    ++steps;
+    if (due(now, nextHeartbeat)) {
+      ++heartbeats;
+      nextHeartbeat = now + 5000;
+      sim.wakeAt(nextHeartbeat);
+    }
+    if (due(now, nextDoor)) {
+      st = engine.handle(st, cfg, Event(EventType::door_open, now, 1)).next;
+      CHECK(st.entry_pending);
+      sim.wakeAt(st.entry_deadline_ms);
+      nextDoor += kDayMs;
+      sim.wakeAt(nextDoor);
+    }
+    if (st.entry_pending && due(now, st.entry_deadline_ms)) {
+      CHECK(now == st.entry_deadline_ms); // no tick overshoots the deadline
+      st = engine.handle(st, cfg, Event(EventType::entry_timeout, now, 0)).next;
+      if (st.level == AlarmLevel::alert) ++alarms;
+      st = engine.handle(st, cfg, Event(EventType::arm_away, now, 0)).next;
+    }
+  }
+  CHECK(sim.ms() == start + 3 * kDayMs);
+  CHECK(alarms == 3 && heartbeats == 3 * kDayMs / 5000);
+  CHECK(steps == heartbeats + 2 * alarms && steps == sim.jumps() && sim.dropped() == 0);
+  return true;
+}
+
+bool test_sample_codec_runs_and_deltas_roundtrip_across_pages() {
+  using namespace SampleCodec;
+  // A ranger sampled every 200 ms (0-2 ms late) that sees the same wall, a person
+  // passing, a noisy stretch, then the wall again; the levels change twice.
+  std::vector<Sample> in;
+  auto push = [&](uint8_t ch, uint32_t ts, uint32_t v) {
+    Sample s;
+    s.channel = ch;
+    s.tsMs = ts;
+    s.value = v;
+    in.push_back(s);
+  };
+  auto cmAt = [](uint32_t i) -> uint32_t {
+    if (i >= 700 && i < 706) return 40u - 5u * (i - 700);
+    if (i >= 1000 && i < 1300) return 181u + (i * 7u) % 5u;
+    return 181u;
+  };
+  const uint32_t t0 = 0xFFFFF000u; // wraps mid-recording
+  push(kLevelsChannel, t0, 0x01);
+  for (uint32_t i = 0; i < 2000; ++i) {
+    const uint32_t ts = t0 + 200u * i + (i % 3);
+    push(6, ts, cmAt(i));
+    if (i == 900) push(kLevelsChannel, ts + 1, 0x05);
+    if (i == 1500) push(kLevelsChannel, ts + 1, 0x01);
+  }
+
+  uint8_t flash[12][kPageBytes];
+  uint8_t pages = 0;
+  PageEncoder enc;
+  enc.begin(flash[0], 1, 7, t0);
+  for (const Sample& s : in) {
+    if (enc.add(s)) continue;
+    enc.finish();
+    CHECK(++pages < 12);
+    enc.begin(flash[pages], 1u + pages, 7, s.tsMs);
+    CHECK(enc.add(s));
+  }
+  enc.finish();
+  ++pages;
+  // The steady stretches collapse into runs; the noise spills over a few pages.
+  CHECK(pages >= 4 && pages <= 7);
+
+  std::vector<Sample> out;
+  for (uint8_t p = 0; p < pages; ++p) {
+    PageDecoder dec;
+    uint32_t seq = 0;
+    uint16_t id = 0;
+    CHECK(dec.open(flash[p], seq, id) && seq == 1u + p && id == 7);
+    Sample s;
+    while (dec.next(s)) out.push_back(s);
+  }
+  CHECK(out.size() == in.size());
+  std::vector<Sample> ranger;
+  std::vector<Sample> levels;
+  for (const Sample& s : out) (s.channel == kLevelsChannel ? levels : ranger).push_back(s);
+  CHECK(levels.size() == 3 && levels[1].value == 0x05 && levels[1].tsMs == t0 + 200u * 900 + 1);
+  CHECK(ranger.size() == 2000);
+  for (uint32_t i = 0; i < ranger.size(); ++i) {
+    const uint32_t cm = cmAt(i);
+    const int32_t skew = (int32_t)(ranger[i].tsMs - (t0 + 200u * i + (i % 3)));
+    CHECK(ranger[i].value == cm && skew >= -(int32_t)kRunJitterMs && skew <= (int32_t)kRunJitterMs);
+  }
+
+  // An erased page is not capture data; a damaged tag ends the page.
+  uint8_t erased[kPageBytes];
+  std::memset(erased, 0xFF, sizeof(erased));
+  PageDecoder dec;
+  uint32_t seq = 0;
+  uint16_t id = 0;
+  CHECK(!dec.open(erased, seq, id));
+  flash[0][kHeaderBytes + 1 + 5] = 0x55; // first record after the base time
+  CHECK(dec.open(flash[0], seq, id));
+  Sample s;
+  CHECK(!dec.next(s));
+  return true;
+}
+
+bool test_main_status_scan_reads_top_level_fields_in_one_pass() {
+  auto scan = [](const char* json) {
+    return scanMainStatus(reinterpret_cast<const uint8_t*>(json), std::strlen(json));
+  };
+
+  // Nested keys and look-alike string values do not count; escapes are decoded.
+  MainStatusFields f = scan(
+    "{\"reason\":\"\\\"mode\\\":\\\"away\\\"\",\"boot_ms\":{\"mode\":\"night\",\"t\":[1,{\"x\":null}]},"
+    "\"mode\" : \"Dis\\u0061rm\",\"someone_home\":false,\"isSomeoneHome\":true,\"uptime_ms\":-1.5e3}");
+  CHECK(f.hasMode && std::strcmp(f.mode, "Disarm") == 0);
+  CHECK(f.hasPresence && f.someoneHome); // isSomeoneHome wins over the alias
+  f = scan("{\"isSomeoneHome\":false,\"someone_home\":true}");
+  CHECK(f.hasPresence && !f.someoneHome);
+  f = scan("{\"someone_home\":\"yes\",\"mode\":7}");
+  CHECK(!f.hasMode && !f.hasPresence);
+
+  // A truncated payload keeps what was read before the damage.
+  f = scan("{\"mode\":\"away\",\"isSomeoneHome\":tru");
+  CHECK(f.hasMode && std::strcmp(f.mode, "away") == 0 && !f.hasPresence);
+  CHECK(!scan("[{\"mode\":\"away\"}]").hasMode);
+
+  JsonScan::Tokenizer t(reinterpret_cast<const uint8_t*>("{\"a\":[1,2}"), 11);
+  CHECK(t.next() == JsonScan::Token::begin_object && t.next() == JsonScan::Token::key);
+  CHECK(t.next() == JsonScan::Token::begin_array && t.next() == JsonScan::Token::number);
+  CHECK(t.next() == JsonScan::Token::number && t.textIs("2"));
+  CHECK(t.next() == JsonScan::Token::error && t.next() == JsonScan::Token::error);
+
+  // Topic hashes folded at compile time match the runtime hash of the same bytes.
+  static_assert(JsonScan::fnv1a("esh/main/status") != JsonScan::fnv1a("esh/main/cmd"), "");
+  const char* topic = "esh/main/status";
+  CHECK(JsonScan::fnv1a(reinterpret_cast<const uint8_t*>(topic), std::strlen(topic)) ==
+        JsonScan::fnv1a("esh/main/status"));
+  return true;
+}
+
 } // namespace
 
 int main() {
@@ -112,9 +1103,32 @@ int main() {
 
   ok &= test_boot_starts_disarm_without_entry_alarm();
   ok &= test_armed_door_open_starts_entry_countdown();
+  ok &= test_rearm_during_entry_countdown_cancels_the_countdown();
   ok &= test_locked_door_open_escalates_alert_in_any_mode();
   ok &= test_mode_override_window_expires_and_handles_wraparound();
   ok &= test_replay_guard_blocks_replay_and_allows_after_expiry();
+  ok &= test_journal_codec_roundtrip_with_deltas_and_erased_tail();
+  ok &= test_packed_system_state_roundtrip_and_clamp();
+  ok &= test_warm_snapshot_seal_open_rejects_corruption_and_rebases();
+  ok &= test_entry_delay_expires_across_two_warm_resets();
+  ok &= test_boot_profile_phases_and_json();
+  ok &= test_motion_profile_trapezoid_reaches_target_on_time();
+  ok &= test_tone_sequencer_priority_and_resume();
+  ok &= test_sensor_health_edges_and_deadlines();
+  ok &= test_sensor_zone_drives_outdoor_and_exit_rules();
+  ok &= test_input_snapshot_edges_and_debounce();
+  ok &= test_mqtt_qos1_packets_and_inflight_window();
+  ok &= test_reconnect_backoff_jitter_and_outage_timer();
+  ok &= test_publish_lanes_weighted_pick_and_packet_ids();
+  ok &= test_overload_controller_escalates_and_steps_down_with_hold();
+  ok &= test_store_eviction_keeps_alarms_through_long_outage();
+  ok &= test_sampling_policy_profiles_and_meter();
+  ok &= test_vibration_bursts_carry_intensity_into_scoring();
+  ok &= test_motion_inside_a_vibration_hit_correlates_in_delivery_order();
+  ok &= test_inject_frames_roundtrip_and_resync_after_corruption();
+  ok &= test_sim_clock_runs_days_of_deadlines_in_few_steps();
+  ok &= test_sample_codec_runs_and_deltas_roundtrip_across_pages();
+  ok &= test_main_status_scan_reads_top_level_fields_in_one_pass();
 
   if (!ok) return 1;
 
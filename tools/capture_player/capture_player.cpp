@@ -0,0 +1,320 @@
+// Replays a raw sample capture (services/SampleCapture, downloaded with
+// "capture dump" on the serial console) through the firmware's own SensorBank,
+// ChokepointSensor and VibrationBurst, so thresholds can be tuned offline against
+// real recordings. Build and run with tools/run_capture_player.sh.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <soc/gpio_reg.h>
+
+#include "app/HardwareConfig.h"
+#include "app/SampleCodec.h"
+#include "app/VibrationBurst.h"
+#include "drivers/UltrasonicDriver.h"
+#include "sensors/ChokepointSensor.h"
+#include "sensors/SensorBank.h"
+
+namespace {
+
+using SampleCodec::Sample;
+
+constexpr uint8_t kSlots = SampleCodec::kLevelsChannel;
+constexpr uint32_t kTailMs = 3000; // keep ticking so hold/cooldown timers can finish
+
+uint64_t gGpio = 0;
+int gCm[kSlots];
+
+struct Options {
+  const char* path = nullptr;
+  long capture = -1; // newest
+  int nearCm = 5;    // EventCollector's values
+  int farCm = 10;
+  uint32_t periodMs = 200;
+  long cooldownMs = -1; // registry holdMs
+  uint32_t tickMs = 5;
+  bool quiet = false;
+};
+
+struct Page {
+  uint8_t bytes[SampleCodec::kPageBytes];
+  uint8_t chunks = 0;
+};
+
+struct DecodedPage {
+  uint32_t seq;
+  uint16_t captureId;
+  std::vector<Sample> samples;
+};
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: capture_player <dump.log> [--capture N] [--near CM] [--far CM]\n"
+               "                      [--period MS] [--cooldown MS] [--tick MS] [--quiet]\n");
+}
+
+bool parseArgs(int argc, char** argv, Options& o) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (a == "--quiet") {
+      o.quiet = true;
+    } else if (a == "--capture" && hasValue) {
+      o.capture = std::strtol(argv[++i], nullptr, 10);
+    } else if (a == "--near" && hasValue) {
+      o.nearCm = (int)std::strtol(argv[++i], nullptr, 10);
+    } else if (a == "--far" && hasValue) {
+      o.farCm = (int)std::strtol(argv[++i], nullptr, 10);
+    } else if (a == "--period" && hasValue) {
+      o.periodMs = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    } else if (a == "--cooldown" && hasValue) {
+      o.cooldownMs = std::strtol(argv[++i], nullptr, 10);
+    } else if (a == "--tick" && hasValue) {
+      o.tickMs = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    } else if (!o.path && a[0] != '-') {
+      o.path = argv[i];
+    } else {
+      return false;
+    }
+  }
+  return o.path && o.tickMs > 0 && o.periodMs > 0;
+}
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// "[CAPTURE] p <page> <chunk> <hex>" lines; anything else in the log is skipped.
+bool readDump(const char* path, std::map<unsigned, Page>& pages) {
+  std::ifstream in(path);
+  if (!in) return false;
+  constexpr unsigned kChunkBytes = 32;
+  constexpr unsigned kChunks = SampleCodec::kPageBytes / kChunkBytes;
+  std::string line;
+  while (std::getline(in, line)) {
+    const size_t at = line.find("[CAPTURE] p ");
+    if (at == std::string::npos) continue;
+    unsigned page = 0;
+    unsigned chunk = 0;
+    int off = 0;
+    if (std::sscanf(line.c_str() + at + 12, "%u %u %n", &page, &chunk, &off) != 2 || chunk >= kChunks) continue;
+    const char* hex = line.c_str() + at + 12 + off;
+    uint8_t buf[kChunkBytes];
+    bool ok = std::strlen(hex) >= 2 * kChunkBytes;
+    for (unsigned i = 0; ok && i < kChunkBytes; ++i) {
+      const int hi = hexValue(hex[2 * i]);
+      const int lo = hexValue(hex[2 * i + 1]);
+      ok = hi >= 0 && lo >= 0;
+      buf[i] = (uint8_t)((hi << 4) | lo);
+    }
+    if (!ok) continue;
+    Page& p = pages[page];
+    std::memcpy(p.bytes + chunk * kChunkBytes, buf, kChunkBytes);
+    p.chunks = (uint8_t)(p.chunks | (1u << chunk));
+  }
+  return true;
+}
+
+uint64_t gpioFromLevels(uint32_t levels) {
+  uint64_t gpio = 0;
+  for (uint8_t i = 0; i < HwCfg::SENSOR_COUNT; ++i) {
+    const SensorDef& d = HwCfg::SENSORS[i];
+    if (!SensorRegistry::isLevelInput(d.kind) || d.pin == HwCfg::PIN_UNUSED) continue;
+    if (levels & (1u << i)) gpio |= InputSnapshot::pinMask(d.pin);
+  }
+  return gpio;
+}
+
+const char* nameOf(const Event& e) {
+  for (uint8_t i = 0; i < HwCfg::SENSOR_COUNT; ++i) {
+    const SensorDef& d = HwCfg::SENSORS[i];
+    if (SensorRegistry::eventFor(d.kind) == e.type && d.id == e.src) return d.name;
+  }
+  return "?";
+}
+
+} // namespace
+
+uint32_t capturePlayerReadReg(uint32_t reg) {
+  return (reg == GPIO_IN_REG) ? (uint32_t)gGpio : (uint32_t)(gGpio >> 32);
+}
+
+// The player's ranger: the distance last recorded for the slot wired to this echo pin.
+UltrasonicDriver::UltrasonicDriver() : trig_(HwCfg::PIN_UNUSED), echo_(HwCfg::PIN_UNUSED) {}
+UltrasonicDriver::UltrasonicDriver(uint8_t trigPin, uint8_t echoPin) : trig_(trigPin), echo_(echoPin) {}
+void UltrasonicDriver::begin() {}
+
+int UltrasonicDriver::readCm(uint32_t) {
+  for (uint8_t i = 0; i < HwCfg::SENSOR_COUNT && i < kSlots; ++i) {
+    const SensorDef& d = HwCfg::SENSORS[i];
+    if (d.kind == SensorKind::ultrasonic && d.pin == echo_ && d.trigPin == trig_) return gCm[i];
+  }
+  return -1;
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parseArgs(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  std::map<unsigned, Page> raw;
+  if (!readDump(opt.path, raw)) {
+    std::fprintf(stderr, "cannot read %s\n", opt.path);
+    return 1;
+  }
+
+  std::vector<DecodedPage> pages;
+  unsigned partial = 0;
+  for (const auto& kv : raw) {
+    if (kv.second.chunks != 0xFF) {
+      ++partial;
+      continue;
+    }
+    DecodedPage dp;
+    SampleCodec::PageDecoder dec;
+    if (!dec.open(kv.second.bytes, dp.seq, dp.captureId)) continue;
+    Sample s;
+    while (dec.next(s)) dp.samples.push_back(s);
+    pages.push_back(std::move(dp));
+  }
+  if (pages.empty()) {
+    std::fprintf(stderr, "no complete capture pages in %s\n", opt.path);
+    return 1;
+  }
+  std::sort(pages.begin(), pages.end(), [](const DecodedPage& a, const DecodedPage& b) {
+    return (int32_t)(a.seq - b.seq) < 0;
+  });
+  const uint16_t captureId = (opt.capture >= 0) ? (uint16_t)opt.capture : pages.back().captureId;
+
+  std::vector<Sample> samples;
+  unsigned usedPages = 0;
+  for (const DecodedPage& p : pages) {
+    if (p.captureId != captureId) continue;
+    ++usedPages;
+    samples.insert(samples.end(), p.samples.begin(), p.samples.end());
+  }
+  if (samples.empty()) {
+    std::fprintf(stderr, "capture %u has no samples\n", (unsigned)captureId);
+    return 1;
+  }
+  // Channels interleave within a page; replay needs one timeline.
+  const uint32_t t0 = samples.front().tsMs;
+  std::stable_sort(samples.begin(), samples.end(), [t0](const Sample& a, const Sample& b) {
+    return (int32_t)(a.tsMs - t0) < (int32_t)(b.tsMs - t0);
+  });
+  const uint32_t start = samples.front().tsMs;
+  const uint32_t spanMs = samples.back().tsMs - start;
+
+  uint32_t pulseSlots = 0;
+  uint32_t perChannel[SampleCodec::kChannels] = {};
+  for (const Sample& s : samples) {
+    ++perChannel[s.channel];
+    if (s.channel < HwCfg::SENSOR_COUNT && HwCfg::SENSORS[s.channel].kind == SensorKind::vibration) {
+      pulseSlots |= 1u << s.channel;
+    }
+  }
+
+  std::printf("capture %u: %u pages (%u partial skipped), %zu samples, %.1f s, %.2f bytes/sample\n",
+              (unsigned)captureId,
+              usedPages,
+              partial,
+              samples.size(),
+              spanMs / 1000.0,
+              (double)usedPages * SampleCodec::kPageBytes / (double)samples.size());
+  for (uint8_t c = 0; c < SampleCodec::kChannels; ++c) {
+    if (!perChannel[c]) continue;
+    const char* name = (c == SampleCodec::kLevelsChannel) ? "levels"
+                       : (c < HwCfg::SENSOR_COUNT)        ? HwCfg::SENSORS[c].name
+                                                          : "?";
+    std::printf("  ch %2u %-8s %u samples\n", (unsigned)c, name, perChannel[c]);
+  }
+  std::printf("replay: near=%d far=%d period=%u ms cooldown=%s tick=%u ms\n",
+              opt.nearCm,
+              opt.farCm,
+              (unsigned)opt.periodMs,
+              opt.cooldownMs < 0 ? "registry" : std::to_string(opt.cooldownMs).c_str(),
+              (unsigned)opt.tickMs);
+
+  for (int& cm : gCm) cm = -1;
+  size_t next = 0;
+  // The bank starts from the first recorded levels, as the board did at capture on.
+  for (const Sample& s : samples) {
+    if (s.channel != SampleCodec::kLevelsChannel) continue;
+    gGpio = gpioFromLevels(s.value);
+    break;
+  }
+
+  SensorBank bank;
+  bank.begin(HwCfg::SENSORS, HwCfg::SENSOR_COUNT, start);
+  bank.setPulseCounted(pulseSlots);
+
+  UltrasonicDriver drivers[kSlots];
+  ChokepointSensor chokepoints[kSlots];
+  VibrationBurst bursts[kSlots];
+  uint32_t pulses[kSlots] = {};
+  for (uint8_t i = 0; i < HwCfg::SENSOR_COUNT && i < kSlots; ++i) {
+    const SensorDef& d = HwCfg::SENSORS[i];
+    if (d.kind != SensorKind::ultrasonic) continue;
+    drivers[i] = UltrasonicDriver(d.trigPin, d.pin);
+    const uint32_t cooldown = opt.cooldownMs < 0 ? d.holdMs : (uint32_t)opt.cooldownMs;
+    chokepoints[i] = ChokepointSensor(&drivers[i], d.id, opt.nearCm, opt.farCm, opt.periodMs, cooldown);
+    chokepoints[i].begin();
+  }
+
+  std::map<std::string, unsigned> counts;
+  auto report = [&](const Event& e) {
+    const char* name = nameOf(e);
+    ++counts[std::string(toString(e.type)) + " " + name];
+    if (opt.quiet) return;
+    std::printf("%10.3f s  %-11s %-6s zone=%s", (uint32_t)(e.ts_ms - start) / 1000.0, toString(e.type), name,
+                toString(e.zone));
+    if (e.type == EventType::vib_spike) std::printf(" intensity=%u", (unsigned)e.value);
+    std::printf("\n");
+  };
+
+  for (uint32_t at = 0;; at += opt.tickMs) {
+    const uint32_t nowMs = start + at;
+    while (next < samples.size() && samples[next].tsMs - start <= at) {
+      const Sample& s = samples[next++];
+      if (s.channel == SampleCodec::kLevelsChannel) {
+        gGpio = gpioFromLevels(s.value);
+      } else if (s.channel < HwCfg::SENSOR_COUNT) {
+        if (HwCfg::SENSORS[s.channel].kind == SensorKind::ultrasonic) gCm[s.channel] = (int)s.value - 1;
+        else pulses[s.channel] += s.value;
+      }
+    }
+
+    Event e;
+    bank.update(nowMs, gGpio);
+    while (bank.next(e)) report(e);
+    for (uint8_t i = 0; i < HwCfg::SENSOR_COUNT && i < kSlots; ++i) {
+      const SensorDef& d = HwCfg::SENSORS[i];
+      if (pulseSlots & (1u << i)) {
+        bursts[i].feed(pulses[i], nowMs, d.holdMs);
+        pulses[i] = 0;
+        VibrationBurst::Hit hit;
+        if (bursts[i].take(hit)) report(Event(EventType::vib_spike, hit.startMs, d.id, d.zone, hit.intensity()));
+      } else if (d.kind == SensorKind::ultrasonic && chokepoints[i].poll(nowMs, e)) {
+        e.zone = d.zone;
+        report(e);
+      }
+    }
+    if (next >= samples.size() && at >= spanMs + kTailMs) break;
+  }
+
+  std::printf("events:\n");
+  if (counts.empty()) std::printf("  none\n");
+  for (const auto& kv : counts) std::printf("  %-24s %u\n", kv.first.c_str(), kv.second);
+  return 0;
+}
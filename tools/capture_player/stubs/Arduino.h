@@ -0,0 +1,16 @@
+#pragma once
+
+// Just enough of the Arduino API for the sensor classes the player links.
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+using String = std::string;
+
+constexpr uint8_t LOW = 0;
+constexpr uint8_t HIGH = 1;
+constexpr uint8_t INPUT = 0x01;
+constexpr uint8_t INPUT_PULLUP = 0x05;
+
+inline void pinMode(uint8_t, uint8_t) {}
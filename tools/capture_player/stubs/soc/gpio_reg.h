@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+
+// GpioSnapshot::read() reads the replayed levels instead of the GPIO registers.
+constexpr uint32_t GPIO_IN_REG = 0;
+constexpr uint32_t GPIO_IN1_REG = 1;
+
+uint32_t capturePlayerReadReg(uint32_t reg);
+#define REG_READ(reg) capturePlayerReadReg(reg)
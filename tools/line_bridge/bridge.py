@@ -137,7 +137,11 @@ LOCK_COMMANDS = {
     "unlock all",
 }
 READ_ONLY_COMMANDS = {"status"}
-SUPPORTED_COMMANDS = LOCK_COMMANDS | READ_ONLY_COMMANDS
+# Sent as one firmware batch (one nonce, one ack, one status; all-or-nothing).
+BATCH_COMMANDS = {
+    "leave home": "lock all;arm away;status",
+}
+SUPPORTED_COMMANDS = LOCK_COMMANDS | READ_ONLY_COMMANDS | set(BATCH_COMMANDS)
 
 INTRUDER_LEVELS = {"alert"}
 INTRUDER_EVENT_TRIGGERS = {
@@ -183,6 +187,8 @@ COMMAND_LABELS = {
     "lock all": "Lock all",
     "unlock all": "Unlock all",
     "status": "Status check",
+    "leave home": "Leave home",
+    "batch": "Command batch",
 }
 
 
@@ -667,7 +673,8 @@ def publish_cmd(cmd: str) -> bool:
         return False
     if not command_auth_ready() and not is_read_only_cmd(text):
         return False
-    payload = _encode_command_payload(text) if command_auth_ready() else text
+    wire = BATCH_COMMANDS.get(text, text)
+    payload = _encode_command_payload(wire) if command_auth_ready() else wire
     if not mqtt_publish_ok(MQTT_TOPIC_CMD, payload=payload, qos=0, retain=False):
         return False
     state.last_cmd = text
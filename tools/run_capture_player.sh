@@ -0,0 +1,21 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+cd "$ROOT_DIR"
+
+mkdir -p .pio/native
+
+CXX_BIN="${CXX:-g++}"
+
+# The player supplies UltrasonicDriver and the GPIO register reads; the sensor
+# classes are the firmware's own.
+"$CXX_BIN" -std=c++17 -O2 -Wall -Wextra -pedantic -Wno-unused-function \
+  -Itools/capture_player/stubs -Isrc -Isrc/main_board \
+  tools/capture_player/capture_player.cpp \
+  src/main_board/sensors/SensorBank.cpp \
+  src/main_board/sensors/ChokepointSensor.cpp \
+  -o .pio/native/capture_player
+
+# Args: <dump.log> [--capture N] [--near CM] [--far CM] [--period MS] [--cooldown MS] [--tick MS] [--quiet]
+.pio/native/capture_player "$@"
@@ -0,0 +1,16 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+cd "$ROOT_DIR"
+
+mkdir -p .pio/native
+
+CXX_BIN="${CXX:-g++}"
+
+"$CXX_BIN" -std=c++17 -O2 -Wall -Wextra -pedantic \
+  -Isrc \
+  test/bench/mqtt_json_bench.cpp \
+  -o .pio/native/mqtt_json_bench
+
+.pio/native/mqtt_json_bench "$@"
@@ -0,0 +1,17 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+cd "$ROOT_DIR"
+
+mkdir -p .pio/native
+
+CXX_BIN="${CXX:-g++}"
+
+"$CXX_BIN" -std=c++17 -O2 -Wall -Wextra -pedantic \
+  -Isrc -Isrc/main_board \
+  test/bench/mqtt_qos_bench.cpp \
+  -o .pio/native/mqtt_qos_bench
+
+# Needs a broker, e.g. `mosquitto -p 1883`. Args: [host] [port] [messages]
+.pio/native/mqtt_qos_bench "$@"
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""
+Binary serial injection for hardware-in-the-loop soak tests (main board).
+
+Streams batches of test codes as framed binary (see docs/serial_test_codes.md) and
+reports throughput and the board's acked processing latency.
+
+Usage:
+  python tools/simulator/serial_inject.py COM5 --codes 310,311,320 --rate 2000 --seconds 60
+  python tools/simulator/serial_inject.py /dev/ttyUSB0 --baud 921600 --codes 303:40 --quiet
+
+Requires pyserial (pip install pyserial).
+"""
+
+from __future__ import annotations
+
+import argparse
+import struct
+import sys
+import time
+from typing import Dict, List, Tuple
+
+MAGIC = b"\xa5\x5a"
+TYPE_EVENTS = 0x01
+TYPE_ACK = 0x81
+FLAG_QUIET = 0x01
+MAX_RECORDS = 50
+STATUS = {0: "ok", 1: "crc", 2: "busy", 3: "bad", 4: "dup"}
+
+
+def crc16(data: bytes, crc: int = 0xFFFF) -> int:
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def encode(ftype: int, seq: int, payload: bytes) -> bytes:
+    body = struct.pack("<BHB", ftype, seq & 0xFFFF, len(payload)) + payload
+    return MAGIC + body + struct.pack("<H", crc16(body))
+
+
+def events_frame(seq: int, records: List[Tuple[int, int, int]], quiet: bool) -> bytes:
+    payload = bytes([FLAG_QUIET if quiet else 0])
+    for code, offset_ms, value in records:
+        payload += struct.pack("<HHB", code, offset_ms, value)
+    return encode(TYPE_EVENTS, seq, payload)
+
+
+class AckReader:
+    """Pulls ACK frames out of the serial stream; other bytes are log text."""
+
+    def __init__(self) -> None:
+        self.buf = bytearray()
+        self.text = bytearray()
+
+    def feed(self, data: bytes) -> List[Tuple[int, Dict[str, int]]]:
+        self.buf += data
+        acks = []
+        while True:
+            i = self.buf.find(MAGIC)
+            if i < 0:
+                keep = 1 if self.buf.endswith(MAGIC[:1]) else 0
+                self.text += self.buf[: len(self.buf) - keep]
+                del self.buf[: len(self.buf) - keep]
+                break
+            self.text += self.buf[:i]
+            del self.buf[:i]
+            if len(self.buf) < 6:
+                break
+            ftype, seq, length = struct.unpack_from("<BHB", self.buf, 2)
+            if len(self.buf) < 8 + length:
+                break
+            body = bytes(self.buf[2 : 6 + length])
+            (crc,) = struct.unpack_from("<H", self.buf, 6 + length)
+            if ftype != TYPE_ACK or crc != crc16(body) or length < 16:
+                del self.buf[:1]
+                continue
+            status, accepted, blocked, rejected, latency, max_event, gaps, free = struct.unpack_from(
+                "<BBBBIIHB", body, 4
+            )
+            acks.append(
+                (
+                    seq,
+                    dict(
+                        status=status,
+                        accepted=accepted,
+                        blocked=blocked,
+                        rejected=rejected,
+                        latency_us=latency,
+                        max_event_us=max_event,
+                        gaps=gaps,
+                        free=free,
+                    ),
+                )
+            )
+            del self.buf[: 8 + length]
+        return acks
+
+
+def parse_codes(spec: str) -> List[Tuple[int, int]]:
+    out = []
+    for item in spec.split(","):
+        code, _, value = item.partition(":")
+        out.append((int(code), int(value or 0)))
+    return out
+
+
+def percentile(values: List[int], p: float) -> int:
+    if not values:
+        return 0
+    s = sorted(values)
+    return s[min(len(s) - 1, int(len(s) * p))]
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("port")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--codes", default="310", help="code[:value],... sent round-robin")
+    ap.add_argument("--rate", type=int, default=1000, help="events per second")
+    ap.add_argument("--seconds", type=float, default=10.0)
+    ap.add_argument("--batch", type=int, default=MAX_RECORDS)
+    ap.add_argument("--window", type=int, default=3, help="frames in flight")
+    ap.add_argument("--quiet", action="store_true", help="suppress per-event [TRACE] lines")
+    ap.add_argument("--log", action="store_true", help="echo board log text")
+    args = ap.parse_args()
+
+    import serial  # pyserial
+
+    codes = parse_codes(args.codes)
+    batch = max(1, min(args.batch, MAX_RECORDS))
+    span_ms = batch * 1000.0 / max(1, args.rate)
+    port = serial.Serial(args.port, args.baud, timeout=0)
+    reader = AckReader()
+
+    seq = 0
+    sent: Dict[int, Tuple[bytes, float]] = {}
+    totals = dict(accepted=0, blocked=0, rejected=0, crc=0, busy=0, dup=0, bad=0)
+    latencies: List[int] = []
+    max_event = 0
+    gaps = 0
+    next_code = 0
+    start = time.monotonic()
+    next_send = start
+
+    while True:
+        now = time.monotonic()
+        sending = now - start < args.seconds
+        if sending and len(sent) < args.window and now >= next_send:
+            records = []
+            for i in range(batch):
+                code, value = codes[next_code % len(codes)]
+                next_code += 1
+                records.append((code, int(i * span_ms / batch), value))
+            frame = events_frame(seq, records, args.quiet)
+            port.write(frame)
+            sent[seq] = (frame, now + 2.0 + span_ms / 1000.0)
+            seq = (seq + 1) & 0xFFFF
+            next_send += span_ms / 1000.0
+        elif not sending and not sent:
+            break
+
+        for ack_seq, a in reader.feed(port.read(4096)):
+            status = STATUS.get(a["status"], "bad")
+            if ack_seq not in sent:
+                continue
+            if status in ("busy", "crc"):
+                # Resent shortly; a crc ack's seq may itself be corrupt, so it also times out.
+                totals[status] += 1
+                if status == "busy":
+                    sent[ack_seq] = (sent[ack_seq][0], now + 0.01)
+                continue
+            if status in ("dup", "bad"):
+                # A dup repeats the counts of an ack already seen (or lost); not re-added.
+                totals[status] += 1
+                sent.pop(ack_seq, None)
+                continue
+            totals["accepted"] += a["accepted"]
+            totals["blocked"] += a["blocked"]
+            totals["rejected"] += a["rejected"]
+            latencies.append(a["latency_us"])
+            max_event = max(max_event, a["max_event_us"])
+            gaps = a["gaps"]
+            sent.pop(ack_seq, None)
+
+        for s, (frame, resend_at) in list(sent.items()):
+            if now >= resend_at:
+                port.write(frame)
+                sent[s] = (frame, now + 2.0 + span_ms / 1000.0)
+        if args.log and reader.text:
+            sys.stdout.write(reader.text.decode("utf-8", "replace"))
+            reader.text.clear()
+        time.sleep(0.0005)
+
+    elapsed = time.monotonic() - start
+    handled = totals["accepted"] + totals["blocked"] + totals["rejected"]
+    print(f"frames={seq} events={handled} rate={handled / elapsed:.0f}/s")
+    print(
+        f"accepted={totals['accepted']} blocked={totals['blocked']} rejected={totals['rejected']} "
+        f"crc={totals['crc']} busy={totals['busy']} dup={totals['dup']} bad={totals['bad']} gaps={gaps}"
+    )
+    print(
+        f"batch_latency_us p50={percentile(latencies, 0.5)} p99={percentile(latencies, 0.99)} "
+        f"max={max(latencies) if latencies else 0} max_event_us={max_event}"
+    )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())